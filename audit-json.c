@@ -45,6 +45,11 @@ static	const char *const stypes[STYPE__MAX] = {
 	"get", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static	const char *const optypes[OPTYPE__MAX] = {
@@ -59,6 +64,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	/* Unary types... */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
@@ -87,6 +93,12 @@ print_name_db_search(const struct search *s)
 	rc = printf("db_%s_%s", s->parent->name, stypes[s->type]);
 	sz += rc > 0 ? rc : 0;
 
+	if (s->name == NULL && s->afield != NULL)
+		sz += (rc = printf("_%s", s->afield->name)) > 0 ? rc : 0;
+	if (s->name == NULL && s->groupby != NULL)
+		sz += (rc = printf("_groupby_%s", 
+			s->groupby->name)) > 0 ? rc : 0;
+
 	if (s->name == NULL && !TAILQ_EMPTY(&s->sntq)) {
 		sz += (rc = printf("_by")) > 0 ? rc : 0;
 		TAILQ_FOREACH(sent, &s->sntq, entries) {
@@ -54,11 +54,20 @@ main(int argc, char *argv[])
 	args.flags = ORT_LANG_C_CORE | ORT_LANG_C_DB_SQLBOX;
 	args.guard = "DB_H";
 
-	while ((c = getopt(argc, argv, "g:jJN:sv")) != -1)
+	while ((c = getopt(argc, argv, "beg:ijJN:r:sv")) != -1)
 		switch (c) {
+		case 'b':
+			args.flags |= ORT_LANG_C_ITERATE_BATCH;
+			break;
+		case 'e':
+			args.flags |= ORT_LANG_C_DB_ERRORS;
+			break;
 		case 'g':
 			args.guard = optarg[0] == '\0' ? NULL : optarg;
 			break;
+		case 'i':
+			args.flags |= ORT_LANG_C_DB_IDMAP;
+			break;
 		case 'j':
 			args.flags |= ORT_LANG_C_JSON_KCGI;
 			break;
@@ -71,6 +80,9 @@ main(int argc, char *argv[])
 			if (strchr(optarg, 'd') != NULL)
 				args.flags &= ~ORT_LANG_C_DB_SQLBOX;
 			break;
+		case 'r':
+			args.role = optarg;
+			break;
 		case 's':
 			args.flags |= ORT_LANG_C_SAFE_TYPES;
 			break;
@@ -109,9 +121,13 @@ main(int argc, char *argv[])
 	if (argc == 0 && !ort_parse_file(cfg, stdin, "<stdin>"))
 		goto out;
 
-	if ((rc = ort_parse_close(cfg)))
-		if (!(rc = ort_lang_c_header(&args, cfg, stdout)))
-			warn(NULL);
+	if ((rc = ort_parse_close(cfg)) && args.role != NULL &&
+	    get_role(cfg, args.role) == NULL) {
+		warnx("%s: unknown role", args.role);
+		rc = 0;
+	}
+	if (rc && !(rc = ort_lang_c_header(&args, cfg, stdout)))
+		warn(NULL);
 out:
 	ort_write_msg_file(stderr, &cfg->mq);
 	ort_config_free(cfg);
@@ -124,8 +140,9 @@ out:
 usage:
 	fprintf(stderr, 
 		"usage: %s "
-		"[-jJsv] "
+		"[-beijJsv] "
 		"[-N[b|d]] "
+		"[-r role] "
 		"[config...]\n",
 		getprogname());
 	return EXIT_FAILURE;
@@ -49,8 +49,14 @@ main(int argc, char *argv[])
 
 	memset(&args, 0, sizeof(struct ort_lang_c));
 
-	while ((c = getopt(argc, argv, "jJv")) != -1)
+	while ((c = getopt(argc, argv, "bejJv")) != -1)
 		switch (c) {
+		case 'b':
+			args.flags |= ORT_LANG_C_ITERATE_BATCH;
+			break;
+		case 'e':
+			args.flags |= ORT_LANG_C_DB_ERRORS;
+			break;
 		case 'j':
 			args.flags |= ORT_LANG_C_JSON_KCGI;
 			break;
@@ -105,6 +111,6 @@ out:
 	free(confs);
 	return !rc;
 usage:
-	fprintf(stderr, "usage: %s [-jJv] [config...]\n", getprogname());
+	fprintf(stderr, "usage: %s [-bejJv] [config...]\n", getprogname());
 	return 1;
 }
@@ -294,6 +294,12 @@ parse_free_resolve(struct resolve *p)
 	case RESOLVE_FIELD_STRUCT:
 		free(p->field_struct.sfield);
 		break;
+	case RESOLVE_AFIELD:
+		free(p->struct_afield.name);
+		break;
+	case RESOLVE_GROUPBY:
+		free(p->struct_groupby.name);
+		break;
 	case RESOLVE_AGGR:
 		for (i = 0; i < p->struct_aggr.namesz; i++)
 			free(p->struct_aggr.names[i]);
@@ -406,6 +412,7 @@ ort_config_free(struct config *cfg)
 		free(cfg->fnames[i]);
 	free(cfg->fnames);
 
+	free(cfg->db);
 	free(cfg->priv);
 	free(cfg);
 }
@@ -89,6 +89,7 @@ main(int argc, char *argv[])
 	FILE			**confs = NULL;
 	size_t			  i;
 	char			 *ext_gensalt, *ext_jsmn, *ext_b64_ntop;
+	const char		 *er;
 
 #if HAVE_PLEDGE
 	if (pledge("stdio rpath", NULL) == -1)
@@ -99,13 +100,22 @@ main(int argc, char *argv[])
 	args.header = "db.h";
 	args.flags = ORT_LANG_C_DB_SQLBOX;
 
-	while ((c = getopt(argc, argv, "h:I:jJN:S:v")) != -1)
+	while ((c = getopt(argc, argv, "beh:iI:jJN:r:R:S:v")) != -1)
 		switch (c) {
+		case 'b':
+			args.flags |= ORT_LANG_C_ITERATE_BATCH;
+			break;
+		case 'e':
+			args.flags |= ORT_LANG_C_DB_ERRORS;
+			break;
 		case 'h':
 			args.header = optarg;
 			if (*optarg == '\0')
 				args.header = NULL;
 			break;
+		case 'i':
+			args.flags |= ORT_LANG_C_DB_IDMAP;
+			break;
 		case 'I':
 			if (strchr(optarg, 'd') != NULL)
 				args.includes |= ORT_LANG_C_DB_SQLBOX;
@@ -124,6 +134,14 @@ main(int argc, char *argv[])
 			if (strchr(optarg, 'd') != NULL)
 				args.flags &= ~ORT_LANG_C_DB_SQLBOX;
 			break;
+		case 'r':
+			args.role = optarg;
+			break;
+		case 'R':
+			args.readers = strtonum(optarg, 0, 64, &er);
+			if (er != NULL)
+				errx(EXIT_FAILURE, "-R: %s", er);
+			break;
 		case 'S':
 			sharedir = optarg;
 			break;
@@ -170,9 +188,13 @@ main(int argc, char *argv[])
 	if (argc == 0 && !ort_parse_file(cfg, stdin, "<stdin>"))
 		goto out;
 
-	if ((rc = ort_parse_close(cfg)))
-		if (!(rc = ort_lang_c_source(&args, cfg, stdout)))
-			warn(NULL);
+	if ((rc = ort_parse_close(cfg)) && args.role != NULL &&
+	    get_role(cfg, args.role) == NULL) {
+		warnx("%s: unknown role", args.role);
+		rc = 0;
+	}
+	if (rc && !(rc = ort_lang_c_source(&args, cfg, stdout)))
+		warn(NULL);
 out:
 	ort_write_msg_file(stderr, &cfg->mq);
 	ort_config_free(cfg);
@@ -188,10 +210,12 @@ out:
 usage:
 	fprintf(stderr, 
 		"usage: %s "
-		"[-jJv] "
+		"[-beijJv] "
 		"[-h header[,header...] "
 		"[-I jJv] "
 		"[-N d] "
+		"[-r role] "
+		"[-R readers] "
 		"[config...]\n",
 		getprogname());
 	return EXIT_FAILURE;
@@ -692,6 +692,19 @@ ort_diff_update(struct diffq *q,
 		rc = 0;
 	}
 
+	/* Batch size (deletes only). */
+
+	if (from->batch != into->batch) {
+		if (q != NULL) {
+			d = diff_alloc(q, DIFF_MOD_UPDATE_BATCH);
+			if (d == NULL)
+				return -1;
+			d->update_pair.from = from;
+			d->update_pair.into = into;
+		}
+		rc = 0;
+	}
+
 	return rc;
 }
 
@@ -922,6 +935,45 @@ ort_diff_search(struct diffq *q,
 		rc = 0;
 	}
 
+	if ((from->afield != NULL && into->afield == NULL) ||
+	    (from->afield == NULL && into->afield != NULL) ||
+	    (from->afield != NULL && into->afield != NULL &&
+	     strcasecmp(from->afield->name, into->afield->name))) {
+		if (q != NULL) {
+			d = diff_alloc(q, DIFF_MOD_SEARCH_FIELD);
+			if (d == NULL)
+				return -1;
+			d->search_pair.from = from;
+			d->search_pair.into = into;
+		}
+		rc = 0;
+	}
+
+	if ((from->groupby != NULL && into->groupby == NULL) ||
+	    (from->groupby == NULL && into->groupby != NULL) ||
+	    (from->groupby != NULL && into->groupby != NULL &&
+	     strcasecmp(from->groupby->name, into->groupby->name))) {
+		if (q != NULL) {
+			d = diff_alloc(q, DIFF_MOD_SEARCH_GROUPBY);
+			if (d == NULL)
+				return -1;
+			d->search_pair.from = from;
+			d->search_pair.into = into;
+		}
+		rc = 0;
+	}
+
+	if ((from->flags & SEARCH_CACHE) != (into->flags & SEARCH_CACHE)) {
+		if (q != NULL) {
+			d = diff_alloc(q, DIFF_MOD_SEARCH_FLAGS);
+			if (d == NULL)
+				return -1;
+			d->search_pair.from = from;
+			d->search_pair.into = into;
+		}
+		rc = 0;
+	}
+
 	if (!ort_check_comment(from->doc, into->doc)) {
 		if (q != NULL) {
 			d = diff_alloc(q, DIFF_MOD_SEARCH_COMMENT);
@@ -1126,6 +1178,15 @@ ort_diff_strct_insert(struct diffq *q,
 		rc = 0;
 	}
 
+	if (fins->flags != iins->flags) {
+		d = diff_alloc(q, DIFF_MOD_INSERT_FLAGS);
+		if (d == NULL)
+			return -1;
+		d->strct_pair.into = into;
+		d->strct_pair.from = from;
+		rc = 0;
+	}
+
 	if (!ort_check_insert_order(from, into)) {
 		d = diff_alloc(q, DIFF_MOD_INSERT_PARAMS);
 		if (d == NULL)
@@ -25,6 +25,8 @@ enum	resolvet {
 	RESOLVE_FIELD_ENUM,
 	RESOLVE_FIELD_FOREIGN,
 	RESOLVE_FIELD_STRUCT,
+	RESOLVE_AFIELD,
+	RESOLVE_GROUPBY,
 	RESOLVE_AGGR,
 	RESOLVE_DISTINCT,
 	RESOLVE_GROUPROW,
@@ -71,6 +73,14 @@ struct	resolve {
 				struct uref	*result;
 				char		*name;
 		} struct_up_mod; /* update ->bar<-: ... */
+		struct struct_afield {
+				struct search	*result;
+				char		*name;
+		} struct_afield; /* sum ->bar<-... */
+		struct struct_groupby {
+				struct search	*result;
+				char		*name;
+		} struct_groupby; /* count: groupby ->bar<- */
 		struct struct_aggr {
 				struct aggr	 *result;
 				char		**names;
@@ -45,6 +45,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"logical or", /* OPTYPE_OR */
 	"string equals", /* OPTYPE_STREQ */
 	"string does not equal", /* OPTYPE_STRNEQ */
+	"in set", /* OPTYPE_IN */
 	/* Unary types... */
 	"is null", /* OPTYPE_ISNULL */
 	"is not null" /* OPTYPE_NOTNULL */
@@ -324,6 +325,88 @@ gen_types(FILE *f, const struct ort_lang_c *args,
 	return 1;
 }
 
+/*
+ * Generate the result structure of a grouped query, which consists of
+ * the grouping key and the count or aggregate value.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_group(FILE *f, const struct search *s)
+{
+	const struct field	*fd = s->groupby;
+	const struct field	*rfd;
+	int			 c = 0;
+
+	if (STYPE_ISAGGR(s->type)) {
+		if (!gen_commentv(f, 0, COMMENT_C,
+		    "%s of %s over rows of %s grouped by %s.", 
+		    s->type == STYPE_SUM ? "Sum" :
+		    s->type == STYPE_AVG ? "Average" :
+		    s->type == STYPE_MIN ? "Minimum" : "Maximum",
+		    s->afield->name, s->parent->name, fd->name))
+			return 0;
+	} else {
+		if (!gen_commentv(f, 0, COMMENT_C,
+		    "Count of rows of %s grouped by %s.",
+		    s->parent->name, fd->name))
+			return 0;
+	}
+
+	if (fputs("struct\t", f) == EOF ||
+	    gen_group_name(f, s) < 0 ||
+	    fputs(" {\n", f) == EOF)
+		return 0;
+
+	if (!gen_commentv(f, 1, COMMENT_C,
+	    "Value of \"%s\" shared by the group.", fd->name))
+		return 0;
+
+	switch (fd->type) {
+	case FTYPE_REAL:
+		c = fputs("\tdouble\t key;\n", f);
+		break;
+	case FTYPE_DATE:
+	case FTYPE_EPOCH:
+		c = fputs("\ttime_t\t key;\n", f);
+		break;
+	case FTYPE_BIT:
+	case FTYPE_BITFIELD:
+	case FTYPE_INT:
+		rfd = fd->ref != NULL ? fd->ref->target : fd;
+		c = fprintf(f, "\t%s_%s\t key;\n", 
+			rfd->parent->name, rfd->name);
+		break;
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		c = fputs("\tchar\t*key;\n", f);
+		break;
+	case FTYPE_ENUM:
+		c = fprintf(f, "\tenum %s key;\n", fd->enm->name);
+		break;
+	default:
+		abort();
+	}
+	if (c < 0)
+		return 0;
+
+	if (STYPE_ISAGGR(s->type)) {
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "Aggregate value, which is never null."))
+			return 0;
+		if (fprintf(f, "\t%sval;\n", 
+		    get_aggr_type_str(s)) < 0)
+			return 0;
+	} else {
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "Number of rows in the group."))
+			return 0;
+		if (fputs("\tuint64_t val;\n", f) == EOF)
+			return 0;
+	}
+
+	return fputs("};\n\n", f) != EOF;
+}
+
 /*
  * Generate the C API for a given structure.
  * This generates the TAILQ_ENTRY listing if the structure has any
@@ -335,6 +418,7 @@ gen_struct(FILE *f, const struct ort_lang_c *args,
 	const struct config *cfg, const struct strct *s)
 {
 	const struct field	*fd;
+	const struct search	*sr;
 
 	if (!gen_comment(f, 0, COMMENT_C, s->doc))
 		return 0;
@@ -372,7 +456,7 @@ gen_struct(FILE *f, const struct ort_lang_c *args,
 	    fprintf(f, "\tTAILQ_ENTRY(%s) _entries;\n", s->name) < 0)
 		return 0;
 
-	if (!TAILQ_EMPTY(&cfg->rq)) {
+	if (gen_rbac(cfg, args->role)) {
 		if (!gen_comment(f, 1, COMMENT_C,
 		    "Private data used for role analysis."))
 			return 0;
@@ -380,6 +464,17 @@ gen_struct(FILE *f, const struct ort_lang_c *args,
 			return 0;
 	}
 
+	if ((args->flags & ORT_LANG_C_DB_IDMAP) &&
+	    gen_strct_shared(cfg, s)) {
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "Private: if not NULL, the number of results of a "
+		    "listing sharing the memory of the same row, which is "
+		    "only freed along with the last of them."))
+			return 0;
+		if (fputs("\tsize_t *priv_refs;\n", f) == EOF)
+			return 0;
+	}
+
 	if (fputs("};\n\n", f) == EOF)
 		return 0;
 
@@ -404,6 +499,28 @@ gen_struct(FILE *f, const struct ort_lang_c *args,
 			return 0;
 	}
 
+	if ((s->flags & STRCT_HAS_ITERATOR) &&
+	    (args->flags & ORT_LANG_C_ITERATE_BATCH)) {
+		if (!gen_commentv(f, 0, COMMENT_C, 
+		    "Callback of %s for batched iteration.\n"
+		    "The v parameter is an array of vsz elements, "
+		    "which is only valid for the duration of the "
+		    "callback.\n"
+		    "The arg parameter is the opaque pointer "
+		    "passed into the iterate function.",
+		    s->name))
+			return 0;
+		if (fprintf(f, "typedef void (*%s_batch_cb)(const struct "
+		    "%s *v,\n\tsize_t vsz, void *arg);\n\n", 
+		    s->name, s->name) < 0)
+			return 0;
+	}
+
+	TAILQ_FOREACH(sr, &s->sq, entries)
+		if (sr->groupby != NULL && get_group_first(sr) &&
+		    !gen_group(f, sr))
+			return 0;
+
 	return 1;
 }
 
@@ -443,6 +560,15 @@ gen_update(FILE *f, const struct config *cfg, const struct update *up)
 				    pos++, ref->field->name))
 					return 0;
 			}
+	} else if (up->batch > 0) {
+		if (!gen_commentv(f, 0, ct, 
+		    "Delete fields in struct %s.\n"
+		    "This deletes at most %" PRId64 " rows per "
+		    "statement, each in its own\n"
+		    "transaction unless one is already open, "
+		    "until none remain.",
+		    up->parent->name, up->batch))
+			return 0;
 	} else {
 		if (!gen_commentv(f, 0, ct, 
 		    "Delete fields in struct %s.\n",
@@ -471,7 +597,18 @@ gen_update(FILE *f, const struct config *cfg, const struct update *up)
 				return 0;
 		}
 
-	if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
+	if (up->flags & UPDATE_RETURNING) {
+		if (!gen_commentv(f, 0, COMMENT_C_FRAG_CLOSE,
+		    "Returns NULL on constraint violation, "
+		    "otherwise the updated rows\n"
+		    "(possibly empty), which must be freed "
+		    "with db_%s_freeq().", up->parent->name))
+			return 0;
+	} else if (up->batch > 0) {
+		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
+		    "Returns the number of rows deleted."))
+			return 0;
+	} else if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
 	    "Returns zero on constraint violation, "
 	    "non-zero on success."))
 		return 0;
@@ -486,7 +623,8 @@ gen_update(FILE *f, const struct config *cfg, const struct update *up)
  * Returns zero on failure, non-zero on success.
  */
 static int
-gen_search(FILE *f, const struct config *cfg, const struct search *s)
+gen_search(FILE *f, const struct ort_lang_c *args,
+	const struct config *cfg, const struct search *s)
 {
 	const struct sent	*sent;
 	const struct strct	*rc;
@@ -509,12 +647,30 @@ gen_search(FILE *f, const struct config *cfg, const struct search *s)
 		if (!gen_commentv(f, 0, COMMENT_C_FRAG_OPEN,
 		    "Count results of a search in %s.", rc->name))
 			return 0;
+	} else if (s->type == STYPE_EXISTS) {
+		if (!gen_commentv(f, 0, COMMENT_C_FRAG_OPEN,
+		    "Check for any results of a search in %s.\n"
+		    "This stops at the first matching row.", 
+		    rc->name))
+			return 0;
+	} else if (STYPE_ISAGGR(s->type)) {
+		if (!gen_commentv(f, 0, COMMENT_C_FRAG_OPEN,
+		    "%s of %s over results of a search in %s.", 
+		    s->type == STYPE_SUM ? "Sum" :
+		    s->type == STYPE_AVG ? "Average" :
+		    s->type == STYPE_MIN ? "Minimum" : "Maximum",
+		    s->afield->name, rc->name))
+			return 0;
 	} else {
 		if (!gen_commentv(f, 0, COMMENT_C_FRAG_OPEN,
 		    "Iterate over results in %s.", rc->name))
 			return 0;
 	}
 
+	if (s->groupby != NULL && !gen_commentv(f, 0, COMMENT_C_FRAG,
+	    "Results are grouped by \"%s\".", s->groupby->name))
+		return 0;
+
 	if (s->dst != NULL) {
 		if (!gen_commentv(f, 0, COMMENT_C_FRAG,
 		    "This %s distinct query results.",
@@ -540,7 +696,8 @@ gen_search(FILE *f, const struct config *cfg, const struct search *s)
 	     "deadlock."))
 		return 0;
 
-	if ((rc->flags & STRCT_HAS_NULLREFS) && !gen_comment
+	if ((rc->flags & STRCT_HAS_NULLREFS) && 
+	    s->type != STYPE_EXISTS && !gen_comment
 	    (f, 0, COMMENT_C_FRAG,
 	     "This search involves nested null structure "
 	     "linking, which involves multiple database "
@@ -586,10 +743,31 @@ gen_search(FILE *f, const struct config *cfg, const struct search *s)
 		    "Free this with db_%s_freeq().",
 		    rc->name))
 			return 0;
+	} else if (s->groupby != NULL) {
+		if (!gen_commentv(f, 0, COMMENT_C_FRAG_CLOSE,
+		    "Returns an array of \"sz\" groups or NULL if "
+		    "there are none.\n"
+		    "Free this with db_%s_%s%s%s_groupby_%s_free().",
+		    s->parent->name, get_stype_str(s->type), 
+		    STYPE_ISAGGR(s->type) ? "_" : "",
+		    STYPE_ISAGGR(s->type) ? s->afield->name : "",
+		    s->groupby->name))
+			return 0;
 	} else if (s->type == STYPE_COUNT) {
 		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
 		    "Returns the count of results."))
 			return 0;
+	} else if (s->type == STYPE_EXISTS) {
+		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
+		    "Returns non-zero if there are any results, "
+		    "zero otherwise."))
+			return 0;
+	} else if (STYPE_ISAGGR(s->type)) {
+		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
+		    "Returns zero if there were no non-null values "
+		    "(e.g., no results), otherwise sets \"out\" to "
+		    "the result and returns non-zero."))
+			return 0;
 	} else {
 		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
 		    "Invokes the given callback with "
@@ -599,7 +777,18 @@ gen_search(FILE *f, const struct config *cfg, const struct search *s)
 
 	if (!gen_func_db_search(f, s, 1))
 		return 0;
-	return fputs("", f) != EOF;
+
+	if (s->type != STYPE_ITERATE ||
+	    !(args->flags & ORT_LANG_C_ITERATE_BATCH))
+		return fputs("", f) != EOF;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Like the above, but filling up to n (or one, if "
+	    "zero) results at a time and invoking the given "
+	    "callback once per batch.\n"
+	    "Row storage is reused between batches."))
+		return 0;
+	return gen_func_db_iterate_batch(f, s, 1);
 }
 
 /*
@@ -607,13 +796,19 @@ gen_search(FILE *f, const struct config *cfg, const struct search *s)
  * Returns zero on failure, non-zero on success.
  */
 static int
-gen_database(FILE *f, const struct config *cfg, const struct strct *p)
+gen_database(FILE *f, const struct ort_lang_c *args,
+	const struct config *cfg, const struct strct *p)
 {
 	const struct search	*s;
 	const struct field	*fd;
 	const struct update	*u;
+	const struct role	*r;
 	size_t			 pos;
 
+	/* Only declare operations granted to the role, if given. */
+
+	r = get_role(cfg, args->role);
+
 	if (!gen_comment(f, 0, COMMENT_C,
 	    "Clear resources and free \"p\".\n"
 	    "Has no effect if \"p\" is NULL."))
@@ -635,7 +830,21 @@ gen_database(FILE *f, const struct config *cfg, const struct strct *p)
 			return 0;
 	}
 
-	if (p->ins != NULL) {
+	TAILQ_FOREACH(s, &p->sq, entries) {
+		if (s->groupby == NULL || !get_group_first(s) ||
+		    !gen_role_granted(s->rolemap, r))
+			continue;
+		if (!gen_comment(f, 0, COMMENT_C,
+		    "Free the array \"p\" of \"sz\" groups.\n"
+		    "Has no effect if \"p\" is NULL."))
+			return 0;
+		if (!gen_func_db_group_free(f, s, 1))
+			return 0;
+		if (fputs("\n", f) == EOF)
+			return 0;
+	}
+
+	if (p->ins != NULL && gen_role_granted(p->ins->rolemap, r)) {
 		if (!gen_comment(f, 0, COMMENT_C_FRAG_OPEN,
 		    "Insert a new row into the database.\n"
 		    "Only native (and non-rowid) fields may "
@@ -657,7 +866,14 @@ gen_database(FILE *f, const struct config *cfg, const struct strct *p)
 					return 0;
 			}
 		}
-		if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
+		if (p->ins->flags & INSERT_RETURNING) {
+			if (!gen_commentv(f, 0, COMMENT_C_FRAG_CLOSE,
+			    "Returns the new row on success, which "
+			    "must be freed with\n"
+			    "db_%s_free(), or NULL on constraint "
+			    "violation.", p->name))
+				return 0;
+		} else if (!gen_comment(f, 0, COMMENT_C_FRAG_CLOSE,
 		    "Returns the new row's identifier on "
 		    "success or <0 otherwise."))
 			return 0;
@@ -667,14 +883,36 @@ gen_database(FILE *f, const struct config *cfg, const struct strct *p)
 			return 0;
 	}
 
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (!gen_sql_unique_many(fd) ||
+		    (r != NULL && r->parent == NULL))
+			continue;
+		if (!gen_commentv(f, 0, COMMENT_C,
+		    "Look up all %s whose %s is any of the \"v1_sz\" "
+		    "values in \"v1\" with a single query.\n"
+		    "This may be invoked by any role.\n"
+		    "Always returns a queue pointer ordered by value, "
+		    "which is empty if there are no matches.\n"
+		    "Free this with db_%s_freeq().",
+		    p->name, fd->name, p->name))
+			return 0;
+		if (!gen_func_db_get_many(f, fd, 1))
+			return 0;
+		if (fputs("\n", f) == EOF)
+			return 0;
+	}
+
 	TAILQ_FOREACH(s, &p->sq, entries)
-		if (!gen_search(f, cfg, s))
+		if (gen_role_granted(s->rolemap, r) &&
+		    !gen_search(f, args, cfg, s))
 			return 0;
 	TAILQ_FOREACH(u, &p->uq, entries)
-		if (!gen_update(f, cfg, u))
+		if (gen_role_granted(u->rolemap, r) &&
+		    !gen_update(f, cfg, u))
 			return 0;
 	TAILQ_FOREACH(u, &p->dq, entries)
-		if (!gen_update(f, cfg, u))
+		if (gen_role_granted(u->rolemap, r) &&
+		    !gen_update(f, cfg, u))
 			return 0;
 
 	return 1;
@@ -975,6 +1213,29 @@ gen_open(FILE *f, const struct config *cfg)
 		return 0;
 	if (!gen_func_db_open_logging(f, 1))
 		return 0;
+	if (fputs("\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Like db_open() but opening \"file\" read-only.\n"
+	    "Only statements that don't modify the database "
+	    "may be run: insertions, updates, and deletions "
+	    "fail as if not permitted by the role.\n"
+	    "This allows the database to be on a read-only "
+	    "file system.\n"
+	    "The database must already exist."))
+		return 0;
+	if (!gen_func_db_open_ro(f, 1))
+		return 0;
+	if (fputs("\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Like db_open_ro() but accepting logging "
+	    "functions as with db_open_logging()."))
+		return 0;
+	if (!gen_func_db_open_ro_logging(f, 1))
+		return 0;
 	return fputs("\n", f) != EOF;
 }
 
@@ -1025,7 +1286,8 @@ gen_roles(FILE *f, const struct config *cfg)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_close(FILE *f, const struct config *cfg)
+gen_close(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
 {
 
 	if (!gen_comment(f, 0, COMMENT_C,
@@ -1034,6 +1296,35 @@ gen_close(FILE *f, const struct config *cfg)
 		return 0;
 	if (!gen_func_db_close(f, 1))
 		return 0;
+	if (fputs("\n", f) == EOF)
+		return 0;
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Get whether the last database function invoked on the "
+	    "context has failed.\n"
+	    "Each function clears the error when invoked: failing "
+	    "functions return NULL, zero, or -1 (insertions), and the "
+	    "context should then only be closed with db_close()."))
+		return 0;
+	if (!gen_func_db_err(f, 1))
+		return 0;
+	if (fputs("\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Retry failed db_trans_open() and the insertions, updates, "
+	    "and deletions run as a single statement up to \"retries\" "
+	    "times, which defaults to zero.\n"
+	    "Each retry first waits \"ms\" milliseconds, doubled for "
+	    "each earlier retry up to 1024 times, then replaces the "
+	    "database connection with a new one.\n"
+	    "Any failure is retried, as busy or locked databases aren't "
+	    "told apart from other failures, but never while a "
+	    "transaction is open: it would be lost."))
+		return 0;
+	if (!gen_func_db_set_retry(f, 1))
+		return 0;
 	return fputs("\n", f) != EOF;
 }
 
@@ -1109,7 +1400,7 @@ ort_lang_c_header(const struct ort_lang_c *args,
 		return 0;
 	
 	if ((args->flags & ORT_LANG_C_DB_SQLBOX) && 
-	    !TAILQ_EMPTY(&cfg->rq)) {
+	    gen_rbac(cfg, args->role)) {
 		if (!gen_comment(f, 0, COMMENT_C,
 		    "Our roles for access control.\n"
 		    "When the database is first opened, "
@@ -1126,6 +1417,26 @@ ort_lang_c_header(const struct ort_lang_c *args,
 			return 0;
 	}
 
+	if ((args->flags & ORT_LANG_C_DB_SQLBOX) &&
+	    (args->flags & ORT_LANG_C_DB_ERRORS)) {
+		if (!gen_comment(f, 0, COMMENT_C,
+		    "Database errors recorded in the context.\n"
+		    "See db_err()."))
+			return 0;
+		if (fputs("enum\tort_err {\n", f) == EOF)
+			return 0;
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "No error has occurred."))
+			return 0;
+		if (fputs("\tORT_ERR_OK = 0,\n", f) == EOF)
+			return 0;
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "A database operation has failed."))
+			return 0;
+		if (fputs("\tORT_ERR_DB\n};\n\n", f) == EOF)
+			return 0;
+	}
+
 	if (args->flags & ORT_LANG_C_CORE) {
 		TAILQ_FOREACH(e, &cfg->eq, entries)
 			if (!gen_enum(f, e))
@@ -1226,13 +1537,13 @@ ort_lang_c_header(const struct ort_lang_c *args,
 			return 0;
 		if (!gen_transaction(f, cfg))
 			return 0;
-		if (!gen_close(f, cfg))
+		if (!gen_close(f, cfg, args))
 			return 0;
-		if (!TAILQ_EMPTY(&cfg->rq))
+		if (gen_rbac(cfg, args->role))
 			if (!gen_roles(f, cfg))
 				return 0;
 		TAILQ_FOREACH(p, &cfg->sq, entries)
-			if (!gen_database(f, cfg, p))
+			if (!gen_database(f, args, cfg, p))
 				return 0;
 	}
 
@@ -64,6 +64,34 @@ gen_field_type(FILE *f, const struct field *fd)
 	return 1;
 }
 
+/*
+ * Like gen_field_type() but for the array of an "in" constraint.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_field_set_type(FILE *f, const struct field *fd)
+{
+	const struct field	*rfd;
+
+	switch (fd->type) {
+	case FTYPE_ENUM:
+		return fprintf(f, "const enum %s *", fd->enm->name) > 0;
+	case FTYPE_BIT:
+	case FTYPE_BITFIELD:
+	case FTYPE_INT:
+		rfd = fd->ref != NULL ? fd->ref->target : fd;
+		return fprintf(f, "const %s_%s *", 
+			rfd->parent->name, rfd->name) > 0;
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		return fputs("const char *const *", f) != EOF;
+	default:
+		break;
+	}
+
+	return fprintf(f, "const %s*", get_ftype_str(fd->type)) > 0;
+}
+
 static int
 gen_doc_block(FILE *f, const char *cp, int tail, int head)
 {
@@ -347,8 +375,13 @@ gen_strcts(FILE *f, const struct config *cfg)
 	return fprintf(f, ".El\n") < 0 ? -1 : 1;
 }
 
+/*
+ * Document a single query.
+ * If "batch" is non-zero, this documents the batched iterator.
+ * Return zero on failure, non-zero on success.
+ */
 static int
-gen_search(FILE *f, const struct search *sr)
+gen_search(FILE *f, const struct search *sr, int batch)
 {
 	const char		*retname;
 	const struct sent	*sent;
@@ -359,8 +392,15 @@ gen_search(FILE *f, const struct search *sr)
 
 	retname = sr->dst != NULL ? 
 		sr->dst->strct->name : sr->parent->name;
-	if (sr->type == STYPE_COUNT)
+	if (sr->groupby != NULL) {
+		if (fputs("struct ", f) == EOF ||
+		    gen_group_name(f, sr) < 0)
+			return 0;
+		c = fprintf(f, " *");
+	} else if (sr->type == STYPE_COUNT)
 		c = fprintf(f, "uint64_t");
+	else if (STYPE_ISAGGR(sr->type) || sr->type == STYPE_EXISTS)
+		c = fprintf(f, "int");
 	else if (sr->type == STYPE_SEARCH)
 		c = fprintf(f, "struct %s *", retname);
 	else if (sr->type == STYPE_LIST)
@@ -370,8 +410,15 @@ gen_search(FILE *f, const struct search *sr)
 	if (c < 0)
 		return 0;
 
-	if (fprintf(f, "\" Fn db_%s_%s", 
-	    sr->parent->name, get_stype_str(sr->type)) < 0)
+	if (fprintf(f, "\" Fn db_%s_%s%s", sr->parent->name, 
+	    get_stype_str(sr->type), batch ? "_batch" : "") < 0)
+		return 0;
+
+	if (sr->name == NULL && STYPE_ISAGGR(sr->type) &&
+	    fprintf(f, "_%s", sr->afield->name) < 0)
+		return 0;
+	if (sr->name == NULL && sr->groupby != NULL &&
+	    fprintf(f, "_groupby_%s", sr->groupby->name) < 0)
 		return 0;
 
 	if (sr->name == NULL && !TAILQ_EMPTY(&sr->sntq)) {
@@ -392,10 +439,24 @@ gen_search(FILE *f, const struct search *sr)
             "-\t\\fIstruct ort *\\fR\t\\fIctx\\fR\n", f) == EOF)
 		return 0;
 
-	if (sr->type == STYPE_ITERATE && fprintf(f, 
+	if (batch) {
+		if (fprintf(f, 
+		    "-\t\\fI%s_batch_cb\\fR\t\\fIcb\\fR\n"
+		    "-\t\\fIvoid *\\fR\t\\fIarg\\fR\n"
+		    "-\t\\fIsize_t\\fR\t\\fIn\\fR\n", retname) < 0)
+			return 0;
+	} else if (sr->type == STYPE_ITERATE && fprintf(f, 
 	    "-\t\\fI%s_cb\\fR\t\\fIcb\\fR\n"
 	    "-\t\\fIvoid *\\fR\t\\fIarg\\fR\n", retname) < 0)
 		return 0;
+	else if (sr->groupby != NULL) {
+		if (fputs("-\t\\fIsize_t *\\fR\t\\fIsz\\fR\n", 
+		    f) == EOF)
+			return 0;
+	} else if (STYPE_ISAGGR(sr->type) && fprintf(f, 
+	    "-\t\\fI%s*\\fR\t\\fIout\\fR\n", 
+	    get_aggr_type_str(sr)) < 0)
+		return 0;
 
 	TAILQ_FOREACH(sent, &sr->sntq, entries) {
 		if (OPTYPE_ISUNARY(sent->op)) {
@@ -411,12 +472,18 @@ gen_search(FILE *f, const struct search *sr)
 			return 0;
 		if (fputs("\\fI", f) == EOF)
 			return 0;
-		if (!gen_field_type(f, sent->field))
+		if (sent->op == OPTYPE_IN) {
+			if (!gen_field_set_type(f, sent->field))
+				return 0;
+		} else if (!gen_field_type(f, sent->field))
 			return 0;
 		if (fprintf(f, "\\fR\t\\fI%s\\fR\n", 
 		    sent->field->name) < 0)
 			return 0;
-
+		if (sent->op == OPTYPE_IN && fprintf(f, 
+		    "-\t\\fIsize_t\\fR\t\\fI%s\\fR (size)\n", 
+		    sent->field->name) < 0)
+			return 0;
 	}
 
 	if (hasunary) {
@@ -446,6 +513,12 @@ gen_search(FILE *f, const struct search *sr)
 
 	if (fputs(".TE\n", f) == EOF)
 		return 0;
+	if (batch)
+		return fputs(".Pp\n"
+		    "Batched form of the above, invoking the callback\n"
+		    "with up to\n"
+		    ".Fa n\n"
+		    "rows at a time.\n", f) != EOF;
 	if (sr->doc != NULL && !gen_doc_block(f, sr->doc, 0, 1))
 		return 0;
 	return 1;
@@ -456,7 +529,8 @@ gen_search(FILE *f, const struct search *sr)
  * Return -1 on failure, 0 if nothing written, 1 if something written.
  */
 static int
-gen_general(FILE *f, const struct config *cfg)
+gen_general(FILE *f, const struct ort_lang_c *args,
+	const struct config *cfg)
 {
 
 	if (fputs
@@ -508,6 +582,35 @@ gen_general(FILE *f, const struct config *cfg)
 	     ".Fn db_open_logging\n"
 	     "but without logging enabled.\n", f) == EOF)
 		return -1;
+	if (fputs
+	    (".It Ft \"struct ort *\" Fn db_open_ro_logging\n"
+	     ".TS\n"
+	     "l l.\n"
+	     "\\fIconst char *\\fR\t\\fIfile\\fR\n"
+	     "\\fI(void *)(const char *, void *)\\fR\t\\fIlog\\fR\n"
+	     "\\fI(void *)(const char *, ...)\\fR\t\\fIlog_short\\fR\n"
+	     "\\fIvoid *\\fR\t\\fIarg\\fR\n"
+	     ".TE\n"
+	     ".Pp\n"
+	     "Like\n"
+	     ".Fn db_open_logging\n"
+	     "but opening an existing\n"
+	     ".Fa file\n"
+	     "read-only.\n"
+	     "Insertions, updates, and deletions are not permitted.\n",
+	     f) == EOF)
+		return -1;
+	if (fputs
+	    (".It Ft \"struct ort *\" Fn db_open_ro\n"
+	     ".TS\n"
+	     "l l.\n"
+	     "\\fIconst char *\\fR\t\\fIfile\\fR\n"
+	     ".TE\n"
+	     ".Pp\n"
+	     "Like\n"
+	     ".Fn db_open_ro_logging\n"
+	     "but without logging enabled.\n", f) == EOF)
+		return -1;
 	if (fputs
 	    (".It Ft void Fn db_logging_data\n"
 	     ".TS\n"
@@ -544,6 +647,46 @@ gen_general(FILE *f, const struct config *cfg)
 	     "is\n"
 	     ".Dv NULL .\n", f) == EOF)
 		return -1;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) && fputs
+	    (".It Ft \"enum ort_err\" Fn db_err\n"
+	     ".TS\n"
+	     "l l.\n"
+	     "\\fIstruct ort *\\fR\t\\fIctx\\fR\n"
+	     ".TE\n"
+	     ".Pp\n"
+	     "Returns\n"
+	     ".Dv ORT_ERR_DB\n"
+	     "if the last database function invoked on the context\n"
+	     "has failed, otherwise\n"
+	     ".Dv ORT_ERR_OK .\n"
+	     "Failing functions return\n"
+	     ".Dv NULL ,\n"
+	     "zero, or -1 for insertions.\n"
+	     "Each function clears the error when invoked, but after\n"
+	     "a failure the context should only be closed with\n"
+	     ".Fn db_close .\n"
+	     ".It Ft void Fn db_set_retry\n"
+	     ".TS\n"
+	     "l l.\n"
+	     "\\fIstruct ort *\\fR\t\\fIctx\\fR\n"
+	     "\\fIsize_t\\fR\t\\fIretries\\fR\n"
+	     "\\fIunsigned int\\fR\t\\fIms\\fR\n"
+	     ".TE\n"
+	     ".Pp\n"
+	     "Retry failed\n"
+	     ".Fn db_trans_open\n"
+	     "and the insertions, updates, and deletions run as a single\n"
+	     "statement up to\n"
+	     ".Fa retries\n"
+	     "times, which defaults to zero.\n"
+	     "Each retry first waits\n"
+	     ".Fa ms\n"
+	     "milliseconds, doubled for each earlier retry up to 1024\n"
+	     "times, then replaces the database connection with a new one.\n"
+	     "Any failure is retried, as busy or locked databases aren't\n"
+	     "told apart from other failures, but never while a\n"
+	     "transaction is open.\n", f) == EOF)
+		return -1;
 	return fputs(".El\n", f) == EOF ? -1 : 1;
 }
 
@@ -551,7 +694,8 @@ gen_general(FILE *f, const struct config *cfg)
  * Return -1 on failure, 0 if nothing written, 1 if something written.
  */
 static int
-gen_searches(FILE *f, const struct config *cfg)
+gen_searches(FILE *f, const struct ort_lang_c *args,
+	const struct config *cfg)
 {
 	const struct strct	*s;
 	const struct search	*sr;
@@ -570,13 +714,61 @@ gen_searches(FILE *f, const struct config *cfg)
 		return -1;
 
 	TAILQ_FOREACH(s, &cfg->sq, entries)
-		TAILQ_FOREACH(sr, &s->sq, entries)
-			if (!gen_search(f, sr))
+		TAILQ_FOREACH(sr, &s->sq, entries) {
+			if (!gen_search(f, sr, 0))
+				return -1;
+			if (sr->type == STYPE_ITERATE &&
+			    (args->flags & ORT_LANG_C_ITERATE_BATCH) &&
+			    !gen_search(f, sr, 1))
 				return -1;
+		}
 
 	return fputs(".El\n", f) == EOF ? -1 : 1;
 }
 
+/*
+ * Document the batched lookups by rowid or unique field.
+ * Return -1 on failure, 0 if nothing written, 1 if something written.
+ */
+static int
+gen_get_manys(FILE *f, const struct config *cfg)
+{
+	const struct strct	*s;
+	const struct field	*fd;
+	int			 shown = 0;
+
+	TAILQ_FOREACH(s, &cfg->sq, entries)
+		TAILQ_FOREACH(fd, &s->fq, entries) {
+			if (!gen_sql_unique_many(fd))
+				continue;
+			if (!shown && fputs
+			    ("The following lookups are available to all\n"
+			     "roles, returning the rows matching any of\n"
+			     "the given unique values ordered by value:\n"
+			     ".Bl -tag -width Ds -offset indent\n", 
+			     f) == EOF)
+				return -1;
+			shown = 1;
+			if (fprintf(f, ".It Ft \"struct %s_q *\" "
+			    "Fn db_%s_get_many_by_%s\n"
+			    ".TS\n"
+			    "lw6 l l.\n"
+			    "-\t\\fIstruct ort *\\fR\t\\fIctx\\fR\n"
+			    "in\t\\fI", s->name, s->name, fd->name) < 0)
+				return -1;
+			if (!gen_field_set_type(f, fd))
+				return -1;
+			if (fprintf(f, "\\fR\t\\fI%s\\fR\n"
+			    "-\t\\fIsize_t\\fR\t\\fI%s\\fR (size)\n"
+			    ".TE\n", fd->name, fd->name) < 0)
+				return -1;
+		}
+
+	if (!shown)
+		return 0;
+	return fputs(".El\n", f) == EOF ? -1 : 1;
+}
+
 static int
 gen_update(FILE *f, const struct update *up)
 {
@@ -584,10 +776,15 @@ gen_update(FILE *f, const struct update *up)
 	const char		*rettype, *functype;
 	int			 hasunary = 0;
 
-	rettype = up->type == UP_MODIFY ? "int" : "void";
+	rettype = up->type == UP_MODIFY ? "int" : 
+		up->batch > 0 ? "uint64_t" : "void";
 	functype = up->type == UP_MODIFY ? "update" : "delete";
 
-	if (fprintf(f, ".It Ft %s Fn db_%s_%s",
+	if (up->flags & UPDATE_RETURNING) {
+		if (fprintf(f, ".It Ft \"struct %s_q *\" Fn db_%s_%s",
+		    up->parent->name, up->parent->name, functype) < 0)
+			return 0;
+	} else if (fprintf(f, ".It Ft %s Fn db_%s_%s",
 	    rettype, up->parent->name, functype) < 0)
 		return 0;
 
@@ -706,7 +903,12 @@ gen_insert(FILE *f, const struct strct *s)
 {
 	const struct field	*fd;
 
-	if (fprintf(f, ".It Ft int64_t Fn db_%s_insert\n", s->name) < 0)
+	if (s->ins->flags & INSERT_RETURNING) {
+		if (fprintf(f, ".It Ft \"struct %s *\" "
+		    "Fn db_%s_insert\n", s->name, s->name) < 0)
+			return 0;
+	} else if (fprintf(f, 
+	    ".It Ft int64_t Fn db_%s_insert\n", s->name) < 0)
 		return 0;
 
 	if (fputs(".TS\nl l.\n", f) == EOF)
@@ -1092,11 +1294,15 @@ ort_lang_c_manpage(const struct ort_lang_c *args,
 
 	if (fputs(".Ss Database input\n", f) == EOF)
 		return 0;
-	if ((c = gen_general(f, cfg)) < 0)
+	if ((c = gen_general(f, args, cfg)) < 0)
+		return 0;
+	else if (c > 0 && fputs(".Pp\n", f) == EOF)
+		return 0;
+	if ((c = gen_searches(f, args, cfg)) < 0)
 		return 0;
 	else if (c > 0 && fputs(".Pp\n", f) == EOF)
 		return 0;
-	if ((c = gen_searches(f, cfg)) < 0)
+	if ((c = gen_get_manys(f, cfg)) < 0)
 		return 0;
 	else if (c > 0 && fputs(".Pp\n", f) == EOF)
 		return 0;
@@ -131,8 +131,65 @@ static	const char *const validbins[VALIDATE__MAX] = {
 	"!=", /* VALIDATE_EQ */
 };
 
+/*
+ * Statements for pragmas of the "database" block.
+ */
+static	const char *const pragmas[PRAGMA__MAX] = {
+	"STMT__PRAGMA_JOURNAL_MODE", /* PRAGMA_JOURNAL_MODE */
+	"STMT__PRAGMA_SYNCHRONOUS", /* PRAGMA_SYNCHRONOUS */
+	"STMT__PRAGMA_CACHE_SIZE", /* PRAGMA_CACHE_SIZE */
+	"STMT__PRAGMA_MMAP_SIZE", /* PRAGMA_MMAP_SIZE */
+	"STMT__PRAGMA_BUSY_TIMEOUT", /* PRAGMA_BUSY_TIMEOUT */
+};
+
 static	int print_src(FILE *, size_t, const char *, ...)
 	__attribute__((format(printf, 3, 4)));
+static	int gen_fail_if(FILE *, const struct ort_lang_c *, size_t,
+	const char *, ...)
+	__attribute__((format(printf, 4, 5)));
+static	int gen_db_check(FILE *, const struct ort_lang_c *, size_t,
+	const char *, const char *, ...)
+	__attribute__((format(printf, 5, 6)));
+static	int gen_step_check(FILE *, const struct ort_lang_c *, size_t,
+	const char *, const char *, ...)
+	__attribute__((format(printf, 5, 6)));
+
+/*
+ * Source identifier used for read-only statements.
+ * If we have read-only sources, these are selected at run-time by
+ * db_src_read(); otherwise, it's the last-opened source.
+ */
+static const char *
+src_read(const struct ort_lang_c *args)
+{
+
+	return args->readers > 0 ? "db_src_read(ctx)" : "0";
+}
+
+/*
+ * Source identifier used for statements that modify the database.
+ * If we have read-only sources, the read-write source is the first
+ * opened (identifier 1); otherwise, it's the last-opened source.
+ */
+static const char *
+src_write(const struct ort_lang_c *args)
+{
+
+	return args->readers > 0 ? "1" : "0";
+}
+
+/*
+ * Whether the context tracks the depth of open transactions: reads
+ * from read-only sources need it to see uncommitted changes, and
+ * retrying failures must not lose the transaction.
+ */
+static int
+has_trans(const struct ort_lang_c *args)
+{
+
+	return args->readers > 0 ||
+		(args->flags & ORT_LANG_C_DB_ERRORS);
+}
 
 /*
  * Print the line of source code given by "fmt" and varargs.
@@ -177,6 +234,192 @@ print_src(FILE *f, size_t indent, const char *fmt, ...)
 	return fputc('\n', f) != EOF;
 }
 
+/*
+ * Print the conditional "fmt" (e.g., "if (res == NULL)") guarding a
+ * failed database operation, indented by "tabs".
+ * With ORT_LANG_C_DB_ERRORS, this opens a block for any clean-up
+ * statements, which must be followed by gen_fail().
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fail_if(FILE *f, const struct ort_lang_c *args, size_t tabs,
+	const char *fmt, ...)
+{
+	va_list	 ap;
+	char	*cp;
+	int	 ret;
+
+	va_start(ap, fmt);
+	ret = vasprintf(&cp, fmt, ap);
+	va_end(ap);
+	if (ret == -1)
+		return 0;
+	ret = print_src(f, tabs, "%s%s", cp,
+		(args->flags & ORT_LANG_C_DB_ERRORS) ? " {" : "");
+	free(cp);
+	return ret;
+}
+
+/*
+ * Close a block opened by gen_fail_if() or gen_fail_ifset() by
+ * returning "rc", or nothing if "rc" is NULL, with the error having
+ * already been recorded in the context.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fail_return(FILE *f, size_t tabs, const char *rc)
+{
+
+	return print_src(f, tabs + 1, "return%s%s;",
+		rc != NULL ? " " : "", rc != NULL ? rc : "") &&
+		print_src(f, tabs, "}");
+}
+
+/*
+ * Print what happens when a database operation fails, following
+ * gen_fail_if() with indentation "tabs".
+ * By default, this exits.
+ * With ORT_LANG_C_DB_ERRORS, the failure is recorded in the context
+ * and the function returns "rc", or nothing if "rc" is NULL.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fail(FILE *f, const struct ort_lang_c *args, size_t tabs,
+	const char *rc)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return print_src(f, tabs + 1, "exit(EXIT_FAILURE);");
+	return print_src(f, tabs + 1, "ctx->err = ORT_ERR_DB;") &&
+		gen_fail_return(f, tabs, rc);
+}
+
+/*
+ * Combine gen_fail_if() and gen_fail() for failures without clean-up.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_db_check(FILE *f, const struct ort_lang_c *args, size_t tabs,
+	const char *rc, const char *fmt, ...)
+{
+	va_list	 ap;
+	char	*cp;
+	int	 ret;
+
+	va_start(ap, fmt);
+	ret = vasprintf(&cp, fmt, ap);
+	va_end(ap);
+	if (ret == -1)
+		return 0;
+	ret = gen_fail_if(f, args, tabs, "%s", cp) &&
+		gen_fail(f, args, tabs, rc);
+	free(cp);
+	return ret;
+}
+
+/*
+ * With ORT_LANG_C_DB_ERRORS, print the check after invoking a helper
+ * that may have recorded a database failure in the context.
+ * This must be followed by gen_fail_return().
+ * Return <0 on failure, 0 if not applicable, >0 if printed.
+ */
+static int
+gen_fail_ifset(FILE *f, const struct ort_lang_c *args, size_t tabs)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 0;
+	return gen_fail_if(f, args, tabs,
+		"if (ctx->err != ORT_ERR_OK)") ? 1 : -1;
+}
+
+/*
+ * With ORT_LANG_C_DB_ERRORS, print the clean-up of a failure following
+ * gen_fail_if() or gen_fail_ifset() that finalises the statement still
+ * open at that point.
+ * Its return value is ignored, as we're already failing.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fail_finalise(FILE *f, const struct ort_lang_c *args, size_t tabs)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	return print_src(f, tabs + 1, "sqlbox_finalise(db, 0);");
+}
+
+/*
+ * Like gen_db_check(), but for failures while a statement is open,
+ * finalising it before returning.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_step_check(FILE *f, const struct ort_lang_c *args, size_t tabs,
+	const char *rc, const char *fmt, ...)
+{
+	va_list	 ap;
+	char	*cp;
+	int	 ret;
+
+	va_start(ap, fmt);
+	ret = vasprintf(&cp, fmt, ap);
+	va_end(ap);
+	if (ret == -1)
+		return 0;
+	ret = gen_fail_if(f, args, tabs, "%s", cp) &&
+		gen_fail_finalise(f, args, tabs) &&
+		gen_fail(f, args, tabs, rc);
+	free(cp);
+	return ret;
+}
+
+/*
+ * With ORT_LANG_C_DB_ERRORS, print the statement clearing the error
+ * left by any earlier call, which begins all functions that may record
+ * one in the context "ctx".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_err_clear(FILE *f, const struct ort_lang_c *args, const char *ctx)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	return fprintf(f, "\t%s->err = ORT_ERR_OK;\n", ctx) > 0;
+}
+
+/*
+ * With ORT_LANG_C_DB_ERRORS, open the loop around a statement whose
+ * failures are retried by db_retry(), which needs the "db" and "tries"
+ * variables.
+ * Return the indentation of the statement or zero on failure.
+ */
+static size_t
+gen_retry_open(FILE *f, const struct ort_lang_c *args)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	return fputs("\tdo {\n", f) == EOF ? 0 : 2;
+}
+
+/*
+ * Close the loop opened by gen_retry_open(), which is repeated while
+ * "cond" indicates failure and db_retry() allows it.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_retry_close(FILE *f, const struct ort_lang_c *args,
+	const char *cond)
+{
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	return fprintf(f, "\t} while (%s && "
+		"db_retry(ctx, &db, &tries));\n", cond) > 0;
+}
+
 /*
  * Generate the function for checking a password.
  * This should be a conditional phrase that evalutes to FALSE if the
@@ -387,6 +630,107 @@ count_bind(enum ftype t, enum optype type)
 
 }
 
+/*
+ * Generate the binding of an "in" set at index "idx" referring to the
+ * array variable "pos" and its size with a tab offset of "tabs".
+ * The set is converted into a JSON array and bound as a single string,
+ * which must be freed after the statement is prepared.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_bind_in(FILE *f, const struct field *fd, size_t idx,
+	size_t pos, size_t tabs)
+{
+	char	 ts[8];
+	size_t	 i;
+
+	assert(tabs < sizeof(ts));
+	for (i = 0; i < tabs; i++)
+		ts[i] = '\t';
+	ts[i] = '\0';
+
+	if (fprintf(f, "%smemset(&in%zu, 0, sizeof(struct ort_in));\n"
+	    "%sfor (j = 0; j < v%zu_sz; j++)\n", 
+	    ts, pos, ts, pos) < 0)
+		return 0;
+
+	switch (fd->type) {
+	case FTYPE_BIT:
+	case FTYPE_BITFIELD:
+	case FTYPE_INT:
+		if (fprintf(f, "%s\tort_in_int(&in%zu, "
+		    "ORT_GETV_%s_%s(v%zu[j]));\n", ts, pos,
+		    fd->parent->name, fd->name, pos) < 0)
+			return 0;
+		break;
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		if (fprintf(f, "%s\tort_in_str(&in%zu, v%zu[j]);\n",
+		    ts, pos, pos) < 0)
+			return 0;
+		break;
+	default:
+		if (fprintf(f, "%s\tort_in_int(&in%zu, v%zu[j]);\n",
+		    ts, pos, pos) < 0)
+			return 0;
+		break;
+	}
+
+	return fprintf(f, 
+		"%sparms[%zu].sparm = ort_in_done(&in%zu);\n"
+		"%sparms[%zu].type = SQLBOX_PARM_STRING;\n",
+		ts, idx - 1, pos, ts, idx - 1) > 0;
+}
+
+/*
+ * Generate the declarations of the buffers used by gen_bind_in() for
+ * each "in" constraint of "s", if any.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_in_decls(FILE *f, const struct search *s)
+{
+	const struct sent	*sent;
+	size_t			 pos = 1;
+	int			 has = 0;
+
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
+		if (!OPTYPE_ISBINARY(sent->op))
+			continue;
+		if (sent->op == OPTYPE_IN) {
+			if (fprintf(f, "\tstruct ort_in in%zu;\n", pos) < 0)
+				return 0;
+			has = 1;
+		}
+		pos++;
+	}
+
+	return !has || fputs("\tsize_t j;\n", f) != EOF;
+}
+
+/*
+ * Generate the release of the buffers of gen_in_decls(), if any, with
+ * a tab offset of "tabs".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_in_free(FILE *f, const struct search *s, size_t tabs)
+{
+	const struct sent	*sent;
+	size_t			 pos = 1;
+
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
+		if (!OPTYPE_ISBINARY(sent->op))
+			continue;
+		if (sent->op == OPTYPE_IN &&
+		    !print_src(f, tabs, "free(in%zu.buf);", pos))
+			return 0;
+		pos++;
+	}
+
+	return 1;
+}
+
 /*
  * Generate the binding for a field of type "t" at index "idx" referring
  * to variable "pos" with a tab offset of "tabs", using
@@ -401,6 +745,8 @@ gen_bind(FILE *f, const struct field *fd, size_t idx,
 
 	if (count_bind(fd->type, type) == 0)
 		return 0;
+	if (type == OPTYPE_IN)
+		return gen_bind_in(f, fd, idx, pos, tabs) ? 1 : -1;
 
 	for (i = 0; i < tabs; i++)
 		if (fputc('\t', f) == EOF)
@@ -478,16 +824,62 @@ gen_bind_hash(FILE *f, size_t pos, size_t hpos, size_t tabs)
 		"SQLBOX_PARM_STRING;\n", pos - 1) > 0;
 }
 
+/*
+ * Release the rows of an iterator batch, then the batch itself, with
+ * a tab offset of "tabs".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_iterator_free(FILE *f, const struct strct *p, size_t tabs)
+{
+
+	if (!print_src(f, tabs, "while (i > 0)\n"
+	    "\tdb_%s_unfill_r(&ps[--i]);", p->name))
+		return 0;
+	if ((p->flags & STRCT_HAS_NULLREFS) &&
+	    !print_src(f, tabs, "free(pps);"))
+		return 0;
+	return print_src(f, tabs, "free(ps);");
+}
+
+/*
+ * Fill the null references of an iterator batch before it's passed to
+ * the callback, with a tab offset of "tabs".
+ * If "open" is non-zero, the statement is still open and is finalised
+ * on failure.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_iterator_flush(FILE *f, const struct ort_lang_c *args,
+	const struct strct *p, size_t tabs, int open)
+{
+	int	 c;
+
+	if (!print_src(f, tabs, "db_%s_reffind_many(ctx, pps, i);",
+	    p->name))
+		return 0;
+	if ((c = gen_fail_ifset(f, args, tabs)) <= 0)
+		return c == 0;
+	if (open && !gen_fail_finalise(f, args, tabs))
+		return 0;
+	return gen_iterator_free(f, p, tabs + 1) &&
+		gen_fail_return(f, tabs, NULL);
+}
+
 /*
  * Generate a search function for an STYPE_ITERATE.
+ * If "batch" is non-zero, generate the batched variant, which fills an
+ * array of up to "n" rows before invoking the callback.
  * Return zero on failure, non-zero on success.
  */
 static int
 gen_iterator(FILE *f, const struct config *cfg,
-	const struct search *s, size_t num)
+	const struct ort_lang_c *args, const struct search *s, 
+	size_t num, int batch)
 {
 	const struct sent	*sent;
 	const struct strct 	*retstr;
+	const char		*ptr = batch ? "p" : "&p";
 	size_t			 pos, idx, parms = 0;
 	int			 c;
 
@@ -502,23 +894,60 @@ gen_iterator(FILE *f, const struct config *cfg,
 
 	/* Emit top of the function w/optional static parameters. */
 
-	if (!gen_func_db_search(f, s, 0))
-		return 0;
-	if (fprintf(f, "\n"
-  	    "{\n"
-	    "\tstruct %s p;\n"
-	    "\tconst struct sqlbox_parmset *res;\n"
-	    "\tstruct sqlbox *db = ctx->db;\n",
-	    retstr->name) < 0)
-		return 0;
+	if (batch) {
+		if (!gen_func_db_iterate_batch(f, s, 0))
+			return 0;
+		if (fprintf(f, "\n"
+		    "{\n"
+		    "\tstruct %s *ps, *p;\n"
+		    "\tsize_t i = 0;\n"
+		    "\tconst struct sqlbox_parmset *res;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n",
+		    retstr->name) < 0)
+			return 0;
+		if ((retstr->flags & STRCT_HAS_NULLREFS) && fprintf(f,
+		    "\tstruct %s **pps;\n", retstr->name) < 0)
+			return 0;
+	} else {
+		if (!gen_func_db_search(f, s, 0))
+			return 0;
+		if (fprintf(f, "\n"
+		    "{\n"
+		    "\tstruct %s p;\n"
+		    "\tconst struct sqlbox_parmset *res;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n",
+		    retstr->name) < 0)
+			return 0;
+	}
 	if (parms > 0 && fprintf(f, 
 	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
 		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
 
 	/* Emit parameter binding. */
 
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if (batch && fprintf(f,
+	    "\tif (n == 0)\n"
+	    "\t\tn = 1;\n"
+	    "\tif ((ps = calloc(n, sizeof(struct %s))) == NULL)\n"
+	    "\t\texit(EXIT_FAILURE);\n",
+	    retstr->name) < 0)
+		return 0;
+	if (batch && (retstr->flags & STRCT_HAS_NULLREFS) && fprintf(f,
+	    "\tif ((pps = calloc(n, sizeof(struct %s *))) == NULL)\n"
+	    "\t\texit(EXIT_FAILURE);\n"
+	    "\tfor (i = 0; i < n; i++)\n"
+	    "\t\tpps[i] = &ps[i];\n"
+	    "\ti = 0;\n",
+	    retstr->name) < 0)
+		return 0;
+	if (batch && parms > 0 && fputc('\n', f) == EOF)
+		return 0;
 	if (parms > 0 &&
 	    fputs("\tmemset(parms, 0, sizeof(parms));\n", f) == EOF)
 		return 0;
@@ -536,23 +965,49 @@ gen_iterator(FILE *f, const struct config *cfg,
 
 	/* Prepare and step. */
 
-	if (fprintf(f, "\n"
-	    "\tif (!sqlbox_prepare_bind_async\n"
-	    "\t    (db, 0, STMT_%s_BY_SEARCH_%zu,\n"
-	    "\t     %zu, %s, SQLBOX_STMT_MULTI))\n"
-	    "\t\texit(EXIT_FAILURE);\n"
-	    "\twhile ((res = sqlbox_step(db, 0)) "
-	    "!= NULL && res->psz) {\n"
-	    "\t\tdb_%s_fill_r(ctx, &p, res, NULL);\n",
-	    s->parent->name, num, parms,
-	    parms > 0 ? "parms" : "NULL", retstr->name) < 0)
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_prepare_bind_async\n"
+	    "    (db, %s, STMT_%s_BY_SEARCH_%zu,\n"
+	    "     %zu, %s, SQLBOX_STMT_MULTI))",
+	    src_read(args), s->parent->name, num, parms,
+	    parms > 0 ? "parms" : "NULL"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) && 
+	    !gen_in_free(f, s, 2))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) && batch &&
+	    !gen_iterator_free(f, retstr, 2))
+		return 0;
+	if (!gen_fail(f, args, 1, NULL))
+		return 0;
+	if (!gen_in_free(f, s, 1))
+		return 0;
+	if (fputs("\twhile ((res = sqlbox_step(db, 0)) "
+	    "!= NULL && res->psz) {\n", f) == EOF)
+		return 0;
+	if (batch && fputs("\t\tp = &ps[i];\n", f) == EOF)
+		return 0;
+	if (fprintf(f, "\t\tdb_%s_fill_r(ctx, %s, res, NULL);\n",
+	    retstr->name, ptr) < 0)
 		return 0;
 
-	/* Conditional post-query null lookup. */
+	/* 
+	 * Conditional post-query null lookup.
+	 * Batches do this all at once before invoking the callback.
+	 */
 
-	if ((retstr->flags & STRCT_HAS_NULLREFS) && fprintf(f,
-	     "\t\tdb_%s_reffind(ctx, &p);\n", retstr->name) < 0)
-		return 0;
+	if (!batch && (retstr->flags & STRCT_HAS_NULLREFS)) {
+		if (fprintf(f, "\t\tdb_%s_reffind(ctx, %s);\n",
+		    retstr->name, ptr) < 0)
+			return 0;
+		if ((c = gen_fail_ifset(f, args, 2)) < 0)
+			return 0;
+		if (c > 0 && (!gen_fail_finalise(f, args, 2) ||
+		    !print_src(f, 3, "db_%s_unfill_r(&p);",
+		    retstr->name) || !gen_fail_return(f, 2, NULL)))
+			return 0;
+	}
 
 	/* Conditional post-query password check. */
 
@@ -568,28 +1023,162 @@ gen_iterator(FILE *f, const struct config *cfg,
 		}
 		if (fputs("\t\tif ", f) == EOF)
 			return 0;
-		if (!gen_checkpass(f, 0, pos, 
+		if (!gen_checkpass(f, batch, pos, 
 		    sent->fname, sent->op, sent->field))
 			return 0;
 		if (fprintf(f, " {\n"
-		    "\t\t\tdb_%s_unfill_r(&p);\n"
+		    "\t\t\tdb_%s_unfill_r(%s);\n"
 		    "\t\t\tcontinue;\n"
 		    "\t\t}\n",
-		    s->parent->name) < 0)
+		    s->parent->name, ptr) < 0)
 			return 0;
 		pos++;
 	}
 
-	return fprintf(f, "\t\t(*cb)(&p, arg);\n"
-		"\t\tdb_%s_unfill_r(&p);\n"
-	       "\t}\n"
-	       "\tif (res == NULL)\n"
-	       "\t\texit(EXIT_FAILURE);\n"
-	       "\tif (!sqlbox_finalise(db, 0))\n"
-	       "\t\texit(EXIT_FAILURE);\n"
-	       "}\n"
-	       "\n", retstr->name) > 0;
-}
+	if (!batch) {
+		if (fprintf(f, "\t\t(*cb)(&p, arg);\n"
+		    "\t\tdb_%s_unfill_r(&p);\n"
+		    "\t}\n", retstr->name) < 0)
+			return 0;
+		return gen_step_check(f, args, 1, NULL,
+			"if (res == NULL)") &&
+		       gen_db_check(f, args, 1, NULL,
+			"if (!sqlbox_finalise(db, 0))") &&
+		       fputs("}\n\n", f) != EOF;
+	}
+
+	/* 
+	 * Batches are only passed to the callback when full, with the
+	 * remainder flushed after the statement has been finalised.
+	 */
+
+	if (fputs("\t\tif (++i < n)\n"
+	    "\t\t\tcontinue;\n", f) == EOF)
+		return 0;
+	if ((retstr->flags & STRCT_HAS_NULLREFS) &&
+	    !gen_iterator_flush(f, args, retstr, 2, 1))
+		return 0;
+	if (fprintf(f, "\t\t(*cb)(ps, i, arg);\n"
+	    "\t\twhile (i > 0)\n"
+	    "\t\t\tdb_%s_unfill_r(&ps[--i]);\n"
+	    "\t}\n", retstr->name) < 0)
+		return 0;
+
+	if (!gen_fail_if(f, args, 1, "if (res == NULL)"))
+		return 0;
+	if (!gen_fail_finalise(f, args, 1))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) && 
+	    !gen_iterator_free(f, retstr, 2))
+		return 0;
+	if (!gen_fail(f, args, 1, NULL))
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_finalise(db, 0))"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) && 
+	    !gen_iterator_free(f, retstr, 2))
+		return 0;
+	if (!gen_fail(f, args, 1, NULL))
+		return 0;
+
+	if (retstr->flags & STRCT_HAS_NULLREFS) {
+		if (fputs("\tif (i > 0) {\n", f) == EOF)
+			return 0;
+		if (!gen_iterator_flush(f, args, retstr, 2, 0))
+			return 0;
+		if (fputs("\t\t(*cb)(ps, i, arg);\n"
+		    "\t}\n", f) == EOF)
+			return 0;
+	} else if (fputs("\tif (i > 0)\n"
+	    "\t\t(*cb)(ps, i, arg);\n", f) == EOF)
+		return 0;
+
+	return gen_iterator_free(f, retstr, 1) &&
+		fputs("}\n\n", f) != EOF;
+}
+
+/*
+ * Guard a database failure with conditional "cond" after the result
+ * queue "q" of "p" has been allocated, releasing it if returning.
+ * If "cond" is NULL, this checks whether a helper recorded an error and
+ * is only printed with ORT_LANG_C_DB_ERRORS.
+ * If "open" is non-zero, the statement is finalised as well.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_freeq_fail(FILE *f, const struct ort_lang_c *args,
+	const struct strct *p, const char *cond, int open)
+{
+	int	 c;
+
+	if (cond == NULL) {
+		if ((c = gen_fail_ifset(f, args, 1)) <= 0)
+			return c == 0;
+	} else if (!gen_fail_if(f, args, 1, "%s", cond))
+		return 0;
+	if (open && !gen_fail_finalise(f, args, 1))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !print_src(f, 2, "db_%s_freeq(q);", p->name))
+		return 0;
+	return cond == NULL ? gen_fail_return(f, 1, "NULL") :
+		gen_fail(f, args, 1, "NULL");
+}
+
+/*
+ * Count the result columns consumed by db_xxx_fill_r() for "p", which
+ * includes its structures filled by (non-null) reference.
+ */
+static size_t
+count_fill_r(const struct strct *p)
+{
+	const struct field	*fd;
+	size_t			 sz = 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type != FTYPE_STRUCT)
+			sz++;
+		else if (!(fd->ref->source->flags & FIELD_NULL))
+			sz += count_fill_r(fd->ref->target->parent);
+	return sz;
+}
+
+/*
+ * Whether filling "p" (recursively) fills any structures that may be
+ * shared between results with ORT_LANG_C_DB_IDMAP.
+ * Return zero if none, non-zero otherwise.
+ */
+static int
+has_shared(const struct config *cfg, const struct strct *p)
+{
+	const struct field	*fd;
+
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type == FTYPE_STRUCT &&
+		    !(fd->ref->source->flags & FIELD_NULL) &&
+		    (gen_strct_shared(cfg, fd->ref->target->parent) ||
+		     has_shared(cfg, fd->ref->target->parent)))
+			return 1;
+	return 0;
+}
+
+/*
+ * Whether we're using an identity map with ORT_LANG_C_DB_IDMAP, which
+ * is only the case if there are structures to share.
+ * Return zero if not, non-zero otherwise.
+ */
+static int
+has_idmap(const struct config *cfg, const struct ort_lang_c *args)
+{
+	const struct strct	*p;
+
+	if (!(args->flags & ORT_LANG_C_DB_IDMAP))
+		return 0;
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		if (gen_strct_shared(cfg, p))
+			return 1;
+	return 0;
+}
 
 /*
  * Generate search function for an STYPE_LIST.
@@ -597,21 +1186,32 @@ gen_iterator(FILE *f, const struct config *cfg,
  */
 static int
 gen_list(FILE *f, const struct config *cfg, 
-	const struct search *s, size_t num)
+	const struct ort_lang_c *args, const struct search *s, size_t num)
 {
 	const struct sent	*sent;
 	const struct strct	*retstr;
 	size_t	 		 pos, parms = 0, idx;
-	int			 c;
+	int			 c, idmap;
 
 	retstr = s->dst != NULL ? s->dst->strct : s->parent;
 
-	/* Count all possible parameters to bind. */
+	/* 
+	 * Count all possible parameters to bind.
+	 * The identity map is only used if results aren't freed while
+	 * stepping, which happens with post-query password checks.
+	 */
 
-	TAILQ_FOREACH(sent, &s->sntq, entries)
+	idmap = has_idmap(cfg, args) && has_shared(cfg, retstr);
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
 		if (OPTYPE_ISBINARY(sent->op))
 			parms += count_bind
 				(sent->field->type, sent->op);
+		if (OPTYPE_ISBINARY(sent->op) &&
+		    sent->field->type == FTYPE_PASSWORD &&
+		    sent->op != OPTYPE_STREQ &&
+		    sent->op != OPTYPE_STRNEQ)
+			idmap = 0;
+	}
 
 	/* Emit top of the function w/optional static parameters. */
 
@@ -628,8 +1228,14 @@ gen_list(FILE *f, const struct config *cfg,
 	if (parms > 0 && fprintf(f, 
 	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
 		return 0;
+	if (idmap && fputs("\tstruct ort_idmap idmap;\n", f) == EOF)
+		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
 	if (parms > 0 && fputs
 	    ("\tmemset(parms, 0, sizeof(parms));\n", f) == EOF)
 		return 0;
@@ -663,11 +1269,23 @@ gen_list(FILE *f, const struct config *cfg,
 
 	/* Bind and step. */
 
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_prepare_bind_async\n"
+	    "    (db, %s, STMT_%s_BY_SEARCH_%zu,\n"
+	    "     %zu, %s, SQLBOX_STMT_MULTI))",
+	    src_read(args), s->parent->name, num, parms,
+	    parms > 0 ? "parms" : "NULL"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    (!gen_in_free(f, s, 2) || !print_src(f, 2, "free(q);")))
+		return 0;
+	if (!gen_fail(f, args, 1, "NULL"))
+		return 0;
+	if (!gen_in_free(f, s, 1))
+		return 0;
+	if (idmap && fputs("\tmemset(&idmap, 0, sizeof(idmap));\n"
+	    "\tctx->idmap = &idmap;\n", f) == EOF)
+		return 0;
 	if (fprintf(f, 
-	    "\tif (!sqlbox_prepare_bind_async\n"
-	    "\t    (db, 0, STMT_%s_BY_SEARCH_%zu,\n"
-	    "\t     %zu, %s, SQLBOX_STMT_MULTI))\n"
-	    "\t	exit(EXIT_FAILURE);\n"
 	    "\twhile ((res = sqlbox_step(db, 0)) != NULL "
 	    "&& res->psz) {\n"
 	    "\t\tp = malloc(sizeof(struct %s));\n"
@@ -676,17 +1294,9 @@ gen_list(FILE *f, const struct config *cfg,
 	    "\t\t\texit(EXIT_FAILURE);\n"
 	    "\t\t}\n"
 	    "\t\tdb_%s_fill_r(ctx, p, res, NULL);\n",
-	    s->parent->name, num, parms,
-	    parms > 0 ? "parms" : "NULL",
 	    retstr->name, retstr->name) < 0)
 		return 0;
 
-	/* Conditional post-query to fill null refs. */
-
-	if (retstr->flags & STRCT_HAS_NULLREFS && fprintf(f, 
-            "\t\tdb_%s_reffind(ctx, p);\n", retstr->name) < 0)
-		return 0;
-
 	/* Conditional post-query password check. */
 
 	pos = 1;
@@ -714,13 +1324,31 @@ gen_list(FILE *f, const struct config *cfg,
 		pos++;
 	}
 
-	return fputs("\t\tTAILQ_INSERT_TAIL(q, p, _entries);\n"
-	     "\t}\n"
-	     "\tif (res == NULL)\n"
-	     "\t\texit(EXIT_FAILURE);\n"
-	     "\tif (!sqlbox_finalise(db, 0))\n"
-	     "\t\texit(EXIT_FAILURE);\n"
-	     "\treturn q;\n"
+	if (fputs("\t\tTAILQ_INSERT_TAIL(q, p, _entries);\n"
+	     "\t}\n", f) == EOF)
+		return 0;
+	if (idmap && fputs("\tctx->idmap = NULL;\n"
+	    "\tfree(idmap.ents);\n", f) == EOF)
+		return 0;
+	if (!gen_freeq_fail(f, args, retstr, "if (res == NULL)", 1) ||
+	    !gen_freeq_fail(f, args, retstr, 
+	     "if (!sqlbox_finalise(db, 0))", 0))
+		return 0;
+
+	/* 
+	 * Conditional post-query to fill null refs, which is batched
+	 * over all results after the statement has been finalised.
+	 */
+
+	if (retstr->flags & STRCT_HAS_NULLREFS) {
+		if (fprintf(f, "\tdb_%s_reffind_q(ctx, q);\n",
+		    retstr->name) < 0)
+			return 0;
+		if (!gen_freeq_fail(f, args, retstr, NULL, 0))
+			return 0;
+	}
+
+	return fputs("\treturn q;\n"
 	     "}\n\n", f) != EOF;
 }
 
@@ -742,333 +1370,1052 @@ count_roles(const struct role *role)
 }
 
 /*
- * Create the role hierarchy.
- * Returns zero on failure, non-zero on success.
+ * Whether any pragmas are set in the "database" block.
+ * Return zero if none, non-zero otherwise.
  */
 static int
-gen_role_hier(FILE *f, const struct role *r)
+has_pragmas(const struct config *cfg)
 {
+	size_t	 i;
 
-	if (r->parent != NULL && 
-	    strcmp(r->parent->name, "all") && 
-	    strcmp(r->parent->name, "none") && fprintf(f, 
-	    "\tif (!sqlbox_role_hier_child(hier, ROLE_%s, ROLE_%s))\n"
-	    "\t\tgoto err;\n",
-	    r->parent->name, r->name) < 0)
-		return 0;
-
-	return 1;
+	for (i = 0; i < PRAGMA__MAX; i++)
+		if (gen_sql_pragma_isset(cfg->db, i))
+			return 1;
+	return 0;
 }
 
 /*
- * Actually print the sqlbox_role_hier_stmt() function for the statement
- * enumeration in "stmt".
- * This does nothing if we're doing the "all" or "none" role.
- * Return zero on failure, non-zero on success.
+ * Whether any structure has statements modifying the database.
+ * Return zero if none, non-zero otherwise.
  */
 static int
-gen_role_stmt(FILE *f, const struct role *r, const char *stmt)
+has_modify(const struct config *cfg)
 {
+	const struct strct	*p;
 
-	if (strcmp(r->name, "all") == 0 ||
-	    strcmp(r->name, "none") == 0)
-		return 1;
-	return fprintf(f, "\tif (!sqlbox_role_hier_stmt"
-		"(hier, ROLE_%s, %s))\n\t\tgoto err;\n", 
-		r->name, stmt) > 0;
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		if (p->ins != NULL || 
+		    !TAILQ_EMPTY(&p->uq) || !TAILQ_EMPTY(&p->dq))
+			return 1;
+	return 0;
 }
 
 /*
- * Print the sqlbox_role_hier_stmt() for all roles.
- * This means that we print for the immediate children of the "all"
- * role and let the hierarchical algorithm handle the rest.
+ * Print (if "f" is not NULL) and count into "sz" the statements
+ * permitted to role "r", or all statements if NULL.
+ * If "write" is set, these are insertions, updates, and deletions;
+ * otherwise, they're all other statements.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_role_stmt_all(FILE *f,
-	const struct config *cfg, const char *stmt)
+gen_role_stmts(FILE *f, const struct config *cfg,
+	const struct role *r, int write, size_t *sz)
 {
-	const struct role	*r, *rr;
-
-	TAILQ_FOREACH(r, &cfg->rq, entries) {
-		if (strcmp(r->name, "all") != 0)
+	const struct strct	*p;
+	const struct search 	*s;
+	const struct update 	*u;
+	const struct field 	*fd;
+	size_t	 		 i, pos;
+
+	*sz = 0;
+	TAILQ_FOREACH(p, &cfg->sq, entries) {
+		if (write) {
+			if (p->ins != NULL &&
+			    gen_role_granted(p->ins->rolemap, r)) {
+				if (f != NULL && fprintf(f, 
+				    "\tSTMT_%s_INSERT,\n", p->name) < 0)
+					return 0;
+				(*sz)++;
+			}
+			pos = 0;
+			TAILQ_FOREACH(u, &p->uq, entries) {
+				pos++;
+				if (!gen_role_granted(u->rolemap, r))
+					continue;
+				if (f != NULL && fprintf(f, 
+				    "\tSTMT_%s_UPDATE_%zu,\n", 
+				    p->name, pos - 1) < 0)
+					return 0;
+				(*sz)++;
+			}
+			pos = 0;
+			TAILQ_FOREACH(u, &p->dq, entries) {
+				pos++;
+				if (!gen_role_granted(u->rolemap, r))
+					continue;
+				if (f != NULL && fprintf(f, 
+				    "\tSTMT_%s_DELETE_%zu,\n", 
+				    p->name, pos - 1) < 0)
+					return 0;
+				(*sz)++;
+			}
 			continue;
-		TAILQ_FOREACH(rr, &r->subrq, entries)
-			if (!gen_role_stmt(f, rr, stmt))
+		}
+
+		/* Unique lookups are granted to all but reserved roles. */
+
+		if (r == NULL || r->parent != NULL)
+			TAILQ_FOREACH(fd, &p->fq, entries) {
+				if (!(fd->flags & (FIELD_ROWID|FIELD_UNIQUE)))
+					continue;
+				if (f != NULL && fprintf(f, 
+				    "\tSTMT_%s_BY_UNIQUE_%s,\n", 
+				    p->name, fd->name) < 0)
+					return 0;
+				(*sz)++;
+				if (!gen_sql_unique_many(fd))
+					continue;
+				if (f != NULL && fprintf(f, 
+				    "\tSTMT_%s_BY_UNIQUE_MANY_%s,\n", 
+				    p->name, fd->name) < 0)
+					return 0;
+				(*sz)++;
+			}
+
+		pos = 0;
+		TAILQ_FOREACH(s, &p->sq, entries) {
+			pos++;
+			if (!gen_role_granted(s->rolemap, r))
+				continue;
+			if (f != NULL && fprintf(f, 
+			    "\tSTMT_%s_BY_SEARCH_%zu,\n", 
+			    p->name, pos - 1) < 0)
 				return 0;
-		break;
+			(*sz)++;
+		}
 	}
+
+	/* The default role configures the database. */
+
+	if (!write && (r == NULL || strcmp(r->name, "default") == 0))
+		for (i = 0; i < PRAGMA__MAX; i++) {
+			if (!gen_sql_pragma_isset(cfg->db, i))
+				continue;
+			if (f != NULL && 
+			    fprintf(f, "\t%s,\n", pragmas[i]) < 0)
+				return 0;
+			(*sz)++;
+		}
+
 	return 1;
 }
 
 /*
- * For structure "p", print all roles capable of all operations.
- * Return >0 on success w/statements, <0 on failure, 0 on success w/o
- * statements.
+ * Print (if "f" is not NULL) and count into "sz" the roles that role
+ * "r" may enter: itself, its ancestors, and the "none" sink.
+ * The "default" role may enter any role.
+ * Return zero on failure, non-zero on success.
  */
 static int
-gen_roles(FILE *f, const struct config *cfg, const struct strct *p)
+gen_role_roles(FILE *f, const struct config *cfg,
+	const struct role *r, size_t *sz)
 {
-	const struct rref	*rs;
-	const struct search 	*s;
-	const struct update 	*u;
-	const struct field 	*fd;
-	size_t	 		 pos, shown = 0;
-	char			*buf;
-
-	/* 
-	 * FIXME: only do this if the role needs access to this, which
-	 * needs to be figured out by a recursive scan.
-	 */
+	const struct role	*rp;
 
-	TAILQ_FOREACH(fd, &p->fq, entries)
-		if ((fd->flags & (FIELD_ROWID|FIELD_UNIQUE))) {
-			if (asprintf(&buf, "STMT_%s_BY_UNIQUE_%s",
-			    p->name, fd->name) < 0)
-				return -1;
-			if (!gen_role_stmt_all(f, cfg, buf))
-				return -1;
-			shown++;
-			free(buf);
+	*sz = 0;
+	if (strcmp(r->name, "default") == 0) {
+		TAILQ_FOREACH(rp, &cfg->arq, allentries) {
+			if (strcmp(rp->name, "all") == 0)
+				continue;
+			if (f != NULL && fprintf(f, 
+			    "\tROLE_%s,\n", rp->name) < 0)
+				return 0;
+			(*sz)++;
 		}
-
-	/* Start with all query types. */
-
-	pos = 0;
-	TAILQ_FOREACH(s, &p->sq, entries) {
-		pos++;
-		if (s->rolemap == NULL)
-			continue;
-		if (asprintf(&buf, "STMT_%s_BY_SEARCH_%zu", 
-		    p->name, pos - 1) < 0)
-			return -1;
-		TAILQ_FOREACH(rs, &s->rolemap->rq, entries)
-			if (strcmp(rs->role->name, "all") == 0) {
-				if (!gen_role_stmt_all(f, cfg, buf))
-					return -1;
-			} else if (!gen_role_stmt(f, rs->role, buf))
-				return -1;
-		shown++;
-		free(buf);
-	}
-
-	/* Next: insertions. */
-
-	if (p->ins != NULL && p->ins->rolemap != NULL) {
-		if (asprintf(&buf, "STMT_%s_INSERT", p->name) < 0)
-			return -1;
-		TAILQ_FOREACH(rs, &p->ins->rolemap->rq, entries)
-			if (strcmp(rs->role->name, "all") == 0) {
-				if (!gen_role_stmt_all(f, cfg, buf))
-					return -1;
-			} else if (!gen_role_stmt(f, rs->role, buf))
-				return -1;
-		shown++;
-		free(buf);
+		return 1;
 	}
 
-	/* Next: updates. */
-
-	pos = 0;
-	TAILQ_FOREACH(u, &p->uq, entries) {
-		pos++;
-		if (u->rolemap == NULL)
-			continue;
-		if (asprintf(&buf, "STMT_%s_UPDATE_%zu", 
-		    p->name, pos - 1) < 0)
-			return -1;
-		TAILQ_FOREACH(rs, &u->rolemap->rq, entries)
-			if (strcmp(rs->role->name, "all") == 0) {
-				if (!gen_role_stmt_all(f, cfg, buf))
-					return -1;
-			} else if (!gen_role_stmt(f, rs->role, buf))
-				return -1;
-		shown++;
-		free(buf);
+	if (strcmp(r->name, "none") != 0) {
+		if (f != NULL && fputs("\tROLE_none,\n", f) == EOF)
+			return 0;
+		(*sz)++;
 	}
-
-	/* Finally: deletions. */
-
-	pos = 0;
-	TAILQ_FOREACH(u, &p->dq, entries) {
-		pos++;
-		if (u->rolemap == NULL)
-			continue;
-		if (asprintf(&buf, "STMT_%s_DELETE_%zu", 
-		    p->name, pos - 1) < 0)
-			return -1;
-		TAILQ_FOREACH(rs, &u->rolemap->rq, entries)
-			if (strcmp(rs->role->name, "all") == 0) {
-				if (!gen_role_stmt_all(f, cfg, buf))
-					return -1;
-			} else if (!gen_role_stmt(f, rs->role, buf))
-				return -1;
-		shown++;
-		free(buf);
+	for (rp = r; rp != NULL; rp = rp->parent) {
+		if (strcmp(rp->name, "all") == 0)
+			break;
+		if (f != NULL && fprintf(f, "\tROLE_%s,\n", rp->name) < 0)
+			return 0;
+		(*sz)++;
 	}
-
-	return shown > 0;
+	return 1;
 }
 
 /*
- * Generate database opening.
- * Returns zero on failure, non-zero on success.
+ * Print the members of a single "struct sqlbox_role" for role "r",
+ * whose tables were printed by gen_role_tables().
+ * If "ro", only list statements not modifying the database.
+ * Return zero on failure, non-zero on success.
  */
 static int
-gen_open(FILE *f, const struct config *cfg)
+gen_role_table(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct role *r, int ro)
 {
-	const struct role 	*r;
-	const struct strct 	*p;
-	size_t			 i;
-	int			 c;
-
-	if (!gen_func_db_set_logging(f, 0))
-		return 0;
-	if (fputs("{\n"
-	    "\n"
-	    "\tif (!sqlbox_msg_set_dat(ort->db, arg, sz))\n"
-	    "\t\texit(EXIT_FAILURE);\n"
-	    "}\n\n", f) == EOF)
-		return 0;
+	size_t	 rsz, wsz, sz;
 
-	if (!gen_func_db_open(f, 0))
-		return 0;
-	if (fputs("{\n"
-	    "\n"
-	    "\treturn db_open_logging(file, NULL, NULL, NULL);\n"
-	    "}\n\n", f) == EOF)
+	if (!gen_role_roles(NULL, cfg, r, &sz) ||
+	    !gen_role_stmts(NULL, cfg, r, 0, &rsz) ||
+	    !gen_role_stmts(NULL, cfg, r, 1, &wsz))
 		return 0;
+	if (ro)
+		wsz = 0;
 
-	if (!gen_func_db_open_logging(f, 0))
-		return 0;
-	if (fputs("{\n"
-	     "\tsize_t i;\n"
-	     "\tstruct ort *ctx = NULL;\n"
-	     "\tstruct sqlbox_cfg cfg;\n"
-	     "\tstruct sqlbox *db = NULL;\n"
-	     "\tstruct sqlbox_pstmt pstmts[STMT__MAX];\n"
-	     "\tstruct sqlbox_src srcs[1] = {\n"
-	     "\t\t{ .fname = (char *)file,\n"
-	     "\t\t  .mode = SQLBOX_SRC_RW }\n"
-	     "\t};\n", f) == EOF)
+	if (fprintf(f, "\t[ROLE_%s] = {\n"
+	    "\t\t.roles = role_roles_%s,\n"
+	    "\t\t.rolesz = %zu", r->name, r->name, sz) < 0)
 		return 0;
-	if (!TAILQ_EMPTY(&cfg->rq) && fputs
-	    ("\tstruct sqlbox_role_hier *hier = NULL;\n", f) == EOF)
+	if (rsz + wsz > 0 && fprintf(f, ",\n"
+	    "\t\t.stmts = role_stmts_%s,\n"
+	    "\t\t.stmtsz = %zu", r->name, rsz + wsz) < 0)
 		return 0;
-	if (fputs("\n"
-	    "\tmemset(&cfg, 0, sizeof(struct sqlbox_cfg));\n"
-	    "\tcfg.msg.func = log;\n"
-	    "\tcfg.msg.func_short = log_short;\n"
-	    "\tcfg.msg.dat = log_arg;\n"
-	    "\tcfg.srcs.srcs = srcs;\n"
-	    "\tcfg.srcs.srcsz = 1;\n"
-	    "\tcfg.stmts.stmts = pstmts;\n"
-	    "\tcfg.stmts.stmtsz = STMT__MAX;\n"
-	    "\n"
-	    "\tfor (i = 0; i < STMT__MAX; i++)\n"
-	    "\t\tpstmts[i].stmt = (char *)stmts[i];\n"
-	    "\n"
-	    "\tctx = malloc(sizeof(struct ort));\n"
-	    "\tif (ctx == NULL)\n"
-	    "\t\tgoto err;\n\n", f) == EOF)
+	if (strcmp(r->name, "default") == 0 && fprintf(f, ",\n"
+	    "\t\t.srcs = role_srcs,\n"
+	    "\t\t.srcsz = %zu", args->readers + 1) < 0)
 		return 0;
+	return fputs(" },\n", f) != EOF;
+}
 
-	if (!TAILQ_EMPTY(&cfg->rq)) {
-		/*
-		 * We need an complete count of all roles except the
-		 * "all" role, which cannot be entered or processed.
-		 * So do this recursively.
-		 */
-
-		i = 0;
-		TAILQ_FOREACH(r, &cfg->rq, entries)
-			i += count_roles(r);
-		assert(i > 0);
-		if (fprintf(f, "\thier = sqlbox_role_hier_alloc(%zu);\n"
-		    "\tif (hier == NULL)\n"
-		    "\t\tgoto err;\n"
-		    "\n", i) < 0)
-			return 0;
+/*
+ * Print the sources opened by the "default" role or, without roles, the
+ * single role of read-only contexts.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_role_srcs(FILE *f, const struct ort_lang_c *args)
+{
+	size_t	 i;
 
-		if (!gen_comment(f, 1, COMMENT_C, "Assign roles."))
+	if (fputs("static\tsize_t role_srcs[] = { 0", f) == EOF)
+		return 0;
+	for (i = 0; i < args->readers; i++)
+		if (fprintf(f, ", %zu", i + 1) < 0)
 			return 0;
+	return fputs(" };\n", f) != EOF;
+}
 
-		/* 
-		 * FIXME: the default role should only be able to open
-		 * the database once.
-		 * With this, it's able to do so multiple times and
-		 * that's not a permission it needs.
-		 */
+/*
+ * Generate the role permission matrix passed directly to sqlbox(3) in
+ * db_open_src(), so opening the database doesn't need to build it from
+ * the role hierarchy.
+ * Each role's statements include those of its ancestors, with those
+ * modifying the database last: read-only contexts use the same tables
+ * but only count the leading statements.
+ * Without roles, this is only a single role for read-only contexts.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_role_tables(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
+{
+	const struct role	*r;
+	size_t			 i, rsz, wsz;
 
-		if (fputs("\n"
-		    "\tif (!sqlbox_role_hier_sink(hier, ROLE_none))\n"
-		    "\t\tgoto err;\n"
-		    "\tif (!sqlbox_role_hier_start(hier, ROLE_default))\n"
-		    "\t\tgoto err;\n"
-		    "\tif (!sqlbox_role_hier_src(hier, ROLE_default, 0))\n"
-		    "\t\tgoto err;\n", f) == EOF)
+	if (!gen_rbac(cfg, args->role)) {
+		if (!gen_role_stmts(NULL, cfg, NULL, 0, &rsz))
 			return 0;
-
-		TAILQ_FOREACH(r, &cfg->arq, allentries)
-			if (!gen_role_hier(f, r))
-				return 0;
-
-		if (fputc('\n', f) == EOF)
+		if (!gen_comment(f, 0, COMMENT_C,
+		    "The single role of contexts opened by "
+		    "db_open_ro(), which may only use statements not "
+		    "modifying the database."))
 			return 0;
-		TAILQ_FOREACH(p, &cfg->sq, entries) {
-			if (!gen_commentv(f, 1, COMMENT_C, 
-			    "White-listing fields and "
-			    "operations for structure \"%s\".",
-			    p->name))
-				return 0;
-			if (fputc('\n', f) == EOF)
+		if (rsz > 0) {
+			if (fputs("static\tsize_t "
+			    "role_stmts_ro[] = {\n", f) == EOF)
 				return 0;
-			if ((c = gen_roles(f, cfg, p)) < 0)
+			if (!gen_role_stmts(f, cfg, NULL, 0, &rsz))
 				return 0;
-			else if (c > 0 && fputc('\n', f) == EOF)
+			if (fputs("};\n", f) == EOF)
 				return 0;
 		}
-		if (fputs("\tif (!sqlbox_role_hier_gen"
-		    "(hier, &cfg.roles, ROLE_default))\n"
-		    "\t\tgoto err;\n\n", f) == EOF)
+		if (fputs("static\tsize_t "
+		    "role_roles_ro[] = { 0 };\n", f) == EOF)
+			return 0;
+		if (!gen_role_srcs(f, args))
 			return 0;
+		if (fputs("static\tstruct sqlbox_role role_ro = {\n"
+		    "\t.roles = role_roles_ro,\n"
+		    "\t.rolesz = 1,\n", f) == EOF)
+			return 0;
+		if (rsz > 0 && fprintf(f, 
+		    "\t.stmts = role_stmts_ro,\n"
+		    "\t.stmtsz = %zu,\n", rsz) < 0)
+			return 0;
+		return fprintf(f, "\t.srcs = role_srcs,\n"
+		    "\t.srcsz = %zu\n"
+		    "};\n\n", args->readers + 1) > 0;
 	}
 
-	if (fputs("\tif ((db = sqlbox_alloc(&cfg)) == NULL)\n"
-	    "\t\tgoto err;\n"
-	    "\tctx->db = db;\n", f) == EOF)
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Statements permitted to each role, including those of "
+	    "its ancestors.\n"
+	    "Statements modifying the database follow all others."))
 		return 0;
-
-	if (!TAILQ_EMPTY(&cfg->rq)) {
-	        if (fputs("\tctx->role = ROLE_default;\n"
-		    "\n"
-		    "\tsqlbox_role_hier_gen_free(&cfg.roles);\n"
-		    "\tsqlbox_role_hier_free(hier);\n"
-		    "\thier = NULL;\n\n", f) == EOF)
+	TAILQ_FOREACH(r, &cfg->arq, allentries) {
+		if (strcmp(r->name, "all") == 0)
+			continue;
+		if (!gen_role_stmts(NULL, cfg, r, 0, &rsz) ||
+		    !gen_role_stmts(NULL, cfg, r, 1, &wsz))
 			return 0;
-	} else if (fputc('\n', f) == EOF)
-		return 0;
-
+		if (rsz + wsz == 0)
+			continue;
+		if (fprintf(f, "static\tsize_t "
+		    "role_stmts_%s[] = {\n", r->name) < 0)
+			return 0;
+		if (!gen_role_stmts(f, cfg, r, 0, &rsz) ||
+		    !gen_role_stmts(f, cfg, r, 1, &wsz))
+			return 0;
+		if (fputs("};\n", f) == EOF)
+			return 0;
+	}
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Roles that may be entered from each role."))
+		return 0;
+	TAILQ_FOREACH(r, &cfg->arq, allentries) {
+		if (strcmp(r->name, "all") == 0)
+			continue;
+		if (fprintf(f, "static\tsize_t "
+		    "role_roles_%s[] = {\n", r->name) < 0)
+			return 0;
+		if (!gen_role_roles(f, cfg, r, &rsz))
+			return 0;
+		if (fputs("};\n", f) == EOF)
+			return 0;
+	}
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Sources opened by the default role."))
+		return 0;
+	if (!gen_role_srcs(f, args))
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	i = 0;
+	TAILQ_FOREACH(r, &cfg->rq, entries)
+		i += count_roles(r);
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Role permissions of contexts opened by db_open()."))
+		return 0;
+	if (fprintf(f, "static\tstruct sqlbox_role "
+	    "roles_rw[%zu] = {\n", i) < 0)
+		return 0;
+	TAILQ_FOREACH(r, &cfg->arq, allentries)
+		if (strcmp(r->name, "all") != 0 &&
+		    !gen_role_table(f, cfg, args, r, 0))
+			return 0;
+	if (fputs("};\n\n", f) == EOF)
+		return 0;
+
+	if (!has_modify(cfg))
+		return 1;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Role permissions of contexts opened by db_open_ro()."))
+		return 0;
+	if (fprintf(f, "static\tstruct sqlbox_role "
+	    "roles_ro[%zu] = {\n", i) < 0)
+		return 0;
+	TAILQ_FOREACH(r, &cfg->arq, allentries)
+		if (strcmp(r->name, "all") != 0 &&
+		    !gen_role_table(f, cfg, args, r, 1))
+			return 0;
+	return fputs("};\n\n", f) != EOF;
+}
+
+/*
+ * Generate the function applying a single "database" pragma.
+ * This uses a statement that may return a row (e.g., "journal_mode"),
+ * so it's stepped instead of executed.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_pragma(FILE *f)
+{
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Apply the pragma \"stmt\" from the configuration's "
+	    "database block to source \"src\".\n"
+	    "Returns zero on failure, non-zero on success."))
+		return 0;
+	return fputs("static int\n"
+	    "db_pragma(struct sqlbox *db, size_t src, enum stmt stmt)\n"
+	    "{\n"
+	    "\n"
+	    "\tif (!sqlbox_prepare_bind_async(db, src, stmt, 0, NULL, 0))\n"
+	    "\t\treturn 0;\n"
+	    "\tif (sqlbox_step(db, 0) == NULL)\n"
+	    "\t\treturn 0;\n"
+	    "\treturn sqlbox_finalise(db, 0);\n"
+	    "}\n\n", f) != EOF;
+}
+
+/*
+ * Whether the structure has any batched lookups by unique field, which
+ * are available to all but the reserved roles.
+ * The role "r" is NULL when not limiting generation to a role.
+ * Return zero if none, non-zero otherwise.
+ */
+static int
+has_many(const struct strct *p, const struct role *r)
+{
+	const struct field	*fd;
+
+	if (r != NULL && r->parent == NULL)
+		return 0;
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (gen_sql_unique_many(fd))
+			return 1;
+	return 0;
+}
+
+/*
+ * Whether the structure has an insert or update returning rows, which
+ * are filled directly from the statement, granted to role "r".
+ * Return zero if none, non-zero otherwise.
+ */
+static int
+has_returning(const struct strct *p, const struct role *r)
+{
+	const struct update	*up;
+
+	if (p->ins != NULL && (p->ins->flags & INSERT_RETURNING) &&
+	    gen_role_granted(p->ins->rolemap, r))
+		return 1;
+	TAILQ_FOREACH(up, &p->uq, entries)
+		if ((up->flags & UPDATE_RETURNING) &&
+		    gen_role_granted(up->rolemap, r))
+			return 1;
+	return 0;
+}
+
+/*
+ * Whether any search in the configuration granted to role "r" uses an
+ * "in" constraint or any structure has batched lookups, both of which
+ * bind sets.
+ * Return zero if none, non-zero otherwise.
+ */
+static int
+has_in(const struct config *cfg, const struct role *r)
+{
+	const struct strct	*p;
+	const struct search	*s;
+	const struct sent	*sent;
+
+	TAILQ_FOREACH(p, &cfg->sq, entries) {
+		if (has_many(p, r))
+			return 1;
+		TAILQ_FOREACH(s, &p->sq, entries) {
+			if (!gen_role_granted(s->rolemap, r))
+				continue;
+			TAILQ_FOREACH(sent, &s->sntq, entries)
+				if (sent->op == OPTYPE_IN)
+					return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Generate the identity map used by listings to fill each shared
+ * structure only once.
+ * This is an open-addressed hash table keyed by structure type and row
+ * identifier.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_idmap(FILE *f, const struct config *cfg)
+{
+	const struct strct	*p;
+	int			 first = 1;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Structures that may be shared between results of a "
+	    "listing."))
+		return 0;
+	if (fputs("enum\tidmap {\n", f) == EOF)
+		return 0;
+	TAILQ_FOREACH(p, &cfg->sq, entries) {
+		if (!gen_strct_shared(cfg, p))
+			continue;
+		if (fprintf(f, "%s\tIDMAP_%s",
+		    first ? "" : ",\n", p->name) < 0)
+			return 0;
+		first = 0;
+	}
+	if (fputs("\n};\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Structure filled while listing, see ort_idmap_get()."))
+		return 0;
+	if (fputs("struct\tort_idmap_ent {\n"
+	    "\tenum idmap type;\n"
+	    "\tint64_t id;\n"
+	    "\tvoid *p;\n"
+	    "};\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Identity map of structures filled while listing, so that "
+	    "each row is only filled once.\n"
+	    "The table has a power-of-two number of slots and is kept "
+	    "at most half full."))
+		return 0;
+	if (fputs("struct\tort_idmap {\n"
+	    "\tstruct ort_idmap_ent *ents;\n"
+	    "\tsize_t sz;\n"
+	    "\tsize_t max;\n"
+	    "};\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Get the first slot of row \"id\" of \"type\" in a table of "
+	    "\"max\" slots."))
+		return 0;
+	if (fputs("static size_t\n"
+	    "ort_idmap_slot(enum idmap type, int64_t id, size_t max)\n"
+	    "{\n"
+	    "\tuint64_t h;\n"
+	    "\n"
+	    "\th = ((uint64_t)id + type) * 0x9e3779b97f4a7c15ULL;\n"
+	    "\treturn (size_t)(h >> 32) & (max - 1);\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Look up row \"id\" of \"type\".\n"
+	    "Returns the structure or NULL if not found."))
+		return 0;
+	if (fputs("static void *\n"
+	    "ort_idmap_get(const struct ort_idmap *m, "
+	    "enum idmap type, int64_t id)\n"
+	    "{\n"
+	    "\tsize_t i;\n"
+	    "\n"
+	    "\tif (m->max == 0)\n"
+	    "\t\treturn NULL;\n"
+	    "\ti = ort_idmap_slot(type, id, m->max);\n"
+	    "\tfor ( ; m->ents[i].p != NULL; i = (i + 1) & (m->max - 1))\n"
+	    "\t\tif (m->ents[i].type == type && m->ents[i].id == id)\n"
+	    "\t\t\treturn m->ents[i].p;\n"
+	    "\treturn NULL;\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Add the structure \"p\" as row \"id\" of \"type\", which "
+	    "must not already be in the map."))
+		return 0;
+	return fputs("static void\n"
+	    "ort_idmap_put(struct ort_idmap *m, enum idmap type, "
+	    "int64_t id,\n"
+	    "\tvoid *p)\n"
+	    "{\n"
+	    "\tstruct ort_idmap_ent *ents;\n"
+	    "\tsize_t i, j, max;\n"
+	    "\n"
+	    "\tif (2 * (m->sz + 1) > m->max) {\n"
+	    "\t\tmax = m->max == 0 ? 64 : m->max * 2;\n"
+	    "\t\tents = calloc(max, sizeof(struct ort_idmap_ent));\n"
+	    "\t\tif (ents == NULL) {\n"
+	    "\t\t\tperror(NULL);\n"
+	    "\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t}\n"
+	    "\t\tfor (i = 0; i < m->max; i++) {\n"
+	    "\t\t\tif (m->ents[i].p == NULL)\n"
+	    "\t\t\t\tcontinue;\n"
+	    "\t\t\tj = ort_idmap_slot(m->ents[i].type, "
+	    "m->ents[i].id, max);\n"
+	    "\t\t\twhile (ents[j].p != NULL)\n"
+	    "\t\t\t\tj = (j + 1) & (max - 1);\n"
+	    "\t\t\tents[j] = m->ents[i];\n"
+	    "\t\t}\n"
+	    "\t\tfree(m->ents);\n"
+	    "\t\tm->ents = ents;\n"
+	    "\t\tm->max = max;\n"
+	    "\t}\n"
+	    "\ti = ort_idmap_slot(type, id, m->max);\n"
+	    "\twhile (m->ents[i].p != NULL)\n"
+	    "\t\ti = (i + 1) & (m->max - 1);\n"
+	    "\tm->ents[i].type = type;\n"
+	    "\tm->ents[i].id = id;\n"
+	    "\tm->ents[i].p = p;\n"
+	    "\tm->sz++;\n"
+	    "}\n\n", f) != EOF;
+}
+
+/*
+ * Generate the "fill_id" function for structures shared by way of the
+ * identity map, which is used instead of "fill_r" when filling by
+ * reference.
+ * The row identifier is read ahead of filling: if already in the map,
+ * the structure is copied and marked as shared instead.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fill_id(FILE *f, const struct strct *p)
+{
+	const struct field	*fd;
+	size_t			 idx = 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (fd == p->rowid)
+			break;
+		if (fd->type != FTYPE_STRUCT)
+			idx++;
+	}
+	assert(fd != NULL);
+
+	if (!gen_commentv(f, 0, COMMENT_C,
+	    "Like db_%s_fill_r(), but while listing, copy the %s from "
+	    "an earlier result with the same row instead of filling "
+	    "it again.\n"
+	    "The copy shares the memory of the original, so both count "
+	    "references to it: see db_%s_unfill_r().",
+	    p->name, p->name, p->name))
+		return 0;
+	return fprintf(f, "static void\n"
+	    "db_%s_fill_id(struct ort *ctx, struct %s *p,\n"
+	    "\tconst struct sqlbox_parmset *res, size_t *pos)\n"
+	    "{\n"
+	    "\tstruct %s *pp;\n"
+	    "\tint64_t id;\n"
+	    "\n"
+	    "\tif (ctx->idmap == NULL) {\n"
+	    "\t\tdb_%s_fill_r(ctx, p, res, pos);\n"
+	    "\t\treturn;\n"
+	    "\t}\n"
+	    "\tif (sqlbox_parm_int(&res->ps[*pos + %zu], &id) == -1)\n"
+	    "\t\texit(EXIT_FAILURE);\n"
+	    "\tpp = ort_idmap_get(ctx->idmap, IDMAP_%s, id);\n"
+	    "\tif (pp != NULL) {\n"
+	    "\t\tif (pp->priv_refs == NULL) {\n"
+	    "\t\t\tpp->priv_refs = malloc(sizeof(size_t));\n"
+	    "\t\t\tif (pp->priv_refs == NULL) {\n"
+	    "\t\t\t\tperror(NULL);\n"
+	    "\t\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t\t}\n"
+	    "\t\t\t*pp->priv_refs = 1;\n"
+	    "\t\t}\n"
+	    "\t\t(*pp->priv_refs)++;\n"
+	    "\t\t*p = *pp;\n"
+	    "\t\t*pos += %zu;\n"
+	    "\t\treturn;\n"
+	    "\t}\n"
+	    "\tdb_%s_fill_r(ctx, p, res, pos);\n"
+	    "\tort_idmap_put(ctx->idmap, IDMAP_%s, id, p);\n"
+	    "}\n\n", p->name, p->name, p->name, p->name, idx,
+	    p->name, count_fill_r(p), p->name, p->name) > 0;
+}
+
+/*
+ * Generate the functions used to bind "in" constraints.
+ * The set is bound as a single JSON array instead of one parameter per
+ * member, which is unpacked with json_each() in the statement.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_in(FILE *f)
+{
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Buffer for binding an \"in\" set as a JSON array."))
+		return 0;
+	if (fputs("struct ort_in {\n"
+	    "\tchar *buf;\n"
+	    "\tsize_t len;\n"
+	    "\tsize_t max;\n"
+	    "};\n\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Append a single character to the set, always leaving room "
+	    "for the trailing bracket and NUL terminator."))
+		return 0;
+	if (fputs("static void\n"
+	    "ort_in_putc(struct ort_in *p, char c)\n"
+	    "{\n"
+	    "\tchar *pp;\n"
+	    "\n"
+	    "\tif (p->len + 2 >= p->max) {\n"
+	    "\t\tp->max = p->max == 0 ? 64 : p->max * 2;\n"
+	    "\t\tif ((pp = realloc(p->buf, p->max)) == NULL)\n"
+	    "\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\tp->buf = pp;\n"
+	    "\t}\n"
+	    "\tp->buf[p->len++] = c;\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Append an integer member to the set."))
+		return 0;
+	if (fputs("static void\n"
+	    "ort_in_int(struct ort_in *p, int64_t v)\n"
+	    "{\n"
+	    "\tchar buf[32];\n"
+	    "\tsize_t i;\n"
+	    "\n"
+	    "\tort_in_putc(p, p->len == 0 ? '[' : ',');\n"
+	    "\tsnprintf(buf, sizeof(buf), \"%lld\", (long long)v);\n"
+	    "\tfor (i = 0; buf[i] != '\\0'; i++)\n"
+	    "\t\tort_in_putc(p, buf[i]);\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Append a string member to the set, escaping quotes, "
+	    "backslashes, and control characters."))
+		return 0;
+	if (fputs("static void\n"
+	    "ort_in_str(struct ort_in *p, const char *v)\n"
+	    "{\n"
+	    "\tchar buf[8];\n"
+	    "\tsize_t i;\n"
+	    "\n"
+	    "\tort_in_putc(p, p->len == 0 ? '[' : ',');\n"
+	    "\tort_in_putc(p, '\"');\n"
+	    "\tfor ( ; *v != '\\0'; v++)\n"
+	    "\t\tif (*v == '\"' || *v == '\\\\') {\n"
+	    "\t\t\tort_in_putc(p, '\\\\');\n"
+	    "\t\t\tort_in_putc(p, *v);\n"
+	    "\t\t} else if ((unsigned char)*v < 0x20) {\n"
+	    "\t\t\tsnprintf(buf, sizeof(buf), \"\\\\u%.4x\",\n"
+	    "\t\t\t    (unsigned int)(unsigned char)*v);\n"
+	    "\t\t\tfor (i = 0; buf[i] != '\\0'; i++)\n"
+	    "\t\t\t\tort_in_putc(p, buf[i]);\n"
+	    "\t\t} else\n"
+	    "\t\t\tort_in_putc(p, *v);\n"
+	    "\tort_in_putc(p, '\"');\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Terminate the set, which may be empty, and return it."))
+		return 0;
+	return fputs("static const char *\n"
+	    "ort_in_done(struct ort_in *p)\n"
+	    "{\n"
+	    "\n"
+	    "\tif (p->len == 0)\n"
+	    "\t\tort_in_putc(p, '[');\n"
+	    "\tort_in_putc(p, ']');\n"
+	    "\tp->buf[p->len] = '\\0';\n"
+	    "\treturn p->buf;\n"
+	    "}\n\n", f) != EOF;
+}
+
+/*
+ * Generate application of "database" pragmas after the sources have
+ * been opened.
+ * The journal mode is persistent and set on the read-write source,
+ * while the others are per-connection and set on all sources.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_open_pragmas(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
+{
+	size_t	 i, tabs = 1;
+
+	if (gen_sql_pragma_isset(cfg->db, PRAGMA_JOURNAL_MODE) &&
+	    fprintf(f, "\tif (mode == SQLBOX_SRC_RW &&\n"
+	    "\t    !db_pragma(db, %s, %s))\n"
+	    "\t\tgoto err;\n", src_write(args),
+	    pragmas[PRAGMA_JOURNAL_MODE]) < 0)
+		return 0;
+
+	for (i = 0; i < PRAGMA__MAX; i++)
+		if (i != PRAGMA_JOURNAL_MODE &&
+		    gen_sql_pragma_isset(cfg->db, i))
+			break;
+	if (i == PRAGMA__MAX)
+		return 1;
+
+	if (args->readers > 0) {
+		if (fprintf(f, "\tfor (i = 1; i <= %zu; i++) {\n",
+		    args->readers + 1) < 0)
+			return 0;
+		tabs++;
+	}
+
+	for (i = 0; i < PRAGMA__MAX; i++) {
+		if (i == PRAGMA_JOURNAL_MODE ||
+		    !gen_sql_pragma_isset(cfg->db, i))
+			continue;
+		if (!print_src(f, tabs, 
+		    "if (!db_pragma(db, %s, %s))\n"
+		    "\tgoto err;", args->readers > 0 ? "i" : "0",
+		    pragmas[i]))
+			return 0;
+	}
+
+	return args->readers == 0 || fputs("\t}\n", f) != EOF;
+}
+
+/*
+ * Generate the round-robin selection of read-only sources.
+ * The read-write source is opened first, so read-only sources have
+ * identifiers starting at two.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_src_read(FILE *f, const struct ort_lang_c *args)
+{
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Select the source for a read-only statement.\n"
+	    "Within a transaction, this is the read-write source so "
+	    "that reads see uncommitted changes.\n"
+	    "Otherwise, cycle through the read-only sources."))
+		return 0;
+	return fprintf(f, "static size_t\n"
+	    "db_src_read(struct ort *ctx)\n"
+	    "{\n"
+	    "\n"
+	    "\tif (ctx->trans > 0)\n"
+	    "\t\treturn 1;\n"
+	    "\tctx->rdsrc = (ctx->rdsrc + 1) %% %zu;\n"
+	    "\treturn ctx->rdsrc + 2;\n"
+	    "}\n\n", args->readers) > 0;
+}
+
+/*
+ * Generate database opening.
+ * Returns zero on failure, non-zero on success.
+ */
+static int
+gen_open(FILE *f, const struct config *cfg, const struct ort_lang_c *args)
+{
+	const struct role 	*r;
+	size_t			 i;
+
+	if (!gen_func_db_set_logging(f, 0))
+		return 0;
+	if (fputs("{\n", f) == EOF)
+		return 0;
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS)) {
+		if (fputs("\n"
+		    "\tif (!sqlbox_msg_set_dat(ort->db, arg, sz))\n"
+		    "\t\texit(EXIT_FAILURE);\n"
+		    "}\n\n", f) == EOF)
+			return 0;
+	} else if (fputs("\tvoid *dat = NULL;\n"
+	    "\n"
+	    "\tort->err = ORT_ERR_OK;\n"
+	    "\tif (!sqlbox_msg_set_dat(ort->db, arg, sz)) {\n"
+	    "\t\tort->err = ORT_ERR_DB;\n"
+	    "\t\treturn;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/* Keep a copy for replacing the connection. */\n"
+	    "\n"
+	    "\tif (sz > 0) {\n"
+	    "\t\tif ((dat = malloc(sz)) == NULL) {\n"
+	    "\t\t\tperror(NULL);\n"
+	    "\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t}\n"
+	    "\t\tmemcpy(dat, arg, sz);\n"
+	    "\t}\n"
+	    "\tfree(ort->log_dat);\n"
+	    "\tort->log_dat = dat;\n"
+	    "\tort->log_datsz = sz;\n"
+	    "\tif (sz == 0)\n"
+	    "\t\tort->log_arg = NULL;\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_func_db_open(f, 0))
+		return 0;
+	if (fputs("{\n"
+	    "\n"
+	    "\treturn db_open_logging(file, NULL, NULL, NULL);\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_func_db_open_ro(f, 0))
+		return 0;
+	if (fputs("{\n"
+	    "\n"
+	    "\treturn db_open_ro_logging(file, NULL, NULL, NULL);\n"
+	    "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Open the database for db_open_logging() or, if \"mode\" "
+	    "is SQLBOX_SRC_RO, db_open_ro_logging().\n"
+	    "Read-only contexts may only use statements that don't "
+	    "modify the database."))
+		return 0;
+	if (fprintf(f, "static struct ort *\n"
+	     "db_open_src(const char *file, enum sqlbox_srcmode mode,\n"
+	     "\tvoid (*log)(const char *, void *),\n"
+	     "\tvoid (*log_short)(const char *, ...), "
+	     "void *log_arg)\n"
+	     "{\n"
+	     "\tsize_t i;\n"
+	     "\tstruct ort *ctx = NULL;\n"
+	     "\tstruct sqlbox_cfg cfg;\n"
+	     "\tstruct sqlbox *db = NULL;\n"
+	     "\tstruct sqlbox_pstmt pstmts[STMT__MAX];\n"
+	     "\tstruct sqlbox_src srcs[%zu] = {\n"
+	     "\t\t{ .fname = (char *)file,\n"
+	     "\t\t  .mode = mode }", args->readers + 1) < 0)
+		return 0;
+
+	/* Read-only sources follow the read-write source. */
+
+	for (i = 0; i < args->readers; i++)
+		if (fputs(",\n"
+		    "\t\t{ .fname = (char *)file,\n"
+		    "\t\t  .mode = SQLBOX_SRC_RO }", f) == EOF)
+			return 0;
+	if (fputs("\n\t};\n", f) == EOF)
+		return 0;
+	if (fprintf(f, "\n"
+	    "\tmemset(&cfg, 0, sizeof(struct sqlbox_cfg));\n"
+	    "\tcfg.msg.func = log;\n"
+	    "\tcfg.msg.func_short = log_short;\n"
+	    "\tcfg.msg.dat = log_arg;\n"
+	    "\tcfg.srcs.srcs = srcs;\n"
+	    "\tcfg.srcs.srcsz = %zu;\n"
+	    "\tcfg.stmts.stmts = pstmts;\n"
+	    "\tcfg.stmts.stmtsz = STMT__MAX;\n"
+	    "\n"
+	    "\tfor (i = 0; i < STMT__MAX; i++)\n"
+	    "\t\tpstmts[i].stmt = (char *)stmts[i];\n"
+	    "\n", args->readers + 1) < 0)
+		return 0;
+
+	/* Role permissions are from gen_role_tables(). */
+
+	if (gen_rbac(cfg, args->role)) {
+		i = 0;
+		TAILQ_FOREACH(r, &cfg->rq, entries)
+			i += count_roles(r);
+		if (fprintf(f, 
+		    "\tcfg.roles.roles = %s;\n"
+		    "\tcfg.roles.rolesz = %zu;\n"
+		    "\tcfg.roles.defrole = ROLE_default;\n"
+		    "\n", has_modify(cfg) ? 
+		    "\n\t    (mode == SQLBOX_SRC_RO ? roles_ro : roles_rw)" :
+		    "roles_rw", i) < 0)
+			return 0;
+	} else if (has_modify(cfg)) {
+		if (!gen_comment(f, 1, COMMENT_C,
+		    "Read-only contexts may not modify the database."))
+			return 0;
+		if (fputs("\n"
+		    "\tif (mode == SQLBOX_SRC_RO) {\n"
+		    "\t\tcfg.roles.roles = &role_ro;\n"
+		    "\t\tcfg.roles.rolesz = 1;\n"
+		    "\t}\n"
+		    "\n", f) == EOF)
+			return 0;
+	}
+
+	if (fputs("\tctx = malloc(sizeof(struct ort));\n"
+	    "\tif (ctx == NULL)\n"
+	    "\t\tgoto err;\n", f) == EOF)
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    fputs("\tif ((ctx->file = strdup(file)) == NULL)\n"
+	    "\t\tgoto err;\n", f) == EOF)
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	if (fputs("\tif ((db = sqlbox_alloc(&cfg)) == NULL)\n"
+	    "\t\tgoto err;\n"
+	    "\tctx->db = db;\n", f) == EOF)
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    fputs("\tctx->err = ORT_ERR_OK;\n"
+	    "\tctx->retries = 0;\n"
+	    "\tctx->retry_ms = 0;\n"
+	    "\tctx->mode = mode;\n"
+	    "\tctx->log = log;\n"
+	    "\tctx->log_short = log_short;\n"
+	    "\tctx->log_arg = log_arg;\n"
+	    "\tctx->log_dat = NULL;\n"
+	    "\tctx->log_datsz = 0;\n", f) == EOF)
+		return 0;
+	if (has_idmap(cfg, args) &&
+	    fputs("\tctx->idmap = NULL;\n", f) == EOF)
+		return 0;
+	if (has_trans(args) &&
+	    fputs("\tctx->trans = 0;\n", f) == EOF)
+		return 0;
+	if (args->readers > 0 &&
+	    fputs("\tctx->rdsrc = 0;\n", f) == EOF)
+		return 0;
+
+	if (gen_rbac(cfg, args->role) && 
+	    fputs("\tctx->role = ROLE_default;\n", f) == EOF)
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+
 	if (!gen_comment(f, 1, COMMENT_C, 
 	    "Now actually open the database.\n"
 	    "If this succeeds, then we're good to go."))
 		return 0;
 
-	if (fputs("\n"
-	    "\tif (sqlbox_open_async(db, 0))\n"
-	    "\t\treturn ctx;\n"
-	    "err:\n", f) == EOF)
+	if (args->readers > 0) {
+		if (fprintf(f, "\n"
+		    "\tfor (i = 0; i < %zu; i++)\n"
+		    "\t\tif (!sqlbox_open_async(db, i))\n"
+		    "\t\t\tgoto err;\n", args->readers + 1) < 0)
+			return 0;
+		if (!gen_open_pragmas(f, cfg, args))
+			return 0;
+		if (fputs("\treturn ctx;\n"
+		    "err:\n", f) == EOF)
+			return 0;
+	} else if (has_pragmas(cfg)) {
+		if (fputs("\n"
+		    "\tif (!sqlbox_open_async(db, 0))\n"
+		    "\t\tgoto err;\n", f) == EOF)
+			return 0;
+		if (!gen_open_pragmas(f, cfg, args))
+			return 0;
+		if (fputs("\treturn ctx;\n"
+		    "err:\n", f) == EOF)
+			return 0;
+	} else if (fputs("\n"
+	    "\tif (sqlbox_open_async(db, 0))\n"
+	    "\t\treturn ctx;\n"
+	    "err:\n", f) == EOF)
+		return 0;
+
+	if (fputs("\tsqlbox_free(db);\n", f) == EOF)
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    fputs("\tif (ctx != NULL)\n"
+	    "\t\tfree(ctx->file);\n", f) == EOF)
+		return 0;
+	if (fputs("\tfree(ctx);\n"
+	     "\treturn NULL;\n"
+	     "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_func_db_open_logging(f, 0))
 		return 0;
-
-	if (!TAILQ_EMPTY(&cfg->rq) && fputs
-	    ("\tsqlbox_role_hier_gen_free(&cfg.roles);\n"
-	     "\tsqlbox_role_hier_free(hier);\n", f) == EOF)
+	if (fputs("{\n"
+	    "\n"
+	    "\treturn db_open_src(file, SQLBOX_SRC_RW,\n"
+	    "\t    log, log_short, log_arg);\n"
+	    "}\n\n", f) == EOF)
 		return 0;
 
-	return fputs("\tsqlbox_free(db);\n"
-	     "\tfree(ctx);\n"
-	     "\treturn NULL;\n"
-	     "}\n\n", f) != EOF;
+	if (!gen_func_db_open_ro_logging(f, 0))
+		return 0;
+	return fputs("{\n"
+	    "\n"
+	    "\treturn db_open_src(file, SQLBOX_SRC_RO,\n"
+	    "\t    log, log_short, log_arg);\n"
+	    "}\n\n", f) != EOF;
 }
 
 /*
@@ -1130,7 +2477,8 @@ gen_func_rolecases(FILE *f, const struct role *r)
  * FIXME: most of this is no longer necessary with sqlbox_role().
  */
 static int
-gen_func_role_transitions(FILE *f, const struct config *cfg)
+gen_func_role_transitions(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
 {
 	const struct role	*r, *rr;
 
@@ -1141,10 +2489,14 @@ gen_func_role_transitions(FILE *f, const struct config *cfg)
 
 	if (!gen_func_db_role(f, 0))
 		return 0;
-	if (fputs("{\n"
-	    "\tif (!sqlbox_role(ctx->db, r))\n"
-	    "\t\texit(EXIT_FAILURE);\n"
-	    "\tif (r == ctx->role)\n"
+	if (fputs("{\n", f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if (!gen_db_check(f, args, 1, NULL,
+	    "if (!sqlbox_role(ctx->db, r))"))
+		return 0;
+	if (fputs("\tif (r == ctx->role)\n"
 	    "\t\treturn;\n"
 	    "\tif (ctx->role == ROLE_none)\n"
 	    "\t\tabort();\n"
@@ -1182,44 +2534,78 @@ gen_func_role_transitions(FILE *f, const struct config *cfg)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_transactions(FILE *f, const struct config *cfg)
+gen_transactions(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
 {
+	const char	*src = src_write(args);
+	size_t		 tabs;
 
 	if (!gen_func_db_trans_open(f, 0))
 		return 0;
 	if (fputs("{\n"
 	    "\tstruct sqlbox *db = ctx->db;\n"
-	    "\tint c;\n"
-	    "\n"
-	    "\tif (mode < 0)\n"
-	    "\t\tc = sqlbox_trans_exclusive(db, 0, id);\n"
-	    "\telse if (mode > 0)\n"
-	    "\t\tc = sqlbox_trans_immediate(db, 0, id);\n"
-	    "\telse\n"
-	    "\t\tc = sqlbox_trans_deferred(db, 0, id);\n"
-	    "\tif (!c)\n"
-	    "\t\texit(EXIT_FAILURE);\n"
-	    "}\n\n", f) == EOF)
+	    "\tint c;\n", f) == EOF)
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    fputs("\tsize_t tries = 0;\n", f) == EOF)
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if ((tabs = gen_retry_open(f, args)) == 0)
+		return 0;
+	if (!print_src(f, tabs,
+	    "if (mode < 0)\n"
+	    "\tc = sqlbox_trans_exclusive(db, %s, id);\n"
+	    "else if (mode > 0)\n"
+	    "\tc = sqlbox_trans_immediate(db, %s, id);\n"
+	    "else\n"
+	    "\tc = sqlbox_trans_deferred(db, %s, id);",
+	    src, src, src))
+		return 0;
+	if (!gen_retry_close(f, args, "!c"))
+		return 0;
+	if (!gen_db_check(f, args, 1, NULL, "if (!c)"))
+		return 0;
+	if (has_trans(args) &&
+	    fputs("\tctx->trans++;\n", f) == EOF)
+		return 0;
+	if (fputs("}\n\n", f) == EOF)
 		return 0;
 
 	if (!gen_func_db_trans_rollback(f, 0))
 		return 0;
 	if (fputs("{\n"
 	    "\tstruct sqlbox *db = ctx->db;\n"
-	    "\n"
-	    "\tif (!sqlbox_trans_rollback(db, 0, id))\n"
-	    "\t\texit(EXIT_FAILURE);\n"
-	    "}\n\n", f) == EOF)
+	    "\n", f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if (!gen_db_check(f, args, 1, NULL,
+	    "if (!sqlbox_trans_rollback(db, %s, id))", src))
+		return 0;
+	if (has_trans(args) &&
+	    fputs("\tctx->trans--;\n", f) == EOF)
+		return 0;
+	if (fputs("}\n\n", f) == EOF)
 		return 0;
 
 	if (!gen_func_db_trans_commit(f, 0))
 		return 0;
-	return fputs("{\n"
-	     "\tstruct sqlbox *db = ctx->db;\n"
-	     "\n"
-	     "\tif (!sqlbox_trans_commit(db, 0, id))\n"
-	     "\t\texit(EXIT_FAILURE);\n"
-	     "}\n\n", f) != EOF;
+	if (fputs("{\n"
+	    "\tstruct sqlbox *db = ctx->db;\n"
+	    "\n", f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if (!gen_db_check(f, args, 1, NULL,
+	    "if (!sqlbox_trans_commit(db, %s, id))", src))
+		return 0;
+	if (has_trans(args) &&
+	    fputs("\tctx->trans--;\n", f) == EOF)
+		return 0;
+	return fputs("}\n\n", f) != EOF;
 }
 
 /*
@@ -1227,26 +2613,145 @@ gen_transactions(FILE *f, const struct config *cfg)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_close(FILE *f, const struct config *cfg)
+gen_close(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args)
 {
 
 	if (!gen_func_db_close(f, 0))
 		return 0;
-	return fputs("{\n"
+	if (fputs("{\n"
 	     "\tif (p == NULL)\n"
 	     "\t\treturn;\n"
-             "\tsqlbox_free(p->db);\n"
-	     "\tfree(p);\n"
+             "\tsqlbox_free(p->db);\n", f) == EOF)
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    fputs("\tfree(p->file);\n"
+	     "\tfree(p->log_dat);\n", f) == EOF)
+		return 0;
+	if (fputs("\tfree(p);\n"
+	     "}\n\n", f) == EOF)
+		return 0;
+
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS))
+		return 1;
+	if (!gen_func_db_err(f, 0))
+		return 0;
+	if (fputs("{\n"
+	     "\treturn ctx->err;\n"
+	     "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_func_db_set_retry(f, 0))
+		return 0;
+	if (fputs("{\n"
+	     "\n"
+	     "\tctx->retries = retries;\n"
+	     "\tctx->retry_ms = ms;\n"
+	     "}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_C,
+	    "Called after a statement has failed, having been retried "
+	    "\"tries\" times, which is then incremented.\n"
+	    "Unless out of retries or in a transaction, wait, then "
+	    "replace the connection with a new one, as sqlbox(3) "
+	    "doesn't recover from failures.\n"
+	    "Return zero if the failure stands, non-zero to retry with "
+	    "the connection now in \"db\"."))
+		return 0;
+	if (fputs("static int\n"
+	     "db_retry(struct ort *ctx, struct sqlbox **db, "
+	     "size_t *tries)\n"
+	     "{\n"
+	     "\tstruct ort *p;\n"
+	     "\tstruct timespec ts;\n"
+	     "\tuint64_t ms;\n"
+	     "\n"
+	     "\tif (ctx->trans > 0 || *tries >= ctx->retries)\n"
+	     "\t\treturn 0;\n"
+	     "\tms = (uint64_t)ctx->retry_ms << "
+	     "(*tries < 10 ? *tries : 10);\n"
+	     "\tts.tv_sec = ms / 1000;\n"
+	     "\tts.tv_nsec = (ms % 1000) * 1000000;\n"
+	     "\tnanosleep(&ts, NULL);\n"
+	     "\t(*tries)++;\n"
+	     "\n"
+	     "\tp = db_open_src(ctx->file, ctx->mode,\n"
+	     "\t    ctx->log, ctx->log_short, ctx->log_arg);\n"
+	     "\tif (p == NULL)\n"
+	     "\t\treturn 0;\n", f) == EOF)
+		return 0;
+	if (gen_rbac(cfg, args->role) &&
+	    fputs("\tif (ctx->role != ROLE_default &&\n"
+	     "\t    !sqlbox_role(p->db, ctx->role)) {\n"
+	     "\t\tdb_close(p);\n"
+	     "\t\treturn 0;\n"
+	     "\t}\n", f) == EOF)
+		return 0;
+	return fputs("\tif (ctx->log_dat != NULL &&\n"
+	     "\t    !sqlbox_msg_set_dat"
+	     "(p->db, ctx->log_dat, ctx->log_datsz)) {\n"
+	     "\t\tdb_close(p);\n"
+	     "\t\treturn 0;\n"
+	     "\t}\n"
+	     "\tsqlbox_free(ctx->db);\n"
+	     "\tctx->db = *db = p->db;\n"
+	     "\tp->db = NULL;\n"
+	     "\tdb_close(p);\n"
+	     "\treturn 1;\n"
 	     "}\n\n", f) != EOF;
 }
 
 /*
- * Generate a query function for an STYPE_COUNT.
+ * Prepare the single-row statement of search "s" numbered "num".
+ * On a database failure, the function returns "rc".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_prepare_one(FILE *f, const struct ort_lang_c *args,
+	const struct search *s, size_t num, size_t parms, const char *rc)
+{
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_prepare_bind_async\n"
+	    "    (db, %s, STMT_%s_BY_SEARCH_%zu, %zu, %s, 0))",
+	    src_read(args), s->parent->name, num, parms,
+	    parms > 0 ? "parms" : "NULL"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !gen_in_free(f, s, 2))
+		return 0;
+	return gen_fail(f, args, 1, rc) &&
+		gen_in_free(f, s, 1);
+}
+
+/*
+ * Step a statement returning a single row of a single column.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_step_one(FILE *f, const struct ort_lang_c *args)
+{
+
+	if (args->flags & ORT_LANG_C_DB_ERRORS)
+		return gen_step_check(f, args, 1, "0",
+			"if ((res = sqlbox_step(db, 0)) == NULL ||\n"
+			"    res->psz != 1)");
+	return fputs("\tif ((res = sqlbox_step(db, 0)) == NULL)\n"
+		"\t\texit(EXIT_FAILURE);\n"
+		"\telse if (res->psz != 1)\n"
+		"\t\texit(EXIT_FAILURE);\n", f) != EOF;
+}
+
+/*
+ * Generate a query function for an STYPE_COUNT or STYPE_EXISTS, the
+ * latter's statement returning zero or one.
  * Return zero on failure, non-zero on success.
  */
 static int
 gen_count(FILE *f, const struct config *cfg,
-	const struct search *s, size_t num)
+	const struct ort_lang_c *args, const struct search *s, size_t num)
 {
 	const struct sent	*sent;
 	size_t			 pos, parms = 0, idx;
@@ -1270,38 +2775,315 @@ gen_count(FILE *f, const struct config *cfg,
 	if (parms > 0 && fprintf(f, 
 	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
 		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+
+	/* Emit parameter binding. */
+
+	pos = idx = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries) 
+		if (OPTYPE_ISBINARY(sent->op)) {
+			c = gen_bind_val(f, sent->field, 
+				idx, pos, sent->op);
+			if (c < 0)
+				return 0;
+			idx += (size_t)c;
+			pos++;
+		}
+
+	if (!gen_prepare_one(f, args, s, num, parms, "0"))
+		return 0;
+	if (!gen_step_one(f, args))
+		return 0;
+
+	/* A single returned entry. */
+
+	return fprintf(f, 
+		"\tif (sqlbox_parm_int(&res->ps[0], &val) == -1)\n"
+		"\t\texit(EXIT_FAILURE);\n"
+		"\tsqlbox_finalise(db, 0);\n"
+		"\treturn %s;\n"
+		"}\n\n", s->type == STYPE_EXISTS ?
+		"val != 0" : "(uint64_t)val") > 0;
+}
+
+/*
+ * Generate a query function for an STYPE_ISAGGR.
+ * These are like gen_count() but may return an SQL null if there are
+ * no values to aggregate.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_aggr(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct search *s, size_t num)
+{
+	const struct sent	*sent;
+	size_t			 pos, parms = 0, idx;
+	int			 c, real;
+
+	real = s->type == STYPE_AVG || s->afield->type == FTYPE_REAL;
+
+	/* Count all possible parameters to bind. */
+
+	TAILQ_FOREACH(sent, &s->sntq, entries) 
+		if (OPTYPE_ISBINARY(sent->op))
+			parms += count_bind
+				(sent->field->type, sent->op);
+
+	if (!gen_func_db_search(f, s, 0))
+		return 0;
+	if (fprintf(f, "\n"
+	    "{\n"
+	    "\tconst struct sqlbox_parmset *res;\n"
+	    "\t%s val;\n"
+	    "\tstruct sqlbox *db = ctx->db;\n", 
+	    real ? "double" : "int64_t") < 0)
+		return 0;
+	if (parms > 0 && fprintf(f, 
+	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
+		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+
+	/* Emit parameter binding. */
+
+	pos = idx = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries) 
+		if (OPTYPE_ISBINARY(sent->op)) {
+			c = gen_bind_val(f, sent->field, 
+				idx, pos, sent->op);
+			if (c < 0)
+				return 0;
+			idx += (size_t)c;
+			pos++;
+		}
+
+	if (!gen_prepare_one(f, args, s, num, parms, "0"))
+		return 0;
+	if (!gen_step_one(f, args))
+		return 0;
+
+	/* A single returned entry, which may be null. */
+
+	return fprintf(f, 
+		"\tif (res->ps[0].type == SQLBOX_PARM_NULL) {\n"
+		"\t\tsqlbox_finalise(db, 0);\n"
+		"\t\treturn 0;\n"
+		"\t}\n"
+		"\tif (%s(&res->ps[0], &val) == -1)\n"
+		"\t\texit(EXIT_FAILURE);\n"
+		"\tsqlbox_finalise(db, 0);\n"
+		"\t*out = val;\n"
+		"\treturn 1;\n"
+		"}\n\n", 
+		real ? "sqlbox_parm_float" : "sqlbox_parm_int") > 0;
+}
+
+/*
+ * Guard a database failure with conditional "cond" in a grouped query,
+ * releasing the results so far if returning.
+ * If "open" is non-zero, the statement is finalised as well.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_group_fail(FILE *f, const struct ort_lang_c *args,
+	const struct search *s, size_t tabs, const char *cond, int open)
+{
+	size_t	 i;
+
+	if (!gen_fail_if(f, args, tabs, "%s", cond))
+		return 0;
+	if (open && !gen_fail_finalise(f, args, tabs))
+		return 0;
+	if (args->flags & ORT_LANG_C_DB_ERRORS) {
+		for (i = 0; i < tabs + 1; i++)
+			if (fputc('\t', f) == EOF)
+				return 0;
+		if (fputs("db_", f) == EOF ||
+		    gen_group_name(f, s) < 0 ||
+		    fputs("_free(ps, *sz);\n", f) == EOF ||
+		    !print_src(f, tabs + 1, "*sz = 0;"))
+			return 0;
+	}
+	return gen_fail(f, args, tabs, "NULL");
+}
+
+/*
+ * Generate a query function for an STYPE_COUNT or STYPE_ISAGGR grouped
+ * by a field.
+ * This fills an array of key-value pairs, one per group.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_groupby(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct search *s, size_t num)
+{
+	const struct sent	*sent;
+	const struct field	*fd = s->groupby;
+	size_t			 pos, parms = 0, idx;
+	int			 c, real;
+
+	real = STYPE_ISAGGR(s->type) &&
+		(s->type == STYPE_AVG || s->afield->type == FTYPE_REAL);
+
+	/* Count all possible parameters to bind. */
+
+	TAILQ_FOREACH(sent, &s->sntq, entries) 
+		if (OPTYPE_ISBINARY(sent->op))
+			parms += count_bind
+				(sent->field->type, sent->op);
+
+	if (!gen_func_db_search(f, s, 0))
+		return 0;
+	if (fputs("\n"
+	    "{\n"
+	    "\tconst struct sqlbox_parmset *res;\n"
+	    "\tstruct ", f) == EOF || gen_group_name(f, s) < 0 ||
+	    fputs(" *ps = NULL, *pp;\n"
+	    "\tsize_t max = 0;\n"
+	    "\tint64_t tmpint;\n"
+	    "\tstruct sqlbox *db = ctx->db;\n", f) == EOF)
+		return 0;
+	if (parms > 0 && fprintf(f, 
+	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
+		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+
+	/* Emit parameter binding. */
+
+	if (parms > 0 &&
+	    fputs("\tmemset(parms, 0, sizeof(parms));\n", f) == EOF)
+		return 0;
+
+	pos = idx = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries) 
+		if (OPTYPE_ISBINARY(sent->op)) {
+			c = gen_bind_val(f, sent->field, 
+				idx, pos, sent->op);
+			if (c < 0)
+				return 0;
+			idx += (size_t)c;
+			pos++;
+		}
+
+	/* Prepare and step, growing the output array as needed. */
+
+	if (fputs("\n"
+	    "\t*sz = 0;\n", f) == EOF)
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_prepare_bind_async\n"
+	    "    (db, %s, STMT_%s_BY_SEARCH_%zu,\n"
+	    "     %zu, %s, SQLBOX_STMT_MULTI))",
+	    src_read(args), s->parent->name, num, parms,
+	    parms > 0 ? "parms" : "NULL"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !gen_in_free(f, s, 2))
+		return 0;
+	if (!gen_fail(f, args, 1, "NULL"))
+		return 0;
+	if (!gen_in_free(f, s, 1))
+		return 0;
+	if (fputs("\twhile ((res = sqlbox_step(db, 0)) "
+	    "!= NULL && res->psz) {\n", f) == EOF)
+		return 0;
+	if (!gen_group_fail(f, args, s, 2, "if (res->psz != 2)", 1))
+		return 0;
+	if (fputs("\t\tif (*sz == max) {\n"
+	    "\t\t\tmax = max == 0 ? 16 : max * 2;\n"
+	    "\t\t\tif (max > SIZE_MAX / sizeof(*ps))\n"
+	    "\t\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t\tpp = realloc(ps, max * sizeof(*ps));\n"
+	    "\t\t\tif (pp == NULL)\n"
+	    "\t\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t\tps = pp;\n"
+	    "\t\t}\n"
+	    "\t\tpp = &ps[(*sz)++];\n", f) == EOF)
+		return 0;
+
+	/* Grouping key (never null) and value. */
+
+	switch (fd->type) {
+	case FTYPE_REAL:
+		c = print_src(f, 2,
+		    "if (sqlbox_parm_float(&res->ps[0], &pp->key) == -1)\n"
+		    "\texit(EXIT_FAILURE);");
+		break;
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		c = print_src(f, 2,
+		    "if (sqlbox_parm_string_alloc\n"
+		    "    (&res->ps[0], &pp->key, NULL) == -1)\n"
+		    "\texit(EXIT_FAILURE);");
+		break;
+	default:
+		c = print_src(f, 2,
+		    "if (sqlbox_parm_int(&res->ps[0], &tmpint) == -1)\n"
+		    "\texit(EXIT_FAILURE);\n"
+		    "pp->key = tmpint;");
+		break;
+	}
+	if (!c)
+		return 0;
 
-	/* Emit parameter binding. */
-
-	pos = idx = 1;
-	TAILQ_FOREACH(sent, &s->sntq, entries) 
-		if (OPTYPE_ISBINARY(sent->op)) {
-			c = gen_bind_val(f, sent->field, 
-				idx, pos, sent->op);
-			if (c < 0)
-				return 0;
-			idx += (size_t)c;
-			pos++;
-		}
+	if (real)
+		c = print_src(f, 2,
+		    "if (sqlbox_parm_float(&res->ps[1], &pp->val) == -1)\n"
+		    "\texit(EXIT_FAILURE);");
+	else
+		c = print_src(f, 2,
+		    "if (sqlbox_parm_int(&res->ps[1], &tmpint) == -1)\n"
+		    "\texit(EXIT_FAILURE);\n"
+		    "pp->val = tmpint;");
+	if (!c)
+		return 0;
 
-	/* A single returned entry. */
+	return fputs("\t}\n", f) != EOF &&
+		gen_group_fail(f, args, s, 1, "if (res == NULL)", 1) &&
+		gen_group_fail(f, args, s, 1,
+			"if (!sqlbox_finalise(db, 0))", 0) &&
+		fputs("\treturn ps;\n"
+		"}\n"
+		"\n", f) != EOF;
+}
 
-	return fprintf(f, "\n"
-		"\tif (!sqlbox_prepare_bind_async\n"
-		"\t    (db, 0, STMT_%s_BY_SEARCH_%zu, %zu, %s, 0))\n"
-		"\t	exit(EXIT_FAILURE);\n"
-		"\tif ((res = sqlbox_step(db, 0)) == NULL)\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\telse if (res->psz != 1)\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\tif (sqlbox_parm_int(&res->ps[0], &val) == -1)\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\tsqlbox_finalise(db, 0);\n"
-		"\treturn (uint64_t)val;\n"
-		"}\n\n", s->parent->name, num, parms,
-		parms > 0 ? "parms" : "NULL") > 0;
+/*
+ * Generate the function freeing the result array of a grouped query.
+ * Only text keys are allocated.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_group_free(FILE *f, const struct search *s)
+{
+	const struct field	*fd = s->groupby;
+
+	if (!gen_func_db_group_free(f, s, 0))
+		return 0;
+	if (fd->type != FTYPE_TEXT && fd->type != FTYPE_EMAIL)
+		return fputs("\n{\n"
+			"\tfree(p);\n"
+			"}\n\n", f) != EOF;
+	return fputs("\n{\n"
+		"\tsize_t i;\n\n"
+		"\tif (p == NULL)\n"
+		"\t\treturn;\n"
+		"\tfor (i = 0; i < sz; i++)\n"
+		"\t\tfree(p[i].key);\n"
+		"\tfree(p);\n"
+		"}\n\n", f) != EOF;
 }
 
 /*
@@ -1310,7 +3092,7 @@ gen_count(FILE *f, const struct config *cfg,
  */
 static int
 gen_search(FILE *f, const struct config *cfg,
-	const struct search *s, size_t num)
+	const struct ort_lang_c *args, const struct search *s, size_t num)
 {
 	const struct sent	*sent;
 	const struct strct	*retstr;
@@ -1338,8 +3120,12 @@ gen_search(FILE *f, const struct config *cfg,
 	if (parms > 0 && fprintf(f, 
 	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
 		return 0;
+	if (!gen_in_decls(f, s))
+		return 0;
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
 
 	/* Emit parameter binding. */
 
@@ -1357,10 +3143,9 @@ gen_search(FILE *f, const struct config *cfg,
 			pos++;
 		} 
 
-	if (fprintf(f, "\n"
-	    "\tif (!sqlbox_prepare_bind_async\n"
-	    "\t    (db, 0, STMT_%s_BY_SEARCH_%zu, %zu, %s, 0))\n"
-	    "\t	exit(EXIT_FAILURE);\n"
+	if (!gen_prepare_one(f, args, s, num, parms, "NULL"))
+		return 0;
+	if (fprintf(f, 
 	    "\tif ((res = sqlbox_step(db, 0)) != NULL "
 	    "&& res->psz) {\n"
 	    "\t\tp = malloc(sizeof(struct %s));\n"
@@ -1369,16 +3154,22 @@ gen_search(FILE *f, const struct config *cfg,
 	    "\t\t\texit(EXIT_FAILURE);\n"
 	    "\t\t}\n"
 	    "\t\tdb_%s_fill_r(ctx, p, res, NULL);\n",
-	    s->parent->name, num, parms,
-	    parms > 0 ? "parms" : "NULL",
 	    retstr->name, retstr->name) < 0)
 		return 0;
 
 	/* Conditional post-query reference lookup. */
 
-	if (retstr->flags & STRCT_HAS_NULLREFS && fprintf(f, 
-	    "\t\tdb_%s_reffind(ctx, p);\n", retstr->name) < 0)
-		return 0;
+	if (retstr->flags & STRCT_HAS_NULLREFS) {
+		if (fprintf(f, "\t\tdb_%s_reffind(ctx, p);\n",
+		    retstr->name) < 0)
+			return 0;
+		if ((c = gen_fail_ifset(f, args, 2)) < 0)
+			return 0;
+		if (c > 0 && (!gen_fail_finalise(f, args, 2) ||
+		    !print_src(f, 3, "db_%s_free(p);",
+		    retstr->name) || !gen_fail_return(f, 2, "NULL")))
+			return 0;
+	}
 
 	/* Conditional post-query password check. */
 
@@ -1406,12 +3197,25 @@ gen_search(FILE *f, const struct config *cfg,
 		pos++;
 	}
 
-	return fputs("\t}\n"
-		"\tif (res == NULL)\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\tif (!sqlbox_finalise(db, 0))\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\treturn p;\n"
+	if (fputs("\t}\n", f) == EOF)
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (res == NULL)"))
+		return 0;
+	if (!gen_fail_finalise(f, args, 1))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !print_src(f, 2, "db_%s_free(p);", retstr->name))
+		return 0;
+	if (!gen_fail(f, args, 1, "NULL"))
+		return 0;
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_finalise(db, 0))"))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !print_src(f, 2, "db_%s_free(p);", retstr->name))
+		return 0;
+	if (!gen_fail(f, args, 1, "NULL"))
+		return 0;
+	return fputs("\treturn p;\n"
 		"}\n\n", f) != EOF;
 }
 
@@ -1451,10 +3255,12 @@ gen_freeq(FILE *f, const struct strct *p)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_insert(FILE *f, const struct config *cfg, const struct strct *p)
+gen_insert(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct strct *p)
 {
 	const struct field	*fd;
 	size_t			 hpos, idx, parms = 0, tabs, pos;
+	int			 c;
 
 	if (p->ins == NULL)
 		return 1;
@@ -1468,12 +3274,24 @@ gen_insert(FILE *f, const struct config *cfg, const struct strct *p)
 
 	if (!gen_func_db_insert(f, p, 0))
 		return 0;
-	if (fputs("\n"
-	    "{\n"
-	    "\tint rc;\n"
-	    "\tint64_t id = -1;\n"
-	    "\tstruct sqlbox *db = ctx->db;\n", f) == EOF)
-		return 0;
+	if (p->ins->flags & INSERT_RETURNING) {
+		if (fprintf(f, "\n"
+		    "{\n"
+		    "\tstruct %s *p;\n"
+		    "\tconst struct sqlbox_parmset *res;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n", p->name) < 0)
+			return 0;
+	} else {
+		if (fputs("\n"
+		    "{\n"
+		    "\tint rc;\n"
+		    "\tint64_t id = -1;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n", f) == EOF)
+			return 0;
+		if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+		    fputs("\tsize_t tries = 0;\n", f) == EOF)
+			return 0;
+	}
 
 	if (parms > 0 && fprintf(f, 
 	    "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
@@ -1489,6 +3307,8 @@ gen_insert(FILE *f, const struct config *cfg, const struct strct *p)
 
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
 
 	hpos = idx = 1;
 	TAILQ_FOREACH(fd, &p->fq, entries) {
@@ -1554,18 +3374,90 @@ gen_insert(FILE *f, const struct config *cfg, const struct strct *p)
 	if (parms > 0 && fputc('\n', f) == EOF)
 		return 0;
 
-	return fprintf(f, 
-		"\trc = sqlbox_exec(db, 0, STMT_%s_INSERT, \n"
-		"\t     %zu, %s, SQLBOX_STMT_CONSTRAINT);\n"
-		"\tif (rc == SQLBOX_CODE_ERROR)\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\telse if (rc != SQLBOX_CODE_OK)\n"
-		"\t\treturn (-1);\n"
-		"\tif (!sqlbox_lastid(db, 0, &id))\n"
-		"\t\texit(EXIT_FAILURE);\n"
-		"\treturn id;\n"
-		"}\n\n", p->name, parms,
-	       parms > 0 ? "parms" : "NULL") > 0;
+	/*
+	 * Returning the row means stepping through the statement
+	 * ourselves: the row comes back from the step, or nothing at
+	 * all if we failed on a constraint.
+	 */
+
+	if (p->ins->flags & INSERT_RETURNING) {
+		if (!gen_db_check(f, args, 1, "NULL",
+		    "if (!sqlbox_prepare_bind_async\n"
+		    "    (db, %s, STMT_%s_INSERT,\n"
+		    "     %zu, %s, SQLBOX_STMT_CONSTRAINT))",
+		    src_write(args), p->name, parms,
+		    parms > 0 ? "parms" : "NULL"))
+			return 0;
+		if (!gen_step_check(f, args, 1, "NULL",
+		    "if ((res = sqlbox_step(db, 0)) == NULL)"))
+			return 0;
+		if (fputs("\tif (res->code == "
+		    "SQLBOX_CODE_CONSTRAINT) {\n", f) == EOF)
+			return 0;
+		if (!gen_db_check(f, args, 2, "NULL",
+		    "if (!sqlbox_finalise(db, 0))"))
+			return 0;
+		if (fputs("\t\treturn NULL;\n", f) == EOF)
+			return 0;
+		if (!gen_step_check(f, args, 1, "NULL",
+		    "} else if (res->psz == 0)"))
+			return 0;
+		if (fprintf(f, 
+		    "\tp = malloc(sizeof(struct %s));\n"
+		    "\tif (p == NULL) {\n"
+		    "\t\tperror(NULL);\n"
+		    "\t\texit(EXIT_FAILURE);\n"
+		    "\t}\n"
+		    "\tdb_%s_fill_r(ctx, p, res, NULL);\n",
+		    p->name, p->name) < 0)
+			return 0;
+		if (!gen_fail_if(f, args, 1, "if (!sqlbox_finalise(db, 0))"))
+			return 0;
+		if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+		    !print_src(f, 2, "db_%s_free(p);", p->name))
+			return 0;
+		if (!gen_fail(f, args, 1, "NULL"))
+			return 0;
+		if (p->flags & STRCT_HAS_NULLREFS) {
+			if (fprintf(f, "\tdb_%s_reffind(ctx, p);\n",
+			    p->name) < 0)
+				return 0;
+			if ((c = gen_fail_ifset(f, args, 1)) < 0)
+				return 0;
+			if (c > 0 && (!print_src(f, 2, "db_%s_free(p);",
+			    p->name) || !gen_fail_return(f, 1, "NULL")))
+				return 0;
+		}
+		return fputs("\treturn p;\n"
+			"}\n\n", f) != EOF;
+	}
+
+	if ((tabs = gen_retry_open(f, args)) == 0)
+		return 0;
+	if (!print_src(f, tabs,
+	    "rc = sqlbox_exec(db, %s, STMT_%s_INSERT, \n"
+	    "     %zu, %s, SQLBOX_STMT_CONSTRAINT);",
+	    src_write(args), p->name, parms,
+	    parms > 0 ? "parms" : "NULL"))
+		return 0;
+	if (!gen_retry_close(f, args, "rc == SQLBOX_CODE_ERROR"))
+		return 0;
+	if (!(args->flags & ORT_LANG_C_DB_ERRORS)) {
+		if (fputs("\tif (rc == SQLBOX_CODE_ERROR)\n"
+		    "\t\texit(EXIT_FAILURE);\n"
+		    "\telse if (rc != SQLBOX_CODE_OK)\n"
+		    "\t\treturn (-1);\n", f) == EOF)
+			return 0;
+	} else if (!gen_db_check(f, args, 1, "(-1)",
+	    "if (rc == SQLBOX_CODE_ERROR)") ||
+	    fputs("\tif (rc != SQLBOX_CODE_OK)\n"
+	    "\t\treturn (-1);\n", f) == EOF)
+		return 0;
+	if (!gen_db_check(f, args, 1, "(-1)",
+	    "if (!sqlbox_lastid(db, %s, &id))", src_write(args)))
+		return 0;
+	return fputs("\treturn id;\n"
+		"}\n\n", f) != EOF;
 }
 
 /*
@@ -1589,7 +3481,8 @@ gen_free(FILE *f, const struct strct *p)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_unfill(FILE *f, const struct config *cfg, const struct strct *p)
+gen_unfill(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct strct *p)
 {
 	const struct field	*fd;
 
@@ -1621,7 +3514,7 @@ gen_unfill(FILE *f, const struct config *cfg, const struct strct *p)
 			break;
 		}
 
-	if (!TAILQ_EMPTY(&cfg->rq) &&
+	if (gen_rbac(cfg, args->role) &&
 	    fputs("\tfree(p->priv_store);\n", f) == EOF)
 		return 0;
 
@@ -1630,129 +3523,506 @@ gen_unfill(FILE *f, const struct config *cfg, const struct strct *p)
 
 /*
  * Generate the nested "unfill" function.
+ * If "shared", the memory may be shared by way of the identity map and
+ * is only released by the last of the results referencing it.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_unfill_r(FILE *f, const struct strct *p, int shared)
+{
+	const struct field	*fd;
+
+	if (fprintf(f, "static void\n"
+	    "db_%s_unfill_r(struct %s *p)\n"
+	    "{\n"
+	    "\tif (p == NULL)\n"
+	    "\t\treturn;\n", p->name, p->name) < 0)
+		return 0;
+	if (shared && fputs("\tif (p->priv_refs != NULL &&\n"
+	    "\t    --(*p->priv_refs) > 0)\n"
+	    "\t\treturn;\n"
+	    "\tfree(p->priv_refs);\n", f) == EOF)
+		return 0;
+	if (fprintf(f, "\tdb_%s_unfill(p);\n", p->name) < 0)
+		return 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (fd->type != FTYPE_STRUCT)
+			continue;
+		if (fd->ref->source->flags & FIELD_NULL) {
+			if (fprintf(f, "\tif (p->has_%s)\n"
+			    "\t\tdb_%s_unfill_r(&p->%s);\n",
+			    fd->ref->source->name, 
+			    fd->ref->target->parent->name, 
+			    fd->name) < 0)
+				return 0;
+		} else {
+			if (fprintf(f, "\tdb_%s_unfill_r(&p->%s);\n",
+			    fd->ref->target->parent->name, 
+			    fd->name) < 0)
+				return 0;
+		}
+	}
+
+	return fputs("}\n\n", f) != EOF;
+}
+
+/*
+ * If a structure has possible null foreign keys, we need to fill in the
+ * null keys after the lookup has taken place IFF they aren't null.
+ * Do that here, using the STMT_XXX_BY_UNIQUE_yyy fields we generated
+ * earlier.
+ * This is only done for structures that have (or have nested)
+ * structures with null foreign keys.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_reffind(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct strct *p)
+{
+	const struct field	*fd;
+	int			 c;
+
+	if (!(p->flags & STRCT_HAS_NULLREFS))
+		return 1;
+
+	/* 
+	 * Do we have any null-ref fields in this?
+	 * (They might be in target references.)
+	 */
+
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if ((fd->type == FTYPE_STRUCT) &&
+		    (fd->ref->source->flags & FIELD_NULL))
+			break;
+
+	if (fprintf(f, "static void\n"
+	    "db_%s_reffind(struct ort *ctx, struct %s *p)\n"
+	    "{\n"
+	    "\tstruct sqlbox *db = ctx->db;\n",
+	    p->name, p->name) < 0)
+		return 0;
+
+	if (fd != NULL && fputs
+	    ("\tconst struct sqlbox_parmset *res;\n"
+	     "\tstruct sqlbox_parm parm;\n", f) == EOF)
+		return 0;
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (fd->type != FTYPE_STRUCT)
+			continue;
+		if ((fd->ref->source->flags & FIELD_NULL)) {
+			if (fprintf(f, "\tif (p->has_%s) {\n"
+			    "\t\tparm.type = SQLBOX_PARM_INT;\n"
+			    "\t\tparm.iparm = ORT_GET_%s_%s(p);\n",
+			    fd->ref->source->name,
+			    fd->ref->source->parent->name,
+			    fd->ref->source->name) < 0)
+				return 0;
+			if (!gen_db_check(f, args, 2, NULL,
+			    "if (!sqlbox_prepare_bind_async\n"
+			    "    (db, %s, STMT_%s_BY_UNIQUE_%s, 1, &parm, 0))",
+			    src_read(args),
+			    fd->ref->target->parent->name,
+			    fd->ref->target->name))
+				return 0;
+			if (!gen_step_check(f, args, 2, NULL,
+			    "if ((res = sqlbox_step(db, 0)) == NULL)"))
+				return 0;
+			if (fprintf(f, "\t\tdb_%s_fill_r"
+			    "(ctx, &p->%s, res, NULL);\n",
+			    fd->ref->target->parent->name,
+			    fd->name) < 0)
+				return 0;
+			if (!gen_fail_if(f, args, 2,
+			    "if (!sqlbox_finalise(db, 0))"))
+				return 0;
+			if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+			    !print_src(f, 3, "p->has_%s = 1;", fd->name))
+				return 0;
+			if (!gen_fail(f, args, 2, NULL))
+				return 0;
+			if (fprintf(f, "\t\tp->has_%s = 1;\n"
+			    "\t}\n", fd->name) < 0)
+				return 0;
+		}
+		if (!(fd->ref->target->parent->flags & 
+		    STRCT_HAS_NULLREFS))
+			continue;
+		if (fprintf(f, "\tdb_%s_reffind(ctx, &p->%s);\n", 
+		    fd->ref->target->parent->name, fd->name) < 0)
+			return 0;
+		if ((c = gen_fail_ifset(f, args, 1)) < 0)
+			return 0;
+		if (c > 0 && !gen_fail_return(f, 1, NULL))
+			return 0;
+	}
+
+	return fputs("}\n\n", f) != EOF;
+}
+
+/*
+ * Get the column of "fd" within a result row filled by db_xxx_fill(),
+ * which skips over nested structures.
+ */
+static size_t
+get_fill_column(const struct field *fd)
+{
+	const struct field	*ffd;
+	size_t			 col = 0;
+
+	TAILQ_FOREACH(ffd, &fd->parent->fq, entries) {
+		if (ffd == fd)
+			break;
+		if (ffd->type != FTYPE_STRUCT)
+			col++;
+	}
+	return col;
+}
+
+/*
+ * Generate the qsort() comparators used by db_xxx_reffind_many() to
+ * order pointers by the keys of their possibly-null references.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_unfill_r(FILE *f, const struct strct *p)
+gen_reffind_cmp(FILE *f, const struct strct *p)
 {
 	const struct field	*fd;
 
+	if (!(p->flags & STRCT_HAS_NULLREFS))
+		return 1;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (fd->type != FTYPE_STRUCT ||
+		    !(fd->ref->source->flags & FIELD_NULL))
+			continue;
+		if (fprintf(f, "static int\n"
+		    "db_%s_%s_cmp(const void *a, const void *b)\n"
+		    "{\n"
+		    "\tint64_t va, vb;\n"
+		    "\n"
+		    "\tva = ORT_GET_%s_%s(*(const struct %s **)a);\n"
+		    "\tvb = ORT_GET_%s_%s(*(const struct %s **)b);\n"
+		    "\treturn va < vb ? -1 : va > vb;\n"
+		    "}\n\n",
+		    p->name, fd->ref->source->name,
+		    p->name, fd->ref->source->name, p->name,
+		    p->name, fd->ref->source->name, p->name) < 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Guard a database failure in db_xxx_reffind_many(), releasing the
+ * pointer array if returning.
+ * If "cond" is NULL, this checks whether a nested lookup recorded an
+ * error and is only printed with ORT_LANG_C_DB_ERRORS.
+ * If "open" is non-zero, the statement is finalised as well.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_reffind_many_fail(FILE *f, const struct ort_lang_c *args,
+	const char *cond, int open)
+{
+	size_t	 tabs = cond != NULL ? 2 : 1;
+	int	 c;
+
+	if (cond == NULL) {
+		if ((c = gen_fail_ifset(f, args, tabs)) <= 0)
+			return c == 0;
+	} else if (!gen_fail_if(f, args, tabs, "%s", cond))
+		return 0;
+	if (open && !gen_fail_finalise(f, args, tabs))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !print_src(f, tabs + 1, "free(pp);"))
+		return 0;
+	return cond == NULL ? gen_fail_return(f, tabs, NULL) :
+		gen_fail(f, args, tabs, NULL);
+}
+
+/*
+ * Like gen_reffind(), but for an array of "sz" pointers at once.
+ * Each possibly-null reference is looked up with a single batched query
+ * over the distinct keys, which is merged with the keys sorted in the
+ * same order as the statement's results.
+ * This then descends into nested structures that need it.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_reffind_many(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct strct *p)
+{
+	const struct field	*fd, *tfd;
+
+	if (!(p->flags & STRCT_HAS_NULLREFS))
+		return 1;
+
+	if (!gen_reffind_cmp(f, p))
+		return 0;
+
 	if (fprintf(f, "static void\n"
-	    "db_%s_unfill_r(struct %s *p)\n"
+	    "db_%s_reffind_many(struct ort *ctx, "
+	    "struct %s **ps, size_t sz)\n"
 	    "{\n"
-	    "\tif (p == NULL)\n"
-	    "\t\treturn;\n"
-	    "\tdb_%s_unfill(p);\n",
+	    "\tstruct sqlbox *db = ctx->db;\n"
+	    "\tconst struct sqlbox_parmset *res;\n"
+	    "\tstruct sqlbox_parm parm;\n"
+	    "\tstruct ort_in in;\n"
+	    "\tstruct %s **pp;\n"
+	    "\tsize_t i, n;\n"
+	    "\tint64_t key;\n",
 	    p->name, p->name, p->name) < 0)
 		return 0;
 
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type == FTYPE_STRUCT &&
+		    (fd->ref->target->parent->flags & 
+		     STRCT_HAS_NULLREFS) &&
+		    fprintf(f, "\tstruct %s **pp_%s;\n",
+		    fd->ref->target->parent->name, fd->name) < 0)
+			return 0;
+
+	if (fprintf(f, "\n"
+	    "\tif (sz == 0)\n"
+	    "\t\treturn;\n"
+	    "\tif ((pp = calloc(sz, sizeof(struct %s *))) == NULL)\n"
+	    "\t\texit(EXIT_FAILURE);\n",
+	    p->name) < 0)
+		return 0;
+
 	TAILQ_FOREACH(fd, &p->fq, entries) {
 		if (fd->type != FTYPE_STRUCT)
 			continue;
-		if (fd->ref->source->flags & FIELD_NULL) {
-			if (fprintf(f, "\tif (p->has_%s)\n"
-			    "\t\tdb_%s_unfill_r(&p->%s);\n",
-			    fd->ref->source->name, 
-			    fd->ref->target->parent->name, 
-			    fd->name) < 0)
-				return 0;
-		} else {
-			if (fprintf(f, "\tdb_%s_unfill_r(&p->%s);\n",
-			    fd->ref->target->parent->name, 
-			    fd->name) < 0)
-				return 0;
-		}
+		tfd = fd->ref->target;
+
+		/* Batched lookup of possibly-null references. */
+
+		if ((fd->ref->source->flags & FIELD_NULL) && fprintf(f, 
+		    "\n"
+		    "\tfor (i = n = 0; i < sz; i++)\n"
+		    "\t\tif (ps[i]->has_%s)\n"
+		    "\t\t\tpp[n++] = ps[i];\n"
+		    "\tif (n > 0) {\n"
+		    "\t\tqsort(pp, n, sizeof(struct %s *), db_%s_%s_cmp);\n"
+		    "\t\tmemset(&in, 0, sizeof(struct ort_in));\n"
+		    "\t\tfor (i = 0; i < n; i++)\n"
+		    "\t\t\tif (i == 0 || ORT_GET_%s_%s(pp[i]) !=\n"
+		    "\t\t\t    ORT_GET_%s_%s(pp[i - 1]))\n"
+		    "\t\t\t\tort_in_int(&in, ORT_GET_%s_%s(pp[i]));\n"
+		    "\t\tmemset(&parm, 0, sizeof(struct sqlbox_parm));\n"
+		    "\t\tparm.type = SQLBOX_PARM_STRING;\n"
+		    "\t\tparm.sparm = ort_in_done(&in);\n",
+		    fd->ref->source->name,
+		    p->name, p->name, fd->ref->source->name,
+		    p->name, fd->ref->source->name,
+		    p->name, fd->ref->source->name,
+		    p->name, fd->ref->source->name) < 0)
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) &&
+		    !gen_fail_if(f, args, 2, 
+		    "if (!sqlbox_prepare_bind_async\n"
+		    "    (db, %s, STMT_%s_BY_UNIQUE_MANY_%s,\n"
+		    "     1, &parm, SQLBOX_STMT_MULTI))",
+		    src_read(args), tfd->parent->name, tfd->name))
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) &&
+		    (args->flags & ORT_LANG_C_DB_ERRORS) &&
+		    !print_src(f, 3, "free(in.buf);\nfree(pp);"))
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) &&
+		    !gen_fail(f, args, 2, NULL))
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) && fprintf(f, 
+		    "\t\tfree(in.buf);\n"
+		    "\t\ti = 0;\n"
+		    "\t\twhile ((res = sqlbox_step(db, 0)) != NULL "
+		    "&& res->psz) {\n"
+		    "\t\t\tif (sqlbox_parm_int"
+		    "(&res->ps[%zu], &key) == -1)\n"
+		    "\t\t\t\texit(EXIT_FAILURE);\n"
+		    "\t\t\twhile (i < n && "
+		    "ORT_GET_%s_%s(pp[i]) < key)\n"
+		    "\t\t\t\ti++;\n"
+		    "\t\t\tfor ( ; i < n && "
+		    "ORT_GET_%s_%s(pp[i]) == key; i++) {\n"
+		    "\t\t\t\tdb_%s_fill_r(ctx, &pp[i]->%s, res, NULL);\n"
+		    "\t\t\t\tpp[i]->has_%s = 1;\n"
+		    "\t\t\t}\n"
+		    "\t\t}\n",
+		    get_fill_column(tfd),
+		    p->name, fd->ref->source->name,
+		    p->name, fd->ref->source->name,
+		    tfd->parent->name, fd->name, fd->name) < 0)
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) &&
+		    (!gen_reffind_many_fail(f, args,
+		      "if (res == NULL)", 1) ||
+		     !gen_reffind_many_fail(f, args,
+		      "if (!sqlbox_finalise(db, 0))", 0) ||
+		     fputs("\t}\n", f) == EOF))
+			return 0;
+
+		/* Descend into nested structures. */
+
+		if (!(tfd->parent->flags & STRCT_HAS_NULLREFS))
+			continue;
+		if (fprintf(f, "\n"
+		    "\tpp_%s = calloc(sz, sizeof(struct %s *));\n"
+		    "\tif (pp_%s == NULL)\n"
+		    "\t\texit(EXIT_FAILURE);\n"
+		    "\tfor (i = n = 0; i < sz; i++)\n",
+		    fd->name, tfd->parent->name, fd->name) < 0)
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) && fprintf(f,
+		    "\t\tif (ps[i]->has_%s)\n"
+		    "\t\t\tpp_%s[n++] = &ps[i]->%s;\n",
+		    fd->name, fd->name, fd->name) < 0)
+			return 0;
+		if (!(fd->ref->source->flags & FIELD_NULL) && fprintf(f,
+		    "\t\tpp_%s[n++] = &ps[i]->%s;\n",
+		    fd->name, fd->name) < 0)
+			return 0;
+		if (fprintf(f, 
+		    "\tdb_%s_reffind_many(ctx, pp_%s, n);\n"
+		    "\tfree(pp_%s);\n",
+		    tfd->parent->name, fd->name, fd->name) < 0)
+			return 0;
+		if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+		    !gen_reffind_many_fail(f, args, NULL, 0))
+			return 0;
 	}
 
-	return fputs("}\n\n", f) != EOF;
+	return fputs("\tfree(pp);\n"
+		"}\n\n", f) != EOF;
 }
 
 /*
- * If a structure has possible null foreign keys, we need to fill in the
- * null keys after the lookup has taken place IFF they aren't null.
- * Do that here, using the STMT_XXX_BY_UNIQUE_yyy fields we generated
- * earlier.
- * This is only done for structures that have (or have nested)
- * structures with null foreign keys.
+ * Generate a function to run db_xxx_reffind_many() over a queue, which
+ * is used for results of list and batched lookups.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_reffind(FILE *f, const struct config *cfg, const struct strct *p)
+gen_reffind_q(FILE *f, const struct strct *p)
 {
-	const struct field	*fd;
 
-	if (!(p->flags & STRCT_HAS_NULLREFS))
+	if (!(p->flags & STRCT_HAS_NULLREFS) ||
+	    !(p->flags & STRCT_HAS_QUEUE))
 		return 1;
 
-	/* 
-	 * Do we have any null-ref fields in this?
-	 * (They might be in target references.)
-	 */
+	return fprintf(f, "static void\n"
+	    "db_%s_reffind_q(struct ort *ctx, struct %s_q *q)\n"
+	    "{\n"
+	    "\tstruct %s *p, **ps;\n"
+	    "\tsize_t sz = 0;\n"
+	    "\n"
+	    "\tTAILQ_FOREACH(p, q, _entries)\n"
+	    "\t\tsz++;\n"
+	    "\tif (sz == 0)\n"
+	    "\t\treturn;\n"
+	    "\tif ((ps = calloc(sz, sizeof(struct %s *))) == NULL)\n"
+	    "\t\texit(EXIT_FAILURE);\n"
+	    "\tsz = 0;\n"
+	    "\tTAILQ_FOREACH(p, q, _entries)\n"
+	    "\t\tps[sz++] = p;\n"
+	    "\tdb_%s_reffind_many(ctx, ps, sz);\n"
+	    "\tfree(ps);\n"
+	    "}\n\n",
+	    p->name, p->name, p->name, p->name, p->name) > 0;
+}
 
-	TAILQ_FOREACH(fd, &p->fq, entries)
-		if ((fd->type == FTYPE_STRUCT) &&
-		    (fd->ref->source->flags & FIELD_NULL))
-			break;
+/*
+ * Generate the db_xxx_get_many_by_yyy() function, which looks up all
+ * rows matching a set of values of the rowid or unique field "fd".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_get_many(FILE *f, const struct ort_lang_c *args,
+	const struct field *fd)
+{
+	const struct strct	*p = fd->parent;
 
-	if (fprintf(f, "static void\n"
-	    "db_%s_reffind(struct ort *ctx, struct %s *p)\n"
+	if (!gen_func_db_get_many(f, fd, 0))
+		return 0;
+	if (fprintf(f, "\n"
 	    "{\n"
-	    "\tstruct sqlbox *db = ctx->db;\n",
-	    p->name, p->name) < 0)
+	    "\tstruct %s *p;\n"
+	    "\tstruct %s_q *q;\n"
+	    "\tconst struct sqlbox_parmset *res;\n"
+	    "\tstruct sqlbox *db = ctx->db;\n"
+	    "\tstruct sqlbox_parm parms[1];\n"
+	    "\tstruct ort_in in1;\n"
+	    "\tsize_t j;\n"
+	    "\n"
+	    "\tmemset(parms, 0, sizeof(parms));\n"
+	    "\tq = malloc(sizeof(struct %s_q));\n"
+	    "\tif (q == NULL) {\n"
+	    "\t\tperror(NULL);\n"
+	    "\t\texit(EXIT_FAILURE);\n"
+	    "\t}\n"
+	    "\tTAILQ_INIT(q);\n"
+	    "\n", p->name, p->name, p->name) < 0)
 		return 0;
-
-	if (fd != NULL && fputs
-	    ("\tconst struct sqlbox_parmset *res;\n"
-	     "\tstruct sqlbox_parm parm;\n", f) == EOF)
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
+	if (!gen_bind_in(f, fd, 1, 1, 1))
 		return 0;
-
 	if (fputc('\n', f) == EOF)
 		return 0;
-
-	TAILQ_FOREACH(fd, &p->fq, entries) {
-		if (fd->type != FTYPE_STRUCT)
-			continue;
-		if ((fd->ref->source->flags & FIELD_NULL))
-			if (fprintf(f, "\tif (p->has_%s) {\n"
-			    "\t\tparm.type = SQLBOX_PARM_INT;\n"
-			    "\t\tparm.iparm = ORT_GET_%s_%s(p);\n"
-			    "\t\tif (!sqlbox_prepare_bind_async\n"
-			    "\t\t    (db, 0, STMT_%s_BY_UNIQUE_%s, 1, &parm, 0))\n"
-			    "\t\t\texit(EXIT_FAILURE);\n"
-			    "\t\tif ((res = sqlbox_step(db, 0)) == NULL)\n"
-			    "\t\t\texit(EXIT_FAILURE);\n"
-			    "\t\tdb_%s_fill_r(ctx, &p->%s, res, NULL);\n"
-			    "\t\tif (!sqlbox_finalise(db, 0))\n"
-			    "\t\t\texit(EXIT_FAILURE);\n"
-			    "\t\tp->has_%s = 1;\n"
-			    "\t}\n",
-			    fd->ref->source->name,
-			    fd->ref->source->parent->name,
-			    fd->ref->source->name,
-			    fd->ref->target->parent->name,
-			    fd->ref->target->name,
-			    fd->ref->target->parent->name,
-			    fd->name, fd->name) < 0)
-				return 0;
-		if (!(fd->ref->target->parent->flags & 
-		    STRCT_HAS_NULLREFS))
-			continue;
-		if (fprintf(f, "\tdb_%s_reffind(ctx, &p->%s);\n", 
-		    fd->ref->target->parent->name, fd->name) < 0)
+	if (!gen_fail_if(f, args, 1, "if (!sqlbox_prepare_bind_async\n"
+	    "    (db, %s, STMT_%s_BY_UNIQUE_MANY_%s,\n"
+	    "     1, parms, SQLBOX_STMT_MULTI))",
+	    src_read(args), p->name, fd->name))
+		return 0;
+	if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+	    !print_src(f, 2, "free(in1.buf);\nfree(q);"))
+		return 0;
+	if (!gen_fail(f, args, 1, "NULL"))
+		return 0;
+	if (fprintf(f, "\tfree(in1.buf);\n"
+	    "\twhile ((res = sqlbox_step(db, 0)) != NULL "
+	    "&& res->psz) {\n"
+	    "\t\tp = malloc(sizeof(struct %s));\n"
+	    "\t\tif (p == NULL) {\n"
+	    "\t\t\tperror(NULL);\n"
+	    "\t\t\texit(EXIT_FAILURE);\n"
+	    "\t\t}\n"
+	    "\t\tdb_%s_fill_r(ctx, p, res, NULL);\n"
+	    "\t\tTAILQ_INSERT_TAIL(q, p, _entries);\n"
+	    "\t}\n", p->name, p->name) < 0)
+		return 0;
+	if (!gen_freeq_fail(f, args, p, "if (res == NULL)", 1) ||
+	    !gen_freeq_fail(f, args, p,
+	     "if (!sqlbox_finalise(db, 0))", 0))
+		return 0;
+	if (p->flags & STRCT_HAS_NULLREFS) {
+		if (fprintf(f, "\tdb_%s_reffind_q(ctx, q);\n",
+		    p->name) < 0)
+			return 0;
+		if (!gen_freeq_fail(f, args, p, NULL, 0))
 			return 0;
 	}
-
-	return fputs("}\n\n", f) != EOF;
+	return fputs("\treturn q;\n"
+	    "}\n\n", f) != EOF;
 }
 
 /*
  * Generate the recursive "fill" function.
  * This simply calls to the underlying "fill" function for all
  * strutcures in the object.
+ * If "idmap" is set, shared structures are filled from the identity map
+ * when possible.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_fill_r(FILE *f, const struct config *cfg, const struct strct *p)
+gen_fill_r(FILE *f, const struct config *cfg, const struct strct *p,
+	int idmap)
 {
 	const struct field	*fd;
 
@@ -1771,9 +4041,11 @@ gen_fill_r(FILE *f, const struct config *cfg, const struct strct *p)
 	TAILQ_FOREACH(fd, &p->fq, entries)
 		if (fd->type == FTYPE_STRUCT &&
 		    !(fd->ref->source->flags & FIELD_NULL))
-			if (fprintf(f, "\tdb_%s_fill_r(ctx, "
+			if (fprintf(f, "\tdb_%s_fill_%s(ctx, "
 			    "&p->%s, res, pos);\n", 
 			    fd->ref->target->parent->name, 
+			    idmap && gen_strct_shared(cfg,
+			    fd->ref->target->parent) ? "id" : "r",
 			    fd->name) < 0)
 				return 0;
 
@@ -1785,7 +4057,8 @@ gen_fill_r(FILE *f, const struct config *cfg, const struct strct *p)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_fill(FILE *f, const struct config *cfg, const struct strct *p)
+gen_fill(FILE *f, const struct config *cfg,
+	const struct ort_lang_c *args, const struct strct *p)
 {
 	const struct field	*fd;
 	int	 		 needint = 0;
@@ -1834,7 +4107,7 @@ gen_fill(FILE *f, const struct config *cfg, const struct strct *p)
 	TAILQ_FOREACH(fd, &p->fq, entries)
 		if (!gen_fill_field(f, fd))
 			return 0;
-	if (!TAILQ_EMPTY(&cfg->rq)) {
+	if (gen_rbac(cfg, args->role)) {
 		if (fputs("\tp->priv_store = malloc"
 		    "(sizeof(struct ort_store));\n"
 		    "\tif (p->priv_store == NULL) {\n"
@@ -1854,7 +4127,7 @@ gen_fill(FILE *f, const struct config *cfg, const struct strct *p)
  */
 static int
 gen_update(FILE *f, const struct config *cfg,
-	const struct update *up, size_t num)
+	const struct ort_lang_c *args, const struct update *up, size_t num)
 {
 	const struct uref	*ref;
 	size_t	 		 pos, idx, hpos, parms = 0, tabs;
@@ -1876,11 +4149,33 @@ gen_update(FILE *f, const struct config *cfg,
 
 	if (!gen_func_db_update(f, up, 0))
 		return 0;
-	if (fputs("\n"
-	    "{\n"
-	    "\tenum sqlbox_code c;\n"
-	    "\tstruct sqlbox *db = ctx->db;\n", f) == EOF)
-		return 0;
+	if (up->flags & UPDATE_RETURNING) {
+		if (fprintf(f, "\n"
+		    "{\n"
+		    "\tstruct %s *p;\n"
+		    "\tstruct %s_q *q;\n"
+		    "\tconst struct sqlbox_parmset *res;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n", 
+		    up->parent->name, up->parent->name) < 0)
+			return 0;
+	} else if (up->batch > 0) {
+		if (fputs("\n"
+		    "{\n"
+		    "\tconst struct sqlbox_parmset *res;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n"
+		    "\tuint64_t total = 0;\n"
+		    "\tint64_t n;\n", f) == EOF)
+			return 0;
+	} else {
+		if (fputs("\n"
+		    "{\n"
+		    "\tenum sqlbox_code c;\n"
+		    "\tstruct sqlbox *db = ctx->db;\n", f) == EOF)
+			return 0;
+		if ((args->flags & ORT_LANG_C_DB_ERRORS) &&
+		    fputs("\tsize_t tries = 0;\n", f) == EOF)
+			return 0;
+	}
 	if (parms > 0 && fprintf
 	    (f, "\tstruct sqlbox_parm parms[%zu];\n", parms) < 0)
 		return 0;
@@ -1901,6 +4196,8 @@ gen_update(FILE *f, const struct config *cfg,
 				return 0;
 	if (fputc('\n', f) == EOF)
 		return 0;
+	if (!gen_err_clear(f, args, "ctx"))
+		return 0;
 
 	idx = hpos = 1;
 	TAILQ_FOREACH(ref, &up->mrq, entries) {
@@ -1976,27 +4273,128 @@ gen_update(FILE *f, const struct config *cfg,
 	if (fputc('\n', f) == EOF)
 		return 0;
 
-	if (up->type == UP_MODIFY) {
-		if (fprintf(f, "\tc = sqlbox_exec\n"
-		    "\t\t(db, 0, STMT_%s_UPDATE_%zu,\n"
-		    "\t\t %zu, %s, SQLBOX_STMT_CONSTRAINT);\n"
-		    "\tif (c == SQLBOX_CODE_ERROR)\n"
+	/*
+	 * Returning rows are collected into a queue, which is only
+	 * allocated once we know that no constraint failed.
+	 */
+
+	if (up->flags & UPDATE_RETURNING) {
+		if (!gen_db_check(f, args, 1, "NULL",
+		    "if (!sqlbox_prepare_bind_async\n"
+		    "    (db, %s, STMT_%s_UPDATE_%zu,\n"
+		    "     %zu, %s, SQLBOX_STMT_CONSTRAINT|"
+		    "SQLBOX_STMT_MULTI))",
+		    src_write(args), up->parent->name, num, 
+		    parms, parms > 0 ? "parms" : "NULL"))
+			return 0;
+		if (!gen_step_check(f, args, 1, "NULL",
+		    "if ((res = sqlbox_step(db, 0)) == NULL)"))
+			return 0;
+		if (fputs("\tif (res->code == "
+		    "SQLBOX_CODE_CONSTRAINT) {\n", f) == EOF)
+			return 0;
+		if (!gen_db_check(f, args, 2, "NULL",
+		    "if (!sqlbox_finalise(db, 0))"))
+			return 0;
+		if (fprintf(f, "\t\treturn NULL;\n"
+		    "\t}\n"
+		    "\tq = malloc(sizeof(struct %s_q));\n"
+		    "\tif (q == NULL) {\n"
+		    "\t\tperror(NULL);\n"
 		    "\t\texit(EXIT_FAILURE);\n"
-		    "\treturn (c == SQLBOX_CODE_OK) ? 1 : 0;\n"
+		    "\t}\n"
+		    "\tTAILQ_INIT(q);\n"
+		    "\tfor ( ; res != NULL && res->psz; "
+		    "res = sqlbox_step(db, 0)) {\n"
+		    "\t\tp = malloc(sizeof(struct %s));\n"
+		    "\t\tif (p == NULL) {\n"
+		    "\t\t\tperror(NULL);\n"
+		    "\t\t\texit(EXIT_FAILURE);\n"
+		    "\t\t}\n"
+		    "\t\tdb_%s_fill_r(ctx, p, res, NULL);\n"
+		    "\t\tTAILQ_INSERT_TAIL(q, p, _entries);\n"
+		    "\t}\n",
+		    up->parent->name, up->parent->name, 
+		    up->parent->name) < 0)
+			return 0;
+		if (!gen_freeq_fail(f, args, up->parent,
+		    "if (res == NULL)", 1) ||
+		    !gen_freeq_fail(f, args, up->parent,
+		    "if (!sqlbox_finalise(db, 0))", 0))
+			return 0;
+		if (up->parent->flags & STRCT_HAS_NULLREFS) {
+			if (fprintf(f, "\tdb_%s_reffind_q(ctx, q);\n",
+			    up->parent->name) < 0)
+				return 0;
+			if (!gen_freeq_fail(f, args, up->parent, NULL, 0))
+				return 0;
+		}
+		return fputs("\treturn q;\n"
+			"}\n\n", f) != EOF;
+	}
+
+	/*
+	 * Batched deletes run the bounded statement until it removes
+	 * fewer rows than the batch size.
+	 * Each is in its own transaction unless the caller has opened
+	 * one of its own.
+	 */
+
+	if (up->batch > 0)
+		return fputs("\tdo {\n", f) != EOF &&
+		    gen_db_check(f, args, 2, "total",
+		    "if (!sqlbox_prepare_bind_async\n"
+		    "    (db, %s, STMT_%s_DELETE_%zu,\n"
+		    "     %zu, %s, SQLBOX_STMT_MULTI))",
+		    src_write(args), up->parent->name, num, 
+		    parms, parms > 0 ? "parms" : "NULL") &&
+		    fputs("\t\tn = 0;\n"
+		    "\t\twhile ((res = sqlbox_step(db, 0)) != NULL "
+		    "&& res->psz)\n"
+		    "\t\t\tn++;\n", f) != EOF &&
+		    gen_step_check(f, args, 2, "total",
+		    "if (res == NULL)") &&
+		    gen_db_check(f, args, 2, "total",
+		    "if (!sqlbox_finalise(db, 0))") &&
+		    fprintf(f, "\t\ttotal += n;\n"
+		    "\t} while (n == %" PRId64 ");\n"
+		    "\treturn total;\n"
 		    "}\n"
-		    "\n",
+		    "\n", up->batch) > 0;
+
+	if ((tabs = gen_retry_open(f, args)) == 0)
+		return 0;
+	if (up->type == UP_MODIFY) {
+		if (!print_src(f, tabs, "c = sqlbox_exec\n"
+		    "\t(db, %s, STMT_%s_UPDATE_%zu,\n"
+		    "\t %zu, %s, SQLBOX_STMT_CONSTRAINT);",
+		    src_write(args),
 		    up->parent->name, num, parms, 
-		    parms > 0 ? "parms" : "NULL") < 0)
+		    parms > 0 ? "parms" : "NULL"))
 			return 0;
-	} else {
-		if (fprintf(f, "\tc = sqlbox_exec\n"
-		    "\t\t(db, 0, STMT_%s_DELETE_%zu, %zu, %s, 0);\n"
-		    "\tif (c != SQLBOX_CODE_OK)\n"
-		    "\t\texit(EXIT_FAILURE);\n"
+		if (!gen_retry_close(f, args, "c == SQLBOX_CODE_ERROR"))
+			return 0;
+		if (!gen_db_check(f, args, 1, "0",
+		    "if (c == SQLBOX_CODE_ERROR)"))
+			return 0;
+		if (fputs("\treturn (c == SQLBOX_CODE_OK) ? 1 : 0;\n"
 		    "}\n"
-		    "\n",
+		    "\n", f) == EOF)
+			return 0;
+	} else {
+		if (!print_src(f, tabs, "c = sqlbox_exec\n"
+		    "\t(db, %s, STMT_%s_DELETE_%zu, %zu, %s, 0);",
+		    src_write(args),
 		    up->parent->name, num, parms, 
-		    parms > 0 ? "parms" : "NULL") < 0)
+		    parms > 0 ? "parms" : "NULL"))
+			return 0;
+		if (!gen_retry_close(f, args, "c == SQLBOX_CODE_ERROR"))
+			return 0;
+		if (!gen_db_check(f, args, 1, NULL,
+		    "if (c != SQLBOX_CODE_OK)"))
+			return 0;
+		if (fputs("}\n"
+		    "\n", f) == EOF)
 			return 0;
 	}
 
@@ -2104,15 +4502,40 @@ gen_valids(FILE *f, const struct strct *p)
 	return 1;
 }
 
+/*
+ * Whether the field is not exported by role "r", which is NULL if not
+ * generating for a single role.
+ * This is always the case for "noexport" fields.
+ * Return zero if exported, non-zero otherwise.
+ */
+static int
+json_omit(const struct field *fd, const struct role *r)
+{
+	const struct rref	*rs;
+	const struct role	*rp;
+
+	if (fd->flags & FIELD_NOEXPORT)
+		return 1;
+	if (r == NULL || fd->rolemap == NULL)
+		return 0;
+	TAILQ_FOREACH(rs, &fd->rolemap->rq, entries)
+		for (rp = r; rp != NULL; rp = rp->parent)
+			if (rp == rs->role)
+				return 1;
+	return 0;
+}
+
 /*
  * Export a field in a structure.
  * This needs to handle whether the field is a blob, might be null, is a
  * structure, and so on.
+ * If generating for role "r", fields are only exported (or not) for
+ * that role, so there's no need to check roles at run-time.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_json_out_field(FILE *f,
-	const struct field *fd, size_t *pos, int *sp)
+gen_json_out_field(FILE *f, const struct field *fd,
+	const struct role *r, size_t *pos, int *sp)
 {
 	char		 	 tabs[] = "\t\t";
 	const struct rref	*rs;
@@ -2120,7 +4543,19 @@ gen_json_out_field(FILE *f,
 
 	*sp = 0;
 
-	if (fd->flags & FIELD_NOEXPORT) {
+	if (r != NULL && !(fd->flags & FIELD_NOEXPORT) && 
+	    json_omit(fd, r)) {
+		if (!hassp && fputc('\n', f) == EOF)
+			return 0;
+		if (!gen_commentv(f, 1, COMMENT_C,
+		    "Omitting %s: marked no export for role %s.", 
+		    fd->name, r->name))
+			return 0;
+		if (fputc('\n', f) == EOF)
+			return 0;
+		*sp = 1;
+		return 1;
+	} else if (fd->flags & FIELD_NOEXPORT) {
 		if (!hassp && fputc('\n', f) == EOF)
 			return 0;
 		if (!gen_commentv(f, 1, COMMENT_C,
@@ -2142,7 +4577,7 @@ gen_json_out_field(FILE *f,
 		return 1;
 	}
 
-	if (fd->rolemap != NULL) {
+	if (r == NULL && fd->rolemap != NULL) {
 		if (!hassp && fputc('\n', f) == EOF)
 			return 0;
 		if (fputs("\tswitch (db_role_stored"
@@ -2227,7 +4662,7 @@ gen_json_out_field(FILE *f,
 		    fd->ref->target->parent->name, fd->name, tabs) < 0)
 			return 0;
 
-	if (fd->rolemap != NULL) {
+	if (r == NULL && fd->rolemap != NULL) {
 		if (fputs("\t\tbreak;\n\t}\n\n", f) == EOF)
 			return 0;
 		*sp = 1;
@@ -2542,11 +4977,12 @@ gen_json_parse(FILE *f, const struct strct *p)
 }
 
 /*
- * Generate JSON output functions via kcgi(3).
+ * Generate JSON output functions via kcgi(3), limited to the fields
+ * exported by role "r" if not NULL.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_json_out(FILE *f, const struct strct *p)
+gen_json_out(FILE *f, const struct strct *p, const struct role *r)
 {
 	const struct field	*fd;
 	size_t		 	 pos;
@@ -2565,8 +5001,7 @@ gen_json_out(FILE *f, const struct strct *p)
 
 	pos = 0;
 	TAILQ_FOREACH(fd, &p->fq, entries)
-		if (fd->type == FTYPE_BLOB &&
-		    !(fd->flags & FIELD_NOEXPORT) &&
+		if (fd->type == FTYPE_BLOB && !json_omit(fd, r) &&
 		    fprintf(f, "\tchar *buf%zu;\n", ++pos) < 0)
 			return 0;
 
@@ -2587,8 +5022,7 @@ gen_json_out(FILE *f, const struct strct *p)
 
 	pos = 0;
 	TAILQ_FOREACH(fd, &p->fq, entries) {
-		if (fd->type != FTYPE_BLOB || 
-		    (fd->flags & FIELD_NOEXPORT))
+		if (fd->type != FTYPE_BLOB || json_omit(fd, r))
 			continue;
 		pos++;
 		if (fprintf(f, "\tsz = (p->%s_sz + 2) / 3 * 4 + 1;\n"
@@ -2611,14 +5045,14 @@ gen_json_out(FILE *f, const struct strct *p)
 
 	pos = 0;
 	TAILQ_FOREACH(fd, &p->fq, entries)
-		if (!gen_json_out_field(f, fd, &pos, &sp))
+		if (!gen_json_out_field(f, fd, r, &pos, &sp))
 			return 0;
 
 	/* Free our temporary base64 buffers. */
 
 	pos = 0;
 	TAILQ_FOREACH(fd, &p->fq, entries) {
-		if (fd->flags & FIELD_NOEXPORT)
+		if (json_omit(fd, r))
 			continue;
 		if (fd->type == FTYPE_BLOB && 
 		    pos == 0 && fputc('\n', f) == EOF)
@@ -2680,38 +5114,63 @@ gen_json_out(FILE *f, const struct strct *p)
  */
 static int
 gen_functions(FILE *f, const struct config *cfg, const struct strct *p, 
-	int json, int jsonparse, int valids, int dbin,
-	const struct filldepq *fq)
+	const struct ort_lang_c *args, const struct filldepq *fq)
 {
 	const struct search 	*s;
 	const struct update 	*u;
 	const struct filldep	*fd;
+	const struct field	*ffd;
+	const struct role	*r;
 	size_t	 		 pos;
-
+	int			 json, jsonparse, valids, dbin, idmap;
+
+	r = get_role(cfg, args->role);
+	idmap = has_idmap(cfg, args);
+	json = args->flags & ORT_LANG_C_JSON_KCGI;
+	jsonparse = args->flags & ORT_LANG_C_JSON_JSMN;
+	valids = args->flags & ORT_LANG_C_VALID_KCGI;
+	dbin = args->flags & ORT_LANG_C_DB_SQLBOX;
 	fd = get_filldep(fq, p);
 
 	if (dbin) {
-		if (fd != NULL && !gen_fill(f, cfg, p))
+		if (fd != NULL && !gen_fill(f, cfg, args, p))
+			return 0;
+		if (fd != NULL && 
+		   (fd->need & FILLDEP_FILL_R) && 
+		   !gen_fill_r(f, cfg, p, idmap))
 			return 0;
 		if (fd != NULL && 
 		   (fd->need & FILLDEP_FILL_R) && 
-		   !gen_fill_r(f, cfg, p))
+		   idmap && gen_strct_shared(cfg, p) &&
+		   !gen_fill_id(f, p))
+			return 0;
+		if (!gen_unfill(f, cfg, args, p))
+			return 0;
+		if (!gen_unfill_r(f, p, 
+		    idmap && gen_strct_shared(cfg, p)))
 			return 0;
-		if (!gen_unfill(f, cfg, p))
+		if (!gen_reffind(f, cfg, args, p))
 			return 0;
-		if (!gen_unfill_r(f, p))
+		if (!gen_reffind_many(f, cfg, args, p))
 			return 0;
-		if (!gen_reffind(f, cfg, p))
+		if (!gen_reffind_q(f, p))
 			return 0;
 		if (!gen_free(f, p))
 			return 0;
 		if (!gen_freeq(f, p))
 			return 0;
-		if (!gen_insert(f, cfg, p))
+		TAILQ_FOREACH(s, &p->sq, entries)
+			if (s->groupby != NULL && get_group_first(s) &&
+			    gen_role_granted(s->rolemap, r) &&
+			    !gen_group_free(f, s))
+				return 0;
+		if (p->ins != NULL &&
+		    gen_role_granted(p->ins->rolemap, r) &&
+		    !gen_insert(f, cfg, args, p))
 			return 0;
 	}
 
-	if (json && !gen_json_out(f, p))
+	if (json && !gen_json_out(f, p, r))
 		return 0;
 	if (jsonparse && !gen_json_parse(f, p))
 		return 0;
@@ -2719,28 +5178,53 @@ gen_functions(FILE *f, const struct config *cfg, const struct strct *p,
 		return 0;
 
 	if (dbin) {
+		TAILQ_FOREACH(ffd, &p->fq, entries)
+			if (gen_sql_unique_many(ffd) && has_many(p, r) &&
+			    !gen_get_many(f, args, ffd))
+				return 0;
 		pos = 0;
 		TAILQ_FOREACH(s, &p->sq, entries)
-			if (s->type == STYPE_SEARCH) {
-				if (!gen_search(f, cfg, s, pos++))
+			if (!gen_role_granted(s->rolemap, r)) {
+				pos++;
+				continue;
+			} else if (s->type == STYPE_SEARCH) {
+				if (!gen_search(f, cfg, args, s, pos++))
 					return 0;
 			} else if (s->type == STYPE_LIST) {
-				if (!gen_list(f, cfg, s, pos++))
+				if (!gen_list(f, cfg, args, s, pos++))
 					return 0;
-			} else if (s->type == STYPE_COUNT) {
-				if (!gen_count(f, cfg, s, pos++))
+			} else if (s->groupby != NULL) {
+				if (!gen_groupby(f, cfg, args, s, pos++))
 					return 0;
-			} else
-				if (!gen_iterator(f, cfg, s, pos++))
+			} else if (s->type == STYPE_COUNT ||
+			    s->type == STYPE_EXISTS) {
+				if (!gen_count(f, cfg, args, s, pos++))
 					return 0;
+			} else if (STYPE_ISAGGR(s->type)) {
+				if (!gen_aggr(f, cfg, args, s, pos++))
+					return 0;
+			} else {
+				if (!gen_iterator(f, cfg, args, s, pos, 0))
+					return 0;
+				if ((args->flags & ORT_LANG_C_ITERATE_BATCH) &&
+				    !gen_iterator(f, cfg, args, s, pos, 1))
+					return 0;
+				pos++;
+			}
 		pos = 0;
-		TAILQ_FOREACH(u, &p->uq, entries)
-			if (!gen_update(f, cfg, u, pos++))
+		TAILQ_FOREACH(u, &p->uq, entries) {
+			if (gen_role_granted(u->rolemap, r) &&
+			    !gen_update(f, cfg, args, u, pos))
 				return 0;
+			pos++;
+		}
 		pos = 0;
-		TAILQ_FOREACH(u, &p->dq, entries)
-			if (!gen_update(f, cfg, u, pos++))
+		TAILQ_FOREACH(u, &p->dq, entries) {
+			if (gen_role_granted(u->rolemap, r) &&
+			    !gen_update(f, cfg, args, u, pos))
 				return 0;
+			pos++;
+		}
 	}
 
 	return 1;
@@ -2821,8 +5305,9 @@ ort_lang_c_source(const struct ort_lang_c *args,
 {
 	const struct strct 	*p;
 	const struct search	*s;
+	const struct role	*r;
 	const char		*start, *cp;
-	size_t			 sz;
+	size_t			 sz, i;
 	int			 need_kcgi = 0, 
 				 need_kcgijson = 0, 
 				 need_sqlbox = 0,
@@ -2834,6 +5319,10 @@ ort_lang_c_source(const struct ort_lang_c *args,
 	need_b64 = 1;
 #endif
 
+	/* Generation may be limited to the operations of one role. */
+
+	r = get_role(cfg, args->role);
+
 	if (!gen_commentv(f, 0, COMMENT_C, 
 	    "WARNING: automatically generated by ort %s.\n"
 	    "DO NOT EDIT!", ORT_VERSION))
@@ -2974,6 +5463,10 @@ ort_lang_c_source(const struct ort_lang_c *args,
 		TAILQ_FOREACH(p, &cfg->sq, entries)
 			if (!gen_sql_enums(f, 1, p, LANG_C))
 				return 0;
+		for (i = 0; i < PRAGMA__MAX; i++)
+			if (gen_sql_pragma_isset(cfg->db, i) &&
+			    fprintf(f, "\t%s,\n", pragmas[i]) < 0)
+				return 0;
 		if (fputs("\tSTMT__MAX\n};\n\n", f) == EOF)
 			return 0;
 
@@ -2988,8 +5481,64 @@ ort_lang_c_source(const struct ort_lang_c *args,
 			return 0;
 		if (fputs("\tstruct sqlbox *db;\n", f) == EOF)
 			return 0;
+		if (has_trans(args)) {
+			if (!gen_comment(f, 1, COMMENT_C,
+			    args->readers > 0 ?
+			    "Depth of open transactions.\n"
+			    "While non-zero, reads use the "
+			    "read-write source." :
+			    "Depth of open transactions.\n"
+			    "While non-zero, failures aren't "
+			    "retried."))
+				return 0;
+			if (fputs("\tsize_t trans;\n", f) == EOF)
+				return 0;
+		}
+		if (args->readers > 0) {
+			if (!gen_comment(f, 1, COMMENT_C,
+			    "Last-used read-only source."))
+				return 0;
+			if (fputs("\tsize_t rdsrc;\n", f) == EOF)
+				return 0;
+		}
+		if (args->flags & ORT_LANG_C_DB_ERRORS) {
+			if (!gen_comment(f, 1, COMMENT_C,
+			    "Sticky database error, see db_err()."))
+				return 0;
+			if (fputs("\tenum ort_err err;\n", f) == EOF)
+				return 0;
+			if (!gen_comment(f, 1, COMMENT_C,
+			    "Retries and initial wait in "
+			    "milliseconds, see db_set_retry()."))
+				return 0;
+			if (fputs("\tsize_t retries;\n"
+			    "\tunsigned int retry_ms;\n", f) == EOF)
+				return 0;
+			if (!gen_comment(f, 1, COMMENT_C,
+			    "Arguments to db_open_src() and copy of "
+			    "those to db_logging_data() for "
+			    "replacing the connection when "
+			    "retrying."))
+				return 0;
+			if (fputs("\tchar *file;\n"
+			    "\tenum sqlbox_srcmode mode;\n"
+			    "\tvoid (*log)(const char *, void *);\n"
+			    "\tvoid (*log_short)(const char *, ...);\n"
+			    "\tvoid *log_arg;\n"
+			    "\tvoid *log_dat;\n"
+			    "\tsize_t log_datsz;\n", f) == EOF)
+				return 0;
+		}
+		if (has_idmap(cfg, args)) {
+			if (!gen_comment(f, 1, COMMENT_C,
+			    "Identity map while listing, else NULL."))
+				return 0;
+			if (fputs("\tstruct ort_idmap *idmap;\n", 
+			    f) == EOF)
+				return 0;
+		}
 
-		if (!TAILQ_EMPTY(&cfg->rq)) {
+		if (gen_rbac(cfg, args->role)) {
 			if (!gen_comment(f, 1, COMMENT_C,
 			    "Current RBAC role."))
 				return 0;
@@ -3044,8 +5593,22 @@ ort_lang_c_source(const struct ort_lang_c *args,
 		TAILQ_FOREACH(p, &cfg->sq, entries)
 			if (!gen_sql_stmts(f, 1, p, LANG_C))
 				return 0;
+		for (i = 0; i < PRAGMA__MAX; i++) {
+			if (!gen_sql_pragma_isset(cfg->db, i))
+				continue;
+			if (fputs("\t\"", f) == EOF)
+				return 0;
+			if (gen_sql_pragma(f, cfg->db, i) < 0)
+				return 0;
+			if (fputs("\",\n", f) == EOF)
+				return 0;
+		}
 		if (fputs("};\n\n", f) == EOF)
 			return 0;
+
+		if ((gen_rbac(cfg, args->role) || has_modify(cfg)) &&
+		    !gen_role_tables(f, cfg, args))
+			return 0;
 	}
 
 	/*
@@ -3076,14 +5639,22 @@ ort_lang_c_source(const struct ort_lang_c *args,
 		return 0;
 
 	if (args->flags & ORT_LANG_C_DB_SQLBOX) {
-		if (!gen_transactions(f, cfg))
+		if (args->readers > 0 && !gen_src_read(f, args))
+			return 0;
+		if (has_pragmas(cfg) && !gen_pragma(f))
+			return 0;
+		if (has_in(cfg, r) && !gen_in(f))
+			return 0;
+		if (has_idmap(cfg, args) && !gen_idmap(f, cfg))
 			return 0;
-		if (!gen_open(f, cfg))
+		if (!gen_open(f, cfg, args))
 			return 0;
-		if (!gen_close(f, cfg))
+		if (!gen_close(f, cfg, args))
 			return 0;
-		if (!TAILQ_EMPTY(&cfg->rq) &&
-		    !gen_func_role_transitions(f, cfg))
+		if (!gen_transactions(f, cfg, args))
+			return 0;
+		if (gen_rbac(cfg, args->role) &&
+		    !gen_func_role_transitions(f, cfg, args))
 			return 0;
 	}
 
@@ -3099,15 +5670,17 @@ ort_lang_c_source(const struct ort_lang_c *args,
 
 	TAILQ_FOREACH(p, &cfg->sq, entries)
 		TAILQ_FOREACH(s, &p->sq, entries)
-			if (!gen_filldep(&fq, p, FILLDEP_FILL_R))
+			if (gen_role_granted(s->rolemap, r) &&
+			    !gen_filldep(&fq, p, FILLDEP_FILL_R))
 				return 0;
 
 	TAILQ_FOREACH(p, &cfg->sq, entries)
-		gen_functions(f, cfg, p, 
-			args->flags & ORT_LANG_C_JSON_KCGI, 
-			args->flags & ORT_LANG_C_JSON_JSMN, 
-			args->flags & ORT_LANG_C_VALID_KCGI, 
-			args->flags & ORT_LANG_C_DB_SQLBOX, &fq);
+		if ((has_many(p, r) || has_returning(p, r)) &&
+		    !gen_filldep(&fq, p, FILLDEP_FILL_R))
+			return 0;
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		gen_functions(f, cfg, p, args, &fq);
 
 	while ((fd = TAILQ_FIRST(&fq)) != NULL) {
 		TAILQ_REMOVE(&fq, fd, entries);
@@ -35,6 +35,11 @@ static	const char *const stypes[STYPE__MAX] = {
 	"get", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static	const char *const utypes[UP__MAX] = {
@@ -77,6 +82,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	/* Unary types... */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
@@ -110,6 +116,60 @@ get_ftype_str(enum ftype op)
 	return ftypes[op];
 }
 
+/*
+ * Get the C type of the result of an aggregate query.
+ * Averages are always floating-point; the rest follow the field.
+ */
+const char *
+get_aggr_type_str(const struct search *s)
+{
+
+	assert(STYPE_ISAGGR(s->type));
+	assert(s->afield != NULL);
+	return s->type == STYPE_AVG ? 
+		ftypes[FTYPE_REAL] : ftypes[s->afield->type];
+}
+
+/*
+ * Print the name of the result structure of a grouped query.
+ * This is shared by all grouped queries in the structure with the same
+ * type, aggregate field, and grouping field.
+ * Return <0 on failure, otherwise the number of bytes written.
+ */
+int
+gen_group_name(FILE *f, const struct search *s)
+{
+
+	assert(s->groupby != NULL);
+	if (STYPE_ISAGGR(s->type))
+		return fprintf(f, "%s_%s_%s_groupby_%s", 
+			s->parent->name, stypes[s->type], 
+			s->afield->name, s->groupby->name);
+	return fprintf(f, "%s_%s_groupby_%s", s->parent->name,
+		stypes[s->type], s->groupby->name);
+}
+
+/*
+ * Whether "s" is the first grouped query in its structure having its
+ * result structure (see gen_group_name()), which is then responsible
+ * for declaring and defining it.
+ */
+int
+get_group_first(const struct search *s)
+{
+	const struct search	*ss;
+
+	assert(s->groupby != NULL);
+	TAILQ_FOREACH(ss, &s->parent->sq, entries) {
+		if (ss == s)
+			break;
+		if (ss->groupby == s->groupby && 
+		    ss->type == s->type && ss->afield == s->afield)
+			return 0;
+	}
+	return 1;
+}
+
 /*
  * Generate the db_open function header.
  * If "decl" is non-zero, this is the declaration; otherwise, the
@@ -143,6 +203,39 @@ gen_func_db_open_logging(FILE *f, int decl)
 		decl ? "" : "\n", decl ? ";" : "") > 0;
 }
 
+/*
+ * Generate the db_open_ro function header.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_open_ro(FILE *f, int decl)
+{
+
+	return fprintf(f, "struct ort *%sdb_open_ro"
+		"(const char *file)%s\n",
+		decl ? "" : "\n", decl ? ";" : "") > 0;
+}
+
+/*
+ * Generate the db_open_ro_logging function header.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_open_ro_logging(FILE *f, int decl)
+{
+
+	return fprintf(f, "struct ort *%sdb_open_ro_logging"
+		"(const char *file,\n"
+		"\tvoid (*log)(const char *, void *),\n"
+		"\tvoid (*log_short)(const char *, ...), "
+		"void *log_arg)%s\n",
+		decl ? "" : "\n", decl ? ";" : "") > 0;
+}
+
 /*
  * Generate the db_logging_data function header.
  * If "decl" is non-zero, this is the declaration; otherwise, the
@@ -259,6 +352,35 @@ gen_func_db_close(FILE *f, int decl)
 		decl ? " " : "\n", decl ? ";" : "") > 0;
 }
 
+/*
+ * Generate the db_err function header.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_err(FILE *f, int decl)
+{
+
+	return fprintf(f, "enum ort_err%sdb_err(struct ort *ctx)%s\n",
+		decl ? " " : "\n", decl ? ";" : "") > 0;
+}
+
+/*
+ * Generate the db_set_retry function header.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_set_retry(FILE *f, int decl)
+{
+
+	return fprintf(f, "void%sdb_set_retry(struct ort *ctx, "
+		"size_t retries, unsigned int ms)%s\n",
+		decl ? " " : "\n", decl ? ";" : "") > 0;
+}
+
 /*
  * Generate the variables in a function header, breaking the line at 72
  * characters to indent 5 spaces.  The "col" is the current position in
@@ -320,6 +442,59 @@ print_var(FILE *f, size_t pos, size_t col,
 	return col + rc;
 }
 
+/*
+ * Like print_var() but for the array and array size of an "in"
+ * constraint on field "fd".
+ * Return -1 on failure or the new column.
+ */
+static int
+print_var_set(FILE *f, size_t pos, size_t col, const struct field *fd)
+{
+	int			 rc;
+	const struct field	*rfd;
+
+	if (fputc(',', f) == EOF)
+		return -1;
+	col++;
+
+	if (col >= 72)
+		rc = fprintf(f, "\n     ");
+	else
+		rc = fprintf(f, " ");
+
+	if (rc < 0)
+		return -1;
+	col += rc;
+
+	switch (fd->type) {
+	case FTYPE_ENUM:
+		rc = fprintf(f, "const enum %s *v%zu, size_t v%zu_sz", 
+			fd->enm->name, pos, pos);
+		break;
+	case FTYPE_BIT:
+	case FTYPE_BITFIELD:
+	case FTYPE_INT:
+		rfd = fd->ref != NULL ? fd->ref->target : fd;
+		rc = fprintf(f, "const %s_%s *v%zu, size_t v%zu_sz", 
+			rfd->parent->name, rfd->name, pos, pos);
+		break;
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		rc = fprintf(f, "const char *const *v%zu, "
+			"size_t v%zu_sz", pos, pos);
+		break;
+	default:
+		rc = fprintf(f, "const %s*v%zu, size_t v%zu_sz", 
+			ftypes[fd->type], pos, pos);
+		break;
+	}
+
+	if (rc < 0)
+		return -1;
+
+	return col + rc;
+}
+
 /*
  * Generate the db_xxxx_update function header.
  * If "decl" is non-zero, this is the declaration; otherwise, the
@@ -334,11 +509,17 @@ gen_func_db_update(FILE *f, const struct update *u, int decl)
 	int			 rc;
 	const char		*type;
 
-	type = u->type == UP_MODIFY ? "int" : "void";
+	type = u->type == UP_MODIFY ? "int" : 
+		u->batch > 0 ? "uint64_t" : "void";
 
 	/* Start with return value. */
 
-	if (!decl) {
+	if (u->flags & UPDATE_RETURNING) {
+		if ((rc = fprintf(f, "struct %s_q *%s", 
+		    u->parent->name, decl ? "" : "\n")) < 0)
+			return 0;
+		col = decl ? rc : 0;
+	} else if (!decl) {
 		if (fprintf(f, "%s\n", type) < 0)
 			return 0;
 	} else {
@@ -430,12 +611,12 @@ gen_func_db_update(FILE *f, const struct update *u, int decl)
 
 /*
  * Generate the db_xxxx_{count,get,list,iterate} function header.
- * If "decl" is non-zero, this is the declaration; otherwise, the
- * definition header.
- * Return zero on failure, non-zero on success.
+ * If "batch" is non-zero, this is the batched iterate variant.
+ * See gen_func_db_search().
  */
-int
-gen_func_db_search(FILE *f, const struct search *s, int decl)
+static int
+gen_func_db_search_type(FILE *f, const struct search *s, int decl,
+	int batch)
 {
 	const struct sent	*sent;
 	const struct strct	*retstr;
@@ -451,12 +632,20 @@ gen_func_db_search(FILE *f, const struct search *s, int decl)
 
 	/* Start with return value. */
 
-	if (s->type == STYPE_SEARCH)
+	if (s->groupby != NULL) {
+		if (fputs("struct ", f) == EOF || 
+		    (rc = gen_group_name(f, s)) < 0 ||
+		    fputs(" *", f) == EOF)
+			return 0;
+		rc += 9;
+	} else if (s->type == STYPE_SEARCH)
 		rc = fprintf(f, "struct %s *", retstr->name);
 	else if (s->type == STYPE_LIST)
 		rc = fprintf(f, "struct %s_q *", retstr->name);
 	else if (s->type == STYPE_ITERATE)
 		rc = fprintf(f, "void");
+	else if (STYPE_ISAGGR(s->type) || s->type == STYPE_EXISTS)
+		rc = fprintf(f, "int");
 	else
 		rc = fprintf(f, "uint64_t");
 
@@ -468,7 +657,8 @@ gen_func_db_search(FILE *f, const struct search *s, int decl)
 		if (fputc('\n', f) == EOF)
 			return 0;
 		col = 0;
-	} else if (s->type != STYPE_SEARCH && s->type != STYPE_LIST) {
+	} else if (s->type != STYPE_SEARCH && 
+	    s->type != STYPE_LIST && s->groupby == NULL) {
 		if (fputc(' ', f) == EOF)
 			return 0;
 		col++;
@@ -476,10 +666,22 @@ gen_func_db_search(FILE *f, const struct search *s, int decl)
 
 	/* Now function name. */
 
-	rc = fprintf(f, "db_%s_%s", s->parent->name, stypes[s->type]);
+	rc = fprintf(f, "db_%s_%s%s", s->parent->name, 
+		stypes[s->type], batch ? "_batch" : "");
 	if (rc < 0)
 		return 0;
 	sz += rc;
+	if (s->name == NULL && STYPE_ISAGGR(s->type)) {
+		if ((rc = fprintf(f, "_%s", s->afield->name)) < 0)
+			return 0;
+		sz += rc;
+	}
+	if (s->name == NULL && s->groupby != NULL) {
+		rc = fprintf(f, "_groupby_%s", s->groupby->name);
+		if (rc < 0)
+			return 0;
+		sz += rc;
+	}
 	if (s->name == NULL && !TAILQ_EMPTY(&s->sntq)) {
 		if (fputs("_by", f) == EOF)
 			return 0;
@@ -509,15 +711,57 @@ gen_func_db_search(FILE *f, const struct search *s, int decl)
 		return 0;
 	col += 16;
 
-	if (s->type == STYPE_ITERATE) {
+	if (s->type == STYPE_ITERATE && batch) {
+		if (fputc(',', f) == EOF)
+			return 0;
+		col++;
+		if (col + strlen(retstr->name) + 39 >= 72) {
+			if (fputs("\n     ", f) == EOF)
+				return 0;
+			col = 5;
+		} else {
+			if (fputc(' ', f) == EOF)
+				return 0;
+			col++;
+		}
+		if ((rc = fprintf(f, "%s_batch_cb cb, "
+		    "void *arg, size_t n", retstr->name)) < 0)
+			return 0;
+		col += rc;
+	} else if (s->type == STYPE_ITERATE) {
 		if ((rc = fprintf(f, 
 		    ", %s_cb cb, void *arg", retstr->name)) < 0)
 			return 0;
 		col += rc;
+	} else if (s->groupby != NULL) {
+		if (fputc(',', f) == EOF)
+			return 0;
+		if (col + 12 >= 72) {
+			if (fputs("\n     ", f) == EOF)
+				return 0;
+			col = 5;
+		} else {
+			if (fputc(' ', f) == EOF)
+				return 0;
+			col += 2;
+		}
+		if (fputs("size_t *sz", f) == EOF)
+			return 0;
+		col += 10;
+	} else if (STYPE_ISAGGR(s->type)) {
+		if ((rc = fprintf(f, 
+		    ", %s*out", get_aggr_type_str(s))) < 0)
+			return 0;
+		col += rc;
 	}
 
 	TAILQ_FOREACH(sent, &s->sntq, entries)
-		if (!OPTYPE_ISUNARY(sent->op)) {
+		if (sent->op == OPTYPE_IN) {
+			if ((rc = print_var_set
+			    (f, pos++, col, sent->field)) < 0)
+				return 0;
+			col = rc;
+		} else if (!OPTYPE_ISUNARY(sent->op)) {
 			if ((rc = print_var
 			    (f, pos++, col, sent->field, 0)) < 0)
 				return 0;
@@ -527,6 +771,34 @@ gen_func_db_search(FILE *f, const struct search *s, int decl)
 	return fprintf(f, ")%s", decl ? ";\n" : "") > 0;
 }
 
+/*
+ * Generate the db_xxxx_{count,get,list,iterate} function header.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_search(FILE *f, const struct search *s, int decl)
+{
+
+	return gen_func_db_search_type(f, s, decl, 0);
+}
+
+/*
+ * Generate the db_xxxx_iterate_batch function header.
+ * The search must be of type STYPE_ITERATE.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_iterate_batch(FILE *f, const struct search *s, int decl)
+{
+
+	assert(s->type == STYPE_ITERATE);
+	return gen_func_db_search_type(f, s, decl, 1);
+}
+
 /*
  * Generate the db_xxxx_insert function header.
  * If "decl" is non-zero, this is the declaration; otherwise, the
@@ -542,7 +814,12 @@ gen_func_db_insert(FILE *f, const struct strct *p, int decl)
 
 	/* Start with return value. */
 
-	if (!decl) {
+	if (p->ins->flags & INSERT_RETURNING) {
+		if ((rc = fprintf(f, "struct %s *%s", 
+		    p->name, decl ? "" : "\n")) < 0)
+			return 0;
+		col = decl ? rc : 0;
+	} else if (!decl) {
 		if (fputs("int64_t\n", f) == EOF)
 			return 0;
 	} else {
@@ -598,6 +875,60 @@ gen_func_db_freeq(FILE *f, const struct strct *p, int decl)
 	       decl ? ";\n" : "") > 0;
 }
 
+/*
+ * Generate the db_xxxx_free function header for the result structure
+ * of a grouped query.
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_group_free(FILE *f, const struct search *s, int decl)
+{
+
+	if (fprintf(f, "void%sdb_", decl ? " " : "\n") < 0 ||
+	    gen_group_name(f, s) < 0 ||
+	    fputs("_free(struct ", f) == EOF ||
+	    gen_group_name(f, s) < 0)
+		return 0;
+	return fprintf(f, " *p,\n    size_t sz)%s", 
+		decl ? ";\n" : "") > 0;
+}
+
+/*
+ * Generate the db_xxxx_get_many_by_yyy function header for the batched
+ * lookup of the rowid or unique field "fd".
+ * If "decl" is non-zero, this is the declaration; otherwise, the
+ * definition header.
+ * Return zero on failure, non-zero on success.
+ */
+int
+gen_func_db_get_many(FILE *f, const struct field *fd, int decl)
+{
+	int	 rc;
+	size_t	 col = 0;
+
+	if ((rc = fprintf(f, "struct %s_q *", fd->parent->name)) < 0)
+		return 0;
+	col += rc;
+
+	if (!decl) {
+		if (fputc('\n', f) == EOF)
+			return 0;
+		col = 0;
+	}
+
+	rc = fprintf(f, "db_%s_get_many_by_%s(struct ort *ctx", 
+		fd->parent->name, fd->name);
+	if (rc < 0)
+		return 0;
+	col += rc;
+
+	if (print_var_set(f, 1, col, fd) < 0)
+		return 0;
+	return fprintf(f, ")%s", decl ? ";\n" : "") > 0;
+}
+
 /*
  * Generate the db_xxxx_free function header.
  * If "decl" is non-zero, this is the declaration; otherwise, the
@@ -816,3 +1147,84 @@ get_filldep(const struct filldepq *fq, const struct strct *s)
 
 	return NULL;
 }
+
+/*
+ * Look up the role "name" (case insensitive) other than "all".
+ * Return the role or NULL if "name" is NULL or not found.
+ */
+const struct role *
+get_role(const struct config *cfg, const char *name)
+{
+	const struct role	*r;
+
+	if (name == NULL)
+		return NULL;
+	TAILQ_FOREACH(r, &cfg->arq, allentries)
+		if (strcasecmp(r->name, name) == 0 &&
+		    strcmp(r->name, "all") != 0)
+			return r;
+	return NULL;
+}
+
+/*
+ * Whether role "r" is granted an operation by the role map "rm", which
+ * may be NULL, either directly or by way of an ancestor.
+ * The "none" role is never granted anything.
+ * If "r" is NULL, there are no roles and everything is granted.
+ * Return zero if not granted, non-zero otherwise.
+ */
+int
+gen_role_granted(const struct rolemap *rm, const struct role *r)
+{
+	const struct rref	*rs;
+	const struct role	*rp;
+
+	if (r == NULL)
+		return 1;
+	if (rm == NULL || strcmp(r->name, "none") == 0)
+		return 0;
+	TAILQ_FOREACH(rs, &rm->rq, entries)
+		for (rp = r; rp != NULL; rp = rp->parent)
+			if (rp == rs->role)
+				return 1;
+	return 0;
+}
+
+/*
+ * Whether roles are enforced at run-time: roles are defined and output
+ * isn't limited to the single role "role", which may be NULL.
+ * With a single role, there's no role state, role switching, or sqlbox
+ * role table: only that role's operations are generated at all.
+ * Return zero if not enforced, non-zero otherwise.
+ */
+int
+gen_rbac(const struct config *cfg, const char *role)
+{
+
+	return !TAILQ_EMPTY(&cfg->rq) && role == NULL;
+}
+
+/*
+ * Whether "p" may be shared between the results of a listing when
+ * using an identity map: it's filled within other structures (not by
+ * null references) and has a row identifier.
+ * Structures containing null references are excluded, as these are
+ * filled separately for each result.
+ * Return zero if not shared, non-zero otherwise.
+ */
+int
+gen_strct_shared(const struct config *cfg, const struct strct *p)
+{
+	const struct strct	*pp;
+	const struct field	*fd;
+
+	if (p->rowid == NULL || (p->flags & STRCT_HAS_NULLREFS))
+		return 0;
+	TAILQ_FOREACH(pp, &cfg->sq, entries)
+		TAILQ_FOREACH(fd, &pp->fq, entries)
+			if (fd->type == FTYPE_STRUCT &&
+			    fd->ref->target->parent == p &&
+			    !(fd->ref->source->flags & FIELD_NULL))
+				return 1;
+	return 0;
+}
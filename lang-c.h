@@ -32,16 +32,23 @@ struct	filldep {
 TAILQ_HEAD(filldepq, filldep);
 
 int	gen_func_db_close(FILE *, int);
+int	gen_func_db_err(FILE *, int);
 int	gen_func_db_free(FILE *, const struct strct *, int);
 int	gen_func_db_freeq(FILE *, const struct strct *, int);
+int	gen_func_db_get_many(FILE *, const struct field *, int);
+int	gen_func_db_group_free(FILE *, const struct search *, int);
 int	gen_func_db_insert(FILE *, const struct strct *, int);
+int	gen_func_db_iterate_batch(FILE *, const struct search *, int);
 int	gen_func_db_open(FILE *, int);
 int	gen_func_db_open_logging(FILE *, int);
+int	gen_func_db_open_ro(FILE *, int);
+int	gen_func_db_open_ro_logging(FILE *, int);
 int	gen_func_db_role(FILE *, int);
 int	gen_func_db_role_current(FILE *, int);
 int	gen_func_db_role_stored(FILE *, int);
 int	gen_func_db_search(FILE *, const struct search *, int);
 int	gen_func_db_set_logging(FILE *, int);
+int	gen_func_db_set_retry(FILE *, int);
 int	gen_func_db_trans_commit(FILE *, int);
 int	gen_func_db_trans_open(FILE *, int);
 int	gen_func_db_trans_rollback(FILE *, int);
@@ -57,12 +64,20 @@ int	gen_func_json_parse_array(FILE *, const struct strct *, int);
 int	gen_func_valid(FILE *, const struct field *, int);
 
 int	gen_filldep(struct filldepq *, const struct strct *, unsigned int);
+int	gen_group_name(FILE *, const struct search *);
+int	gen_rbac(const struct config *, const char *);
+int	gen_role_granted(const struct rolemap *, const struct role *);
+int	gen_strct_shared(const struct config *, const struct strct *);
 const struct filldep *
 	get_filldep(const struct filldepq *, const struct strct *);
+const struct role *
+	get_role(const struct config *, const char *);
 
 const char	*get_optype_str(enum optype);
 const char	*get_modtype_str(enum modtype);
 const char	*get_stype_str(enum stype);
 const char	*get_ftype_str(enum ftype);
+const char	*get_aggr_type_str(const struct search *);
+int		 get_group_first(const struct search *);
 
 #endif /* !LANG_C_H */
@@ -252,62 +252,71 @@ gen_jsdoc_field(FILE *f, const struct field *fd)
 /*
  * Generate calls to _fillField, _fillDateValue, and _fillBitsChecked
  * with properly wrapping lines.
+ * If "diff" is set, the calls are only made if the value differs from
+ * that of the previous object "_prev".
+ * The binding "_bind" and "_prev" start with an underscore, which
+ * identifiers can't, so they don't shadow nested structure classes.
  * Don't generate calls if we don't export the value.
  */
 static int
-gen_js_field(FILE *f, const struct field *fd)
+gen_js_field(FILE *f, const struct field *fd, int diff)
 {
-	char	*buf = NULL;
-	int	 rc;
-	size_t	 col;
+	char		*buf = NULL;
+	int		 rc;
+	size_t		 col;
+	const char	*ind = diff ? "\t" : "";
 
 	if (fd->type == FTYPE_PASSWORD ||
 	    (fd->flags & FIELD_NOEXPORT))
 		return 1;
 
+	if (diff && fprintf(f, "\t\t\tif (!_same(o.%s, _prev.%s)) {\n",
+	    fd->name, fd->name) < 0)
+		return 0;
+
 	if (fd->type == FTYPE_STRUCT) {
 		if (fd->rolemap != NULL)
 			rc = (fd->ref->source->flags & FIELD_NULL) ?
 				asprintf(&buf, 
-					"\t\t\t\ttypeof o.%s === "
+					"%s\t\t\t\ttypeof o.%s === "
 					  "\'undefined\' ? undefined :\n"
-					"\t\t\t\to.%s === null ? null :\n"
-					"\t\t\t\tnew %s(o.%s)", 
-					fd->name, fd->name,
+					"%s\t\t\t\to.%s === null ? null :\n"
+					"%s\t\t\t\tnew %s(o.%s)", 
+					ind, fd->name, ind, fd->name, ind,
 					fd->ref->target->parent->name, 
 					fd->name) :
 				asprintf(&buf, 
-					"\t\t\t\ttypeof o.%s === "
+					"%s\t\t\t\ttypeof o.%s === "
 					  "\'undefined\' ?\n"
-					"\t\t\t\tundefined : new %s(o.%s)", 
-					fd->name,
+					"%s\t\t\t\tundefined : new %s(o.%s)", 
+					ind, fd->name, ind,
 					fd->ref->target->parent->name, 
 					fd->name);
 		else
 			rc = (fd->ref->source->flags & FIELD_NULL) ?
 				asprintf(&buf, 
-					"\t\t\t\to.%s === null ? null :\n"
-					"\t\t\t\tnew %s(o.%s)", 
-					fd->name,
+					"%s\t\t\t\to.%s === null ? null :\n"
+					"%s\t\t\t\tnew %s(o.%s)", 
+					ind, fd->name, ind,
 					fd->ref->target->parent->name, 
 					fd->name) :
-				asprintf(&buf, "\t\t\t\tnew %s(o.%s)", 
-					fd->ref->target->parent->name, 
+				asprintf(&buf, "%s\t\t\t\tnew %s(o.%s)", 
+					ind, fd->ref->target->parent->name, 
 					fd->name);
 		if (rc == -1)
 			return 0;
 	}
 
-	col = 37;
-	if (fputs("\t\t\t_fillField(e,", f) == EOF)
+	col = diff ? 45 : 37;
+	if (fprintf(f, "%s\t\t\t_fillField(e,", ind) < 0)
 		return 0;
 
 	/* Structure name. */
 
 	if (col + strlen(fd->parent->name) + 4 >= 72) {
-		if (fputs("\n\t\t\t\t", f) == EOF)
+		if (fprintf(f, "\n%s\t\t\t\t", ind) < 0)
 			return 0;
-		col = 32;
+		col = diff ? 40 : 32;
 	} else {
 		if (fputc(' ', f) == EOF)
 			return 0;
@@ -321,9 +330,9 @@ gen_js_field(FILE *f, const struct field *fd)
 	/* Field name. */
 
 	if (col + strlen(fd->name) + 4 >= 72) {
-		if (fputs("\n\t\t\t\t", f) == EOF)
+		if (fprintf(f, "\n%s\t\t\t\t", ind) < 0)
 			return 0;
-		col = 32;
+		col = diff ? 40 : 32;
 	} else {
 		if (fputc(' ', f) == EOF)
 			return 0;
@@ -337,9 +346,9 @@ gen_js_field(FILE *f, const struct field *fd)
 	/* "Custom." */
 
 	if (col + 7 >= 72) {
-		if (fputs("\n\t\t\t\t", f) == EOF)
+		if (fprintf(f, "\n%s\t\t\t\t", ind) < 0)
 			return 0;
-		col = 32;
+		col = diff ? 40 : 32;
 	} else {
 		if (fputc(' ', f) == EOF)
 			return 0;
@@ -353,9 +362,9 @@ gen_js_field(FILE *f, const struct field *fd)
 	/* Field in interface and "inc". */
 
 	if (col + 7 + strlen(fd->name) >= 72) {
-		if (fputs("\n\t\t\t\t", f) == EOF)
+		if (fprintf(f, "\n%s\t\t\t\t", ind) < 0)
 			return 0;
-		col = 32;
+		col = diff ? 40 : 32;
 	} else {
 		if (fputc(' ', f) == EOF)
 			return 0;
@@ -369,9 +378,9 @@ gen_js_field(FILE *f, const struct field *fd)
 	/* True or false. */
 
 	if (col + 6 >= 72) {
-		if (fputs("\n\t\t\t\t", f) == EOF)
+		if (fprintf(f, "\n%s\t\t\t\t", ind) < 0)
 			return 0;
-		col = 32;
+		col = diff ? 40 : 32;
 	} else {
 		if (fputc(' ', f) == EOF)
 			return 0;
@@ -390,27 +399,27 @@ gen_js_field(FILE *f, const struct field *fd)
 	/* Nested object or null. */
 
 	if (buf != NULL) {
-		if (fprintf(f, "\n%s);\n", buf) < 0)
+		if (fprintf(f, "\n%s, _bind);\n", buf) < 0)
 			return 0;
 	} else  {
-		if (fputs("null);\n", f) == EOF)
+		if (fputs("null, _bind);\n", f) == EOF)
 			return 0;
 	}
 
 	free(buf);
 
 	if (fd->type == FTYPE_BIT || fd->type == FTYPE_BITFIELD)
-		if (fprintf(f, "\t\t\t_fillBitsChecked"
-		    "(e, '%s-%s', o.%s, inc);\n",
+		if (fprintf(f, "%s\t\t\t_fillBitsChecked"
+		    "(e, '%s-%s', o.%s, inc, _bind);\n", ind,
 		    fd->parent->name, fd->name, fd->name) < 0)
 			return 0;
 	if (fd->type == FTYPE_DATE || fd->type == FTYPE_EPOCH)
-		if (fprintf(f, "\t\t\t_fillDateValue"
-		    "(e, '%s-%s', o.%s, inc);\n",
+		if (fprintf(f, "%s\t\t\t_fillDateValue"
+		    "(e, '%s-%s', o.%s, inc, _bind);\n", ind,
 		    fd->parent->name, fd->name, fd->name) < 0)
 			return 0;
 
-	return 1;
+	return !diff || fputs("\t\t\t}\n", f) != EOF;
 }
 
 /*
@@ -484,6 +493,207 @@ gen_class_proto(FILE *f, int priv,
 	return fprintf(f, "%s\n", ret) > 0;
 }
 
+/*
+ * Append "p" and the structures it nests by exported fields (each
+ * only once) to "set", which holds "setsz" members.
+ */
+static void
+gen_js_nested(const struct strct *p,
+	const struct strct **set, size_t *setsz)
+{
+	const struct field	*fd;
+	size_t			 i;
+
+	for (i = 0; i < *setsz; i++)
+		if (set[i] == p)
+			return;
+	set[(*setsz)++] = p;
+
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type == FTYPE_STRUCT &&
+		    !(fd->flags & FIELD_NOEXPORT))
+			gen_js_nested(fd->ref->target->parent,
+				set, setsz);
+}
+
+/*
+ * Generate the compile() and fillCompiled() methods of "p", which
+ * record and apply a FillPlan for the structure and the structures it
+ * nests.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_js_plan(FILE *f, const struct config *cfg, const struct strct *p)
+{
+	const struct strct	*s, **set;
+	size_t			 i, setsz = 0;
+	int			 rc = 0;
+
+	i = 0;
+	TAILQ_FOREACH(s, &cfg->sq, entries)
+		i++;
+	if ((set = calloc(i, sizeof(struct strct *))) == NULL)
+		return 0;
+	gen_js_nested(p, set, &setsz);
+
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Walk a template element once, recording the elements "
+	    "(inclusive) having classes filled by this structure "
+	    "and its nested structures.\n"
+	    "@param e The template DOM element.\n"
+	    "@return Plan for {@link fillCompiled}."))
+		goto out;
+	if (!gen_class_proto(f, 2, "FillPlan", "compile",
+	    "e", "HTMLElement", NULL))
+		goto out;
+	if (fputs("\t\t{\n"
+	    "\t\t\treturn new FillPlan(e, [", f) == EOF)
+		goto out;
+	for (i = 0; i < setsz; i++)
+		if (fprintf(f, "%s\'%s\'", i > 0 ? ", " : "",
+		    set[i]->name) < 0)
+			goto out;
+	if (fputs("]);\n"
+	    "\t\t}\n\n", f) == EOF)
+		goto out;
+
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Like {@link fill} but resolving elements with a plan "
+	    "instead of querying the DOM.\n"
+	    "@param e The DOM element, which must be the "
+	    "template given to {@link compile} or an unmodified "
+	    "clone of it.\n"
+	    "@param plan The plan from {@link compile}.\n"
+	    "@param custom Custom handler dictionary (see "
+	    "{@link fill} for details)."))
+		goto out;
+	if (!gen_class_proto(f, 0, "void", "fillCompiled",
+	    "e", "HTMLElement|null",
+	    "plan", "FillPlan",
+	    "custom?", "DataCallbacks|null", NULL))
+		goto out;
+	if (fputs("\t\t{\n"
+	    "\t\t\tif (e !== null)\n"
+	    "\t\t\t\tthis._fill(e, this.obj, true, custom,\n"
+	    "\t\t\t\t\tnew FillBinding(plan, e));\n"
+	    "\t\t}\n\n", f) == EOF)
+		goto out;
+
+	rc = 1;
+out:
+	free(set);
+	return rc;
+}
+
+/*
+ * Generate the invocation of the structure-wide custom callbacks of
+ * "p" on the filled object "o".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_js_custom(FILE *f, const struct strct *p)
+{
+
+	return fprintf(f, "\t\t\tif (custom !== null &&\n"
+	    "\t\t\t    typeof custom[\'%s\'] !== "
+	    "\'undefined\') {\n"
+	    "\t\t\t\tif (custom['%s'] instanceof Array) {\n"
+	    "\t\t\t\t\tlet i: number;\n"
+	    "\t\t\t\t\tfor (i = 0; "
+	    "i < custom['%s'].length; i++)\n"
+	    "\t\t\t\t\t\tcustom['%s'][i](e, '%s', o);\n"
+	    "\t\t\t\t} else\n"
+	    "\t\t\t\t\tcustom['%s'](e, '%s', o);\n"
+	    "\t\t\t}\n", p->name, p->name, p->name, 
+	    p->name, p->name, p->name, p->name) >= 0;
+}
+
+/*
+ * Generate the _fillChanged() and fillArrayKeyed() methods of "p",
+ * the latter only if "p" has an exported row identifier to key rows.
+ * The former only fills fields differing from the previous object.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_js_keyed(FILE *f, const struct strct *p)
+{
+	const struct field	*fd;
+	char			*type;
+	int			 rc;
+
+	if (p->rowid == NULL || (p->rowid->flags & FIELD_NOEXPORT))
+		return 1;
+
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Like {@link _fill} for a single object, but only "
+	    "for those fields that differ from the previously "
+	    "filled object.\n"
+	    "@internal"))
+		return 0;
+	if (asprintf(&type, "%sData", p->name) == -1)
+		return 0;
+	rc = gen_class_proto(f, 1, "void", "_fillChanged",
+	    "e", "HTMLElement",
+	    "o", type,
+	    "_prev", type,
+	    "_bind", "FillBinding",
+	    "custom?", "DataCallbacks|null", NULL);
+	free(type);
+	if (!rc)
+		return 0;
+	if (fputs("\t\t{\n"
+	    "\t\t\tconst inc: boolean = true;\n"
+	    "\t\t\tif (typeof custom === 'undefined')\n"
+	    "\t\t\t\tcustom = null;\n", f) == EOF)
+		return 0;
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (!gen_js_field(f, fd, 1))
+			return 0;
+	if (!gen_js_custom(f, p) ||
+	    fputs("\t\t}\n\n", f) == EOF)
+		return 0;
+
+	if (!gen_commentv(f, 2, COMMENT_JS,
+	    "Like {@link fillArray} but keyed by **%s**. "
+	    "Rows from the previous keyed fill of \'e\' are "
+	    "reused by key: rows for new keys are cloned from "
+	    "the saved element, rows for missing keys are "
+	    "removed, and rows are moved only if out of order. "
+	    "Reused rows are only filled (with their custom "
+	    "callbacks) for fields whose values have changed. "
+	    "The element \'e\' must only be filled with this "
+	    "method after the first call.\n"
+	    "@param e The DOM element.\n"
+	    "@param custom Custom handler dictionary (see "
+	    "{@link fill}).", p->rowid->name))
+		return 0;
+	if (!gen_class_proto(f, 0, "void", "fillArrayKeyed",
+	    "e", "HTMLElement|null",
+	    "custom?", "DataCallbacks|null", NULL))
+		return 0;
+	return fprintf(f, "\t\t{\n"
+	    "\t\t\tconst o: %sData[] =\n"
+	    "\t\t\t\t(this.obj instanceof Array) ?\n"
+	    "\t\t\t\t this.obj : [this.obj];\n"
+	    "\n"
+	    "\t\t\tif (e === null)\n"
+	    "\t\t\t\treturn;\n"
+	    "\t\t\t_fillKeyed(e, this.obj === null ? [] : o,\n"
+	    "\t\t\t\t\'%s\', %s.compile,\n"
+	    "\t\t\t\t(row: HTMLElement, obj: %sData,\n"
+	    "\t\t\t\t prev: %sData|null, bind: FillBinding): "
+	    "void => {\n"
+	    "\t\t\t\t\tif (prev === null)\n"
+	    "\t\t\t\t\t\tthis._fill(row, obj, "
+	    "true, custom, bind);\n"
+	    "\t\t\t\t\telse\n"
+	    "\t\t\t\t\t\tthis._fillChanged(row, obj, "
+	    "prev, bind, custom);\n"
+	    "\t\t\t\t});\n"
+	    "\t\t}\n\n", p->name, p->rowid->name, p->name,
+	    p->name, p->name) >= 0;
+}
+
 int
 ort_lang_javascript(const struct config *cfg,
 	const struct ort_lang_js *args, FILE *f)
@@ -745,13 +955,24 @@ ort_lang_javascript(const struct config *cfg,
 		    "\t\t}\n\n", f) == EOF)
 			return 0;
 
-		/* _fill() private method. */
+		/* compile() and fillCompiled() methods. */
 
-		if (!gen_class_proto(f, 1, "void", "_fill",
+		if (!gen_js_plan(f, cfg, s))
+			return 0;
+
+		/* 
+		 * _fill() method, not private because nested
+		 * structures are filled with their parent's binding.
+		 */
+
+		if (!gen_comment(f, 2, COMMENT_JS, "@internal"))
+			return 0;
+		if (!gen_class_proto(f, 0, "void", "_fill",
 		    "e", "HTMLElement", 
 		    "obj", obj,
 		    "inc", "boolean",
-		    "custom?", "DataCallbacks|null", NULL))
+		    "custom?", "DataCallbacks|null",
+		    "_bind?", "FillBinding|null", NULL))
 			return 0;
 		if (fprintf(f, "\t\t{\n"
 		    "\t\t\tif (obj instanceof Array && "
@@ -763,22 +984,15 @@ ort_lang_javascript(const struct config *cfg,
 		    "\t\t\t\tcustom = null;\n", s->name) < 0)
 			return 0;
 		TAILQ_FOREACH(fd, &s->fq, entries)
-			if (!gen_js_field(f, fd))
+			if (!gen_js_field(f, fd, 0))
 				return 0;
-		if (fprintf(f, "\t\t\tif (custom !== null &&\n"
-		    "\t\t\t    typeof custom[\'%s\'] !== "
-		    "\'undefined\') {\n"
-		    "\t\t\t\tif (custom['%s'] instanceof Array) {\n"
-		    "\t\t\t\t\tlet i: number;\n"
-		    "\t\t\t\t\tfor (i = 0; "
-		    "i < custom['%s'].length; i++)\n"
-		    "\t\t\t\t\t\tcustom['%s'][i](e, '%s', o);\n"
-		    "\t\t\t\t} else\n"
-		    "\t\t\t\t\tcustom['%s'](e, '%s', o);\n"
-		    "\t\t\t}\n"
-		    "\t\t}\n"
-		    "\n", s->name, s->name, s->name, 
-		    s->name, s->name, s->name, s->name) < 0)
+		if (!gen_js_custom(f, s) ||
+		    fputs("\t\t}\n\n", f) == EOF)
+			return 0;
+
+		/* _fillChanged() and fillArrayKeyed() methods. */
+
+		if (!gen_js_keyed(f, s))
 			return 0;
 
 		/* _fillByClass() private method. */
@@ -880,7 +1094,9 @@ ort_lang_javascript(const struct config *cfg,
 		    "of the subtree root). If the input array is "
 		    "empty or null, \'e\' is hidden by using the "
 		    "*hide* class. Otherwise, the *hide* class is "
-		    "removed.\n"
+		    "removed. The saved element is compiled once "
+		    "with {@link compile}, so the clones are filled "
+		    "without querying the DOM.\n"
 		    "@param e The DOM element.\n"
 		    "@param custom Custom handler dictionary (see "
 		    "{@link fill})."))
@@ -904,15 +1120,17 @@ ort_lang_javascript(const struct config *cfg,
 		    "\n"
 		    "\t\t\tconst row: HTMLElement =\n"
 		    "\t\t\t\t<HTMLElement>e.children[0];\n"
+		    "\t\t\tconst plan: FillPlan = %s.compile(row);\n"
 		    "\t\t\twhile (e.firstChild !== null)\n"
 		    "\t\t\t\te.removeChild(e.firstChild)\n"
 		    "\t\t\tfor (i = 0; i < o.length; i++) {\n"
 		    "\t\t\t\tconst cln: HTMLElement =\n"
 		    "\t\t\t\t\t<HTMLElement>row.cloneNode(true);\n"
 		    "\t\t\t\te.appendChild(cln);\n"
-		    "\t\t\t\tthis._fill(cln, o[i], true, custom);\n"
+		    "\t\t\t\tthis._fill(cln, o[i], true, custom,\n"
+		    "\t\t\t\t\tnew FillBinding(plan, cln));\n"
 		    "\t\t\t}\n"
-		    "\t\t}\n\n", s->name) < 0)
+		    "\t\t}\n\n", s->name, s->name) < 0)
 		    	return 0;
 
 		/* fillArrayByClass() method. */
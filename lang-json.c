@@ -61,6 +61,7 @@ static const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
 };
@@ -101,6 +102,11 @@ static const char *const stypes[STYPE__MAX] = {
 	"search", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static const char *const rolemapts[ROLEMAP__MAX] = {
@@ -113,6 +119,11 @@ static const char *const rolemapts[ROLEMAP__MAX] = {
 	"search", /* ROLEMAP_SEARCH */
 	"update", /* ROLEMAP_UPDATE */
 	"noexport", /* ROLEMAP_NOEXPORT */
+	"sum", /* ROLEMAP_SUM */
+	"avg", /* ROLEMAP_AVG */
+	"min", /* ROLEMAP_MIN */
+	"max", /* ROLEMAP_MAX */
+	"exists", /* ROLEMAP_EXISTS */
 };
 
 /*
@@ -671,6 +682,10 @@ gen_insert(FILE *f, const struct insert *insert)
 		return 0;
 	if (!gen_pos(f, &insert->pos))
 		return 0;
+	if (fprintf(f, " \"flags\": [%s ],", 
+	    (insert->flags & INSERT_RETURNING) ?
+	    " \"returning\"" : "") < 0)
+		return 0;
 	if (!gen_rolemap(f, 0, insert->rolemap))
 		return 0;
 	return fputs(" },", f) != EOF;
@@ -832,6 +847,9 @@ gen_search(FILE *f, int *first, const struct search *s)
 	    " \"offset\": \"%" PRId64 "\", \"type\": \"%s\",", 
 	    s->limit, s->offset, stypes[s->type]) < 0)
 		return 0;
+	if (fprintf(f, " \"flags\": [%s ],", 
+	    (s->flags & SEARCH_CACHE) ? " \"cache\"" : "") < 0)
+		return 0;
 	if (fputs(" \"sntq\": [", f) == EOF)
 		return 0;
 	TAILQ_FOREACH(sent, &s->sntq, entries) {
@@ -862,6 +880,18 @@ gen_search(FILE *f, int *first, const struct search *s)
 		return 0;
 	if (!gen_distinct(f, s->dst))
 		return 0;
+	if (s->afield != NULL && fprintf(f, 
+	    ", \"afield\": \"%s\"", s->afield->name) < 0)
+		return 0;
+	if (s->afield == NULL && 
+	    fputs(", \"afield\": null", f) == EOF)
+		return 0;
+	if (s->groupby != NULL && fprintf(f, 
+	    ", \"groupby\": \"%s\"", s->groupby->name) < 0)
+		return 0;
+	if (s->groupby == NULL && 
+	    fputs(", \"groupby\": null", f) == EOF)
+		return 0;
 	return fputs(" }", f) != EOF;
 }
 
@@ -943,7 +973,12 @@ gen_update(FILE *f, int *first, const struct update *u)
 	if (u->flags & UPDATE_ALL)
 		if (fputs(" \"all\"", f) == EOF)
 			return 0;
-	if (fputs(" ], ", f) == EOF)
+	if (u->flags & UPDATE_RETURNING)
+		if (fprintf(f, "%s \"returning\"", 
+		    (u->flags & UPDATE_ALL) ? "," : "") < 0)
+			return 0;
+	if (fprintf(f, " ], \"batch\": \"%" PRId64 "\", ",
+	    u->batch) < 0)
 		return 0;
 	if (!gen_rolemap(f, 0, u->rolemap))
 		return 0;
@@ -38,6 +38,11 @@ static	const char *const stypes[STYPE__MAX] = {
 	"get", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static	const char *const utypes[UP__MAX] = {
@@ -65,6 +70,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
 };
@@ -92,14 +98,188 @@ static const char *const vtypes[VALIDATE__MAX] = {
 	"===", /* VALIDATE_EQ */
 };
 
+/*
+ * A single parameter of a generated database method, used when
+ * generating the whole-signature validators.
+ */
+struct	vparm {
+	const struct field	*fd; /* native field */
+	int			 set; /* array for "in" operator */
+};
+
+/*
+ * Print the name of the result interface of a grouped query.
+ * This is shared by all grouped queries in the structure with the same
+ * type, aggregate field, and grouping field.
+ * Return <0 on failure, otherwise the number of bytes written.
+ */
+static int
+gen_group_name(FILE *f, const struct search *s)
+{
+
+	assert(s->groupby != NULL);
+	if (STYPE_ISAGGR(s->type))
+		return fprintf(f, "%s_%s_%s_groupby_%s", 
+			s->parent->name, stypes[s->type], 
+			s->afield->name, s->groupby->name);
+	return fprintf(f, "%s_%s_groupby_%s", s->parent->name,
+		stypes[s->type], s->groupby->name);
+}
+
+/*
+ * Whether "s" is the first grouped query in its structure having its
+ * result interface (see gen_group_name()).
+ */
+static int
+group_first(const struct search *s)
+{
+	const struct search	*ss;
+
+	TAILQ_FOREACH(ss, &s->parent->sq, entries) {
+		if (ss == s)
+			break;
+		if (ss->groupby == s->groupby && 
+		    ss->type == s->type && ss->afield == s->afield)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Whether the integer field "fd" is represented as a number instead of
+ * a bigint, which is only the case with ORT_LANG_NODEJS_NUMBER.
+ * Its values must provably fit into 53 bits: bit indices always do,
+ * bitfields if their highest bit index does, and others if limited on
+ * both sides.
+ * Row identifiers, references, and unique fields are used as keys, so
+ * they're always bigint.
+ */
+static int
+is_number(const struct ort_lang_nodejs *args, const struct field *fd)
+{
+	const struct fvalid	*fv;
+	const struct bitidx	*bi;
+	const int64_t		 max = INT64_C(9007199254740991);
+	int			 lo = 0, hi = 0;
+
+	if (!(args->flags & ORT_LANG_NODEJS_NUMBER))
+		return 0;
+	if (fd->ref != NULL || (fd->flags & FIELD_ROWID) ||
+	    (fd->flags & FIELD_UNIQUE))
+		return 0;
+
+	switch (fd->type) {
+	case FTYPE_BIT:
+		return 1;
+	case FTYPE_BITFIELD:
+		TAILQ_FOREACH(bi, &fd->bitf->bq, entries)
+			if (bi->value > 52)
+				return 0;
+		return 1;
+	case FTYPE_DATE:
+	case FTYPE_EPOCH:
+	case FTYPE_INT:
+		break;
+	default:
+		return 0;
+	}
+
+	TAILQ_FOREACH(fv, &fd->fvq, entries) {
+		switch (fv->type) {
+		case VALIDATE_GE:
+			lo = lo || fv->d.value.integer >= -max;
+			break;
+		case VALIDATE_GT:
+			lo = lo || fv->d.value.integer >= -max - 1;
+			break;
+		case VALIDATE_LE:
+			hi = hi || fv->d.value.integer <= max;
+			break;
+		case VALIDATE_LT:
+			hi = hi || fv->d.value.integer <= max + 1;
+			break;
+		case VALIDATE_EQ:
+			lo = lo || fv->d.value.integer >= -max;
+			hi = hi || fv->d.value.integer <= max;
+			break;
+		default:
+			break;
+		}
+	}
+	return lo && hi;
+}
+
+/*
+ * Get the TypeScript type of native (non-struct, non-enum) field "fd".
+ */
+static const char *
+get_ftype(const struct ort_lang_nodejs *args, const struct field *fd)
+{
+
+	assert(ftypes[fd->type] != NULL);
+	return is_number(args, fd) ? "number" : ftypes[fd->type];
+}
+
+/*
+ * Whether any query in the configuration is marked for caching.
+ */
+static int
+has_cache(const struct config *cfg)
+{
+	const struct strct	*p;
+	const struct search	*s;
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		TAILQ_FOREACH(s, &p->sq, entries)
+			if (s->flags & SEARCH_CACHE)
+				return 1;
+	return 0;
+}
+
+/*
+ * Whether any query in the configuration is an iterate query, which
+ * also has an asynchronous variant.
+ */
+static int
+has_iterate(const struct config *cfg)
+{
+	const struct strct	*p;
+	const struct search	*s;
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		TAILQ_FOREACH(s, &p->sq, entries)
+			if (s->type == STYPE_ITERATE)
+				return 1;
+	return 0;
+}
+
+/*
+ * Print the bump of cached query generations for modifications of "p",
+ * if any queries are cached at all.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_cache_bump(FILE *f, const struct config *cfg, const struct strct *p)
+{
+
+	if (!has_cache(cfg))
+		return 1;
+	return fprintf(f, "\n"
+	    "\t\tthis.#o.cache.bump(ortcachetab.%s_write);\n",
+	    p->name) > 0;
+}
+
 /*
  * Generate variable vNN where NN is position "pos" (from one) with the
  * appropriate type in a method signature.
+ * If "set" is non-zero, the variable is an array of the type as used by
+ * the "in" operator.
  * This will start with a comma if not the first variable.
  * Return <0 on fail, >0 for columns printed.
  */
 static int
-gen_var(FILE *f, size_t pos, size_t col, const struct field *fd)
+gen_var(FILE *f, const struct ort_lang_nodejs *args, size_t pos,
+	size_t col, const struct field *fd, int set)
 {
 	int	 rc;
 
@@ -125,12 +305,16 @@ gen_var(FILE *f, size_t pos, size_t col, const struct field *fd)
 
 	rc = fd->type == FTYPE_ENUM ?
 		fprintf(f, "ortns.%s", fd->enm->name) :
-		fprintf(f, "%s", ftypes[fd->type]);
+		fprintf(f, "%s", get_ftype(args, fd));
 	if (rc < 0)
 		return -1;
 	col += rc;
 
-	if ((fd->flags & FIELD_NULL) ||
+	if (set) {
+		if (fputs("[]", f) == EOF)
+			return -1;
+		col += 2;
+	} else if ((fd->flags & FIELD_NULL) ||
 	    (fd->type == FTYPE_STRUCT &&
 	     (fd->ref->source->flags & FIELD_NULL))) {
 		if ((rc = fprintf(f, "|null")) < 0)
@@ -190,6 +374,75 @@ gen_rolemap(FILE *f, const struct rolemap *rm)
 	     "\t\t}\n", f) != EOF;
 }
 
+/*
+ * Push parameter "v<pos>" of bit or bitfield "fd".
+ * Those represented as bigint are converted into a signed
+ * representation, else high bits will trip range errors.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_push_bits(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd, size_t pos)
+{
+
+	if (is_number(args, fd))
+		return fprintf(f, "\t\tparms.push(v%zu);\n", pos) > 0;
+	if (fd->flags & FIELD_NULL)
+		return fprintf(f, "\t\tparms.push"
+		    "(v%zu === null ? null : "
+		    "BigInt.asIntN(64, v%zu));\n", pos, pos) > 0;
+	return fprintf(f, "\t\tparms.push"
+	    "(BigInt.asIntN(64, v%zu));\n", pos) > 0;
+}
+
+/*
+ * Print the JSON array of the set "v<pos>" bound as a single parameter
+ * for the "in" operator and batched lookups.
+ * Strings must be quoted and escaped while numbers and enums (bitfields
+ * again being signed) are joined as-is.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_set_json(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd, size_t pos)
+{
+
+	if (is_number(args, fd))
+		return fprintf(f, "'[' + v%zu.join(',') + ']'", pos) > 0;
+
+	switch (fd->type) {
+	case FTYPE_TEXT:
+	case FTYPE_EMAIL:
+		return fprintf(f, "JSON.stringify(v%zu)", pos) > 0;
+	case FTYPE_BIT:
+	case FTYPE_BITFIELD:
+		return fprintf(f, "'[' + v%zu.map(x => "
+		    "BigInt.asIntN(64, x)).join(',') + ']'", pos) > 0;
+	default:
+		break;
+	}
+	return fprintf(f, "'[' + v%zu.join(',') + ']'", pos) > 0;
+}
+
+/*
+ * Get the column of "fd" within a result row filled by db_xxx_fill(),
+ * which skips over nested structures.
+ */
+static size_t
+get_fill_column(const struct field *fd)
+{
+	const struct field	*ffd;
+	size_t			 col = 0;
+
+	TAILQ_FOREACH(ffd, &fd->parent->fq, entries) {
+		if (ffd == fd)
+			break;
+		if (ffd->type != FTYPE_STRUCT)
+			col++;
+	}
+	return col;
+}
+
 /*
  * Generate db_xxx_reffind method (if applicable).
  * Return zero on failure, non-zero on success or non-applicable.
@@ -250,7 +503,7 @@ gen_reffind(FILE *f, const struct strct *p)
 			    "\t\t\tif (typeof cols === \'undefined\')\n"
 			    "\t\t\t\tthrow \'referenced row not found\';\n"
 			    "\t\t\tobj.%s = this.db_%s_fill\n"
-			    "\t\t\t\t({row: <any[]>cols, pos: 0});\n"
+			    "\t\t\t\t(<any[]>cols);\n"
 			    "\t\t}\n",
 			    fd->ref->source->name,
 			    fd->ref->target->parent->name,
@@ -272,14 +525,250 @@ gen_reffind(FILE *f, const struct strct *p)
 }
 
 /*
- * Generate db_xxx_fill method.
+ * Like gen_reffind(), but for an array of objects at once.
+ * Each possibly-null reference is looked up with a single batched query
+ * over the distinct keys, then results are distributed to all objects
+ * sharing the key.
+ * If the referenced field has no batched query, each distinct key is
+ * instead looked up on its own.
+ * This then descends into nested structures that need it.
+ * Return zero on failure, non-zero on success or non-applicable.
+ */
+static int
+gen_reffind_many(FILE *f, const struct ort_lang_nodejs *args,
+	const struct strct *p)
+{
+	const struct field	*fd, *tfd;
+	const char		*type;
+
+	if (!(p->flags & STRCT_HAS_NULLREFS))
+		return 1;
+
+	if (fprintf(f, "\n"
+	    "\tprivate db_%s_reffind_many\n"
+	    "\t\t(db: ortdb, objs: ortns.%sData[]): void\n"
+	    "\t{\n"
+	    "\t\tif (objs.length === 0)\n"
+	    "\t\t\treturn;\n",
+	    p->name, p->name) < 0)
+		return 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (fd->type != FTYPE_STRUCT)
+			continue;
+		tfd = fd->ref->target;
+		type = get_ftype(args, fd->ref->source);
+		if ((fd->ref->source->flags & FIELD_NULL) && fprintf(f,
+		    "\n"
+		    "\t\tconst keys_%s: Map<%s, ortns.%sData[]> =\n"
+		    "\t\t\tnew Map();\n"
+		    "\t\tfor (const obj of objs) {\n"
+		    "\t\t\tif (obj.%s === null)\n"
+		    "\t\t\t\tcontinue;\n"
+		    "\t\t\tconst v: ortns.%sData[]|undefined =\n"
+		    "\t\t\t\tkeys_%s.get(obj.%s);\n"
+		    "\t\t\tif (typeof v === 'undefined')\n"
+		    "\t\t\t\tkeys_%s.set(obj.%s, [obj]);\n"
+		    "\t\t\telse\n"
+		    "\t\t\t\tv.push(obj);\n"
+		    "\t\t}\n"
+		    "\t\tif (keys_%s.size > 0) {\n"
+		    "\t\t\tconst stmt: Database.Statement =\n"
+		    "\t\t\t\tdb.db.prepare(ortstmt.stmtBuilder\n"
+		    "\t\t\t\t(ortstmt.ortstmt.STMT_%s_BY_UNIQUE_%s%s));\n"
+		    "\t\t\tstmt.raw(true);\n",
+		    fd->name, type, p->name,
+		    fd->ref->source->name,
+		    p->name,
+		    fd->name, fd->ref->source->name,
+		    fd->name, fd->ref->source->name,
+		    fd->name,
+		    tfd->parent->name,
+		    gen_sql_unique_many(tfd) ? "MANY_" : "",
+		    tfd->name) < 0)
+			return 0;
+		if ((fd->ref->source->flags & FIELD_NULL) &&
+		    gen_sql_unique_many(tfd)) {
+			if (fprintf(f, "\t\t\tconst v1: %s[] =\n"
+			    "\t\t\t\tArray.from(keys_%s.keys());\n"
+			    "\t\t\tconst rows: any[] = stmt.all(",
+			    type, fd->name) < 0)
+				return 0;
+			if (!gen_set_json(f, args, fd->ref->source, 1))
+				return 0;
+			if (fprintf(f, ");\n"
+			    "\t\t\tfor (const cols of rows) {\n"
+			    "\t\t\t\tconst v: ortns.%sData[]|undefined =\n"
+			    "\t\t\t\t\tkeys_%s.get(<%s>cols[%zu]);\n"
+			    "\t\t\t\tif (typeof v === 'undefined')\n"
+			    "\t\t\t\t\tcontinue;\n"
+			    "\t\t\t\tfor (const obj of v)\n"
+			    "\t\t\t\t\tobj.%s = this.db_%s_fill\n"
+			    "\t\t\t\t\t\t(<any[]>cols);\n"
+			    "\t\t\t}\n"
+			    "\t\t}\n",
+			    p->name, fd->name, type,
+			    get_fill_column(tfd),
+			    fd->name, tfd->parent->name) < 0)
+				return 0;
+		} else if (fd->ref->source->flags & FIELD_NULL) {
+			if (fprintf(f,
+			    "\t\t\tfor (const [key, v] of keys_%s) {\n"
+			    "\t\t\t\tconst cols: any = stmt.get([key]);\n"
+			    "\t\t\t\tif (typeof cols === 'undefined')\n"
+			    "\t\t\t\t\tcontinue;\n"
+			    "\t\t\t\tfor (const obj of v)\n"
+			    "\t\t\t\t\tobj.%s = this.db_%s_fill\n"
+			    "\t\t\t\t\t\t(<any[]>cols);\n"
+			    "\t\t\t}\n"
+			    "\t\t}\n",
+			    fd->name, fd->name,
+			    tfd->parent->name) < 0)
+				return 0;
+		}
+		if (!(tfd->parent->flags & STRCT_HAS_NULLREFS))
+			continue;
+		if (fd->ref->source->flags & FIELD_NULL) {
+			if (fprintf(f, "\t\tthis.db_%s_reffind_many(db, "
+			    "objs\n"
+			    "\t\t\t.filter(obj => obj.%s !== null)\n"
+			    "\t\t\t.map(obj => <ortns.%sData>obj.%s));\n",
+			    tfd->parent->name, fd->name,
+			    tfd->parent->name, fd->name) < 0)
+				return 0;
+		} else {
+			if (fprintf(f, "\t\tthis.db_%s_reffind_many(db, "
+			    "objs.map(obj => obj.%s));\n",
+			    tfd->parent->name, fd->name) < 0)
+				return 0;
+		}
+	}
+
+	return fputs("\t}\n", f) != EOF;
+}
+
+/*
+ * Print "tabs" tabs.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_fill(FILE *f, const struct strct *p)
+gen_tabs(FILE *f, size_t tabs)
+{
+
+	while (tabs-- > 0)
+		if (fputc('\t', f) == EOF)
+			return 0;
+	return 1;
+}
+
+/*
+ * Print the value of column "col" for field "fd", which may not be a
+ * struct, continuing lines (if needed) at "tabs" indentation.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fill_value(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd, size_t col, size_t tabs)
+{
+
+	if (fd->type == FTYPE_ENUM) {
+		/*
+		 * Convert these to a string because our
+		 * internal representation is 64-bit but numeric
+		 * enumerations are constraint to 53.
+		 */
+		if (fprintf(f, "<ortns.%s%s>", fd->enm->name,
+		    (fd->flags & FIELD_NULL) ? "|null" : "") < 0)
+			return 0;
+		if (!(fd->flags & FIELD_NULL))
+			return fprintf(f, "row[%zu].toString()", col) > 0;
+		if (fprintf(f, "(row[%zu] === null ?\n", col) < 0)
+			return 0;
+		if (!gen_tabs(f, tabs + 1))
+			return 0;
+		return fprintf(f, "null : row[%zu].toString())", col) > 0;
+	}
+
+	if (!is_number(args, fd))
+		return fprintf(f, "<%s%s>row[%zu]", get_ftype(args, fd),
+		    (fd->flags & FIELD_NULL) ? "|null" : "", col) > 0;
+
+	/* Converted from the 64-bit database value. */
+
+	if (!(fd->flags & FIELD_NULL))
+		return fprintf(f, "Number(row[%zu])", col) > 0;
+	if (fprintf(f, "(row[%zu] === null ?\n", col) < 0)
+		return 0;
+	if (!gen_tabs(f, tabs + 1))
+		return 0;
+	return fprintf(f, "null : Number(row[%zu]))", col) > 0;
+}
+
+/*
+ * Print the members of an object literal of "p" filled from the
+ * columns at "col" onward, at "tabs" indentation, advancing "col" past
+ * them.
+ * Columns are ordered as by gen_sql_stmt_schema(): those of "p", then
+ * those of each non-null nested structure in turn, so nested objects
+ * are filled in place from constant offsets.
+ * Nested structures of null references are left to db_xxx_reffind().
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fill_members(FILE *f, const struct ort_lang_nodejs *args,
+	const struct strct *p, size_t *col, size_t tabs)
 {
-	size_t	 		 col;
 	const struct field	*fd;
+	size_t			 pos, nested;
+
+	/* Nested columns follow all of our own. */
+
+	nested = *col;
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type != FTYPE_STRUCT)
+			nested++;
+
+	pos = *col;
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if (!gen_tabs(f, tabs))
+			return 0;
+		if (fprintf(f, "'%s': ", fd->name) < 0)
+			return 0;
+		if (fd->type != FTYPE_STRUCT) {
+			if (!gen_fill_value(f, args, fd, pos++, tabs))
+				return 0;
+		} else if (fd->ref->source->flags & FIELD_NULL) {
+			if (fputs("null", f) == EOF)
+				return 0;
+		} else {
+			if (fputs("{\n", f) == EOF)
+				return 0;
+			if (!gen_fill_members(f, args,
+			    fd->ref->target->parent, &nested, tabs + 1))
+				return 0;
+			if (!gen_tabs(f, tabs))
+				return 0;
+			if (fputc('}', f) == EOF)
+				return 0;
+		}
+		if (fputs(",\n", f) == EOF)
+			return 0;
+	}
+
+	*col = nested;
+	return 1;
+}
+
+/*
+ * Generate db_xxx_fill method, which builds the object (and all nested
+ * objects) from a result row in a single literal.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fill(FILE *f, const struct ort_lang_nodejs *args,
+	const struct strct *p)
+{
+	size_t	 		 col;
 	int			 rc;
 
 	if (fputs("\n\t", f) == EOF)
@@ -298,8 +787,7 @@ gen_fill(FILE *f, const struct strct *p)
 		col++;
 	}
 
-	if ((rc = fprintf(f, 
-	    "data: {row: any[], pos: number}):")) < 0)
+	if ((rc = fprintf(f, "row: any[]):")) < 0)
 		return 0;
 	col += rc;
 
@@ -312,88 +800,49 @@ gen_fill(FILE *f, const struct strct *p)
 	}
 
 	if (fprintf(f, "ortns.%sData\n\t{\n"
-	    "\t\tconst obj: ortns.%sData = {\n", 
-	    p->name, p->name) < 0)
+	    "\t\treturn {\n", p->name) < 0)
 		return 0;
 
 	col = 0;
-	TAILQ_FOREACH(fd, &p->fq, entries) {
-		switch (fd->type) {
-		case FTYPE_STRUCT:
-			if (fputs("\t\t\t/* A dummy value "
-			    "for now. */\n", f) == EOF)
-				return 0;
-			if (fd->ref->source->flags & FIELD_NULL) {
-				if (fprintf(f, "\t\t\t'%s': "
-				    "null,\n", fd->name) < 0)
-					return 0;
-				break;
-			}
-			if (fprintf(f, "\t\t\t'%s': "
-			    "<ortns.%sData>{},\n", fd->name, 
-			    fd->ref->target->parent->name) < 0)
-				return 0;
-			break;
-		case FTYPE_ENUM:
-			/*
-			 * Convert these to a string because our
-			 * internal representation is 64-bit but numeric
-			 * enumerations are constraint to 53.
-			 */
-			if (fprintf(f, "\t\t\t'%s': <ortns.%s%s>",
-			    fd->name, fd->enm->name,
-			    (fd->flags & FIELD_NULL) ? 
-			    "|null" : "") < 0)
-				return 0;
-			if (fd->flags & FIELD_NULL) {
-				if (fprintf(f, 
-				    "(data.row[data.pos + %zu] === "
-				    "null ?\n\t\t\t\tnull : "
-				    "data.row[data.pos + %zu]."
-				    "toString()),\n", col, col) < 0)
-					return 0;
-			} else {
-				if (fprintf(f, 
-				    "data.row[data.pos + %zu]."
-				    "toString(),\n", col) < 0)
-					return 0;
-			}
-			break;
-		default:
-			assert(ftypes[fd->type] != NULL);
-			if (fprintf(f, "\t\t\t'%s': <%s%s>"
-			    "data.row[data.pos + %zu],\n",
-			    fd->name, ftypes[fd->type],
-			    (fd->flags & FIELD_NULL) ? 
-			    "|null" : "", col) < 0)
-				return 0;
-			break;
-		}
-		if (fd->type != FTYPE_STRUCT)
-			col++;
-	}
-
-	if (fprintf(f, "\t\t};\n"
-	    "\t\tdata.pos += %zu;\n", col) < 0)
+	if (!gen_fill_members(f, args, p, &col, 3))
 		return 0;
-
-	TAILQ_FOREACH(fd, &p->fq, entries)
-		if (fd->type == FTYPE_STRUCT &&
-		    !(fd->ref->source->flags & FIELD_NULL))
-			if (fprintf(f, "\t\tobj.%s = "
-			    "this.db_%s_fill(data);\n", fd->name, 
-			    fd->ref->target->parent->name) < 0)
-				return 0;
-
-	return fputs("\t\treturn obj;\n\t}\n", f) != EOF;
+	return fputs("\t\t};\n\t}\n", f) != EOF;
 }
 
 /*
  * Generate db_xxxx_insert method.
  * Return zero on failure, non-zero on success.
  */
+/*
+ * Generate the tail of a method filling "rows" from a statement into
+ * objects of "rs", looking up nested null references in batch over all
+ * of them, then returning the objects.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_fill_rows(FILE *f, const struct strct *rs)
+{
+
+	if (fprintf(f, 
+	    "\t\tconst objs: ortns.%sData[] = [];\n"
+	    "\t\tlet i: number;\n"
+	    "\n"
+	    "\t\tfor (i = 0; i < rows.length; i++)\n"
+	    "\t\t\tobjs.push(this.db_%s_fill\n"
+	    "\t\t\t\t(<any[]>rows[i]));\n",
+	    rs->name, rs->name) < 0)
+		return 0;
+	if ((rs->flags & STRCT_HAS_NULLREFS) && fprintf(f, 
+	    "\t\tthis.db_%s_reffind_many(this.#o, objs);\n", 
+	    rs->name) < 0)
+		return 0;
+	return fprintf(f, "\t\treturn objs.map"
+	    "(obj => new ortns.%s(this.#role, obj));\n", rs->name) > 0;
+}
+
 static int
-gen_insert(FILE *f, const struct strct *p)
+gen_insert(FILE *f, const struct config *cfg,
+	const struct ort_lang_nodejs *args, const struct strct *p)
 {
 	const struct field	*fd;
 	size_t	 	 	 pos = 1, col;
@@ -414,7 +863,12 @@ gen_insert(FILE *f, const struct strct *p)
 		    "@param v%zu %s", pos++, fd->name))
 			return 0;
 	}
-	if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+	if (p->ins->flags & INSERT_RETURNING) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return New row on success or null on "
+		    "constraint violation."))
+			return 0;
+	} else if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
 	    "@return New row's identifier on success or "
 	    "<0 otherwise."))
 		return 0;
@@ -439,7 +893,7 @@ gen_insert(FILE *f, const struct strct *p)
 	TAILQ_FOREACH(fd, &p->fq, entries)
 		if (!(fd->type == FTYPE_STRUCT || 
 		      (fd->flags & FIELD_ROWID))) {
-			if ((rc = gen_var(f, pos++, col, fd)) < 0)
+			if ((rc = gen_var(f, args, pos++, col, fd, 0)) < 0)
 				return 0;
 			col = rc;
 		}
@@ -447,7 +901,11 @@ gen_insert(FILE *f, const struct strct *p)
 	if (fputs("):", f) == EOF)
 		return 0;
 
-	if (col + 7 >= 72) {
+	if (p->ins->flags & INSERT_RETURNING) {
+		if (fprintf(f, "%sortns.%s|null", 
+		    col + 7 >= 72 ? "\n\t\t" : " ", p->name) < 0)
+			return 0;
+	} else if (col + 7 >= 72) {
 		if (fputs("\n\t\tbigint", f) == EOF)
 			return 0;
 	} else {
@@ -458,11 +916,17 @@ gen_insert(FILE *f, const struct strct *p)
 	if (fprintf(f, "\n"
 	    "\t{\n"
 	    "\t\tconst parms: any[] = [];\n"
-	    "\t\tlet info: Database.RunResult;\n"
+	    "\t\t%s\n"
 	    "\t\tconst stmt: Database.Statement =\n"
 	    "\t\t\tthis.#o.db.prepare(ortstmt.stmtBuilder\n"
 	    "\t\t\t(ortstmt.ortstmt.STMT_%s_INSERT));\n"
-	    "\n", p->name) < 0)
+	    "%s"
+	    "\n", 
+	    (p->ins->flags & INSERT_RETURNING) ?
+	    "let cols: any;" : "let info: Database.RunResult;",
+	    p->name,
+	    (p->ins->flags & INSERT_RETURNING) ?
+	    "\t\tstmt.raw(true);\n" : "") < 0)
 		return 0;
 
 	if ((rc = gen_rolemap(f, p->ins->rolemap)) < 0)
@@ -488,18 +952,8 @@ gen_insert(FILE *f, const struct strct *p)
 			break;
 		case FTYPE_BIT:
 		case FTYPE_BITFIELD:
-			if (fd->flags & FIELD_NULL) {
-				if (fprintf(f, "\t\tparms.push"
-				    "(v%zu === null ? null : "
-				    "BigInt.asIntN(64, v%zu));\n",
-				    pos, pos) < 0)
-					return 0;
-			} else
-				if (fprintf(f, 
-				    "\t\tparms.push"
-				    "(BigInt.asIntN(64, v%zu));\n", 
-				    pos) < 0)
-					return 0;
+			if (!gen_push_bits(f, args, fd, pos))
+				return 0;
 			pos++;
 			continue;
 		default:
@@ -528,6 +982,33 @@ gen_insert(FILE *f, const struct strct *p)
 		pos++;
 	}
 
+	if (!gen_cache_bump(f, cfg, p))
+		return 0;
+
+	if (p->ins->flags & INSERT_RETURNING) {
+		if (fprintf(f, "\n"
+		    "\t\ttry {\n"
+		    "\t\t\tcols = stmt.get(parms);\n"
+		    "\t\t} catch (er) {\n"
+		    "\t\t\treturn null;\n"
+		    "\t\t}\n"
+		    "\n"
+		    "\t\tif (typeof cols === 'undefined')\n"
+		    "\t\t\tthrow \'insert returned no result!?\';\n"
+		    "\t\tconst obj: ortns.%sData = \n"
+		    "\t\t\tthis.db_%s_fill"
+		    "(<any[]>cols);\n",
+		    p->name, p->name) < 0)
+			return 0;
+		if ((p->flags & STRCT_HAS_NULLREFS) && fprintf(f, 
+		    "\t\tthis.db_%s_reffind(this.#o, obj);\n",
+		    p->name) < 0)
+			return 0;
+		return fprintf(f, "\t\treturn new "
+			"ortns.%s(this.#role, obj);\n"
+			"\t}\n", p->name) > 0;
+	}
+
 	return fputs("\n"
 	     "\t\ttry {\n"
 	     "\t\t\tinfo = stmt.run(parms);\n"
@@ -539,13 +1020,57 @@ gen_insert(FILE *f, const struct strct *p)
 	     "\t}\n", f) != EOF;
 }
 
+/*
+ * Print the name of the db_xxx_delete or db_xxx_update method.
+ * Return <0 on failure, >0 for columns printed.
+ */
+static int
+gen_update_name(FILE *f, const struct update *up)
+{
+	const struct uref	*ref;
+	int			 rc, sz;
+
+	if ((rc = fprintf(f, "db_%s_%s",
+	    up->parent->name, utypes[up->type])) < 0)
+		return -1;
+	sz = rc;
+
+	if (up->name == NULL && up->type == UP_MODIFY &&
+	    !(up->flags & UPDATE_ALL))
+		TAILQ_FOREACH(ref, &up->mrq, entries) {
+			if ((rc = fprintf(f, "_%s_%s", ref->field->name,
+			    modtypes[ref->mod])) < 0)
+				return -1;
+			sz += rc;
+		}
+
+	if (up->name == NULL && !TAILQ_EMPTY(&up->crq)) {
+		if ((rc = fprintf(f, "_by")) < 0)
+			return -1;
+		sz += rc;
+		TAILQ_FOREACH(ref, &up->crq, entries) {
+			if ((rc = fprintf(f, "_%s_%s", ref->field->name,
+			    optypes[ref->op])) < 0)
+				return -1;
+			sz += rc;
+		}
+	} else if (up->name != NULL) {
+		if ((rc = fprintf(f, "_%s", up->name)) < 0)
+			return -1;
+		sz += rc;
+	}
+
+	return sz;
+}
+
 /*
  * Generate db_xxx_delete or db_xxx_update method.
  * Return zero on failure, non-zero on success.
  */
 static int
 gen_update(FILE *f, const struct config *cfg,
-	const struct update *up, size_t num)
+	const struct ort_lang_nodejs *args, const struct update *up,
+	size_t num)
 {
 	const struct uref	*ref;
 	enum cmtt		 ct = COMMENT_JS_FRAG_OPEN;
@@ -570,6 +1095,16 @@ gen_update(FILE *f, const struct config *cfg,
 		ct = COMMENT_JS_FRAG;
 	}
 
+	if (up->batch > 0) {
+		if (!gen_commentv(f, 1, ct,
+		    "This deletes at most %" PRId64 " rows per "
+		    "statement, each in its own transaction "
+		    "unless one is already open, until none "
+		    "remain.", up->batch))
+			return 0;
+		ct = COMMENT_JS_FRAG;
+	}
+
 	if (hasunary) { 
 		if (!gen_comment(f, 1, ct,
 		    "The following fields are constrained by "
@@ -617,11 +1152,20 @@ gen_update(FILE *f, const struct config *cfg,
 	else
 		ct = COMMENT_JS_FRAG_CLOSE;
 
-	if (up->type == UP_MODIFY) {
+	if (up->flags & UPDATE_RETURNING) {
+		if (!gen_comment(f, 1, ct,
+		    "@return Null on constraint violation, "
+		    "otherwise the updated rows."))
+			return 0;
+	} else if (up->type == UP_MODIFY) {
 		if (!gen_comment(f, 1, ct,
 		    "@return False on constraint violation, "
 		    "true on success."))
 			return 0;
+	} else if (up->batch > 0) {
+		if (!gen_comment(f, 1, ct,
+		    "@return Number of rows deleted."))
+			return 0;
 	} else {
 		if (!gen_comment(f, 1, ct, ""))
 			return 0;
@@ -631,53 +1175,10 @@ gen_update(FILE *f, const struct config *cfg,
 
 	if (fputc('\t', f) == EOF)
 		return 0;
-	if ((rc = fprintf(f, "db_%s_%s",
-	    up->parent->name, utypes[up->type])) < 0)
+	if ((rc = gen_update_name(f, up)) < 0)
 		return 0;
 	col = 8 + rc;
 
-	if (up->name == NULL && up->type == UP_MODIFY) {
-		if (!(up->flags & UPDATE_ALL))
-			TAILQ_FOREACH(ref, &up->mrq, entries) {
-				rc = fprintf(f, "_%s_%s", 
-					ref->field->name, 
-					modtypes[ref->mod]);
-				if (rc < 0)
-					return 0;
-				col += rc;
-			}
-		if (!TAILQ_EMPTY(&up->crq)) {
-			if ((rc = fprintf(f, "_by")) < 0)
-				return 0;
-			col += rc;
-			TAILQ_FOREACH(ref, &up->crq, entries) {
-				rc = fprintf(f, "_%s_%s", 
-					ref->field->name, 
-					optypes[ref->op]);
-				if (rc < 0)
-					return 0;
-				col += rc;
-			}
-		}
-	} else if (up->name == NULL) {
-		if (!TAILQ_EMPTY(&up->crq)) {
-			if ((rc = fprintf(f, "_by")) < 0)
-				return 0;
-			col += rc;
-			TAILQ_FOREACH(ref, &up->crq, entries) {
-				rc = fprintf(f, "_%s_%s", 
-					ref->field->name, 
-					optypes[ref->op]);
-				if (rc < 0)
-				col += rc;
-			}
-		}
-	} else {
-		if ((rc = fprintf(f, "_%s", up->name)) < 0)
-			return 0;
-		col += rc;
-	}
-
 	if (col >= 72) {
 		if (fputs("\n\t(", f) == EOF)
 			return 0;
@@ -690,14 +1191,14 @@ gen_update(FILE *f, const struct config *cfg,
 
 	pos = 1;
 	TAILQ_FOREACH(ref, &up->mrq, entries) {
-		if ((rc = gen_var(f, pos++, col, ref->field)) < 0)
+		if ((rc = gen_var(f, args, pos++, col, ref->field, 0)) < 0)
 			return 0;
 		col = rc;
 	}
 	TAILQ_FOREACH(ref, &up->crq, entries)
 		if (!OPTYPE_ISUNARY(ref->op)) {
-			if ((rc = gen_var
-			    (f, pos++, col, ref->field)) < 0)
+			if ((rc = gen_var(f, args,
+			    pos++, col, ref->field, 0)) < 0)
 				return 0;
 			col = rc;
 		}
@@ -712,8 +1213,12 @@ gen_update(FILE *f, const struct config *cfg,
 			return 0;
 	}
 
-	if (fputs(up->type == UP_MODIFY ? 
-	    "boolean" : "void", f) == EOF)
+	if (up->flags & UPDATE_RETURNING) {
+		if (fprintf(f, "ortns.%s[]|null", 
+		    up->parent->name) < 0)
+			return 0;
+	} else if (fputs(up->type == UP_MODIFY ? "boolean" : 
+	    up->batch > 0 ? "bigint" : "void", f) == EOF)
 		return 0;
 
 	/* Method body. */
@@ -721,14 +1226,19 @@ gen_update(FILE *f, const struct config *cfg,
 	if (fprintf(f, "\n"
 	    "\t{\n"
 	    "\t\tconst parms: any[] = [];\n"
-	    "\t\tlet info: Database.RunResult;\n"
+	    "\t\t%s\n"
 	    "\t\tconst stmt: Database.Statement =\n"
 	    "\t\t\tthis.#o.db.prepare(ortstmt.stmtBuilder\n"
 	    "\t\t\t(ortstmt.ortstmt.STMT_%s_%s_%zu));\n"
+	    "%s"
 	    "\n", 
+	    (up->flags & UPDATE_RETURNING) ? "let rows: any[];" : 
+	    up->batch > 0 ? "let total: bigint = BigInt(0);\n"
+	    "\t\tlet n: number;" : "let info: Database.RunResult;",
 	    up->parent->name,
 	    up->type == UP_MODIFY ? "UPDATE" : "DELETE",
-	    num) < 0)
+	    num, ((up->flags & UPDATE_RETURNING) || up->batch > 0) ?
+	    "\t\tstmt.raw(true);\n" : "") < 0)
 		return 0;
 
 	if ((rc = gen_rolemap(f, up->rolemap)) < 0)
@@ -748,18 +1258,8 @@ gen_update(FILE *f, const struct config *cfg,
 		switch (ref->field->type) {
 		case FTYPE_BIT:
 		case FTYPE_BITFIELD:
-			if (ref->field->flags & FIELD_NULL) {
-				if (fprintf(f, "\t\tparms.push"
-				    "(v%zu === null ? null : "
-				    "BigInt.asIntN(64, v%zu));\n",
-				    pos, pos) < 0)
-					return 0;
-			} else
-				if (fprintf(f, 
-				    "\t\tparms.push"
-				    "(BigInt.asIntN(64, v%zu));\n", 
-				    pos) < 0)
-					return 0;
+			if (!gen_push_bits(f, args, ref->field, pos))
+				return 0;
 			pos++;
 			continue;
 		case FTYPE_PASSWORD:
@@ -797,18 +1297,8 @@ gen_update(FILE *f, const struct config *cfg,
 		switch (ref->field->type) {
 		case FTYPE_BIT:
 		case FTYPE_BITFIELD:
-			if (ref->field->flags & FIELD_NULL) {
-				if (fprintf(f, "\t\tparms.push"
-				    "(v%zu === null ? null : "
-				    "BigInt.asIntN(64, v%zu));\n",
-				    pos, pos) < 0)
-					return 0;
-			} else
-				if (fprintf(f, 
-				    "\t\tparms.push"
-				    "(BigInt.asIntN(64, v%zu));\n", 
-				    pos) < 0)
-					return 0;
+			if (!gen_push_bits(f, args, ref->field, pos))
+				return 0;
 			pos++;
 			break;
 		default:
@@ -819,7 +1309,21 @@ gen_update(FILE *f, const struct config *cfg,
 		}
 	}
 
-	if (up->type == UP_MODIFY) {
+	if (!gen_cache_bump(f, cfg, up->parent))
+		return 0;
+
+	if (up->flags & UPDATE_RETURNING) {
+		if (fputs("\n"
+		    "\t\ttry {\n"
+		    "\t\t\trows = stmt.all(parms);\n"
+		    "\t\t} catch (er) {\n"
+		    "\t\t\treturn null;\n"
+		    "\t\t}\n"
+		    "\n", f) == EOF)
+			return 0;
+		if (!gen_fill_rows(f, up->parent))
+			return 0;
+	} else if (up->type == UP_MODIFY) {
 		if (fputs("\n"
 		    "\t\ttry {\n"
 		    "\t\t\tinfo = stmt.run(parms);\n"
@@ -829,6 +1333,14 @@ gen_update(FILE *f, const struct config *cfg,
 		    "\n"
 		    "\t\treturn true;\n", f) == EOF)
 			return 0;
+	} else if (up->batch > 0) {
+		if (fprintf(f, "\n"
+		    "\t\tdo {\n"
+		    "\t\t\tn = stmt.all(parms).length;\n"
+		    "\t\t\ttotal += BigInt(n);\n"
+		    "\t\t} while (n === %" PRId64 ");\n"
+		    "\t\treturn total;\n", up->batch) < 0)
+			return 0;
 	} else {
 		if (fputs("\n"
 		    "\t\tstmt.run(parms);\n", f) == EOF)
@@ -839,181 +1351,597 @@ gen_update(FILE *f, const struct config *cfg,
 }
 
 /*
- * Generate db_xxx_{get,count,list,iterate} method.
+ * Generate the body of a grouped count or aggregate method, which
+ * collects all groups into an array.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_query(FILE *f, const struct config *cfg,
-	const struct search *s, size_t num)
+gen_query_groupby(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s, const char *all)
 {
-	const struct sent	*sent;
-	const struct strct	*rs;
-	size_t			 pos, col, sz;
-	int		 	 hasunary = 0, rc;
-
-	/*
-	 * The "real struct" we'll return is either ourselves or the one
-	 * we reference with a distinct clause.
-	 */
-
-	rs = s->dst != NULL ? s->dst->strct : s->parent;
+	const struct field	*fd = s->groupby;
+	const char		*key, *val;
 
-	/* Do we document non-parameterised constraints? */
+	/* Enumerations are strings: see db_xxx_fill(). */
 
-	TAILQ_FOREACH(sent, &s->sntq, entries)
-		if (OPTYPE_ISUNARY(sent->op)) {
-			hasunary = 1;
-			break;
-		}
+	if (fd->type == FTYPE_ENUM)
+		key = "rows[i][0].toString()";
+	else if (fd->type == FTYPE_REAL || is_number(args, fd))
+		key = "Number(rows[i][0])";
+	else if (fd->type == FTYPE_TEXT || fd->type == FTYPE_EMAIL)
+		key = "<string>rows[i][0]";
+	else
+		key = "BigInt(rows[i][0])";
 
-	/* Print per-query-type method documentation. */
+	if (STYPE_ISAGGR(s->type) && (s->type == STYPE_AVG ||
+	    s->afield->type == FTYPE_REAL))
+		val = "Number(rows[i][1])";
+	else
+		val = "BigInt(rows[i][1])";
 
-	if (fputc('\n', f) == EOF)
+	if (fprintf(f, "\t\tconst rows: any[] = %s;\n"
+	    "\t\tconst objs: ortns.", all) < 0 ||
+	    gen_group_name(f, s) < 0)
 		return 0;
+	return fprintf(f, "[] = [];\n"
+	    "\t\tlet i: number;\n"
+	    "\n"
+	    "\t\tfor (i = 0; i < rows.length; i++)\n"
+	    "\t\t\tobjs.push({\n"
+	    "\t\t\t\tkey: %s,\n"
+	    "\t\t\t\tval: %s\n"
+	    "\t\t\t});\n"
+	    "\t\treturn objs;\n", key, val) > 0;
+}
 
-	if (s->doc != NULL) {
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG_OPEN, s->doc))
-			return 0;
-	} else if (s->type == STYPE_SEARCH) {
-		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
-		    "Search for a specific {@link ortns.%s}.", 
-		    rs->name))
-			return 0;
-	} else if (s->type == STYPE_LIST) {
-		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
-		    "Search for a set of {@link ortns.%s}.", 
-		    rs->name))
-			return 0;
-	} else if (s->type == STYPE_COUNT) {
-		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
-		    "Search result count of {@link ortns.%s}.", 
-		    rs->name))
-			return 0;
-	} else
-		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
-		    "Iterate results in {@link ortns.%s}.", 
-		    rs->name))
-			return 0;
-
-	if (s->dst != NULL) {
-		if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
-		    "This %s distinct query results.",
-		    s->type == STYPE_ITERATE ? "iterates over" : 
-		    s->type == STYPE_COUNT ? "counts" : "returns"))
-			return 0;
-		if (s->dst->strct != s->parent) 
-			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
-			    "The results are limited to "
-			    "{@link ortns.%sData.%s}, which is a "
-			    "{@link ortns.%sData}.",
-			    s->parent->name, s->dst->fname,
-			    s->dst->strct->name))
-				return 0;
-	}
+/*
+ * Print the method name of query "s".
+ * Return <0 on failure, otherwise the number of bytes written.
+ */
+static int
+gen_query_name(FILE *f, const struct search *s)
+{
+	const struct sent	*sent;
+	int			 rc, sz;
 
-	if (s->type == STYPE_ITERATE)
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
-		    "This callback function is called during an "
-		    "implicit transaction: thus, it should not "
-		    "invoke any database modifications or risk "
-		    "deadlock."))
-			return 0;
-	if (rs->flags & STRCT_HAS_NULLREFS)
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
-		    "This search involves nested null structure "
-		    "linking, which involves multiple database "
-		    "calls per invocation. Use this sparingly!"))
-			return 0;
+	if ((rc = fprintf(f, "db_%s_%s", 
+	    s->parent->name, stypes[s->type])) < 0)
+		return -1;
+	sz = rc;
 
-	if (hasunary) { 
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
-		    "The following fields are constrained by "
-		    "unary operations: "))
-			return 0;
-		TAILQ_FOREACH(sent, &s->sntq, entries) {
-			if (!OPTYPE_ISUNARY(sent->op))
-				continue;
-			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
-			    "%s (checked %s null)", sent->fname, 
-			    sent->op == OPTYPE_NOTNULL ? "not" : "is"))
-				return 0;
-		}
+	if (s->name == NULL && STYPE_ISAGGR(s->type)) {
+		if ((rc = fprintf(f, "_%s", s->afield->name)) < 0)
+			return -1;
+		sz += rc;
 	}
-
-	pos = 1;
-	TAILQ_FOREACH(sent, &s->sntq, entries) {
-		if (OPTYPE_ISUNARY(sent->op))
-			continue;
-		if (sent->field->type == FTYPE_PASSWORD) {
-			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
-			    "@param v%zu %s (hashed password)", 
-			    pos++, sent->fname))
-				return 0;
-		} else
-			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
-			    "@param v%zu %s", pos++, sent->fname))
-				return 0;
+	if (s->name == NULL && s->groupby != NULL) {
+		rc = fprintf(f, "_groupby_%s", s->groupby->name);
+		if (rc < 0)
+			return -1;
+		sz += rc;
 	}
 
-	if (s->type == STYPE_ITERATE)
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
-		    "@param cb Callback with retrieved data."))
-			return 0;
-
-	if (s->type == STYPE_SEARCH) {
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
-		    "@return Result or null if no results found."))
-			return 0;
-	} else if (s->type == STYPE_LIST) {
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
-		    "@return Result of null if no results found."))
-			return 0;
-	} else if (s->type == STYPE_COUNT)
-		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
-		    "@return Count of results."))
-			return 0;
-
-	if (fputc('\t', f) == EOF)
-		return 0;
-
-	if ((rc = fprintf(f, "db_%s_%s", 
-	    s->parent->name, stypes[s->type])) < 0)
-		return 0;
-	col = 8 + rc;
-
 	if (s->name == NULL && !TAILQ_EMPTY(&s->sntq)) {
 		if ((rc = fprintf(f, "_by")) < 0)
-			return 0;
-		col += rc;
+			return -1;
+		sz += rc;
 		TAILQ_FOREACH(sent, &s->sntq, entries) {
 			if ((rc = fprintf(f, "_%s_%s", 
 			    sent->uname, optypes[sent->op])) < 0)
-				return 0;
-			col += rc;
+				return -1;
+			sz += rc;
 		}
 	} else if (s->name != NULL) {
 		if ((rc = fprintf(f, "_%s", s->name)) < 0)
-			return 0;
-		col += rc;
+			return -1;
+		sz += rc;
 	}
 
-	if (col >= 72) {
-		if (fputs("\n\t(", f) == EOF)
-			return 0;
-		col = 9;
-	} else {
-		if (fputc('(', f) == EOF)
-			return 0;
-		col++;
-	}
+	return sz;
+}
+
+/*
+ * Generate the parameters bound to query "s" from its arguments.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_query_parms(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s)
+{
+	const struct sent	*sent;
+	size_t			 pos;
 
 	pos = 1;
-	TAILQ_FOREACH(sent, &s->sntq, entries)
-		if (!OPTYPE_ISUNARY(sent->op)) {
-			if ((rc = gen_var
-			    (f, pos++, col, sent->field)) < 0)
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
+		if (OPTYPE_ISUNARY(sent->op))
+			continue;
+
+		if (sent->op == OPTYPE_IN) {
+			if (fputs("\t\tparms.push(", f) == EOF ||
+			    !gen_set_json(f, args, sent->field, pos) ||
+			    fputs(");\n", f) == EOF)
 				return 0;
-			col = rc;
+			pos++;
+			continue;
+		}
+
+		/* 
+		 * Passwords are special-cased below the switch (unless
+		 * they're streq/strneq) and we need to convert
+		 * bitfields (individual bits and named fields) into a
+		 * signed representation: unsigned can exceed range.
+		 */
+
+		switch (sent->field->type) {
+		case FTYPE_BIT:
+		case FTYPE_BITFIELD:
+			if (!gen_push_bits(f, args, sent->field, pos))
+				return 0;
+			pos++;
+			continue;
+		case FTYPE_PASSWORD:
+			if (sent->op != OPTYPE_STREQ &&
+			    sent->op != OPTYPE_STRNEQ)
+				break;
+			/* FALLTHROUGH */
+		default:
+			if (fprintf(f, 
+			    "\t\tparms.push(v%zu);\n", pos++) < 0)
+				return 0;
+			continue;
+		}
+
+		if (sent->field->flags & FIELD_NULL) {
+			if (fprintf(f, "\t\tif (v%zu === null)\n"
+			    "\t\t\tparms.push(null);\n"
+			    "\t\telse\n"
+			    "\t\t\tparms.push(bcrypt.hashSync"
+			    "(v%zu, bcrypt.genSaltSync()));\n", 
+			    pos, pos) < 0)
+				return 0;
+		} else {
+			if (fprintf(f, "\t\tparms.push(bcrypt.hashSync"
+			    "(v%zu, bcrypt.genSaltSync()));\n", 
+			    pos) < 0)
+				return 0;
+		}
+		pos++;
+	}
+	
+	if (pos > 1 && fputc('\n', f) == EOF)
+		return 0;
+	return 1;
+}
+
+/*
+ * Generate the asynchronous variant of iterate query "s", which yields
+ * each result and returns to the event loop between batches.
+ * It runs on its own read-only connection, as better-sqlite3 doesn't
+ * allow other statements on a connection with an open iterator.
+ * With ORT_LANG_NODEJS_POOL, that's the connection of a pool worker;
+ * otherwise it's from ortdb's connectReadonly().
+ * The role is checked when the iterator is created.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_iterate_async(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s, size_t num)
+{
+	const struct sent	*sent;
+	const struct strct	*rs;
+	size_t			 pos, col;
+	int			 rc;
+
+	assert(s->type == STYPE_ITERATE);
+	rs = s->dst != NULL ? s->dst->strct : s->parent;
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+	    "Asynchronously iterate results in {@link ortns.%s}.",
+	    rs->name))
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+	    (args->flags & ORT_LANG_NODEJS_POOL) ?
+	    "This is the same query as the synchronous variant, "
+	    "but rows are read by the worker pool, see {@link "
+	    "ortpool}, so it doesn't see uncommitted changes of "
+	    "an open transaction.  Rows are read in batches, "
+	    "returning to the event loop between them, and only "
+	    "as the results are consumed.  Use `Readable.from()` "
+	    "for a stream." :
+	    "This is the same query as the synchronous variant, "
+	    "but rows are read with a separate read-only database "
+	    "connection, so it doesn't see uncommitted changes of "
+	    "an open transaction.  Rows are read in batches, "
+	    "returning to the event loop between them, and only "
+	    "as the results are consumed.  Use `Readable.from()` "
+	    "for a stream."))
+		return 0;
+
+	pos = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
+		if (OPTYPE_ISUNARY(sent->op))
+			continue;
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+		    "@param v%zu %s%s", pos++, sent->fname,
+		    sent->field->type == FTYPE_PASSWORD ?
+		    " (hashed password)" :
+		    sent->op == OPTYPE_IN ? " (set of values)" : ""))
+			return 0;
+	}
+	if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+	    "@param batch Number of rows read before returning to "
+	    "the event loop."))
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+	    "@return Iterator over the results."))
+		return 0;
+
+	if (fputc('\t', f) == EOF)
+		return 0;
+	if ((rc = gen_query_name(f, s)) < 0)
+		return 0;
+	if (fputs("_async", f) == EOF)
+		return 0;
+	col = 14 + rc;
+
+	if (col >= 72) {
+		if (fputs("\n\t(", f) == EOF)
+			return 0;
+		col = 9;
+	} else {
+		if (fputc('(', f) == EOF)
+			return 0;
+		col++;
+	}
+
+	pos = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries)
+		if (!OPTYPE_ISUNARY(sent->op)) {
+			if ((rc = gen_var(f, args, pos++, col, sent->field, 
+			    sent->op == OPTYPE_IN)) < 0)
+				return 0;
+			col = rc;
+		}
+
+	if (pos > 1 && fputc(',', f) == EOF)
+		return 0;
+	if (col + 24 >= 72) {
+		if (fputs("\n\t\t", f) == EOF)
+			return 0;
+	} else if (pos > 1 && fputc(' ', f) == EOF)
+		return 0;
+
+	/*
+	 * Check the role and bind the parameters when the iterator is
+	 * created, not when it's first advanced, then return a
+	 * generator over the results.
+	 */
+
+	if (fprintf(f, "batch: number = 1000):\n"
+	    "\t\tAsyncIterableIterator<ortns.%s>\n"
+	    "\t{\n"
+	    "\t\tconst ctx: ortctx = this;\n"
+	    "\t\tconst parms: any[] = [];\n", rs->name) < 0)
+		return 0;
+	if (fprintf(f, "\t\tconst sql: string = ortstmt.stmtBuilder\n"
+	    "\t\t\t(ortstmt.ortstmt.STMT_%s_BY_SEARCH_%zu);\n"
+	    "\n", s->parent->name, num) < 0)
+		return 0;
+	if ((rc = gen_rolemap(f, s->rolemap)) < 0)
+		return 0;
+	else if (rc > 0 && fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_query_parms(f, args, s))
+		return 0;
+	if (fprintf(f, "\t\treturn (async function *():\n"
+	    "\t\t    AsyncIterableIterator<ortns.%s> {\n",
+	    rs->name) < 0)
+		return 0;
+
+	if (args->flags & ORT_LANG_NODEJS_POOL) {
+		if (fprintf(f, "\t\t\tfor await (const cols of "
+		    "ctx.#o.pool.iterate\n"
+		    "\t\t\t\t(sql, parms, batch)) {\n"
+		    "\t\t\t\tconst obj: ortns.%sData =\n"
+		    "\t\t\t\t\tctx.db_%s_fill"
+		    "(<any[]>cols);\n",
+		    rs->name, rs->name) < 0)
+			return 0;
+		if ((rs->flags & STRCT_HAS_NULLREFS) && fprintf(f, 
+		    "\t\t\t\tctx.db_%s_reffind(ctx.#o, obj);\n",
+		    rs->name) < 0)
+			return 0;
+		return fprintf(f, 
+		    "\t\t\t\tyield new ortns.%s(ctx.#role, obj);\n"
+		    "\t\t\t}\n"
+		    "\t\t})();\n"
+		    "\t}\n", rs->name) > 0;
+	}
+
+	if (fprintf(f, "\t\t\tconst db: Database.Database =\n"
+	    "\t\t\t\tctx.#o.connectReadonly();\n"
+	    "\t\t\tlet n: number = 0;\n"
+	    "\t\t\ttry {\n"
+	    "\t\t\t\tconst stmt: Database.Statement =\n"
+	    "\t\t\t\t\tdb.prepare(sql);\n"
+	    "\t\t\t\tstmt.raw(true);\n"
+	    "\t\t\t\tfor (const cols of stmt.iterate(parms)) {\n"
+	    "\t\t\t\t\tconst obj: ortns.%sData =\n"
+	    "\t\t\t\t\t\tctx.db_%s_fill"
+	    "(<any[]>cols);\n",
+	    rs->name, rs->name) < 0)
+		return 0;
+	if ((rs->flags & STRCT_HAS_NULLREFS) && fprintf(f, 
+	    "\t\t\t\t\tctx.db_%s_reffind(ctx.#o, obj);\n",
+	    rs->name) < 0)
+		return 0;
+	return fprintf(f, 
+	    "\t\t\t\t\tyield new ortns.%s(ctx.#role, obj);\n"
+	    "\t\t\t\t\tif (++n %% batch === 0)\n"
+	    "\t\t\t\t\t\tawait new Promise(resolve =>\n"
+	    "\t\t\t\t\t\t\tsetImmediate(resolve));\n"
+	    "\t\t\t\t}\n"
+	    "\t\t\t} finally {\n"
+	    "\t\t\t\tdb.close();\n"
+	    "\t\t\t}\n"
+	    "\t\t})();\n"
+	    "\t}\n", rs->name) > 0;
+}
+
+/*
+ * Generate the body of a list query (or batched lookup) whose statement
+ * has been prepared and whose parameters are "parms".
+ * Nested null references are looked up in batch over all results.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_list_reffind(FILE *f, const struct strct *rs, const char *all)
+{
+
+	if (fprintf(f, 
+	    "\t\tconst rows: any[] = %s;\n", all) < 0)
+		return 0;
+	return gen_fill_rows(f, rs);
+}
+
+/*
+ * Generate db_xxx_{get,count,list,iterate} method, reading all rows
+ * with the "all" expression and the first row with "get".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_query_method(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s, size_t num, int async,
+	const char *all, const char *get)
+{
+	const struct sent	*sent;
+	const struct strct	*rs;
+	size_t			 pos, col, sz;
+	int		 	 hasunary = 0, rc, real = 0;
+
+	/*
+	 * The "real struct" we'll return is either ourselves or the one
+	 * we reference with a distinct clause.
+	 */
+
+	rs = s->dst != NULL ? s->dst->strct : s->parent;
+
+	/* Aggregates are either bigint or (averages, reals) number. */
+
+	if (STYPE_ISAGGR(s->type))
+		real = s->type == STYPE_AVG ||
+			s->afield->type == FTYPE_REAL;
+
+	/* Do we document non-parameterised constraints? */
+
+	TAILQ_FOREACH(sent, &s->sntq, entries)
+		if (OPTYPE_ISUNARY(sent->op)) {
+			hasunary = 1;
+			break;
+		}
+
+	/* Print per-query-type method documentation. */
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+
+	if (s->doc != NULL) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_OPEN, s->doc))
+			return 0;
+	} else if (s->type == STYPE_SEARCH) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search for a specific {@link ortns.%s}.", 
+		    rs->name))
+			return 0;
+	} else if (s->type == STYPE_LIST) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search for a set of {@link ortns.%s}.", 
+		    rs->name))
+			return 0;
+	} else if (s->type == STYPE_COUNT && s->groupby != NULL) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search result count of {@link ortns.%s} grouped "
+		    "by {@link ortns.%sData.%s}.", rs->name,
+		    rs->name, s->groupby->name))
+			return 0;
+	} else if (s->type == STYPE_COUNT) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search result count of {@link ortns.%s}.", 
+		    rs->name))
+			return 0;
+	} else if (s->type == STYPE_EXISTS) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Check for any search results in {@link "
+		    "ortns.%s}.", rs->name))
+			return 0;
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    "This stops at the first matching row."))
+			return 0;
+	} else if (STYPE_ISAGGR(s->type) && s->groupby != NULL) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search result %s of {@link ortns.%sData.%s} "
+		    "grouped by {@link ortns.%sData.%s}.", 
+		    s->type == STYPE_SUM ? "sum" :
+		    s->type == STYPE_AVG ? "average" :
+		    s->type == STYPE_MIN ? "minimum" : "maximum",
+		    rs->name, s->afield->name, 
+		    rs->name, s->groupby->name))
+			return 0;
+	} else if (STYPE_ISAGGR(s->type)) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Search result %s of {@link ortns.%sData.%s}.", 
+		    s->type == STYPE_SUM ? "sum" :
+		    s->type == STYPE_AVG ? "average" :
+		    s->type == STYPE_MIN ? "minimum" : "maximum",
+		    rs->name, s->afield->name))
+			return 0;
+	} else
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+		    "Iterate results in {@link ortns.%s}.", 
+		    rs->name))
+			return 0;
+
+	if (s->dst != NULL) {
+		if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+		    "This %s distinct query results.",
+		    s->type == STYPE_ITERATE ? "iterates over" : 
+		    s->type == STYPE_COUNT ? "counts" : "returns"))
+			return 0;
+		if (s->dst->strct != s->parent) 
+			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+			    "The results are limited to "
+			    "{@link ortns.%sData.%s}, which is a "
+			    "{@link ortns.%sData}.",
+			    s->parent->name, s->dst->fname,
+			    s->dst->strct->name))
+				return 0;
+	}
+
+	if (async)
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    "This runs with the worker pool, see {@link "
+		    "ortpool}, so it doesn't see uncommitted changes "
+		    "of an open transaction."))
+			return 0;
+	if (s->flags & SEARCH_CACHE)
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    async ?
+		    "Results are cached by parameters, see {@link "
+		    "ortcache}, until the queried tables change, but "
+		    "not while a transaction is open." :
+		    "Results are cached by parameters, see {@link "
+		    "ortcache}, until the queried tables change."))
+			return 0;
+	if (s->type == STYPE_ITERATE)
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    "This callback function is called during an "
+		    "implicit transaction: thus, it should not "
+		    "invoke any database modifications or risk "
+		    "deadlock."))
+			return 0;
+	if ((rs->flags & STRCT_HAS_NULLREFS) && s->type != STYPE_EXISTS)
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    "This search involves nested null structure "
+		    "linking, which involves multiple database "
+		    "calls per invocation. Use this sparingly!"))
+			return 0;
+
+	if (hasunary) { 
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+		    "The following fields are constrained by "
+		    "unary operations: "))
+			return 0;
+		TAILQ_FOREACH(sent, &s->sntq, entries) {
+			if (!OPTYPE_ISUNARY(sent->op))
+				continue;
+			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+			    "%s (checked %s null)", sent->fname, 
+			    sent->op == OPTYPE_NOTNULL ? "not" : "is"))
+				return 0;
+		}
+	}
+
+	pos = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries) {
+		if (OPTYPE_ISUNARY(sent->op))
+			continue;
+		if (sent->field->type == FTYPE_PASSWORD) {
+			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+			    "@param v%zu %s (hashed password)", 
+			    pos++, sent->fname))
+				return 0;
+		} else if (sent->op == OPTYPE_IN) {
+			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+			    "@param v%zu %s (set of values)", 
+			    pos++, sent->fname))
+				return 0;
+		} else
+			if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+			    "@param v%zu %s", pos++, sent->fname))
+				return 0;
+	}
+
+	if (s->type == STYPE_ITERATE)
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@param cb Callback with retrieved data."))
+			return 0;
+
+	if (s->type == STYPE_SEARCH) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Result or null if no results found."))
+			return 0;
+	} else if (s->type == STYPE_LIST) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Result of null if no results found."))
+			return 0;
+	} else if (s->groupby != NULL) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Groups, which may be empty."))
+			return 0;
+	} else if (s->type == STYPE_COUNT) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Count of results."))
+			return 0;
+	} else if (s->type == STYPE_EXISTS) {
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Whether there are any results."))
+			return 0;
+	} else if (STYPE_ISAGGR(s->type))
+		if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+		    "@return Result or null if there were no "
+		    "non-null values (e.g., no results)."))
+			return 0;
+
+	if (fputs(async ? "\tasync " : "\t", f) == EOF)
+		return 0;
+
+	if ((rc = gen_query_name(f, s)) < 0)
+		return 0;
+	col = 8 + rc;
+	if (async && fputs("_async", f) == EOF)
+		return 0;
+	if (async)
+		col += 12;
+
+	if (col >= 72) {
+		if (fputs("\n\t(", f) == EOF)
+			return 0;
+		col = 9;
+	} else {
+		if (fputc('(', f) == EOF)
+			return 0;
+		col++;
+	}
+
+	pos = 1;
+	TAILQ_FOREACH(sent, &s->sntq, entries)
+		if (!OPTYPE_ISUNARY(sent->op)) {
+			if ((rc = gen_var(f, args, pos++, col, sent->field, 
+			    sent->op == OPTYPE_IN)) < 0)
+				return 0;
+			col = rc;
 		}
 
 	if (s->type == STYPE_ITERATE) {
@@ -1038,120 +1966,101 @@ gen_query(FILE *f, const struct config *cfg,
 	if (fputs("): ", f) == EOF)
 		return 0;
 
-	if (s->type == STYPE_SEARCH)
+	if (s->groupby != NULL)
+		sz = strlen(rs->name) + strlen(s->groupby->name) + 
+			(STYPE_ISAGGR(s->type) ? 
+			 strlen(s->afield->name) + 1 : 0) + 22;
+	else if (s->type == STYPE_SEARCH)
 		sz = strlen(rs->name) + 11;
 	else if (s->type == STYPE_LIST)
 		sz = strlen(rs->name) + 8;
 	else if (s->type == STYPE_ITERATE)
 		sz = 4;
+	else if (s->type == STYPE_EXISTS)
+		sz = 7;
+	else if (STYPE_ISAGGR(s->type))
+		sz = 11;
 	else
 		sz = 6;
 
+	if (async)
+		sz += 9;
 	if (col + sz >= 72 && fputs("\n\t\t", f) == EOF)
 		return 0;
+	if (async && fputs("Promise<", f) == EOF)
+		return 0;
 
-	if (s->type == STYPE_SEARCH) {
-		if (fprintf(f, "ortns.%s|null\n", rs->name) < 0)
+	if (s->groupby != NULL) {
+		if (fputs("ortns.", f) == EOF ||
+		    gen_group_name(f, s) < 0 ||
+		    fputs("[]", f) == EOF)
+			return 0;
+	} else if (s->type == STYPE_SEARCH) {
+		if (fprintf(f, "ortns.%s|null", rs->name) < 0)
 			return 0;
 	} else if (s->type == STYPE_LIST) {
-		if (fprintf(f, "ortns.%s[]\n", rs->name) < 0)
+		if (fprintf(f, "ortns.%s[]", rs->name) < 0)
 			return 0;
 	} else if (s->type == STYPE_ITERATE) {
-		if (fputs("void\n", f) == EOF)
+		if (fputs("void", f) == EOF)
+			return 0;
+	} else if (s->type == STYPE_EXISTS) {
+		if (fputs("boolean", f) == EOF)
+			return 0;
+	} else if (STYPE_ISAGGR(s->type)) {
+		if (fprintf(f, "%s|null", real ? 
+		    "number" : "bigint") < 0)
 			return 0;
 	} else {
-		if (fputs("bigint\n", f) == EOF)
+		if (fputs("bigint", f) == EOF)
 			return 0;
 	}
 
-	if (fputs("\t{\n", f) == EOF)
+	if (fputs(async ? ">\n" : "\n", f) == EOF)
 		return 0;
 
-	/* Now generate the method body. */
-
-	if (fprintf(f, "\t\tconst parms: any[] = [];\n"
-	    "\t\tconst stmt: Database.Statement =\n"
-	    "\t\t\tthis.#o.db.prepare(ortstmt.stmtBuilder\n"
-	    "\t\t\t(ortstmt.ortstmt.STMT_%s_BY_SEARCH_%zu));\n"
-	    "\t\tstmt.raw(true);\n"
-	    "\n", s->parent->name, num) < 0)
-		return 0;
-	if ((rc = gen_rolemap(f, s->rolemap)) < 0)
-		return 0;
-	else if (rc > 0 && fputc('\n', f) == EOF)
+	if (fputs("\t{\n", f) == EOF)
 		return 0;
 
-	pos = 1;
-	TAILQ_FOREACH(sent, &s->sntq, entries) {
-		if (OPTYPE_ISUNARY(sent->op))
-			continue;
-
-		/* 
-		 * Passwords are special-cased below the switch (unless
-		 * they're streq/strneq) and we need to convert
-		 * bitfields (individual bits and named fields) into a
-		 * signed representation: unsigned can exceed range.
-		 */
-
-		switch (sent->field->type) {
-		case FTYPE_BIT:
-		case FTYPE_BITFIELD:
-			if (sent->field->flags & FIELD_NULL) {
-				if (fprintf(f, "\t\tparms.push"
-				    "(v%zu === null ? null : "
-				    "BigInt.asIntN(64, v%zu));\n",
-				    pos, pos) < 0)
-					return 0;
-			} else
-				if (fprintf(f, 
-				    "\t\tparms.push"
-				    "(BigInt.asIntN(64, v%zu));\n", 
-				    pos) < 0)
-					return 0;
-			pos++;
-			continue;
-		case FTYPE_PASSWORD:
-			if (sent->op != OPTYPE_STREQ &&
-			    sent->op != OPTYPE_STRNEQ)
-				break;
-			/* FALLTHROUGH */
-		default:
-			if (fprintf(f, 
-			    "\t\tparms.push(v%zu);\n", pos++) < 0)
-				return 0;
-			continue;
-		}
+	/* Now generate the method body. */
 
-		if (sent->field->flags & FIELD_NULL) {
-			if (fprintf(f, "\t\tif (v%zu === null)\n"
-			    "\t\t\tparms.push(null);\n"
-			    "\t\telse\n"
-			    "\t\t\tparms.push(bcrypt.hashSync"
-			    "(v%zu, bcrypt.genSaltSync()));\n", 
-			    pos, pos) < 0)
-				return 0;
-		} else {
-			if (fprintf(f, "\t\tparms.push(bcrypt.hashSync"
-			    "(v%zu, bcrypt.genSaltSync()));\n", 
-			    pos) < 0)
-				return 0;
-		}
-		pos++;
+	if (async || (s->flags & SEARCH_CACHE)) {
+		if (fprintf(f, "\t\tconst parms: any[] = [];\n"
+		    "\t\tconst sql: string = ortstmt.stmtBuilder\n"
+		    "\t\t\t(ortstmt.ortstmt.STMT_%s_BY_SEARCH_%zu);\n"
+		    "\n", s->parent->name, num) < 0)
+			return 0;
+	} else {
+		if (fprintf(f, "\t\tconst parms: any[] = [];\n"
+		    "\t\tconst stmt: Database.Statement =\n"
+		    "\t\t\tthis.#o.db.prepare(ortstmt.stmtBuilder\n"
+		    "\t\t\t(ortstmt.ortstmt.STMT_%s_BY_SEARCH_%zu));\n"
+		    "\t\tstmt.raw(true);\n"
+		    "\n", s->parent->name, num) < 0)
+			return 0;
 	}
-	
-	if (pos > 1 && fputc('\n', f) == EOF)
+	if ((rc = gen_rolemap(f, s->rolemap)) < 0)
+		return 0;
+	else if (rc > 0 && fputc('\n', f) == EOF)
+		return 0;
+
+	if (!gen_query_parms(f, args, s))
 		return 0;
 
+	if (s->groupby != NULL)
+		return gen_query_groupby(f, args, s, all) &&
+			fputs("\t}\n", f) != EOF;
+
 	switch (s->type) {
 	case STYPE_SEARCH:
-		if (fprintf(f, "\t\tconst cols: any = stmt.get(parms);\n"
+		if (fprintf(f, "\t\tconst cols: any = %s;\n"
 		    "\n"
 		    "\t\tif (typeof cols === 'undefined')\n"
 		    "\t\t\treturn null;\n"
 		    "\t\tconst obj: ortns.%sData = \n"
 		    "\t\t\tthis.db_%s_fill"
-		    "({row: <any[]>cols, pos: 0});\n",
-		    rs->name, rs->name) < 0)
+		    "(<any[]>cols);\n",
+		    get, rs->name, rs->name) < 0)
 			return 0;
 		if (rs->flags & STRCT_HAS_NULLREFS) {
 		       if (fprintf(f, "\t\tthis.db_%s_reffind"
@@ -1167,7 +2076,7 @@ gen_query(FILE *f, const struct config *cfg,
 		    "\t\tfor (const cols of stmt.iterate(parms)) {\n"
 		    "\t\t\tconst obj: ortns.%sData =\n"
 		    "\t\t\t\tthis.db_%s_fill"
-		    "({row: <any>cols, pos: 0});\n",
+		    "(<any[]>cols);\n",
 		    rs->name, rs->name) < 0)
 			return 0;
 		if (rs->flags & STRCT_HAS_NULLREFS) {
@@ -1181,22 +2090,22 @@ gen_query(FILE *f, const struct config *cfg,
 			return 0;
 		break;
 	case STYPE_LIST:
+		if (rs->flags & STRCT_HAS_NULLREFS) {
+			if (!gen_list_reffind(f, rs, all))
+				return 0;
+			break;
+		}
 		if (fprintf(f, 
-		    "\t\tconst rows: any[] = stmt.all(parms);\n"
+		    "\t\tconst rows: any[] = %s;\n"
 		    "\t\tconst objs: ortns.%s[] = [];\n"
 		    "\t\tlet i: number;\n"
 		    "\n"
 		    "\t\tfor (i = 0; i < rows.length; i++) {\n"
 		    "\t\t\tconst obj: ortns.%sData =\n"
 		    "\t\t\t\tthis.db_%s_fill"
-		    "({row: <any[]>rows[i], pos: 0});\n",
-		    rs->name, rs->name, rs->name) < 0)
+		    "(<any[]>rows[i]);\n",
+		    all, rs->name, rs->name, rs->name) < 0)
 			return 0;
-		if (rs->flags & STRCT_HAS_NULLREFS) {
-			if (fprintf(f, "\t\t\tthis.db_%s_reffind"
-			    "(this.#o, obj);\n", rs->name) < 0)
-				return 0;
-		}
 		if (fprintf(f, 
 		    "\t\t\tobjs.push(new ortns.%s(this.#role, obj));\n"
 		    "\t\t}\n"
@@ -1205,11 +2114,35 @@ gen_query(FILE *f, const struct config *cfg,
 		break;
 	case STYPE_COUNT:
 		if (fprintf(f, 
-		    "\t\tconst cols: any = stmt.get(parms);\n"
+		    "\t\tconst cols: any = %s;\n"
 		    "\n"
 		    "\t\tif (typeof cols === 'undefined')\n"
 		    "\t\t\tthrow \'count returned no result!?\';\n"
-		    "\t\treturn BigInt(cols[0]);\n") < 0)
+		    "\t\treturn BigInt(cols[0]);\n", get) < 0)
+			return 0;
+		break;
+	case STYPE_EXISTS:
+		if (fprintf(f, 
+		    "\t\tconst cols: any = %s;\n"
+		    "\n"
+		    "\t\tif (typeof cols === 'undefined')\n"
+		    "\t\t\tthrow \'exists returned no result!?\';\n"
+		    "\t\treturn BigInt(cols[0]) !== BigInt(0);\n", get) < 0)
+			return 0;
+		break;
+	case STYPE_SUM:
+	case STYPE_AVG:
+	case STYPE_MIN:
+	case STYPE_MAX:
+		if (fprintf(f, 
+		    "\t\tconst cols: any = %s;\n"
+		    "\n"
+		    "\t\tif (typeof cols === 'undefined')\n"
+		    "\t\t\tthrow \'%s returned no result!?\';\n"
+		    "\t\tif (cols[0] === null)\n"
+		    "\t\t\treturn null;\n"
+		    "\t\treturn %s(cols[0]);\n", get, stypes[s->type],
+		    real ? "Number" : "BigInt") < 0)
 			return 0;
 		break;
 	default:
@@ -1219,38 +2152,195 @@ gen_query(FILE *f, const struct config *cfg,
 	return fputs("\t}\n", f) != EOF;
 }
 
+/*
+ * Generate db_xxx_{get,count,list,iterate} method.
+ * Asynchronous variants run with the worker pool.
+ * Cached queries go through the ortdb cache, which only prepares and
+ * runs the statement when there's no current entry.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_query(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s, size_t num, int async)
+{
+	char	*all = NULL, *get = NULL;
+	int	 rc;
+
+	assert(!async || s->type != STYPE_ITERATE);
+
+	if (!(s->flags & SEARCH_CACHE))
+		return async ?
+			gen_query_method(f, args, s, num, async,
+			    "await this.#o.pool.all(sql, parms)",
+			    "await this.#o.pool.get(sql, parms)") :
+			gen_query_method(f, args, s, num, async,
+			    "stmt.all(parms)", "stmt.get(parms)");
+
+	/*
+	 * The pool doesn't see the uncommitted changes of an open
+	 * transaction, which the main connection (and thus cached
+	 * entries) may, so don't use the cache in that case.
+	 */
+
+	if (async) {
+		rc = asprintf(&all, "this.#o.db.inTransaction ?\n"
+		    "\t\t\tawait this.#o.pool.all(sql, parms) :\n"
+		    "\t\t\tawait this.#o.cache.getAsync(\'%s:%zu\',\n"
+		    "\t\t\tortcachetab.%s_read, parms,\n"
+		    "\t\t\t() => this.#o.pool.all(sql, parms))",
+		    s->parent->name, num, s->parent->name);
+		if (rc != -1)
+			rc = asprintf(&get, 
+			    "this.#o.db.inTransaction ?\n"
+			    "\t\t\tawait this.#o.pool.get(sql, parms) :\n"
+			    "\t\t\tawait this.#o.cache.getAsync"
+			    "(\'%s:%zu\',\n"
+			    "\t\t\tortcachetab.%s_read, parms,\n"
+			    "\t\t\t() => this.#o.pool.get(sql, parms))",
+			    s->parent->name, num, s->parent->name);
+	} else {
+		rc = asprintf(&all, "this.#o.cache.get(\'%s:%zu\',\n"
+		    "\t\t\tortcachetab.%s_read, parms,\n"
+		    "\t\t\t() => this.#o.db.prepare(sql)"
+		    ".raw(true).all(parms))",
+		    s->parent->name, num, s->parent->name);
+		if (rc != -1)
+			rc = asprintf(&get, "this.#o.cache.get"
+			    "(\'%s:%zu\',\n"
+			    "\t\t\tortcachetab.%s_read, parms,\n"
+			    "\t\t\t() => this.#o.db.prepare(sql)"
+			    ".raw(true).get(parms))",
+			    s->parent->name, num, s->parent->name);
+	}
+
+	rc = rc != -1 &&
+		gen_query_method(f, args, s, num, async, all, get);
+	free(all);
+	free(get);
+	return rc;
+}
+
+/*
+ * Generate the db_xxx_get_many_by_yyy method, which looks up all rows
+ * matching a set of values of the rowid or unique field "fd".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_get_many(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd)
+{
+	const struct strct	*p = fd->parent;
+	size_t			 col;
+	int			 rc;
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_commentv(f, 1, COMMENT_JS_FRAG_OPEN,
+	    "Look up all {@link ortns.%s} whose {@link "
+	    "ortns.%sData.%s} is any of the given values with a "
+	    "single query.", p->name, p->name, fd->name))
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS_FRAG,
+	    "This may be invoked by any role."))
+		return 0;
+	if (!gen_commentv(f, 1, COMMENT_JS_FRAG,
+	    "@param v1 %s (set of values)", fd->name))
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS_FRAG_CLOSE,
+	    "@return Results ordered by value, which may be empty."))
+		return 0;
+
+	if ((rc = fprintf(f, "\tdb_%s_get_many_by_%s", 
+	    p->name, fd->name)) < 0)
+		return 0;
+	col = 8 + rc;
+
+	if (col >= 72) {
+		if (fputs("\n\t(", f) == EOF)
+			return 0;
+		col = 9;
+	} else {
+		if (fputc('(', f) == EOF)
+			return 0;
+		col++;
+	}
+
+	if ((rc = gen_var(f, args, 1, col, fd, 1)) < 0)
+		return 0;
+	col = rc;
+
+	if (fputs("): ", f) == EOF)
+		return 0;
+	if (col + strlen(p->name) + 8 >= 72 && 
+	    fputs("\n\t\t", f) == EOF)
+		return 0;
+
+	if (fprintf(f, "ortns.%s[]\n"
+	    "\t{\n"
+	    "\t\tconst stmt: Database.Statement =\n"
+	    "\t\t\tthis.#o.db.prepare(ortstmt.stmtBuilder\n"
+	    "\t\t\t(ortstmt.ortstmt.STMT_%s_BY_UNIQUE_MANY_%s));\n"
+	    "\t\tstmt.raw(true);\n"
+	    "\t\tconst parm: string = ", 
+	    p->name, p->name, fd->name) < 0)
+		return 0;
+	if (!gen_set_json(f, args, fd, 1) || fputs(";\n\n", f) == EOF)
+		return 0;
+	if (!gen_list_reffind(f, p, "stmt.all(parm)"))
+		return 0;
+
+	return fputs("\t}\n", f) != EOF;
+}
+
 /*
  * Generate the database functions for a structure.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_api(FILE *f, const struct config *cfg, const struct strct *p)
+gen_api(FILE *f, const struct config *cfg,
+	const struct ort_lang_nodejs *args, const struct strct *p)
 {
+	const struct field	*fd;
 	const struct search	*s;
 	const struct update	*u;
 	size_t			 pos;
 
-	if (!gen_fill(f, p))
+	if (!gen_fill(f, args, p))
 		return 0;
 	if (!gen_reffind(f, p))
 		return 0;
+	if (!gen_reffind_many(f, args, p))
+		return 0;
 
-	if (p->ins != NULL && !gen_insert(f, p))
+	if (p->ins != NULL && !gen_insert(f, cfg, args, p))
 		return 0;
 
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (gen_sql_unique_many(fd) && !gen_get_many(f, args, fd))
+			return 0;
+
 	pos = 0;
-	TAILQ_FOREACH(s, &p->sq, entries)
-		if (!gen_query(f, cfg, s, pos++))
+	TAILQ_FOREACH(s, &p->sq, entries) {
+		if (!gen_query(f, args, s, pos, 0))
 			return 0;
+		if ((args->flags & ORT_LANG_NODEJS_POOL) &&
+		    s->type != STYPE_ITERATE &&
+		    !gen_query(f, args, s, pos, 1))
+			return 0;
+		if (s->type == STYPE_ITERATE &&
+		    !gen_iterate_async(f, args, s, pos))
+			return 0;
+		pos++;
+	}
 
 	pos = 0;
 	TAILQ_FOREACH(u, &p->dq, entries)
-		if (!gen_update(f, cfg, u, pos++))
+		if (!gen_update(f, cfg, args, u, pos++))
 			return 0;
 
 	pos = 0;
 	TAILQ_FOREACH(u, &p->uq, entries)
-		if (!gen_update(f, cfg, u, pos++))
+		if (!gen_update(f, cfg, args, u, pos++))
 			return 0;
 
 	return 1;
@@ -1289,40 +2379,292 @@ gen_bitf(FILE *f, const struct bitf *p, size_t pos)
 			return 0;
 	}
 
-	return fputs("\t}\n", f) != EOF;
+	return fputs("\t}\n", f) != EOF;
+}
+
+/*
+ * Generate an enumeration.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_enm(FILE *f, const struct enm *p, size_t pos)
+{
+	const struct eitem	*ei;
+
+	if (pos > 0 && fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS, p->doc))
+		return 0;
+
+	if (fprintf(f, "\texport enum %s {\n", p->name) < 0)
+		return 0;
+
+	TAILQ_FOREACH(ei, &p->eq, entries) {
+		if (!gen_comment(f, 2, COMMENT_JS, ei->doc))
+			return 0;
+		if (fprintf(f, "\t\t%s = \'%" PRId64 "\'", 
+		    ei->name, ei->value) < 0)
+			return 0;
+		if (TAILQ_NEXT(ei, entries) != NULL)
+			if (fputc(',', f) == EOF)
+				return 0;
+		if (fputc('\n', f) == EOF)
+			return 0;
+	}
+
+	return fputs("\t}\n", f) != EOF;
+}
+
+/*
+ * Generate the result interface of a grouped query: the grouping key
+ * and its count or aggregate value.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_group(FILE *f, const struct ort_lang_nodejs *args,
+	const struct search *s)
+{
+	const struct field	*fd = s->groupby;
+
+	if (STYPE_ISAGGR(s->type)) {
+		if (!gen_commentv(f, 1, COMMENT_JS,
+		    "%s of {@link ortns.%sData.%s} grouped by "
+		    "{@link ortns.%sData.%s}.",
+		    s->type == STYPE_SUM ? "Sum" :
+		    s->type == STYPE_AVG ? "Average" :
+		    s->type == STYPE_MIN ? "Minimum" : "Maximum",
+		    s->parent->name, s->afield->name,
+		    s->parent->name, fd->name))
+			return 0;
+	} else {
+		if (!gen_commentv(f, 1, COMMENT_JS,
+		    "Count of {@link ortns.%s} grouped by "
+		    "{@link ortns.%sData.%s}.",
+		    s->parent->name, s->parent->name, fd->name))
+			return 0;
+	}
+
+	if (fputs("\texport interface ", f) == EOF ||
+	    gen_group_name(f, s) < 0 ||
+	    fputs(" {\n", f) == EOF)
+		return 0;
+	if (!gen_commentv(f, 2, COMMENT_JS,
+	    "Value of {@link ortns.%sData.%s} shared by the group.", 
+	    s->parent->name, fd->name))
+		return 0;
+	if (fd->type == FTYPE_ENUM) {
+		if (fprintf(f, "\t\tkey: ortns.%s;\n", 
+		    fd->enm->name) < 0)
+			return 0;
+	} else {
+		if (fprintf(f, "\t\tkey: %s;\n", 
+		    get_ftype(args, fd)) < 0)
+			return 0;
+	}
+	if (!gen_comment(f, 2, COMMENT_JS, STYPE_ISAGGR(s->type) ?
+	    "Aggregate value, which is never null." :
+	    "Number of rows in the group."))
+		return 0;
+	return fprintf(f, "\t\tval: %s;\n\t}\n\n", 
+		STYPE_ISAGGR(s->type) && (s->type == STYPE_AVG || 
+		s->afield->type == FTYPE_REAL) ? "number" : "bigint") > 0;
+}
+
+/*
+ * Generate the JSON value of field "fd" in "obj" as the right-hand side
+ * of a string concatenation.
+ * This matches the output of JSON.stringify() on db_export_xxx().
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_tojson_value(FILE *f, const struct field *fd)
+{
+	const char	*fmt;
+
+	switch (fd->type) {
+	case FTYPE_STRUCT:
+		if (fd->ref->source->flags & FIELD_NULL)
+			return fprintf(f, "(obj.%s === null ? 'null' : "
+				"db_tojson_%s(role, obj.%s))",
+				fd->name, fd->ref->target->parent->name,
+				fd->name) > 0;
+		return fprintf(f, "db_tojson_%s(role, obj.%s)", 
+			fd->ref->target->parent->name, fd->name) > 0;
+	case FTYPE_BIT:
+	case FTYPE_DATE:
+	case FTYPE_EPOCH:
+	case FTYPE_INT:
+	case FTYPE_REAL:
+	case FTYPE_BITFIELD:
+		fmt = "'\"' + obj.%s.toString() + '\"'";
+		break;
+	case FTYPE_BLOB:
+		fmt = "'\"' + obj.%s.toString('base64') + '\"'";
+		break;
+	default:
+		return fprintf(f, "JSON.stringify(obj.%s)", 
+			fd->name) > 0;
+	}
+
+	if ((fd->flags & FIELD_NULL) && fprintf(f, 
+	    "(obj.%s === null ? 'null' : ", fd->name) < 0)
+		return 0;
+	if (fprintf(f, fmt, fd->name) < 0)
+		return 0;
+	return !(fd->flags & FIELD_NULL) || fputc(')', f) != EOF;
+}
+
+/*
+ * Generate db_tojson_xxx(), which writes the JSON text of
+ * db_export_xxx() directly from the data without an intermediate
+ * object.
+ * Keys and separators are precomputed unless fields before them are
+ * only exported to some roles.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_tojson(FILE *f, const struct strct *p)
+{
+	const struct field	*fd;
+	const struct rref	*r;
+	const char		*tab;
+	int			 emitted = 0, cond = 0;
+
+	if (!gen_commentv(f, 1, COMMENT_JS,
+	    "Like `JSON.stringify(db_export_%s(role, obj))`, but "
+	    "without the intermediate object.", p->name))
+		return 0;
+	if (fprintf(f, "\tfunction db_tojson_%s"
+	    "(role: string, obj: %sData): string\n"
+	    "\t{\n"
+	    "\t\tlet res: string = '{';\n"
+	    "\n", p->name, p->name) < 0)
+		return 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries) {
+		if ((fd->flags & FIELD_NOEXPORT) ||
+		    fd->type == FTYPE_PASSWORD)
+			continue;
+
+		tab = "";
+		if (fd->rolemap != NULL) {
+			tab = "\t";
+			if (fputs("\t\tswitch (role) {\n", f) == EOF)
+				return 0;
+			TAILQ_FOREACH(r, &fd->rolemap->rq, entries)
+				if (!gen_role(f, r->role, 2))
+					return 0;
+			if (fputs("\t\t\tbreak;\n"
+			    "\t\tdefault:\n", f) == EOF)
+				return 0;
+		}
+
+		if (emitted) {
+			if (fprintf(f, "%s\t\tres += ',\"%s\":' +\n",
+			    tab, fd->name) < 0)
+				return 0;
+		} else if (cond) {
+			if (fprintf(f, "%s\t\tres += (res.length > 1 ? "
+			    "',\"%s\":' : '\"%s\":') +\n",
+			    tab, fd->name, fd->name) < 0)
+				return 0;
+		} else {
+			if (fprintf(f, "%s\t\tres += '\"%s\":' +\n",
+			    tab, fd->name) < 0)
+				return 0;
+		}
+		if (fprintf(f, "%s\t\t\t", tab) < 0)
+			return 0;
+		if (!gen_tojson_value(f, fd))
+			return 0;
+		if (fputs(";\n", f) == EOF)
+			return 0;
+
+		if (fd->rolemap != NULL) {
+			if (fputs("\t\t\tbreak;\n\t\t}\n", f) == EOF)
+				return 0;
+			cond = 1;
+		} else
+			emitted = 1;
+	}
+
+	if (!emitted && !cond &&
+	    !gen_comment(f, 2, COMMENT_JS, "Nothing to export."))
+		return 0;
+
+	return fputs("\n"
+	    "\t\treturn res + '}';\n"
+	    "\t}\n\n", f) != EOF;
 }
 
 /*
- * Generate an enumeration.
+ * Generate the class methods writing the object, and arrays of the
+ * object, as JSON text.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_enm(FILE *f, const struct enm *p, size_t pos)
+gen_tojson_methods(FILE *f, const struct strct *p)
 {
-	const struct eitem	*ei;
 
-	if (pos > 0 && fputc('\n', f) == EOF)
+	if (!gen_commentv(f, 2, COMMENT_JS,
+	    "Like `JSON.stringify()` of {@link export}, but written "
+	    "directly from the contained {@link ortns.%sData}.",
+	    p->name))
 		return 0;
-	if (!gen_comment(f, 1, COMMENT_JS, p->doc))
+	if (fprintf(f, "\t\ttoJSONString(): string\n"
+	    "\t\t{\n"
+	    "\t\t\treturn db_tojson_%s(this.#role, this.obj);\n"
+	    "\t\t}\n"
+	    "\n", p->name) < 0)
 		return 0;
 
-	if (fprintf(f, "\texport enum %s {\n", p->name) < 0)
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Write {@link toJSONString} to a stream.\n"
+	    "@param stream Where to write, such as a "
+	    "`http.ServerResponse`."))
+		return 0;
+	if (fputs("\t\twriteJSON(stream: "
+	    "{ write(chunk: string): any }): void\n"
+	    "\t\t{\n"
+	    "\t\t\tstream.write(this.toJSONString());\n"
+	    "\t\t}\n"
+	    "\n", f) == EOF)
 		return 0;
 
-	TAILQ_FOREACH(ei, &p->eq, entries) {
-		if (!gen_comment(f, 2, COMMENT_JS, ei->doc))
-			return 0;
-		if (fprintf(f, "\t\t%s = \'%" PRId64 "\'", 
-		    ei->name, ei->value) < 0)
-			return 0;
-		if (TAILQ_NEXT(ei, entries) != NULL)
-			if (fputc(',', f) == EOF)
-				return 0;
-		if (fputc('\n', f) == EOF)
-			return 0;
-	}
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Like {@link toJSONString} for an array of objects, "
+	    "such as returned by listings.\n"
+	    "@param objs The objects."))
+		return 0;
+	if (fprintf(f, "\t\tstatic toJSONArrayString"
+	    "(objs: ortns.%s[]): string\n"
+	    "\t\t{\n"
+	    "\t\t\tlet res: string = '[';\n"
+	    "\n"
+	    "\t\t\tfor (let i: number = 0; i < objs.length; i++)\n"
+	    "\t\t\t\tres += (i > 0 ? ',' : '') + "
+	    "objs[i].toJSONString();\n"
+	    "\t\t\treturn res + ']';\n"
+	    "\t\t}\n"
+	    "\n", p->name) < 0)
+		return 0;
 
-	return fputs("\t}\n", f) != EOF;
+	if (!gen_comment(f, 2, COMMENT_JS,
+	    "Like {@link writeJSON} for an array of objects, writing "
+	    "each in turn.\n"
+	    "@param stream Where to write.\n"
+	    "@param objs The objects."))
+		return 0;
+	return fprintf(f, "\t\tstatic writeJSONArray(stream: "
+	    "{ write(chunk: string): any },\n"
+	    "\t\t    objs: ortns.%s[]): void\n"
+	    "\t\t{\n"
+	    "\t\t\tstream.write('[');\n"
+	    "\t\t\tfor (let i: number = 0; i < objs.length; i++)\n"
+	    "\t\t\t\tstream.write((i > 0 ? ',' : '') + "
+	    "objs[i].toJSONString());\n"
+	    "\t\t\tstream.write(']');\n"
+	    "\t\t}\n", p->name) > 0;
 }
 
 /*
@@ -1330,9 +2672,11 @@ gen_enm(FILE *f, const struct enm *p, size_t pos)
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_strct(FILE *f, const struct strct *p, size_t pos)
+gen_strct(FILE *f, const struct ort_lang_nodejs *args,
+	const struct strct *p, size_t pos)
 {
 	const struct field	*fd;
+	const struct search	*s;
 	const struct rref	*r;
 	const char		*tab;
 
@@ -1357,7 +2701,7 @@ gen_strct(FILE *f, const struct strct *p, size_t pos)
 			    fd->enm->name) < 0)
 				return 0;
 		} else {
-			if (fprintf(f, "%s", ftypes[fd->type]) < 0)
+			if (fprintf(f, "%s", get_ftype(args, fd)) < 0)
 				return 0;
 		}
 
@@ -1374,6 +2718,11 @@ gen_strct(FILE *f, const struct strct *p, size_t pos)
 	if (fputs("\t}\n\n", f) == EOF)
 		return 0;
 
+	TAILQ_FOREACH(s, &p->sq, entries)
+		if (s->groupby != NULL && group_first(s) &&
+		    !gen_group(f, args, s))
+			return 0;
+
 	if (fprintf(f, "\tfunction db_export_%s"
 	    "(role: string, obj: %sData): any\n"
 	    "\t{\n"
@@ -1498,6 +2847,8 @@ gen_strct(FILE *f, const struct strct *p, size_t pos)
 	    "\t\treturn res;\n"
 	    "\t}\n\n", f) == EOF)
 		return 0;
+	if (!gen_tojson(f, p))
+		return 0;
 
 	if (!gen_commentv(f, 1, COMMENT_JS,
 	    "Class instance of {@link ortns.%sData}.",
@@ -1532,15 +2883,20 @@ gen_strct(FILE *f, const struct strct *p, size_t pos)
 	    "responses.", p->name))
 		return 0;
 
-	return fprintf(f, "\t\texport(): any\n"
-	       "\t\t{\n"
-	       "\t\t\treturn db_export_%s(this.#role, this.obj);\n"
-	       "\t\t}\n"
-	       "\t}\n", p->name) > 0;
+	if (fprintf(f, "\t\texport(): any\n"
+	    "\t\t{\n"
+	    "\t\t\treturn db_export_%s(this.#role, this.obj);\n"
+	    "\t\t}\n"
+	    "\n", p->name) < 0)
+		return 0;
+	if (!gen_tojson_methods(f, p))
+		return 0;
+	return fputs("\t}\n", f) != EOF;
 }
 
 static int
-gen_ortns_express_valid(FILE *f, const struct field *fd)
+gen_ortns_express_valid(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd)
 {
 	const struct fvalid	*fv;
 
@@ -1636,41 +2992,581 @@ gen_ortns_express_valid(FILE *f, const struct field *fd)
 		     "\t\t\t\treturn null;\n"
 		     "\t\t\t}\n", f) == EOF)
 			return 0;
-		
-		/*
-		 * Bitfields need to be clamped into signed integers,
-		 * but can be passed as unsigned.  Integers need to be
-		 * checked for boundaries, and bits are 0--63.
-		 */
+		
+		/*
+		 * Bitfields need to be clamped into signed integers,
+		 * but can be passed as unsigned, or into 53 bits if
+		 * they're numbers.  Integers need to be checked for
+		 * boundaries, and bits are 0--63.
+		 */
+
+		if (fd->type == FTYPE_BITFIELD && is_number(args, fd)) {
+		       if (fputs
+			   ("\t\t\tif (nv < BigInt(0) || nv > "
+			    "BigInt(Number.MAX_SAFE_INTEGER))\n" 
+			    "\t\t\t\treturn null;\n", f) == EOF)
+			       return 0;
+		} else if (fd->type == FTYPE_BITFIELD) {
+		       if (fputs
+			   ("\t\t\tif (nv < minInt || nv > maxUint)\n" 
+			    "\t\t\t\treturn null;\n"
+			    "\t\t\tnv = BigInt.asIntN(64, nv);\n", f) == EOF)
+			       return 0;
+		} else if (fd->type != FTYPE_BIT) {
+		       if (fputs
+			   ("\t\t\tif (nv < minInt || nv > maxInt)\n" 
+			    "\t\t\t\treturn null;\n", f) == EOF)
+			       return 0;
+		} else {
+		       if (fputs
+			   ("\t\t\tif (nv < BigInt(0) || nv > BigInt(64))\n"
+			    "\t\t\t\treturn null;\n", f) == EOF)
+			       return 0;
+		}
+		break;
+	}
+
+	TAILQ_FOREACH(fv, &fd->fvq, entries)
+		if (fprintf(f, 
+		    "\t\t\tif (!(nv %s BigInt('%" PRId64 "')))\n"
+		    "\t\t\t\treturn null;\n", 
+		    vtypes[fv->type], fv->d.value.integer) < 0)
+			return 0;
+
+	return fputs(is_number(args, fd) ? 
+	    "\t\t\treturn Number(nv);\n" : 
+	    "\t\t\treturn nv;\n", f) != EOF;
+}
+
+/*
+ * Generate the compiled check for a single field as the function
+ * ortCheck_xxx_yyy.
+ * Unlike the ortValids closures, integers and reals are scanned
+ * without regular expressions or exceptions, dates are parsed in
+ * place, and enumerations are looked up in a static set.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_valid_check(FILE *f, const struct ort_lang_nodejs *args,
+	const struct field *fd)
+{
+	const struct fvalid	*fv;
+
+	if (fprintf(f, "\n"
+	    "\tfunction ortCheck_%s_%s(v: any): ",
+	    fd->parent->name, fd->name) < 0)
+		return 0;
+	if ((fd->type == FTYPE_ENUM ?
+	    fprintf(f, "ortns.%s|null\n", fd->enm->name) :
+	    fprintf(f, "%s|null\n", get_ftype(args, fd))) < 0)
+		return 0;
+	if (fputs("\t{\n"
+	    "\t\tif (typeof v === 'undefined' || v === null)\n"
+	    "\t\t\treturn null;\n", f) == EOF)
+		return 0;
+
+	switch (fd->type) {
+	case FTYPE_BLOB:
+		return fputs("\t\treturn typeof v === 'string' || "
+		    "v instanceof Uint8Array ?\n"
+		    "\t\t\tBuffer.from(v) : null;\n"
+		    "\t}\n", f) != EOF;
+	case FTYPE_TEXT:
+	case FTYPE_PASSWORD:
+		if (fputs("\t\tconst nv: string = v.toString();\n",
+		    f) == EOF)
+			return 0;
+		TAILQ_FOREACH(fv, &fd->fvq, entries)
+			if (fprintf(f,
+			    "\t\tif (!(nv.length %s %zu))\n"
+			    "\t\t\treturn null;\n",
+			    vtypes[fv->type], fv->d.value.len) < 0)
+				return 0;
+		return fputs("\t\treturn nv;\n\t}\n", f) != EOF;
+	case FTYPE_EMAIL:
+		return fputs("\t\tconst nv: string = "
+		    "v.toString().trim();\n"
+		    "\t\tif (!validator.isEmail(nv))\n"
+		    "\t\t\treturn null;\n"
+		    "\t\tconst em: string|false = "
+		    "validator.normalizeEmail(nv);\n"
+		    "\t\treturn typeof em === 'string' ? em : null;\n"
+		    "\t}\n", f) != EOF;
+	case FTYPE_REAL:
+		if (fputs("\t\tconst nv: number|null = "
+		    "ortParseReal(v);\n"
+		    "\t\tif (nv === null)\n"
+		    "\t\t\treturn null;\n", f) == EOF)
+			return 0;
+		TAILQ_FOREACH(fv, &fd->fvq, entries)
+			if (fprintf(f,
+			    "\t\tif (!(nv %s %f))\n"
+			    "\t\t\treturn null;\n",
+			    vtypes[fv->type], fv->d.value.decimal) < 0)
+				return 0;
+		return fputs("\t\treturn nv;\n\t}\n", f) != EOF;
+	case FTYPE_ENUM:
+		return fprintf(f, "\t\tconst nv: string = "
+		    "v.toString().trim();\n"
+		    "\t\treturn ortEnum_%s.has(nv) ? "
+		    "<ortns.%s>nv : null;\n"
+		    "\t}\n", fd->enm->name, fd->enm->name) > 0;
+	case FTYPE_DATE:
+		if (fputs("\t\tconst nv: bigint|null = "
+		    "ortParseDate(v);\n", f) == EOF)
+			return 0;
+		break;
+	case FTYPE_BITFIELD:
+		if (fputs("\t\tlet nv: bigint|null = "
+		    "ortParseInt(v);\n", f) == EOF)
+			return 0;
+		break;
+	default:
+		if (fputs("\t\tconst nv: bigint|null = "
+		    "ortParseInt(v);\n", f) == EOF)
+			return 0;
+		break;
+	}
+
+	if (fputs("\t\tif (nv === null)\n"
+	    "\t\t\treturn null;\n", f) == EOF)
+		return 0;
+
+	/* Same clamping as in gen_ortns_express_valid(). */
+
+	if (fd->type == FTYPE_BITFIELD && is_number(args, fd)) {
+		if (fputs("\t\tif (nv < BigInt(0) || nv > "
+		    "BigInt(Number.MAX_SAFE_INTEGER))\n"
+		    "\t\t\treturn null;\n", f) == EOF)
+			return 0;
+	} else if (fd->type == FTYPE_BITFIELD) {
+		if (fputs("\t\tif (nv < minInt || nv > maxUint)\n"
+		    "\t\t\treturn null;\n"
+		    "\t\tnv = BigInt.asIntN(64, nv);\n", f) == EOF)
+			return 0;
+	} else if (fd->type == FTYPE_BIT) {
+		if (fputs("\t\tif (nv < BigInt(0) || nv > BigInt(64))\n"
+		    "\t\t\treturn null;\n", f) == EOF)
+			return 0;
+	} else {
+		if (fputs("\t\tif (nv < minInt || nv > maxInt)\n"
+		    "\t\t\treturn null;\n", f) == EOF)
+			return 0;
+	}
+
+	TAILQ_FOREACH(fv, &fd->fvq, entries)
+		if (fprintf(f,
+		    "\t\tif (!(nv %s BigInt('%" PRId64 "')))\n"
+		    "\t\t\treturn null;\n",
+		    vtypes[fv->type], fv->d.value.integer) < 0)
+			return 0;
+
+	return fputs(is_number(args, fd) ?
+	    "\t\treturn Number(nv);\n\t}\n" :
+	    "\t\treturn nv;\n\t}\n", f) != EOF;
+}
+
+/*
+ * Print the input key of parameter "pos" (from zero) of "vp".
+ * This is the same struct-field key as used by ortValids, but if the
+ * field has already appeared in the signature, it's suffixed by the
+ * parameter's position (from one).
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_valid_key(FILE *f, const struct vparm *vp, size_t pos)
+{
+	size_t	 i;
+
+	for (i = 0; i < pos; i++)
+		if (vp[i].fd == vp[pos].fd)
+			break;
+	if (fprintf(f, "'%s-%s", vp[pos].fd->parent->name,
+	    vp[pos].fd->name) < 0)
+		return 0;
+	if (i < pos && fprintf(f, "-%zu", pos + 1) < 0)
+		return 0;
+	return fputc('\'', f) != EOF;
+}
+
+/*
+ * Generate the remainder of a whole-signature validator whose name has
+ * already been printed: its signature and body validating each of the
+ * "vpsz" parameters in "vp" in order.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_valid_args(FILE *f, const struct ort_lang_nodejs *args,
+	const struct vparm *vp, size_t vpsz)
+{
+	const struct field	*fd;
+	size_t			 i, col = 9;
+	int			 rc;
+
+	if (fputs("(v: {[key: string]: any}):\n\t\t[", f) == EOF)
+		return 0;
+	for (i = 0; i < vpsz; i++) {
+		fd = vp[i].fd;
+		if (i > 0) {
+			if (fputc(',', f) == EOF)
+				return 0;
+			if (col >= 56) {
+				if (fputs("\n\t\t ", f) == EOF)
+					return 0;
+				col = 17;
+			} else {
+				if (fputc(' ', f) == EOF)
+					return 0;
+				col += 2;
+			}
+		}
+		rc = fd->type == FTYPE_ENUM ?
+			fprintf(f, "ortns.%s", fd->enm->name) :
+			fprintf(f, "%s", get_ftype(args, fd));
+		if (rc < 0)
+			return 0;
+		col += rc;
+		if (vp[i].set) {
+			if (fputs("[]", f) == EOF)
+				return 0;
+			col += 2;
+		} else if (fd->flags & FIELD_NULL) {
+			if (fputs("|null", f) == EOF)
+				return 0;
+			col += 5;
+		}
+	}
+	if (fputs("]|null\n\t{\n", f) == EOF)
+		return 0;
+
+	for (i = 0; i < vpsz; i++) {
+		fd = vp[i].fd;
+		if (vp[i].set) {
+			if (fprintf(f, "\t\tconst i%zu: any = v[", i + 1) < 0)
+				return 0;
+			if (!gen_valid_key(f, vp, i))
+				return 0;
+			if (fprintf(f, "];\n"
+			    "\t\tconst a%zu: any[] = Array.isArray(i%zu) ? "
+			    "i%zu : [i%zu];\n"
+			    "\t\tconst v%zu: ",
+			    i + 1, i + 1, i + 1, i + 1, i + 1) < 0)
+				return 0;
+			if ((fd->type == FTYPE_ENUM ?
+			    fprintf(f, "ortns.%s", fd->enm->name) :
+			    fprintf(f, "%s", get_ftype(args, fd))) < 0)
+				return 0;
+			if (fprintf(f, "[] = "
+			    "new Array(a%zu.length);\n"
+			    "\t\tfor (let i: number = 0; "
+			    "i < a%zu.length; i++) {\n"
+			    "\t\t\tconst nv = ortCheck_%s_%s(a%zu[i]);\n"
+			    "\t\t\tif (nv === null)\n"
+			    "\t\t\t\treturn null;\n"
+			    "\t\t\tv%zu[i] = nv;\n"
+			    "\t\t}\n", i + 1, i + 1, fd->parent->name,
+			    fd->name, i + 1, i + 1) < 0)
+				return 0;
+			continue;
+		}
+		if (fprintf(f, "\t\tconst i%zu: any = v[", i + 1) < 0)
+			return 0;
+		if (!gen_valid_key(f, vp, i))
+			return 0;
+		if (fprintf(f, "];\n"
+		    "\t\tconst v%zu = ortCheck_%s_%s(i%zu);\n",
+		    i + 1, fd->parent->name, fd->name, i + 1) < 0)
+			return 0;
+		if ((fd->flags & FIELD_NULL) ? fprintf(f,
+		    "\t\tif (v%zu === null &&\n"
+		    "\t\t    typeof i%zu !== 'undefined' && "
+		    "i%zu !== null)\n"
+		    "\t\t\treturn null;\n", i + 1, i + 1, i + 1) < 0 :
+		    fprintf(f, "\t\tif (v%zu === null)\n"
+		    "\t\t\treturn null;\n", i + 1) < 0)
+			return 0;
+	}
+
+	if (fputs("\t\treturn [", f) == EOF)
+		return 0;
+	for (i = 0; i < vpsz; i++)
+		if (fprintf(f, "%sv%zu", i > 0 ? ", " : "", i + 1) < 0)
+			return 0;
+	return fputs("];\n\t}\n", f) != EOF;
+}
+
+/*
+ * Generate whole-signature validators for the insert, update, delete,
+ * and query methods of "p" that accept parameters.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_valid_strct(FILE *f, const struct ort_lang_nodejs *args,
+	const struct strct *p)
+{
+	const struct field	*fd;
+	const struct update	*up;
+	const struct uref	*ref;
+	const struct search	*s;
+	const struct sent	*sent;
+	struct vparm		*vp;
+	size_t			 vpsz, max = 0;
+	int			 rc = 0;
+
+	/* Allocate enough for the largest signature. */
+
+	vpsz = 0;
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		vpsz++;
+	if (vpsz > max)
+		max = vpsz;
+	TAILQ_FOREACH(up, &p->uq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(ref, &up->mrq, entries)
+			vpsz++;
+		TAILQ_FOREACH(ref, &up->crq, entries)
+			vpsz++;
+		if (vpsz > max)
+			max = vpsz;
+	}
+	TAILQ_FOREACH(up, &p->dq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(ref, &up->crq, entries)
+			vpsz++;
+		if (vpsz > max)
+			max = vpsz;
+	}
+	TAILQ_FOREACH(s, &p->sq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(sent, &s->sntq, entries)
+			vpsz++;
+		if (vpsz > max)
+			max = vpsz;
+	}
+	if (max == 0)
+		return 1;
+	if ((vp = calloc(max, sizeof(struct vparm))) == NULL)
+		return 0;
+
+	if (p->ins != NULL) {
+		vpsz = 0;
+		TAILQ_FOREACH(fd, &p->fq, entries)
+			if (!(fd->type == FTYPE_STRUCT ||
+			    (fd->flags & FIELD_ROWID))) {
+				vp[vpsz].fd = fd;
+				vp[vpsz++].set = 0;
+			}
+		if (vpsz > 0) {
+			if (fprintf(f, "\n\texport function "
+			    "db_%s_insert", p->name) < 0)
+				goto out;
+			if (!gen_valid_args(f, args, vp, vpsz))
+				goto out;
+		}
+	}
+
+	TAILQ_FOREACH(up, &p->uq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(ref, &up->mrq, entries) {
+			vp[vpsz].fd = ref->field;
+			vp[vpsz++].set = 0;
+		}
+		TAILQ_FOREACH(ref, &up->crq, entries)
+			if (!OPTYPE_ISUNARY(ref->op)) {
+				vp[vpsz].fd = ref->field;
+				vp[vpsz++].set = 0;
+			}
+		if (vpsz == 0)
+			continue;
+		if (fputs("\n\texport function ", f) == EOF)
+			goto out;
+		if (gen_update_name(f, up) < 0)
+			goto out;
+		if (!gen_valid_args(f, args, vp, vpsz))
+			goto out;
+	}
+
+	TAILQ_FOREACH(up, &p->dq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(ref, &up->crq, entries)
+			if (!OPTYPE_ISUNARY(ref->op)) {
+				vp[vpsz].fd = ref->field;
+				vp[vpsz++].set = 0;
+			}
+		if (vpsz == 0)
+			continue;
+		if (fputs("\n\texport function ", f) == EOF)
+			goto out;
+		if (gen_update_name(f, up) < 0)
+			goto out;
+		if (!gen_valid_args(f, args, vp, vpsz))
+			goto out;
+	}
+
+	TAILQ_FOREACH(s, &p->sq, entries) {
+		vpsz = 0;
+		TAILQ_FOREACH(sent, &s->sntq, entries)
+			if (!OPTYPE_ISUNARY(sent->op)) {
+				vp[vpsz].fd = sent->field;
+				vp[vpsz++].set = sent->op == OPTYPE_IN;
+			}
+		if (vpsz == 0)
+			continue;
+		if (fputs("\n\texport function ", f) == EOF)
+			goto out;
+		if (gen_query_name(f, s) < 0)
+			goto out;
+		if (!gen_valid_args(f, args, vp, vpsz))
+			goto out;
+	}
+
+	rc = 1;
+out:
+	free(vp);
+	return rc;
+}
+
+/*
+ * Generate the compiled validators: scanning helpers, enumeration
+ * sets, a check per field, and whole-signature validators for each
+ * database method accepting parameters.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_valid_compiled(const struct ort_lang_nodejs *args,
+	FILE *f, const struct config *cfg)
+{
+	const struct strct	*st;
+	const struct field	*fd;
+	const struct enm	*e;
+
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS,
+	    "Scan a decimal integer, optionally signed and surrounded "
+	    "by white-space, without regular expressions or "
+	    "exceptions.  Native numbers must be integral."))
+		return 0;
+	if (fputs
+	    ("\tfunction ortParseInt(v: any): bigint|null\n"
+	     "\t{\n"
+	     "\t\tif (typeof v === 'bigint')\n"
+	     "\t\t\treturn v;\n"
+	     "\t\tif (typeof v === 'number')\n"
+	     "\t\t\treturn Number.isInteger(v) ? BigInt(v) : null;\n"
+	     "\t\tconst s: string = v.toString().trim();\n"
+	     "\t\tconst n: number = s.length;\n"
+	     "\t\tlet i: number = 0;\n"
+	     "\t\tif (n > 0 && (s.charCodeAt(0) === 43 ||\n"
+	     "\t\t    s.charCodeAt(0) === 45))\n"
+	     "\t\t\ti++;\n"
+	     "\t\tif (i === n)\n"
+	     "\t\t\treturn null;\n"
+	     "\t\tfor (let j: number = i; j < n; j++) {\n"
+	     "\t\t\tconst c: number = s.charCodeAt(j);\n"
+	     "\t\t\tif (c < 48 || c > 57)\n"
+	     "\t\t\t\treturn null;\n"
+	     "\t\t}\n"
+	     "\t\treturn n - i < 16 ? "
+	     "BigInt(parseInt(s, 10)) : BigInt(s);\n"
+	     "\t}\n"
+	     "\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS,
+	    "Scan a decimal real (digits with an optional fraction, "
+	    "optionally signed and surrounded by white-space) "
+	    "without regular expressions.  Native numbers must be "
+	    "finite."))
+		return 0;
+	if (fputs
+	    ("\tfunction ortParseReal(v: any): number|null\n"
+	     "\t{\n"
+	     "\t\tif (typeof v === 'number')\n"
+	     "\t\t\treturn isFinite(v) ? v : null;\n"
+	     "\t\tconst s: string = v.toString().trim();\n"
+	     "\t\tconst n: number = s.length;\n"
+	     "\t\tlet i: number = 0, digits: number = 0, c: number;\n"
+	     "\t\tif (n > 0 && (s.charCodeAt(0) === 43 ||\n"
+	     "\t\t    s.charCodeAt(0) === 45))\n"
+	     "\t\t\ti++;\n"
+	     "\t\tfor ( ; i < n; i++, digits++)\n"
+	     "\t\t\tif ((c = s.charCodeAt(i)) < 48 || c > 57)\n"
+	     "\t\t\t\tbreak;\n"
+	     "\t\tif (i < n && s.charCodeAt(i) === 46) {\n"
+	     "\t\t\tconst frac: number = ++i;\n"
+	     "\t\t\tfor ( ; i < n; i++, digits++)\n"
+	     "\t\t\t\tif ((c = s.charCodeAt(i)) < 48 || c > 57)\n"
+	     "\t\t\t\t\tbreak;\n"
+	     "\t\t\tif (i === frac)\n"
+	     "\t\t\t\treturn null;\n"
+	     "\t\t}\n"
+	     "\t\treturn i === n && digits > 0 ? parseFloat(s) : null;\n"
+	     "\t}\n"
+	     "\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS,
+	    "Scan a YYYY-MM-DD date, optionally surrounded by "
+	    "white-space, into UTC epoch seconds."))
+		return 0;
+	if (fputs
+	    ("\tfunction ortParseDate(v: any): bigint|null\n"
+	     "\t{\n"
+	     "\t\tconst s: string = v.toString().trim();\n"
+	     "\t\tlet y: number = 0, m: number = 0, d: number = 0;\n"
+	     "\t\tif (s.length !== 10 || s.charCodeAt(4) !== 45 ||\n"
+	     "\t\t    s.charCodeAt(7) !== 45)\n"
+	     "\t\t\treturn null;\n"
+	     "\t\tfor (let i: number = 0; i < 10; i++) {\n"
+	     "\t\t\tif (i === 4 || i === 7)\n"
+	     "\t\t\t\tcontinue;\n"
+	     "\t\t\tconst c: number = s.charCodeAt(i) - 48;\n"
+	     "\t\t\tif (c < 0 || c > 9)\n"
+	     "\t\t\t\treturn null;\n"
+	     "\t\t\tif (i < 4)\n"
+	     "\t\t\t\ty = y * 10 + c;\n"
+	     "\t\t\telse if (i < 7)\n"
+	     "\t\t\t\tm = m * 10 + c;\n"
+	     "\t\t\telse\n"
+	     "\t\t\t\td = d * 10 + c;\n"
+	     "\t\t}\n"
+	     "\t\tconst dt: Date = new Date(0);\n"
+	     "\t\tdt.setUTCFullYear(y, m - 1, d);\n"
+	     "\t\tif (dt.getUTCMonth() !== m - 1 || "
+	     "dt.getUTCDate() !== d)\n"
+	     "\t\t\treturn null;\n"
+	     "\t\treturn BigInt(dt.getTime() / 1000);\n"
+	     "\t}\n", f) == EOF)
+		return 0;
+
+	TAILQ_FOREACH(e, &cfg->eq, entries)
+		if (fprintf(f, "\n"
+		    "\tconst ortEnum_%s: ReadonlySet<string> =\n"
+		    "\t\tnew Set<string>(Object.values(ortns.%s));\n",
+		    e->name, e->name) < 0)
+			return 0;
 
-		if (fd->type == FTYPE_BITFIELD) {
-		       if (fputs
-			   ("\t\t\tif (nv < minInt || nv > maxUint)\n" 
-			    "\t\t\t\treturn null;\n"
-			    "\t\t\tnv = BigInt.asIntN(64, nv);\n", f) == EOF)
-			       return 0;
-		} else if (fd->type != FTYPE_BIT) {
-		       if (fputs
-			   ("\t\t\tif (nv < minInt || nv > maxInt)\n" 
-			    "\t\t\t\treturn null;\n", f) == EOF)
-			       return 0;
-		} else {
-		       if (fputs
-			   ("\t\t\tif (nv < BigInt(0) || nv > BigInt(64))\n"
-			    "\t\t\t\treturn null;\n", f) == EOF)
-			       return 0;
-		}
-		break;
-	}
+	TAILQ_FOREACH(st, &cfg->sq, entries)
+		TAILQ_FOREACH(fd, &st->fq, entries)
+			if (fd->type != FTYPE_STRUCT &&
+			    !gen_valid_check(f, args, fd))
+				return 0;
 
-	TAILQ_FOREACH(fv, &fd->fvq, entries)
-		if (fprintf(f, 
-		    "\t\t\tif (!(nv %s BigInt('%" PRId64 "')))\n"
-		    "\t\t\t\treturn null;\n", 
-		    vtypes[fv->type], fv->d.value.integer) < 0)
+	if (fputc('\n', f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS,
+	    "Whole-signature validators, one for each database "
+	    "method accepting parameters and named for it.\n"
+	    "Each reads the method's parameters from a key-value "
+	    "object (e.g., a request's body or query) in a single "
+	    "pass and returns them as a tuple to pass directly to "
+	    "the method, or null if any fails validation."))
+		return 0;
+
+	TAILQ_FOREACH(st, &cfg->sq, entries)
+		if (!gen_valid_strct(f, args, st))
 			return 0;
 
-	return fputs("\t\t\treturn nv;\n", f) != EOF;
+	return 1;
 }
 
 static int
@@ -1711,7 +3607,7 @@ gen_ortns_express_valids(const struct ort_lang_nodejs *args,
 				break;
 			default:
 				c = fprintf(f, "%s|null;\n", 
-					ftypes[fd->type]) >= 0;
+					get_ftype(args, fd)) >= 0;
 				break;
 			}
 			if (!c)
@@ -1740,14 +3636,18 @@ gen_ortns_express_valids(const struct ort_lang_nodejs *args,
 			if (fprintf(f, "\t\t'%s-%s': (v) => {\n", 
 			    st->name, fd->name) < 0)
 				return 0;
-			if (!gen_ortns_express_valid(f, fd))
+			if (!gen_ortns_express_valid(f, args, fd))
 				return 0;
 			if (fputs("\t\t},\n", f) == EOF)
 				return 0;
 		}
 	}
 
-	return fputs("\t}\n}\n", f) != EOF;
+	if (fputs("\t}\n", f) == EOF)
+		return 0;
+	if (!gen_valid_compiled(args, f, cfg))
+		return 0;
+	return fputs("}\n", f) != EOF;
 }
 
 /*
@@ -1785,20 +3685,619 @@ gen_ortns(const struct ort_lang_nodejs *args,
 		if (!gen_bitf(f, b, i++))
 			return 0;
 	TAILQ_FOREACH(p, &cfg->sq, entries)
-		if (!gen_strct(f, p, i++))
+		if (!gen_strct(f, args, p, i++))
 			return 0;
 
 	return fputs("}\n", f) != EOF;
 }
 
+/*
+ * Generate the tuning of a read-only connection "db" from the
+ * "database" block, less the journal mode, which is a property of the
+ * database file and can't be set read-only.
+ * Each statement is prefixed by "pfx".
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_pragmas_readonly(FILE *f, const struct config *cfg, const char *pfx)
+{
+	size_t	 i;
+
+	for (i = 0; i < PRAGMA__MAX; i++) {
+		if (i == PRAGMA_JOURNAL_MODE ||
+		    !gen_sql_pragma_isset(cfg->db, i))
+			continue;
+		if (fprintf(f, "%sdb.exec(\'", pfx) < 0)
+			return 0;
+		if (gen_sql_pragma(f, cfg->db, i) < 0)
+			return 0;
+		if (fputs("\');\n", f) == EOF)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Generate the worker source and class for the pool of read-only
+ * connections used by the asynchronous query variants.
+ * Each worker opens its own connection with the tuning pragmas (but
+ * the journal mode, which is only set by the writer).
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_ortpool(const struct ort_lang_nodejs *args,
+	FILE *f, const struct config *cfg)
+{
+
+	if (fputs("\n"
+	    "const ortpoolsrc: string = `\n"
+	    "const { parentPort, workerData } = "
+	     "require('worker_threads');\n"
+	    "const Database = require('better-sqlite3');\n"
+	    "const db = new Database(workerData,\n"
+	    "\t{ readonly: true, fileMustExist: true });\n"
+	    "let iter = null;\n"
+	    "db.defaultSafeIntegers(true);\n", f) == EOF)
+		return 0;
+	if (!gen_pragmas_readonly(f, cfg, ""))
+		return 0;
+	if (fputs("function next(n) {\n"
+	    "\tconst rows = [];\n"
+	    "\tlet r;\n"
+	    "\twhile (iter !== null && rows.length < n)\n"
+	    "\t\tif ((r = iter.next()).done)\n"
+	    "\t\t\titer = null;\n"
+	    "\t\telse\n"
+	    "\t\t\trows.push(r.value);\n"
+	    "\treturn rows;\n"
+	    "}\n"
+	    "parentPort.on('message', (m) => {\n"
+	    "\ttry {\n"
+	    "\t\tconst parms = m.parms === undefined ? [] :\n"
+	    "\t\t\tm.parms.map((p) => p instanceof Uint8Array ?\n"
+	    "\t\t\tBuffer.from(p.buffer, p.byteOffset, "
+	     "p.byteLength) : p);\n"
+	    "\t\tlet rows = [];\n"
+	    "\t\tif (m.op === 'all') {\n"
+	    "\t\t\trows = db.prepare(m.sql).raw(true).all(parms);\n"
+	    "\t\t} else if (m.op === 'get') {\n"
+	    "\t\t\tconst r = db.prepare(m.sql).raw(true).get(parms);\n"
+	    "\t\t\tif (r !== undefined)\n"
+	    "\t\t\t\trows.push(r);\n"
+	    "\t\t} else if (m.op === 'iterate') {\n"
+	    "\t\t\titer = db.prepare(m.sql).raw(true)\n"
+	    "\t\t\t\t.iterate(parms);\n"
+	    "\t\t\trows = next(m.batch);\n"
+	    "\t\t} else if (m.op === 'next') {\n"
+	    "\t\t\trows = next(m.batch);\n"
+	    "\t\t} else if (iter !== null) {\n"
+	    "\t\t\titer.return();\n"
+	    "\t\t\titer = null;\n"
+	    "\t\t}\n"
+	    "\t\tparentPort.postMessage({ rows });\n"
+	    "\t} catch (er) {\n"
+	    "\t\titer = null;\n"
+	    "\t\tparentPort.postMessage({ error: String(er) });\n"
+	    "\t}\n"
+	    "});\n"
+	    "`;\n"
+	    "\n", f) == EOF)
+		return 0;
+
+	if (!gen_comment(f, 0, COMMENT_JS,
+	    "Pool of worker threads, each with its own read-only "
+	    "database connection, used by the asynchronous (`_async`) "
+	    "query methods.  Queries wait for an idle worker, so at "
+	    "most this many run at once.  Reads don't see uncommitted "
+	    "changes of an open transaction on the main connection, "
+	    "which still services all writes.  If there are no "
+	    "workers, queries run on the main connection (or, for "
+	    "iterators, on a separate read-only connection).  A "
+	    "worker that exits or fails rejects its outstanding "
+	    "query and is replaced."))
+		return 0;
+	if (!(args->flags & ORT_LANG_NODEJS_NOMODULE) &&
+	    fputs("export ", f) == EOF)
+		return 0;
+	if (fputs("class ortpool {\n"
+	    "\treadonly #db: Database.Database;\n"
+	    "\treadonly #workers: Worker[] = [];\n"
+	    "\treadonly #idle: Worker[] = [];\n"
+	    "\treadonly #wait: ((w: Worker|null) => void)[] = [];\n"
+	    "\t#closed: boolean = false;\n"
+	    "\n"
+	    "\tconstructor(db: Database.Database, workers: number)\n"
+	    "\t{\n"
+	    "\t\tthis.#db = db;\n"
+	    "\t\tfor (let i: number = 0; i < workers; i++)\n"
+	    "\t\t\tthis.#idle.push(this.#spawn());\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#spawn(): Worker\n"
+	    "\t{\n"
+	    "\t\tconst w: Worker = new Worker(ortpoolsrc,\n"
+	    "\t\t\t{ eval: true, workerData: this.#db.name });\n"
+	    "\t\tw.unref();\n"
+	    "\t\tw.on('exit', () => this.#remove(w));\n"
+	    "\t\tthis.#workers.push(w);\n"
+	    "\t\treturn w;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/*\n"
+	    "\t * Forget a worker that has failed or exited.  If it "
+	     "was idle,\n"
+	    "\t * replace it now; otherwise, it's replaced when "
+	     "released.\n"
+	    "\t * Nothing is replaced once closed.\n"
+	    "\t */\n"
+	    "\t#remove(w: Worker): void\n"
+	    "\t{\n"
+	    "\t\tlet i: number;\n"
+	    "\t\tif ((i = this.#workers.indexOf(w)) === -1)\n"
+	    "\t\t\treturn;\n"
+	    "\t\tthis.#workers.splice(i, 1);\n"
+	    "\t\tif ((i = this.#idle.indexOf(w)) === -1)\n"
+	    "\t\t\treturn;\n"
+	    "\t\tif (this.#closed)\n"
+	    "\t\t\tthis.#idle.splice(i, 1);\n"
+	    "\t\telse\n"
+	    "\t\t\tthis.#idle.splice(i, 1, this.#spawn());\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/*\n"
+	    "\t * Wait for an idle worker, or null if there are none "
+	     "at all (or\n"
+	    "\t * the pool has been closed), when the caller should "
+	     "use the main\n"
+	    "\t * connection instead.\n"
+	    "\t */\n"
+	    "\t#acquire(): Promise<Worker|null>\n"
+	    "\t{\n"
+	    "\t\tconst w: Worker|undefined = this.#idle.pop();\n"
+	    "\t\tif (w !== undefined)\n"
+	    "\t\t\treturn Promise.resolve(w);\n"
+	    "\t\tif (this.#workers.length === 0)\n"
+	    "\t\t\treturn Promise.resolve(null);\n"
+	    "\t\treturn new Promise(resolve => "
+	     "this.#wait.push(resolve));\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/*\n"
+	    "\t * Give a worker back after a query, replacing it if "
+	     "it has failed.\n"
+	    "\t * Once closed, the worker is terminated instead.\n"
+	    "\t */\n"
+	    "\t#release(w: Worker): void\n"
+	    "\t{\n"
+	    "\t\tif (this.#closed) {\n"
+	    "\t\t\tw.terminate();\n"
+	    "\t\t\treturn;\n"
+	    "\t\t}\n"
+	    "\t\tconst next: ((w: Worker|null) => void)|undefined =\n"
+	    "\t\t\tthis.#wait.shift();\n"
+	    "\t\tif (!this.#workers.includes(w))\n"
+	    "\t\t\tw = this.#spawn();\n"
+	    "\t\tif (next !== undefined)\n"
+	    "\t\t\tnext(w);\n"
+	    "\t\telse\n"
+	    "\t\t\tthis.#idle.push(w);\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/*\n"
+	    "\t * Blobs arrive from workers as Uint8Array: make them "
+	     "Buffer again.\n"
+	    "\t */\n"
+	    "\t#buffers(rows: any[][]): any[][]\n"
+	    "\t{\n"
+	    "\t\tfor (const row of rows)\n"
+	    "\t\t\tfor (let i: number = 0; i < row.length; i++)\n"
+	    "\t\t\t\tif (row[i] instanceof Uint8Array)\n"
+	    "\t\t\t\t\trow[i] = Buffer.from(row[i].buffer,\n"
+	    "\t\t\t\t\t\trow[i].byteOffset,\n"
+	    "\t\t\t\t\t\trow[i].byteLength);\n"
+	    "\t\treturn rows;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#send(w: Worker, msg: any): Promise<any[]>\n"
+	    "\t{\n"
+	    "\t\treturn new Promise((resolve, reject) => {\n"
+	    "\t\t\tconst off = (): void => {\n"
+	    "\t\t\t\tw.off('message', onmsg);\n"
+	    "\t\t\t\tw.off('error', onerr);\n"
+	    "\t\t\t\tw.off('exit', onexit);\n"
+	    "\t\t\t};\n"
+	    "\t\t\tconst onerr = (er: Error): void => {\n"
+	    "\t\t\t\toff();\n"
+	    "\t\t\t\tthis.#remove(w);\n"
+	    "\t\t\t\treject(er);\n"
+	    "\t\t\t};\n"
+	    "\t\t\tconst onexit = (code: number): void => {\n"
+	    "\t\t\t\toff();\n"
+	    "\t\t\t\tthis.#remove(w);\n"
+	    "\t\t\t\treject(new Error"
+	     "('worker exited: ' + code));\n"
+	    "\t\t\t};\n"
+	    "\t\t\tconst onmsg = (m: any): void => {\n"
+	    "\t\t\t\toff();\n"
+	    "\t\t\t\tif (m.error !== undefined) {\n"
+	    "\t\t\t\t\treject(new Error(m.error));\n"
+	    "\t\t\t\t\treturn;\n"
+	    "\t\t\t\t}\n"
+	    "\t\t\t\tresolve(this.#buffers(m.rows));\n"
+	    "\t\t\t};\n"
+	    "\t\t\tw.once('message', onmsg);\n"
+	    "\t\t\tw.once('error', onerr);\n"
+	    "\t\t\tw.once('exit', onexit);\n"
+	    "\t\t\tw.postMessage(msg);\n"
+	    "\t\t});\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Run a query, resolving to all of its rows, each as "
+	     "an array of\n"
+	    "\t * column values.\n"
+	    "\t */\n"
+	    "\tasync all(sql: string, parms: any[]): Promise<any[]>\n"
+	    "\t{\n"
+	    "\t\tconst w: Worker|null = await this.#acquire();\n"
+	    "\t\tif (w === null)\n"
+	    "\t\t\treturn this.#db.prepare(sql)."
+	     "raw(true).all(parms);\n"
+	    "\t\ttry {\n"
+	    "\t\t\treturn await this.#send(w, "
+	     "{ op: 'all', sql, parms });\n"
+	    "\t\t} finally {\n"
+	    "\t\t\tthis.#release(w);\n"
+	    "\t\t}\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Run a query, resolving to the first row, an array of "
+	     "column\n"
+	    "\t * values, or undefined if there are no rows.\n"
+	    "\t */\n"
+	    "\tasync get(sql: string, parms: any[]): Promise<any>\n"
+	    "\t{\n"
+	    "\t\tconst w: Worker|null = await this.#acquire();\n"
+	    "\t\tif (w === null)\n"
+	    "\t\t\treturn this.#db.prepare(sql)."
+	     "raw(true).get(parms);\n"
+	    "\t\ttry {\n"
+	    "\t\t\treturn (await this.#send(w,\n"
+	    "\t\t\t\t{ op: 'get', sql, parms }))[0];\n"
+	    "\t\t} finally {\n"
+	    "\t\t\tthis.#release(w);\n"
+	    "\t\t}\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Run a query, yielding each row as an array of column "
+	     "values.\n"
+	    "\t * Rows are passed from the worker \"batch\" at a time.  "
+	     "The worker\n"
+	    "\t * is held until the iterator completes or is returned.\n"
+	    "\t */\n"
+	    "\tasync *iterate(sql: string, parms: any[], "
+	     "batch: number):\n"
+	    "\t\tAsyncIterableIterator<any[]>\n"
+	    "\t{\n"
+	    "\t\tconst w: Worker|null = await this.#acquire();\n"
+	    "\t\tif (w === null) {\n"
+	    "\t\t\tconst db: Database.Database =\n"
+	    "\t\t\t\tnew Database(this.#db.name,\n"
+	    "\t\t\t\t{ readonly: true, fileMustExist: true });\n"
+	    "\t\t\tlet n: number = 0;\n"
+	    "\t\t\tdb.defaultSafeIntegers(true);\n", f) == EOF)
+		return 0;
+	if (!gen_pragmas_readonly(f, cfg, "\t\t\t"))
+		return 0;
+	return fputs("\t\t\ttry {\n"
+	    "\t\t\t\tconst stmt: Database.Statement =\n"
+	    "\t\t\t\t\tdb.prepare(sql).raw(true);\n"
+	    "\t\t\t\tfor (const cols of stmt.iterate(parms)) {\n"
+	    "\t\t\t\t\tyield <any[]>cols;\n"
+	    "\t\t\t\t\tif (++n % batch === 0)\n"
+	    "\t\t\t\t\t\tawait new Promise(resolve =>\n"
+	    "\t\t\t\t\t\t\tsetImmediate(resolve));\n"
+	    "\t\t\t\t}\n"
+	    "\t\t\t} finally {\n"
+	    "\t\t\t\tdb.close();\n"
+	    "\t\t\t}\n"
+	    "\t\t\treturn;\n"
+	    "\t\t}\n"
+	    "\t\tlet done: boolean = false;\n"
+	    "\t\ttry {\n"
+	    "\t\t\tlet rows: any[] = await this.#send(w,\n"
+	    "\t\t\t\t{ op: 'iterate', sql, parms, batch });\n"
+	    "\t\t\tfor (;;) {\n"
+	    "\t\t\t\tfor (const cols of rows)\n"
+	    "\t\t\t\t\tyield cols;\n"
+	    "\t\t\t\tif (rows.length < batch)\n"
+	    "\t\t\t\t\tbreak;\n"
+	    "\t\t\t\trows = await this.#send(w,\n"
+	    "\t\t\t\t\t{ op: 'next', batch });\n"
+	    "\t\t\t}\n"
+	    "\t\t\tdone = true;\n"
+	    "\t\t} finally {\n"
+	    "\t\t\tif (!done && this.#workers.includes(w))\n"
+	    "\t\t\t\tawait this.#send(w, { op: 'close' })\n"
+	    "\t\t\t\t\t.catch(() => undefined);\n"
+	    "\t\t\tthis.#release(w);\n"
+	    "\t\t}\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Stop all workers.  Queries after this run on the main "
+	     "connection,\n"
+	    "\t * as do those still waiting for a worker.\n"
+	    "\t */\n"
+	    "\tasync close(): Promise<void>\n"
+	    "\t{\n"
+	    "\t\tconst workers: Worker[] = "
+	     "this.#workers.splice(0);\n"
+	    "\t\tthis.#closed = true;\n"
+	    "\t\tthis.#idle.length = 0;\n"
+	    "\t\tfor (const next of this.#wait.splice(0))\n"
+	    "\t\t\tnext(null);\n"
+	    "\t\tawait Promise.all(workers.map(w => w.terminate()));\n"
+	    "\t}\n"
+	    "}\n", f) != EOF;
+}
+
+/*
+ * Collect into "set" (of size "sz", already holding "n" structures)
+ * the structures whose changes may change the results of queries in
+ * the first, if "write" is zero, or whose rows may be changed by
+ * modifications of the first through references with actions, if it
+ * is non-zero.
+ * Return the number of structures in the set.
+ */
+static size_t
+get_cache_tables(const struct config *cfg,
+	const struct strct **set, size_t n, int write)
+{
+	const struct strct	*p;
+	const struct field	*fd;
+	size_t			 i, j;
+	int			 more = 1;
+
+	while (more) {
+		more = 0;
+		TAILQ_FOREACH(p, &cfg->sq, entries) {
+			for (i = 0; i < n; i++)
+				if (set[i] == p)
+					break;
+			TAILQ_FOREACH(fd, &p->fq, entries) {
+				if (fd->ref == NULL)
+					continue;
+				if (!write && i < n &&
+				    fd->type == FTYPE_STRUCT) {
+					for (j = 0; j < n; j++)
+						if (set[j] == 
+						    fd->ref->target->parent)
+							break;
+					if (j == n) {
+						set[n++] = 
+						    fd->ref->target->parent;
+						more = 1;
+					}
+				}
+				if (!write || i < n ||
+				    fd->type == FTYPE_STRUCT ||
+				    ((fd->actdel == UPACT_NONE ||
+				      fd->actdel == UPACT_RESTRICT) &&
+				     (fd->actup == UPACT_NONE ||
+				      fd->actup == UPACT_RESTRICT)))
+					continue;
+				for (j = 0; j < n; j++)
+					if (set[j] == fd->ref->target->parent)
+						break;
+				if (j < n) {
+					set[n++] = p;
+					more = 1;
+					break;
+				}
+			}
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Generate the cache of query results and the tables it tracks for each
+ * structure, if any queries are marked for caching.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_ortcache(const struct ort_lang_nodejs *args,
+	FILE *f, const struct config *cfg)
+{
+	const struct strct	*p, **set;
+	size_t			 i, n, sz = 0;
+	int			 write;
+
+	if (!has_cache(cfg))
+		return 1;
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		sz++;
+	if ((set = calloc(sz, sizeof(struct strct *))) == NULL)
+		return 0;
+
+	if (fputc('\n', f) == EOF)
+		goto err;
+	if (!gen_comment(f, 0, COMMENT_JS,
+	    "Tables whose changes invalidate cached queries of each "
+	    "structure (\"read\"), and tables changed by its "
+	    "modifications (\"write\"), including those changed by "
+	    "reference actions."))
+		goto err;
+	if (fputs("namespace ortcachetab {\n", f) == EOF)
+		goto err;
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		for (write = 0; write < 2; write++) {
+			set[0] = p;
+			n = get_cache_tables(cfg, set, 1, write);
+			if (fprintf(f, "\texport const %s_%s: "
+			    "readonly string[] = [", p->name,
+			    write ? "write" : "read") < 0)
+				goto err;
+			for (i = 0; i < n; i++)
+				if (fprintf(f, "%s\'%s\'", i > 0 ? 
+				    ", " : "", set[i]->name) < 0)
+					goto err;
+			if (fputs("];\n", f) == EOF)
+				goto err;
+		}
+	if (fputs("}\n\n", f) == EOF)
+		goto err;
+	free(set);
+
+	if (!gen_comment(f, 0, COMMENT_JS,
+	    "Least-recently used cache of the results of queries "
+	    "marked \"cache\", keyed on the query and its "
+	    "parameters.  Modifications bump the generation of the "
+	    "tables they change, and entries are discarded when "
+	    "the generations of the tables they read have changed.  "
+	    "Entries hold the rows as read from the database, not "
+	    "the objects filled from them, so objects returned from "
+	    "cached queries may be freely modified (but not blob "
+	    "buffers, which are shared)."))
+		return 0;
+	if (!(args->flags & ORT_LANG_NODEJS_NOMODULE) &&
+	    fputs("export ", f) == EOF)
+		return 0;
+	if (fputs("class ortcache {\n", f) == EOF)
+		return 0;
+	if (!gen_comment(f, 1, COMMENT_JS,
+	    "Maximum number of entries.  Zero disables caching."))
+		return 0;
+	if (fputs("\tmax: number;\n"
+	    "\treadonly #entries: Map<string, "
+	     "{gen: number, value: any}> =\n"
+	    "\t\tnew Map();\n"
+	    "\treadonly #gens: {[table: string]: number} = {\n", f) == EOF)
+		return 0;
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		if (fprintf(f, "\t\t\'%s\': 0,\n", p->name) < 0)
+			return 0;
+	return fputs("\t};\n"
+	    "\n"
+	    "\tconstructor(max: number)\n"
+	    "\t{\n"
+	    "\t\tthis.max = max;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#gen(tables: readonly string[]): number\n"
+	    "\t{\n"
+	    "\t\tlet gen: number = 0;\n"
+	    "\t\tfor (const t of tables)\n"
+	    "\t\t\tgen += this.#gens[t];\n"
+	    "\t\treturn gen;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#key(id: string, parms: any[]): string\n"
+	    "\t{\n"
+	    "\t\treturn id + JSON.stringify(parms, (k, v) =>\n"
+	    "\t\t\ttypeof v === 'bigint' ? v.toString() : v);\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#find(key: string, gen: number):\n"
+	    "\t\t{gen: number, value: any}|undefined\n"
+	    "\t{\n"
+	    "\t\tconst ent: {gen: number, value: any}|undefined =\n"
+	    "\t\t\tthis.#entries.get(key);\n"
+	    "\t\tif (ent === undefined)\n"
+	    "\t\t\treturn undefined;\n"
+	    "\t\tthis.#entries.delete(key);\n"
+	    "\t\tif (ent.gen !== gen)\n"
+	    "\t\t\treturn undefined;\n"
+	    "\t\tthis.#entries.set(key, ent);\n"
+	    "\t\treturn ent;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t#put(key: string, gen: number, value: any): any\n"
+	    "\t{\n"
+	    "\t\tif (this.max <= 0)\n"
+	    "\t\t\treturn value;\n"
+	    "\t\tthis.#entries.set(key, {gen, value});\n"
+	    "\t\twhile (this.#entries.size > this.max)\n"
+	    "\t\t\tthis.#entries.delete\n"
+	    "\t\t\t\t(<string>this.#entries.keys().next().value);\n"
+	    "\t\treturn value;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Get the entry for query \"id\" with \"parms\" if "
+	     "still current, else\n"
+	    "\t * run \"fn\" and store its result.\n"
+	    "\t */\n"
+	    "\tget(id: string, tables: readonly string[], "
+	     "parms: any[],\n"
+	    "\t\tfn: () => any): any\n"
+	    "\t{\n"
+	    "\t\tconst key: string = this.#key(id, parms);\n"
+	    "\t\tconst gen: number = this.#gen(tables);\n"
+	    "\t\tconst ent: {gen: number, value: any}|undefined =\n"
+	    "\t\t\tthis.#find(key, gen);\n"
+	    "\t\treturn ent !== undefined ? ent.value :\n"
+	    "\t\t\tthis.#put(key, gen, fn());\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Like {@link get}, but for an asynchronous \"fn\".  "
+	     "The generations\n"
+	    "\t * are those from before it runs, so modifications "
+	     "meanwhile\n"
+	    "\t * invalidate the entry.\n"
+	    "\t */\n"
+	    "\tasync getAsync(id: string, tables: readonly string[],\n"
+	    "\t\tparms: any[], fn: () => Promise<any>): Promise<any>\n"
+	    "\t{\n"
+	    "\t\tconst key: string = this.#key(id, parms);\n"
+	    "\t\tconst gen: number = this.#gen(tables);\n"
+	    "\t\tconst ent: {gen: number, value: any}|undefined =\n"
+	    "\t\t\tthis.#find(key, gen);\n"
+	    "\t\treturn ent !== undefined ? ent.value :\n"
+	    "\t\t\tthis.#put(key, gen, await fn());\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Invalidate entries having read any of \"tables\".\n"
+	    "\t */\n"
+	    "\tbump(tables: readonly string[]): void\n"
+	    "\t{\n"
+	    "\t\tfor (const t of tables)\n"
+	    "\t\t\tthis.#gens[t]++;\n"
+	    "\t}\n"
+	    "\n"
+	    "\t/**\n"
+	    "\t * Invalidate all entries, e.g., after rolling back a "
+	     "transaction.\n"
+	    "\t */\n"
+	    "\tclear(): void\n"
+	    "\t{\n"
+	    "\t\tthis.#entries.clear();\n"
+	    "\t\tfor (const t in this.#gens)\n"
+	    "\t\t\tthis.#gens[t]++;\n"
+	    "\t}\n"
+	    "}\n", f) != EOF;
+err:
+	free(set);
+	return 0;
+}
+
 /*
  * Generate the class for managing a single connection.
  * This is otherwise defined as a single sequence of role transitions.
  * Return zero on failure, non-zero on success.
  */
 static int
-gen_ortdb(const struct ort_lang_nodejs *args, FILE *f)
+gen_ortdb(const struct ort_lang_nodejs *args,
+	FILE *f, const struct config *cfg)
 {
+	size_t	 i;
 
 	if (fputc('\n', f) == EOF)
 		return 0;
@@ -1813,6 +4312,18 @@ gen_ortdb(const struct ort_lang_nodejs *args, FILE *f)
 	if (fputs("class ortdb {\n"
 	    "\tdb: Database.Database;\n", f) == EOF)
 		return 0;
+	if ((args->flags & ORT_LANG_NODEJS_POOL) &&
+	    fputs("\treadonly pool: ortpool;\n", f) == EOF)
+		return 0;
+	if (has_cache(cfg)) {
+		if (!gen_comment(f, 1, COMMENT_JS,
+		    "Results of queries marked \"cache\", by default "
+		    "holding at most 1000 entries."))
+			return 0;
+		if (fputs("\treadonly cache: ortcache = "
+		    "new ortcache(1000);\n", f) == EOF)
+			return 0;
+	}
 	if (!gen_comment(f, 1, COMMENT_JS,
 	    "The ort-nodejs version used to produce this file."))
 		return 0;
@@ -1826,15 +4337,75 @@ gen_ortdb(const struct ort_lang_nodejs *args, FILE *f)
 	if (fprintf(f, "\treadonly vstamp: number = %lld;\n"
 	    "\n", (long long)ORT_VSTAMP) < 0)
 		return 0;
-	if (!gen_comment(f, 1, COMMENT_JS,
-	    "@param dbname The file-name of the database "
-	    "relative to the running application."))
+	if (!(args->flags & ORT_LANG_NODEJS_POOL)) {
+		if (!gen_comment(f, 1, COMMENT_JS,
+		    "@param dbname The file-name of the database "
+		    "relative to the running application."))
+			return 0;
+		if (fputs("\tconstructor(dbname: string) {\n", f) == EOF)
+			return 0;
+	} else {
+		if (!gen_comment(f, 1, COMMENT_JS,
+		    "@param dbname The file-name of the database "
+		    "relative to the running application.\n"
+		    "@param workers The number of workers in {@link "
+		    "ortpool}, each with its own read-only connection."))
+			return 0;
+		if (fputs("\tconstructor(dbname: string, "
+		    "workers: number = 0) {\n", f) == EOF)
+			return 0;
+	}
+	if (fputs("\t\tthis.db = new Database(dbname);\n"
+	    "\t\tthis.db.defaultSafeIntegers(true);\n", f) == EOF)
 		return 0;
-	if (fputs("\tconstructor(dbname: string) {\n"
-	    "\t\tthis.db = new Database(dbname);\n"
-	    "\t\tthis.db.defaultSafeIntegers(true);\n"
-	    "\t}\n\n", f) == EOF)
+
+	/* Tuning from the "database" block, if any. */
+
+	for (i = 0; i < PRAGMA__MAX; i++) {
+		if (!gen_sql_pragma_isset(cfg->db, i))
+			continue;
+		if (fputs("\t\tthis.db.exec(\'", f) == EOF)
+			return 0;
+		if (gen_sql_pragma(f, cfg->db, i) < 0)
+			return 0;
+		if (fputs("\');\n", f) == EOF)
+			return 0;
+	}
+
+	if ((args->flags & ORT_LANG_NODEJS_POOL) &&
+	    fputs("\t\tthis.pool = new ortpool(this.db, workers);\n",
+	    f) == EOF)
 		return 0;
+	if (fputs("\t}\n\n", f) == EOF)
+		return 0;
+
+	/*
+	 * Without the pool, asynchronous iterates use their own
+	 * read-only connection, which needs the same tuning (less the
+	 * journal mode, which is a property of the database file).
+	 */
+
+	if (!(args->flags & ORT_LANG_NODEJS_POOL) && has_iterate(cfg)) {
+		if (!gen_comment(f, 1, COMMENT_JS,
+		    "Open a read-only connection to the database "
+		    "with the tuning of the primary connection.  "
+		    "This is used by asynchronous iterates.  The "
+		    "caller must close the connection."))
+			return 0;
+		if (fputs("\tconnectReadonly(): Database.Database\n"
+		    "\t{\n"
+		    "\t\tconst db: Database.Database = new Database\n"
+		    "\t\t\t(this.db.name, "
+		    "{ readonly: true, fileMustExist: true });\n"
+		    "\t\tdb.defaultSafeIntegers(true);\n", f) == EOF)
+			return 0;
+		if (!gen_pragmas_readonly(f, cfg, "\t\t"))
+			return 0;
+		if (fputs("\t\treturn db;\n"
+		    "\t}\n\n", f) == EOF)
+			return 0;
+	}
+
 	if (!gen_comment(f, 1, COMMENT_JS,
 	    "Connect to the database.  This should be invoked for "
 	    "each request.  In applications not having a request, "
@@ -2103,24 +4674,29 @@ gen_ortctx(const struct ort_lang_nodejs *args,
 		return 0;
 	if (fputs("\tdb_trans_rollback(id: number): void\n"
 	    "\t{\n"
-	    "\t\tthis.#o.db.exec(\'ROLLBACK TRANSACTION\');\n"
-	    "\t}\n\n", f) == EOF)
+	    "\t\tthis.#o.db.exec(\'ROLLBACK TRANSACTION\');\n", f) == EOF)
+		return 0;
+	if (has_cache(cfg) &&
+	    fputs("\t\tthis.#o.cache.clear();\n", f) == EOF)
+		return 0;
+	if (fputs("\t}\n\n", f) == EOF)
 		return 0;
 
 	if (!gen_comment(f, 1, COMMENT_JS,
 	    "Commit a transaction opened by db_trans_open_xxxx() "
 	    "with identifier \"id\".  Throws an exception on "
 	    "database error."))
+		return 0;
 	if (fputs("\tdb_trans_commit(id: number): void\n"
 	    "\t{\n"
 	    "\t\tthis.#o.db.exec(\'COMMIT TRANSACTION\');\n"
 	    "\t}\n", f) == EOF)
-	    	return 0;
+		return 0;
 
 	if (!gen_ortctx_dbrole(f, cfg))
 		return 0;
 	TAILQ_FOREACH(p, &cfg->sq, entries)
-		if (!gen_api(f, cfg, p))
+		if (!gen_api(f, cfg, args, p))
 			return 0;
 	return fputs("}\n", f) != EOF;
 }
@@ -2151,6 +4727,11 @@ ort_lang_nodejs(const struct ort_lang_nodejs *args,
 		    fputs("import bcrypt from 'bcrypt';\n"
 		    "import Database from 'better-sqlite3';\n", f) == EOF)
 			return 0;
+		if ((args->flags & ORT_LANG_NODEJS_DB) &&
+		    (args->flags & ORT_LANG_NODEJS_POOL) &&
+		    fputs("import { Worker } from 'worker_threads';\n",
+		    f) == EOF)
+			return 0;
 		if ((args->flags & ORT_LANG_NODEJS_VALID) &&
 		    fputs("import validator from 'validator';\n", f) == EOF)
 			return 0;
@@ -2165,7 +4746,12 @@ ort_lang_nodejs(const struct ort_lang_nodejs *args,
 		return 0;
 
 	if ((args->flags & ORT_LANG_NODEJS_DB)) {
-		if (!gen_ortdb(args, f))
+		if ((args->flags & ORT_LANG_NODEJS_POOL) &&
+		    !gen_ortpool(args, f, cfg))
+			return 0;
+		if (!gen_ortcache(args, f, cfg))
+			return 0;
+		if (!gen_ortdb(args, f, cfg))
 			return 0;
 		if (!gen_ortctx(args, f, cfg))
 			return 0;
@@ -2181,7 +4767,12 @@ ort_lang_nodejs(const struct ort_lang_nodejs *args,
 		if (!(args->flags & ORT_LANG_NODEJS_NOMODULE) &&
 		    fputs("export ", f) == EOF)
 			return 0;
-		if (fputs
+		if ((args->flags & ORT_LANG_NODEJS_POOL) ? fputs
+		    ("function ort(dbname: string, "
+		     "workers: number = 0): ortdb\n"
+		     "{\n"
+		     "\treturn new ortdb(dbname, workers);\n"
+		     "}\n", f) == EOF : fputs
 		    ("function ort(dbname: string): ortdb\n"
 		     "{\n"
 		     "\treturn new ortdb(dbname);\n"
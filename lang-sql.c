@@ -250,8 +250,24 @@ ort_lang_sql(const struct ort_lang_sql *args,
 	const struct config *cfg, FILE *f)
 {
 	const struct strct *p;
+	size_t		    i;
+	int		    c;
 
-	if (fputs("PRAGMA foreign_keys=ON;\n\n", f) == EOF)
+	if (fputs("PRAGMA foreign_keys=ON;\n", f) == EOF)
+		return 0;
+
+	/* Tuning from the "database" block, if any. */
+
+	for (i = 0; i < PRAGMA__MAX; i++) {
+		if ((c = gen_sql_pragma(f, cfg->db, i)) < 0)
+			return 0;
+		else if (c == 0)
+			continue;
+		if (fputs(";\n", f) == EOF)
+			return 0;
+	}
+
+	if (fputc('\n', f) == EOF)
 		return 0;
 
 	TAILQ_FOREACH(p, &cfg->sq, entries)
@@ -51,11 +51,48 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"|", /* OPTYPE_OR */
 	"=", /* OPTYPE_STREQ */
 	"!=", /* OPTYPE_STRNEQ */
+	"IN", /* OPTYPE_IN */
 	/* Unary types... */
 	"ISNULL", /* OPTYPE_ISNULL */
 	"NOTNULL", /* OPTYPE_NOTNULL */
 };
 
+static	const char *const pragmas[PRAGMA__MAX] = {
+	"journal_mode", /* PRAGMA_JOURNAL_MODE */
+	"synchronous", /* PRAGMA_SYNCHRONOUS */
+	"cache_size", /* PRAGMA_CACHE_SIZE */
+	"mmap_size", /* PRAGMA_MMAP_SIZE */
+	"busy_timeout", /* PRAGMA_BUSY_TIMEOUT */
+};
+
+static	const char *const journals[JOURNAL__MAX] = {
+	NULL, /* JOURNAL_DEFAULT */
+	"DELETE", /* JOURNAL_DELETE */
+	"TRUNCATE", /* JOURNAL_TRUNCATE */
+	"PERSIST", /* JOURNAL_PERSIST */
+	"MEMORY", /* JOURNAL_MEMORY */
+	"WAL", /* JOURNAL_WAL */
+	"OFF", /* JOURNAL_OFF */
+};
+
+static	const char *const syncs[SYNC__MAX] = {
+	NULL, /* SYNC_DEFAULT */
+	"OFF", /* SYNC_OFF */
+	"NORMAL", /* SYNC_NORMAL */
+	"FULL", /* SYNC_FULL */
+	"EXTRA", /* SYNC_EXTRA */
+};
+
+/*
+ * SQL functions for the STYPE_ISAGGR query types, starting with
+ * STYPE_SUM.
+ */
+static	const char *const aggrfuncs[STYPE__MAX - STYPE_SUM] = {
+	"SUM", /* STYPE_SUM */
+	"AVG", /* STYPE_AVG */
+	"MIN", /* STYPE_MIN */
+	"MAX", /* STYPE_MAX */
+};
 
 /*
  * Generate a (possibly) multi-line comment with "tabs" number of
@@ -423,6 +460,116 @@ gen_sql_stmt_join(FILE *f, size_t tabs, enum langt lang,
 	return 1;
 }
 
+/*
+ * Whether the rowid or unique field "fd" has a batched lookup statement
+ * STMT_xxx_BY_UNIQUE_MANY_yyy, which binds its keys as a JSON array.
+ * Return zero if not, non-zero if so.
+ */
+int
+gen_sql_unique_many(const struct field *fd)
+{
+
+	if (!(fd->flags & (FIELD_ROWID|FIELD_UNIQUE)))
+		return 0;
+	return fd->type != FTYPE_BLOB && fd->type != FTYPE_REAL &&
+		fd->type != FTYPE_PASSWORD && fd->type != FTYPE_STRUCT;
+}
+
+/*
+ * Generate the lookup statement for the rowid or unique field "fd".
+ * If "many" is non-zero, this generates the batched variant matching
+ * any of a JSON array of keys.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_sql_stmt_unique(FILE *f, size_t tabs, enum langt lang,
+	const struct field *fd, int many)
+{
+	const struct strct	*p = fd->parent;
+	size_t			 i, nc, col;
+	int			 rc;
+	char			 delim;
+	const char		*spacer;
+
+	delim = lang == LANG_JS ? '\'' : '"';
+	spacer = lang == LANG_JS ? "+ " : "";
+
+	for (i = 0; i < tabs; i++)
+		if (fputc('\t', f) == EOF)
+			return 0;
+	if (fprintf(f, "/* STMT_%s_BY_UNIQUE_%s%s */\n", 
+	    p->name, many ? "MANY_" : "", fd->name) < 0)
+		return 0;
+	for (i = 0; i < tabs; i++)
+		if (fputc('\t', f) == EOF)
+			return 0;
+	col = tabs * 8;
+	if ((rc = fprintf(f, "%cSELECT ", delim)) < 0)
+		return 0;
+	col += rc;
+	if (!gen_sql_stmt_schema(f, 
+	    tabs, lang, p, 1, p, NULL, &col))
+		return 0;
+
+	if (fprintf(f, "%s%c FROM %s", 
+	    spacer, delim, p->name) < 0)
+		return 0;
+	nc = 0;
+	if (!gen_sql_stmt_join
+	    (f, tabs, lang, p, p, NULL, &nc))
+		return 0;
+	if (nc > 0) {
+		if (fputc('\n', f) == EOF)
+			return 0;
+		for (i = 0; i < tabs + 1; i++)
+			if (fputc('\t', f) == EOF)
+				return 0;
+		if (fprintf(f, "%s%c", spacer, delim) < 0)
+			return 0;
+	} else {
+		if (fputc(' ', f) == EOF)
+			return 0;
+	}
+
+	/*
+	 * The batched variant is ordered by key so that callers may
+	 * merge the results with their own sorted keys.
+	 */
+
+	if (many)
+		return fprintf(f, "WHERE %s.%s IN "
+			"(SELECT value FROM json_each(?)) "
+			"ORDER BY %s.%s%c,\n", p->name, fd->name, 
+			p->name, fd->name, delim) > 0;
+
+	return fprintf(f, "WHERE %s.%s = ?%c,\n", 
+		p->name, fd->name, delim) > 0;
+}
+
+/*
+ * Finish an open insert or update statement by returning the columns of
+ * the modified rows, which are put on their own line.
+ * The linker makes sure that there are no nested structures to join.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+gen_sql_stmt_returning(FILE *f, size_t tabs,
+	const struct strct *p, enum langt lang)
+{
+	size_t	 i;
+
+	if (fprintf(f, "%c\n", lang == LANG_JS ? '\'' : '"') < 0)
+		return 0;
+	for (i = 0; i < tabs + 1; i++)
+		if (fputc('\t', f) == EOF)
+			return 0;
+	if (lang == LANG_JS)
+		return fprintf(f, "+ ' RETURNING ' + "
+			"ort_schema_%s('%s'),\n", p->name, p->name) > 0;
+	return fprintf(f, "\" RETURNING \" "
+		"DB_SCHEMA_%s(%s),\n", p->name, p->name) > 0;
+}
+
 int
 gen_sql_stmts(FILE *f, size_t tabs, 
 	const struct strct *p, enum langt lang)
@@ -446,6 +593,8 @@ gen_sql_stmts(FILE *f, size_t tabs,
 	 * These are generated in the event of null foreign key
 	 * reference lookups with the generated db_xxx_reffind()
 	 * functions.
+	 * The batched variants are used both for those lookups over
+	 * multiple results and for db_xxx_get_many_by_yyy().
 	 * TODO: figure out which ones we should be generating and only
 	 * do this, as otherwise we're just wasting static space.
 	 */
@@ -453,45 +602,10 @@ gen_sql_stmts(FILE *f, size_t tabs,
 	TAILQ_FOREACH(fd, &p->fq, entries)  {
 		if (!(fd->flags & (FIELD_ROWID|FIELD_UNIQUE)))
 			continue;
-		for (i = 0; i < tabs; i++)
-			if (fputc('\t', f) == EOF)
-				return 0;
-		if (fprintf(f, "/* STMT_%s_BY_UNIQUE_%s */\n", 
-		    p->name, fd->name) < 0)
-			return 0;
-		for (i = 0; i < tabs; i++)
-			if (fputc('\t', f) == EOF)
-				return 0;
-		col = tabs * 8;
-		if ((rc = fprintf(f, "%cSELECT ", delim)) < 0)
+		if (!gen_sql_stmt_unique(f, tabs, lang, fd, 0))
 			return 0;
-		col += rc;
-		if (!gen_sql_stmt_schema(f, 
-		    tabs, lang, p, 1, p, NULL, &col))
-			return 0;
-
-		if (fprintf(f, "%s%c FROM %s", 
-		    spacer, delim, p->name) < 0)
-			return 0;
-		nc = 0;
-		if (!gen_sql_stmt_join
-		    (f, tabs, lang, p, p, NULL, &nc))
-			return 0;
-		if (nc > 0) {
-			if (fputc('\n', f) == EOF)
-				return 0;
-			for (i = 0; i < tabs + 1; i++)
-				if (fputc('\t', f) == EOF)
-					return 0;
-			if (fprintf(f, "%s%c", spacer, delim) < 0)
-				return 0;
-		} else {
-			if (fputc(' ', f) == EOF)
-				return 0;
-		}
-
-		if (fprintf(f, "WHERE %s.%s = ?%c,\n", 
-		    p->name, fd->name, delim) < 0)
+		if (gen_sql_unique_many(fd) &&
+		    !gen_sql_stmt_unique(f, tabs, lang, fd, 1))
 			return 0;
 	}
 
@@ -517,15 +631,35 @@ gen_sql_stmts(FILE *f, size_t tabs,
 		 * Juggle around the possibilities of...
 		 *   select count(*)
 		 *   select count(distinct --gen_sql_stmt_schema--)
+		 *   select sum(field) (or avg, min, max)
+		 *   select exists(select 1 ...)
 		 *   select --gen_sql_stmt_schema--
+		 * The count and aggregates may be prefixed by their
+		 * grouping key.
 		 */
 
+		if (s->groupby != NULL) {
+			if ((rc = fprintf(f, "%s.%s, ", 
+			    p->name, s->groupby->name)) < 0)
+				return 0;
+			col += rc;
+		}
 		if (s->type == STYPE_COUNT) {
 			if ((rc = fprintf(f, "COUNT(")) < 0)
 				return 0;
 			col += rc;
 		}
-		if (s->dst) {
+		if (s->type == STYPE_EXISTS) {
+			if ((rc = fprintf(f, "EXISTS(SELECT 1")) < 0)
+				return 0;
+			col += rc;
+		} else if (STYPE_ISAGGR(s->type)) {
+			if ((rc = fprintf(f, "%s(%s.%s)", 
+			    aggrfuncs[s->type - STYPE_SUM], 
+			    p->name, s->afield->name)) < 0)
+				return 0;
+			col += rc;
+		} else if (s->dst) {
 			if ((rc = fprintf(f, "DISTINCT ")) < 0)
 				return 0;
 			col += rc;
@@ -535,12 +669,13 @@ gen_sql_stmts(FILE *f, size_t tabs,
 			    NULL : s->dst->fname, &col))
 				return 0;
 			needquot = 1;
-		} else if (s->type != STYPE_COUNT) {
+		} else if (s->type != STYPE_COUNT &&
+		    s->type != STYPE_EXISTS) {
 			if (!gen_sql_stmt_schema(f, tabs, lang,
 			    p, 1, p, NULL, &col))
 				return 0;
 			needquot = 1;
-		} else
+		} else if (s->type == STYPE_COUNT)
 			if (fputc('*', f) == EOF)
 				return 0;
 
@@ -555,10 +690,13 @@ gen_sql_stmts(FILE *f, size_t tabs,
 		 * Whether anything is coming after the "FROM" clause,
 		 * which includes all ORDER, WHERE, GROUP, LIMIT, and
 		 * OFFSET commands.
+		 * Existence checks always close with a limit.
 		 */
 
 		hastrail = 
+			(s->type == STYPE_EXISTS) ||
 			(s->aggr != NULL && s->group != NULL) ||
+			(s->groupby != NULL) ||
 			(!TAILQ_EMPTY(&s->sntq)) ||
 			(!TAILQ_EMPTY(&s->ordq)) ||
 			(s->type != STYPE_SEARCH && s->limit > 0) ||
@@ -664,6 +802,17 @@ gen_sql_stmts(FILE *f, size_t tabs,
 				    sent->field->name, 
 				    optypes[sent->op]) < 0)
 					return 0;
+			} else if (sent->op == OPTYPE_IN) {
+				/* 
+				 * Sets are bound as a single JSON array,
+				 * so there's no limit on their size.
+				 */
+				if (fprintf(f, " %s.%s IN (SELECT "
+				    "value FROM json_each(?))", 
+				    sent->alias == NULL ?
+				    p->name : sent->alias->alias,
+				    sent->field->name) < 0)
+					return 0;
 			} else {
 				if (fprintf(f, " %s.%s %s ?", 
 				    sent->alias == NULL ?
@@ -674,6 +823,36 @@ gen_sql_stmts(FILE *f, size_t tabs,
 			}
 		}
 
+		/* 
+		 * Grouped aggregates drop groups without any non-null
+		 * values, so the aggregate value is never null.
+		 */
+
+		if (s->groupby != NULL && fprintf(f, " GROUP BY %s.%s",
+		    p->name, s->groupby->name) < 0)
+			return 0;
+		if (s->groupby != NULL && STYPE_ISAGGR(s->type) &&
+		    fprintf(f, " HAVING %s(%s.%s) IS NOT NULL",
+		    aggrfuncs[s->type - STYPE_SUM], 
+		    p->name, s->afield->name) < 0)
+			return 0;
+
+		/*
+		 * Existence checks stop at the first matching row, so
+		 * ordering and the query's limit are meaningless.
+		 */
+
+		if (s->type == STYPE_EXISTS) {
+			if (fputs(" LIMIT 1", f) == EOF)
+				return 0;
+			if (s->offset > 0 && fprintf(f, 
+			    " OFFSET %" PRId64, s->offset) < 0)
+				return 0;
+			if (fprintf(f, ")%c,\n", delim) < 0)
+				return 0;
+			continue;
+		}
+
 		first = 1;
 		if (!TAILQ_EMPTY(&s->ordq) &&
 		    fputs(" ORDER BY ", f) == EOF)
@@ -794,13 +973,17 @@ gen_sql_stmts(FILE *f, size_t tabs,
 				col += 2;
 				first = 0;
 			}
-			if (fprintf(f, ")%c,\n", delim) < 0)
+			if (fputc(')', f) == EOF)
 				return 0;
 		} else {
-			if (fprintf(f, 
-			    "DEFAULT VALUES%c,\n", delim) < 0)
+			if (fputs("DEFAULT VALUES", f) == EOF)
 				return 0;
 		}
+		if (p->ins->flags & INSERT_RETURNING) {
+			if (!gen_sql_stmt_returning(f, tabs, p, lang))
+				return 0;
+		} else if (fprintf(f, "%c,\n", delim) < 0)
+			return 0;
 	}
 	
 	/* 
@@ -894,7 +1077,10 @@ gen_sql_stmts(FILE *f, size_t tabs,
 			}
 			first = 0;
 		}
-		if (fprintf(f, "%c,\n", delim) < 0)
+		if (up->flags & UPDATE_RETURNING) {
+			if (!gen_sql_stmt_returning(f, tabs, p, lang))
+				return 0;
+		} else if (fprintf(f, "%c,\n", delim) < 0)
 			return 0;
 	}
 
@@ -914,6 +1100,16 @@ gen_sql_stmts(FILE *f, size_t tabs,
 		if (fprintf(f, "%cDELETE FROM %s", delim, p->name) < 0)
 			return 0;
 
+		/*
+		 * Batched deletes remove a bounded chunk per statement,
+		 * returning the row identifiers so that callers can
+		 * count them and know when to stop.
+		 */
+
+		if (up->batch > 0 && fprintf(f, " WHERE rowid IN "
+		    "(SELECT rowid FROM %s", p->name) < 0)
+			return 0;
+
 		first = 1;
 		TAILQ_FOREACH(ur, &up->crq, entries) {
 			if (fprintf(f, 
@@ -932,6 +1128,9 @@ gen_sql_stmts(FILE *f, size_t tabs,
 			}
 			first = 0;
 		}
+		if (up->batch > 0 && fprintf(f, " LIMIT %" PRId64 
+		    ") RETURNING rowid", up->batch) < 0)
+			return 0;
 		if (fprintf(f, "%c,\n", delim) < 0)
 			return 0;
 	}
@@ -956,6 +1155,14 @@ gen_sql_enums(FILE *f, size_t tabs,
 			if (fprintf(f, "STMT_%s_BY_UNIQUE_%s,\n", 
 			    p->name, fd->name) < 0)
 				return 0;
+			if (!gen_sql_unique_many(fd))
+				continue;
+			for (i = 0; i < tabs; i++)
+				if (fputc('\t', f) == EOF)
+					return 0;
+			if (fprintf(f, "STMT_%s_BY_UNIQUE_MANY_%s,\n", 
+			    p->name, fd->name) < 0)
+				return 0;
 		}
 
 	pos = 0;
@@ -1000,3 +1207,73 @@ gen_sql_enums(FILE *f, size_t tabs,
 	return 1;
 }
 
+/*
+ * See whether the pragma "type" is set in the "database" block, which
+ * may be NULL if not specified at all.
+ * Return zero if not set, non-zero if set.
+ */
+int
+gen_sql_pragma_isset(const struct database *db, enum pragmat type)
+{
+
+	if (db == NULL)
+		return 0;
+
+	switch (type) {
+	case PRAGMA_JOURNAL_MODE:
+		return db->journal != JOURNAL_DEFAULT;
+	case PRAGMA_SYNCHRONOUS:
+		return db->sync != SYNC_DEFAULT;
+	case PRAGMA_CACHE_SIZE:
+		return db->flags & DATABASE_CACHESIZE;
+	case PRAGMA_MMAP_SIZE:
+		return db->flags & DATABASE_MMAPSIZE;
+	case PRAGMA_BUSY_TIMEOUT:
+		return db->flags & DATABASE_BUSYTIMEOUT;
+	default:
+		break;
+	}
+
+	abort();
+	/* NOTREACHED */
+}
+
+/*
+ * Print the pragma "type" from the "database" block, e.g., "PRAGMA
+ * journal_mode = WAL", without any statement terminator.
+ * Return <0 on failure, 0 if the pragma was not specified (nothing is
+ * printed), >0 if it was printed.
+ */
+int
+gen_sql_pragma(FILE *f, const struct database *db, enum pragmat type)
+{
+	int	 c;
+
+	if (!gen_sql_pragma_isset(db, type))
+		return 0;
+
+	switch (type) {
+	case PRAGMA_JOURNAL_MODE:
+		c = fprintf(f, "PRAGMA %s = %s", 
+			pragmas[type], journals[db->journal]);
+		break;
+	case PRAGMA_SYNCHRONOUS:
+		c = fprintf(f, "PRAGMA %s = %s", 
+			pragmas[type], syncs[db->sync]);
+		break;
+	case PRAGMA_CACHE_SIZE:
+		c = fprintf(f, "PRAGMA %s = %" PRId64, 
+			pragmas[type], db->cachesize);
+		break;
+	case PRAGMA_MMAP_SIZE:
+		c = fprintf(f, "PRAGMA %s = %" PRId64, 
+			pragmas[type], db->mmapsize);
+		break;
+	default:
+		c = fprintf(f, "PRAGMA %s = %" PRId64, 
+			pragmas[type], db->busytimeout);
+		break;
+	}
+
+	return c < 0 ? -1 : 1;
+}
@@ -34,10 +34,26 @@ enum	langt {
 	LANG_C
 };
 
+/*
+ * Pragmas set by the "database" block, in the order that they should
+ * be applied.
+ */
+enum	pragmat {
+	PRAGMA_JOURNAL_MODE = 0,
+	PRAGMA_SYNCHRONOUS,
+	PRAGMA_CACHE_SIZE,
+	PRAGMA_MMAP_SIZE,
+	PRAGMA_BUSY_TIMEOUT,
+	PRAGMA__MAX
+};
+
 int	 gen_comment(FILE *, size_t, enum cmtt, const char *);
 int	 gen_commentv(FILE *, size_t, enum cmtt, const char *, ...)
 		__attribute__((format(printf, 4, 5)));
 int	 gen_sql_stmts(FILE *, size_t, const struct strct *, enum langt);
 int	 gen_sql_enums(FILE *, size_t, const struct strct *, enum langt);
+int	 gen_sql_pragma(FILE *, const struct database *, enum pragmat);
+int	 gen_sql_pragma_isset(const struct database *, enum pragmat);
+int	 gen_sql_unique_many(const struct field *);
 
 #endif /* !ORT_LANG_H */
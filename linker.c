@@ -170,19 +170,55 @@ check_searchtype(struct config *cfg, const struct search *srch)
 	/*
 	 * XXX: we use SQL's "count" function for this, so we can't
 	 * currently use any of the password equality checks.
+	 * The same goes for the other aggregate functions and for
+	 * existence checks, which never return the row.
 	 */
 
-	if (srch->type == STYPE_COUNT)
+	if (srch->type == STYPE_COUNT || 
+	    srch->type == STYPE_EXISTS || STYPE_ISAGGR(srch->type))
 		TAILQ_FOREACH(sent, &srch->sntq, entries)
 			if (!OPTYPE_ISUNARY(sent->op) &&
 			    sent->op != OPTYPE_STREQ &&
 			    sent->op != OPTYPE_STRNEQ &&
 			    sent->field->type == FTYPE_PASSWORD) {
 				gen_errx(cfg, &sent->pos, "passwords "
-					"for count only accept unary "
-					"and string operators");
+					"for %s only accept unary "
+					"and string operators",
+					srch->type == STYPE_COUNT ?
+					"count" : 
+					srch->type == STYPE_EXISTS ?
+					"exists" : "aggregates");
 				errs++;
 			}
+
+	/* Aggregates operate on the structure itself. */
+
+	if (STYPE_ISAGGR(srch->type) && srch->dst != NULL) {
+		gen_errx(cfg, &srch->dst->pos, "distinct not "
+			"allowed in aggregate queries");
+		errs++;
+	}
+
+	/* Existence checks don't return any rows. */
+
+	if (srch->type == STYPE_EXISTS && srch->dst != NULL) {
+		gen_errx(cfg, &srch->dst->pos, "distinct not "
+			"allowed in exists queries");
+		errs++;
+	}
+
+	/* Grouped results are keyed on the structure's own rows. */
+
+	if (srch->groupby != NULL && srch->dst != NULL) {
+		gen_errx(cfg, &srch->dst->pos, "distinct not "
+			"allowed in grouped queries");
+		errs++;
+	}
+	if (srch->groupby != NULL && srch->group != NULL) {
+		gen_errx(cfg, &srch->group->pos, "grouprow not "
+			"allowed in grouped queries");
+		errs++;
+	}
 	
 	/*
 	 * Start by checking that singleton returns don't occur on
@@ -195,6 +231,7 @@ check_searchtype(struct config *cfg, const struct search *srch)
 			"single-result search without parameters "
 			"and without a limit of one");
 	if (srch->type != STYPE_SEARCH &&
+	    srch->type != STYPE_EXISTS &&
 	    (srch->flags & SEARCH_IS_UNIQUE))
 		gen_warnx(cfg, &srch->pos, 
 			"multiple-result search on a unique field");
@@ -241,6 +278,19 @@ check_searchtype(struct config *cfg, const struct search *srch)
 			errs++;
 		}
 
+	/* Sets are bound as JSON arrays of integers or strings. */
+
+	TAILQ_FOREACH(sent, &srch->sntq, entries)
+		if (sent->op == OPTYPE_IN &&
+		    (sent->field->type == FTYPE_BLOB ||
+		     sent->field->type == FTYPE_PASSWORD ||
+		     sent->field->type == FTYPE_REAL)) {
+			gen_errx(cfg, &sent->pos, "in operator "
+				"not available on blob, password, "
+				"and real types");
+			errs++;
+		}
+
 	/* Require text types for LIKE operator. */
 
 	TAILQ_FOREACH(sent, &srch->sntq, entries)
@@ -448,6 +498,42 @@ check_unique_roles(struct config *cfg, const struct rolemap *rm)
 	return errs == 0;
 }
 
+/*
+ * Statements returning their rows can only return columns of the
+ * modified table itself, so they can't fill nested structures that
+ * would otherwise be joined.
+ * (Null references are looked up after the fact, so they're fine.)
+ * Returns zero on failure, non-zero otherwise.
+ */
+static int
+check_returning(struct config *cfg, const struct strct *p)
+{
+	const struct update	*u;
+	const struct field	*fd;
+	size_t			 errs = 0;
+
+	TAILQ_FOREACH(fd, &p->fq, entries)
+		if (fd->type == FTYPE_STRUCT &&
+		    !(fd->ref->source->flags & FIELD_NULL))
+			break;
+	if (fd == NULL)
+		return 1;
+
+	TAILQ_FOREACH(u, &p->uq, entries)
+		if (u->flags & UPDATE_RETURNING) {
+			gen_errx(cfg, &u->pos, "returning update "
+				"with nested structure: %s", fd->name);
+			errs++;
+		}
+	if (p->ins != NULL && (p->ins->flags & INSERT_RETURNING)) {
+		gen_errx(cfg, &p->ins->pos, "returning insert "
+			"with nested structure: %s", fd->name);
+		errs++;
+	}
+
+	return errs == 0;
+}
+
 /* 
  * See whether operations are defined in a role.
  * These aren't errors, but should be warned about.
@@ -490,6 +576,7 @@ ort_parse_close(struct config *cfg)
 	struct field	 *f;
 	struct rolemap	 *rm;
 	struct search	 *srch;
+	struct update	 *u;
 	size_t		  colour = 1, sz = 0, i = 0;
 
 	if (TAILQ_EMPTY(&cfg->sq)) {
@@ -544,6 +631,13 @@ ort_parse_close(struct config *cfg)
 	if (i > 0)
 		return 0;
 
+	/* Make sure returning statements don't need joins. */
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		i += !check_returning(cfg, p);
+	if (i > 0)
+		return 0;
+
 	/* See if our search types are wonky. */
 
 	TAILQ_FOREACH(p, &cfg->sq, entries)
@@ -600,6 +694,24 @@ ort_parse_close(struct config *cfg)
 		if (check_reffind(cfg, p))
 			p->flags |= STRCT_HAS_NULLREFS;
 
+	/* Batched lookups by unique fields return a queue. */
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		TAILQ_FOREACH(f, &p->fq, entries)
+			if (f->flags & (FIELD_ROWID|FIELD_UNIQUE)) {
+				p->flags |= STRCT_HAS_QUEUE;
+				break;
+			}
+
+	/* As do updates returning their modified rows. */
+
+	TAILQ_FOREACH(p, &cfg->sq, entries)
+		TAILQ_FOREACH(u, &p->uq, entries)
+			if (u->flags & UPDATE_RETURNING) {
+				p->flags |= STRCT_HAS_QUEUE;
+				break;
+			}
+
 	free(pa);
 	return 1;
 }
@@ -300,6 +300,14 @@ resolve_up_const(struct config *cfg, struct struct_up_const *r)
 			"notnull or isnull operator "
 			"on field that's never null");
 
+	/* Sets are only bound in queries. */
+
+	if (r->result->op == OPTYPE_IN) {
+		gen_errx(cfg, &r->result->pos, 
+			"in operator not allowed in constraints");
+		errs++;
+	}
+
 	/* 
 	 * "like" operator needs text.
 	 * FIXME: useful for binary as well?
@@ -386,6 +394,78 @@ resolve_up_mod(struct config *cfg, struct struct_up_mod *r)
 	return errs == 0;
 }
 
+/*
+ * Look up the field aggregated by a sum, avg, min, or max query.
+ * This must be a numeric field in the query's structure: min and max
+ * also accept date types.
+ */
+static int
+resolve_struct_afield(struct config *cfg, struct struct_afield *r)
+{
+	struct field	*f;
+
+	TAILQ_FOREACH(f, &r->result->parent->fq, entries)
+		if (strcasecmp(f->name, r->name) == 0)
+			break;
+
+	if (f == NULL) {
+		gen_errx(cfg, &r->result->pos, 
+			"field not found: %s", r->name);
+		return 0;
+	}
+
+	switch (f->type) {
+	case FTYPE_INT:
+	case FTYPE_REAL:
+		break;
+	case FTYPE_DATE:
+	case FTYPE_EPOCH:
+		if (r->result->type == STYPE_MIN ||
+		    r->result->type == STYPE_MAX)
+			break;
+		/* FALLTHROUGH */
+	default:
+		gen_errx(cfg, &r->result->pos, "aggregate field "
+			"must be numeric: %s", f->name);
+		return 0;
+	}
+
+	r->result->afield = f;
+	return 1;
+}
+
+/*
+ * Look up the field by which a count or aggregate query is grouped.
+ * This must be a non-null field in the query's structure that's
+ * neither a struct, blob, nor password.
+ */
+static int
+resolve_struct_groupby(struct config *cfg, struct struct_groupby *r)
+{
+	struct field	*f;
+
+	TAILQ_FOREACH(f, &r->result->parent->fq, entries)
+		if (strcasecmp(f->name, r->name) == 0)
+			break;
+
+	if (f == NULL) {
+		gen_errx(cfg, &r->result->pos, 
+			"field not found: %s", r->name);
+		return 0;
+	} else if (f->type == FTYPE_STRUCT ||
+	    f->type == FTYPE_BLOB ||
+	    f->type == FTYPE_PASSWORD ||
+	    (f->flags & FIELD_NULL)) {
+		gen_errx(cfg, &r->result->pos, "groupby field "
+			"cannot be null, a struct, a blob, or a "
+			"password: %s", f->name);
+		return 0;
+	}
+
+	r->result->groupby = f;
+	return 1;
+}
+
 static int
 resolve_struct_unique(struct config *cfg, struct struct_unique *r)
 {
@@ -514,6 +594,16 @@ resolve_struct_rolemap_query(struct config *cfg, struct struct_rolemap *r)
 		type = STYPE_LIST;
 	else if (r->type == ROLEMAP_COUNT)
 		type = STYPE_COUNT;
+	else if (r->type == ROLEMAP_EXISTS)
+		type = STYPE_EXISTS;
+	else if (r->type == ROLEMAP_SUM)
+		type = STYPE_SUM;
+	else if (r->type == ROLEMAP_AVG)
+		type = STYPE_AVG;
+	else if (r->type == ROLEMAP_MIN)
+		type = STYPE_MIN;
+	else if (r->type == ROLEMAP_MAX)
+		type = STYPE_MAX;
 
 	assert(type != STYPE__MAX);
 
@@ -723,17 +813,27 @@ resolve_struct_rolemap(struct config *cfg, struct struct_rolemap *r)
 		gen_errx(cfg, &r->result->parent->pos,
 			"insert operation not specified");
 		break;
+	case ROLEMAP_AVG:
 	case ROLEMAP_COUNT:
+	case ROLEMAP_EXISTS:
 	case ROLEMAP_ITERATE:
 	case ROLEMAP_LIST:
+	case ROLEMAP_MAX:
+	case ROLEMAP_MIN:
 	case ROLEMAP_SEARCH:
+	case ROLEMAP_SUM:
 		if (resolve_struct_rolemap_query(cfg, r))
 			return 1;
 		gen_errx(cfg, &r->result->parent->pos,
 			"%s operation not found: %s", 
 			r->type == ROLEMAP_COUNT ? "count" : 
+			r->type == ROLEMAP_EXISTS ? "exists" : 
 			r->type == ROLEMAP_ITERATE ? "iterate" : 
 			r->type == ROLEMAP_LIST ? "list" : 
+			r->type == ROLEMAP_SUM ? "sum" : 
+			r->type == ROLEMAP_AVG ? "avg" : 
+			r->type == ROLEMAP_MIN ? "min" : 
+			r->type == ROLEMAP_MAX ? "max" : 
 			"search", r->name);
 		break;
 	case ROLEMAP_NOEXPORT:
@@ -953,6 +1053,14 @@ linker_resolve(struct config *cfg)
 			fail += !resolve_struct_unique
 				(cfg, &r->struct_unique);
 			break;
+		case RESOLVE_AFIELD:
+			fail += !resolve_struct_afield
+				(cfg, &r->struct_afield);
+			break;
+		case RESOLVE_GROUPBY:
+			fail += !resolve_struct_groupby
+				(cfg, &r->struct_groupby);
+			break;
 		case RESOLVE_UP_CONSTRAINT:
 			fail += !resolve_up_const
 				(cfg, &r->struct_up_const);
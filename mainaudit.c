@@ -37,6 +37,11 @@ static	const char *const stypes[STYPE__MAX] = {
 	"search", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static size_t
@@ -104,10 +109,7 @@ audit_query(const struct audit *a, char *b, size_t bsz)
 
 	audit_buf(a, b, bsz, 0);
 	printf("%-11s %-*s %s:%zu:%zu\n", 
-		a->sr->type == STYPE_COUNT ? "count" : 
-			a->sr->type == STYPE_ITERATE ? "iterate" : 
-			a->sr->type == STYPE_SEARCH ? "search" : 
-			"list", (int)bsz, b, a->sr->pos.fname, 
+		stypes[a->sr->type], (int)bsz, b, a->sr->pos.fname, 
 		a->sr->pos.line, a->sr->pos.column);
 }
 
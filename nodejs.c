@@ -50,11 +50,17 @@ main(int argc, char *argv[])
 		err(1, "pledge");
 #endif
 
-	while ((c = getopt(argc, argv, "eN:v")) != -1)
+	while ((c = getopt(argc, argv, "enN:pv")) != -1)
 		switch (c) {
 		case 'e':
 			args.flags |= ORT_LANG_NODEJS_NOMODULE;
 			break;
+		case 'n':
+			args.flags |= ORT_LANG_NODEJS_NUMBER;
+			break;
+		case 'p':
+			args.flags |= ORT_LANG_NODEJS_POOL;
+			break;
 		case 'N':
 			if (strchr(optarg, 'b') != NULL)
 				args.flags &= ~ORT_LANG_NODEJS_CORE;
@@ -107,7 +113,7 @@ out:
 	free(confs);
 	return !rc;
 usage:
-	fprintf(stderr, "usage: %s [-ev] [-N[b|d] [config...]\n", 
+	fprintf(stderr, "usage: %s [-enpv] [-N[b|d] [config...]\n", 
 		getprogname());
 	return 1;
 }
@@ -182,12 +182,16 @@ namespace ortJson {
 	export interface insertObj {
 		pos: posObj;
 		rolemap: string[];
+		/**
+		 * Can contain "returning" to represent INSERT_RETURNING.
+		 */
+		flags: string[];
 	}
 
 	export type sentObjOp = 'eq'|'ge'|'gt'|'le'|'lt'|'neq'|'like'|'and'|
-		'or'|'streq'|'strneq'|'isnull'|'notnull';
+		'or'|'streq'|'strneq'|'in'|'isnull'|'notnull';
 	export type urefObjOp = 'eq'|'ge'|'gt'|'le'|'lt'|'neq'|'like'|'and'|
-		'or'|'streq'|'strneq'|'isnull'|'notnull';
+		'or'|'streq'|'strneq'|'in'|'isnull'|'notnull';
 
 	/**
 	 * Same as "struct sent" in ort(3).
@@ -272,7 +276,20 @@ namespace ortJson {
 		aggr: aggrObj|null;
 		group: groupObj|null;
 		dst: dstnctObj|null;
-		type: 'search'|'iterate'|'list'|'count';
+		/**
+		 * Field aggregated by sum, avg, min, and max.
+		 */
+		afield: string|null;
+		/**
+		 * Field grouping count and aggregate results.
+		 */
+		groupby: string|null;
+		/**
+		 * Can contain "cache" to represent SEARCH_CACHE.
+		 */
+		flags: string[];
+		type: 'search'|'iterate'|'list'|'count'|'exists'|
+			'sum'|'avg'|'min'|'max';
 	}
 
 	export interface searchSet {
@@ -310,9 +327,15 @@ namespace ortJson {
 		type: 'update'|'delete';
 		rolemap: string[];
 		/**
-		 * Can contain "all" to represent UPDATE_ALL.
+		 * Can contain "all" to represent UPDATE_ALL and
+		 * "returning" to represent UPDATE_RETURNING.
 		 */
 		flags: string[];
+		/**
+		 * Maximum rows per delete statement or "0" if not
+		 * batched.  Only applies to deletes.
+		 */
+		batch: string;
 		mrq: urefObj[];
 		crq: urefObj[];
 	}
@@ -341,7 +364,8 @@ namespace ortJson {
 	}
 
 	export type rolemapObjType = 'all'|'count'|'delete'|'insert'|
-		'iterate'|'list'|'search'|'update'|'noexport';
+		'iterate'|'list'|'search'|'update'|'noexport'|
+		'sum'|'avg'|'min'|'max'|'exists';
 
 	/**
 	 * Similar to "struct rolemap" in ort(3).
@@ -659,7 +683,8 @@ namespace ortJson {
 		private updateObjToString(up: updateObj): string
 		{
 			let str: string = ' ' + up.type;
-			if (up.type === 'update' && up.flags.length === 0) {
+			if (up.type === 'update' && 
+			    up.flags.indexOf('all') < 0) {
 				for (let i: number = 0; i < up.mrq.length; i++) {
 					if (i > 0)
 						str += ',';
@@ -680,6 +705,10 @@ namespace ortJson {
 			str += this.commentToString(up.doc);
 			if (up.name !== null)
 				str += ' name ' + up.name;
+			if (up.flags.indexOf('returning') >= 0)
+				str += ' returning';
+			if (up.batch !== '0')
+				str += ' batch ' + up.batch;
 			return str + ';';
 		}
 
@@ -695,6 +724,8 @@ namespace ortJson {
 		private searchObjToString(search: searchObj): string
 		{
 			let str: string = ' ' + search.type;
+			if (search.afield !== null)
+				str += ' ' + search.afield;
 			for (let i: number = 0; i < search.sntq.length; i++) {
 				if (i > 0)
 					str += ',';
@@ -717,6 +748,10 @@ namespace ortJson {
 			if (search.aggr !== null)
 				str += ' ' + search.aggr.op + 
 					' ' + search.aggr.fname;
+			if (search.groupby !== null)
+				str += ' groupby ' + search.groupby;
+			if (search.flags.indexOf('cache') >= 0)
+				str += ' cache';
 			if (search.ordq.length > 0) {
 				str += ' order';
 				for (let i: number = 0; i < search.ordq.length; i++) {
@@ -771,7 +806,9 @@ namespace ortJson {
 		       		str += this.updateObjToString(strct.dq.anon[i]);	
 			str += this.updateSetToString(strct.dq.named);
 			if (strct.insert !== null)
-				str += ' insert;';
+				str += strct.insert.flags.indexOf
+					('returning') >= 0 ?
+					' insert returning;' : ' insert;';
 			str += this.commentToString(strct.doc);
 			if (strct.doc !== null) 
 				str += ';';
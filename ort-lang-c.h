@@ -23,6 +23,9 @@
 #define	ORT_LANG_C_VALID_KCGI	 0x08
 #define ORT_LANG_C_DB_SQLBOX	 0x10
 #define ORT_LANG_C_SAFE_TYPES	 0x20
+#define ORT_LANG_C_ITERATE_BATCH 0x40
+#define ORT_LANG_C_DB_ERRORS	 0x80
+#define ORT_LANG_C_DB_IDMAP	 0x100
 
 struct	ort_lang_c {
 	const char		*guard;
@@ -32,6 +35,8 @@ struct	ort_lang_c {
 	const char		*ext_b64_ntop;
 	const char		*ext_jsmn;
 	const char		*ext_gensalt;
+	size_t			 readers;
+	const char		*role;
 };
 
 int	ort_lang_c_header(const struct ort_lang_c *,
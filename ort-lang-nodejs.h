@@ -21,6 +21,8 @@
 #define	ORT_LANG_NODEJS_CORE		0x02
 #define ORT_LANG_NODEJS_DB		0x04
 #define	ORT_LANG_NODEJS_NOMODULE	0x08
+#define	ORT_LANG_NODEJS_NUMBER		0x10
+#define	ORT_LANG_NODEJS_POOL		0x20
 
 struct ort_lang_nodejs {
 	unsigned int	 flags;
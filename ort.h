@@ -208,6 +208,7 @@ enum	optype {
 	OPTYPE_OR, /* logical (bitwise) or */
 	OPTYPE_STREQ, /* string equality */
 	OPTYPE_STRNEQ, /* string non-equality */
+	OPTYPE_IN, /* set membership: x in (?, ...) */
 	/* Unary types... */
 	OPTYPE_ISNULL, /* nullity: x isnull */
 	OPTYPE_NOTNULL, /* non-nullity: x notnull */
@@ -243,6 +244,11 @@ enum	rolemapt {
 	ROLEMAP_SEARCH, /* search */
 	ROLEMAP_UPDATE, /* update */
 	ROLEMAP_NOEXPORT, /* noexport */
+	ROLEMAP_SUM, /* sum */
+	ROLEMAP_AVG, /* avg */
+	ROLEMAP_MIN, /* min */
+	ROLEMAP_MAX, /* max */
+	ROLEMAP_EXISTS, /* exists */
 	ROLEMAP__MAX
 };
 
@@ -330,9 +336,20 @@ enum	stype {
 	STYPE_SEARCH,
 	STYPE_LIST,
 	STYPE_ITERATE,
+	STYPE_EXISTS,
+	STYPE_SUM,
+	STYPE_AVG,
+	STYPE_MIN,
+	STYPE_MAX,
 	STYPE__MAX
 };
 
+/*
+ * Whether the query type is a scalar aggregate (sum, avg, etc.) over
+ * the search's "afield".
+ */
+#define	STYPE_ISAGGR(_x) ((_x) >= STYPE_SUM)
+
 struct	dstnct {
 	struct field	**chain;
 	size_t		  chainsz;
@@ -349,6 +366,8 @@ struct	search {
 	struct group	   *group;
 	struct pos	    pos;
 	struct dstnct	   *dst;
+	struct field	   *afield; /* STYPE_ISAGGR */
+	struct field	   *groupby; /* STYPE_COUNT, STYPE_ISAGGR */
 	char		   *name;
 	char		   *doc;
 	struct strct	   *parent;
@@ -358,6 +377,7 @@ struct	search {
 	struct rolemap	   *rolemap;
 	unsigned int	    flags; 
 #define	SEARCH_IS_UNIQUE    0x01
+#define	SEARCH_CACHE	    0x02
 	TAILQ_ENTRY(search) entries;
 };
 
@@ -401,6 +421,8 @@ struct	update {
 	struct rolemap	   *rolemap;
 	unsigned int	    flags;
 #define	UPDATE_ALL	    0x01
+#define	UPDATE_RETURNING    0x02
+	int64_t		    batch;
 	TAILQ_ENTRY(update) entries;
 };
 
@@ -408,6 +430,8 @@ struct	insert {
 	struct rolemap	*rolemap;
 	struct strct	*parent;
 	struct pos	 pos;
+	unsigned int	 flags;
+#define	INSERT_RETURNING 0x01
 };
 
 struct	strct {
@@ -461,12 +485,56 @@ struct	msg {
 	TAILQ_ENTRY(msg) entries;
 };
 
+/*
+ * Journal mode of the "database" block.
+ */
+enum	journalt {
+	JOURNAL_DEFAULT = 0, /* not specified */
+	JOURNAL_DELETE,
+	JOURNAL_TRUNCATE,
+	JOURNAL_PERSIST,
+	JOURNAL_MEMORY,
+	JOURNAL_WAL,
+	JOURNAL_OFF,
+	JOURNAL__MAX
+};
+
+/*
+ * Synchronous level of the "database" block.
+ */
+enum	synct {
+	SYNC_DEFAULT = 0, /* not specified */
+	SYNC_OFF,
+	SYNC_NORMAL,
+	SYNC_FULL,
+	SYNC_EXTRA,
+	SYNC__MAX
+};
+
+/*
+ * Tuning for how the database is opened.
+ * Integer values are only set if the matching flag is set.
+ */
+struct	database {
+	enum journalt	 journal;
+	enum synct	 sync;
+	int64_t		 cachesize;
+	int64_t		 mmapsize;
+	int64_t		 busytimeout;
+	struct pos	 pos;
+	unsigned int	 flags;
+#define	DATABASE_CACHESIZE   0x01
+#define	DATABASE_MMAPSIZE    0x02
+#define	DATABASE_BUSYTIMEOUT 0x04
+};
+
 struct	config {
 	struct strctq	  sq;
 	struct enmq	  eq;
 	struct bitfq	  bq;
 	struct roleq	  rq;
 	struct roleq	  arq;
+	struct database	 *db;
 	char		**langs;
 	size_t		  langsz;
 	char		**fnames;
@@ -526,6 +594,7 @@ enum	difftype {
 	DIFF_MOD_FIELD_TYPE,
 	DIFF_MOD_FIELD_VALIDS,
 	DIFF_MOD_INSERT,
+	DIFF_MOD_INSERT_FLAGS,
 	DIFF_MOD_INSERT_PARAMS,
 	DIFF_MOD_INSERT_ROLEMAP,
 	DIFF_MOD_ROLE,
@@ -537,7 +606,10 @@ enum	difftype {
 	DIFF_MOD_SEARCH_AGGR,
 	DIFF_MOD_SEARCH_COMMENT,
 	DIFF_MOD_SEARCH_DISTINCT,
+	DIFF_MOD_SEARCH_FIELD,
+	DIFF_MOD_SEARCH_FLAGS,
 	DIFF_MOD_SEARCH_GROUP,
+	DIFF_MOD_SEARCH_GROUPBY,
 	DIFF_MOD_SEARCH_LIMIT,
 	DIFF_MOD_SEARCH_OFFSET,
 	DIFF_MOD_SEARCH_ORDER,
@@ -546,6 +618,7 @@ enum	difftype {
 	DIFF_MOD_STRCT,
 	DIFF_MOD_STRCT_COMMENT,
 	DIFF_MOD_UPDATE,
+	DIFF_MOD_UPDATE_BATCH,
 	DIFF_MOD_UPDATE_COMMENT,
 	DIFF_MOD_UPDATE_FLAGS,
 	DIFF_MOD_UPDATE_PARAMS,
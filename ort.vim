@@ -5,6 +5,12 @@ syn keyword kwbpCmd struct
 syn keyword kwbpCmd item
 syn keyword kwbpCmd field
 syn keyword kwbpCmd iterate
+syn keyword kwbpCmd count
+syn keyword kwbpCmd exists
+syn keyword kwbpCmd sum
+syn keyword kwbpCmd avg
+syn keyword kwbpCmd min
+syn keyword kwbpCmd max
 syn keyword kwbpCmd list
 syn keyword kwbpCmd search
 syn keyword kwbpCmd update
@@ -15,6 +21,9 @@ syn keyword kwbpInnerCmd int
 syn keyword kwbpInnerCmd name
 syn keyword kwbpInnerCmd role
 syn keyword kwbpInnerCmd comment
+syn keyword kwbpInnerCmd returning
+syn keyword kwbpInnerCmd batch
+syn keyword kwbpInnerCmd cache
 syn keyword kwbpInnerCmd jslabel
 syn keyword kwbpInnerCmd isunset
 syn keyword kwbpInnerCmd isnull
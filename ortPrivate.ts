@@ -1,3 +1,9 @@
+	/*
+	 * Native 64-bit arithmetic, if provided by the run-time.  This is
+	 * declared here so as not to require the ES2020 library to compile.
+	 */
+	declare const BigInt: any;
+
 	/**
 	 * Facilities to manipulate 64-bit numbers encoded as strings.
 	 * The JavaScript implementation of openradtool uses strings for numbers
@@ -6,6 +12,8 @@
 	 * integers, and 32 for bit-wise operations.
 	 * This class is a modified version of long.js fixed to base 10 and
 	 * converted to TypeScript.
+	 * Where the run-time has native BigInt, it's used for conversion
+	 * to and from strings and numbers.
 	 *
 	 * Original source: https://github.com/dcodeIO/long.js
 	 *
@@ -58,6 +66,18 @@
 		private static readonly TWO_PWR_63_DBL: number = 
 			Long.TWO_PWR_64_DBL / 2;
 
+		/**
+		 * Whether to convert with native BigInt, which is
+		 * enabled if the run-time supports it.  Set this to
+		 * false to use only the portable implementation.
+		 */
+		static native: boolean = typeof BigInt === 'function';
+		private static readonly BIG_32: any = 
+			typeof BigInt === 'function' ? BigInt(32) : null;
+		private static readonly BIG_MASK: any = 
+			typeof BigInt === 'function' ?
+			BigInt(0xFFFFFFFF) : null;
+
 		/**
 		 * @return Whether this is a ortns.Long object.
 		 */
@@ -100,6 +120,58 @@
 			return this.unsigned ? this.low >>> 0 : this.low;
 		}
 
+		/**
+		 * Convert to the decimal string representation, with a
+		 * leading "-" if negative.  This is the inverse of
+		 * fromString().
+		 * @return The Long converted to a string.
+		 */
+		toString(): string
+		{
+			let i: number;
+			let cur: number;
+			let rem: number;
+			let s: string = '';
+
+			if (Long.native)
+				return this.toBigInt().toString();
+
+			/*
+			 * Divide the magnitude's 16-bit chunks by 10^4 until
+			 * zero.  Since negating MIN_VALUE is itself, read the
+			 * chunks as unsigned.
+			 */
+
+			const v: Long = this.isNegative() ? this.neg() : this;
+			const c: number[] = [v.high >>> 16, v.high & 0xFFFF,
+				v.low >>> 16, v.low & 0xFFFF];
+
+			do {
+				rem = 0;
+				for (i = 0; i < 4; i++) {
+					cur = rem * 65536 + c[i];
+					c[i] = Math.floor(cur / 10000);
+					rem = cur % 10000;
+				}
+				s = (c[0] | c[1] | c[2] | c[3]) === 0 ?
+					rem + s : ('000' + rem).slice(-4) + s;
+			} while ((c[0] | c[1] | c[2] | c[3]) !== 0);
+
+			return (this.isNegative() ? '-' : '') + s;
+		}
+
+		/**
+		 * Convert to a native BigInt.  Only call if native is
+		 * set.
+		 * @return The Long as a BigInt.
+		 */
+		private toBigInt(): any
+		{
+			return (BigInt(this.unsigned ?
+				this.high >>> 0 : this.high) << Long.BIG_32) |
+				BigInt(this.low >>> 0);
+		}
+
 		/**
 		 * Test whether the value is strictly <0.  For unsigned
 		 * values, this is always false.
@@ -412,6 +484,8 @@
 					(<string>val, unsigned);
 			if (Long.isLong(val))
 				return <Long>val;
+			if (typeof val === 'bigint')
+				return Long.fromBigInt(val, unsigned);
 			return null;
 		}
 
@@ -465,6 +539,18 @@
 				 unsigned);
 		}
 
+		/**
+		 * Convert from a native BigInt, wrapping to 64 bits.
+		 * Only call if native is set.
+		 * @return The value.
+		 */
+		private static fromBigInt(val: any, unsigned?: boolean): Long
+		{
+			return new Long(Number(val & Long.BIG_MASK),
+				Number((val >> Long.BIG_32) & Long.BIG_MASK),
+				unsigned);
+		}
+
 		/**
 		 * Like fromString(), except returning failed conversions as a
 		 * zero value.
@@ -497,6 +583,11 @@
 			    str === '+Infinity' || str === '-Infinity')
 				return null;
 
+			if (Long.native)
+				return /^-?[0-9]+$/.test(str) ?
+					Long.fromBigInt(BigInt(str), usgn) :
+					null;
+
 			if (hyph === 0) {
 				const nresult: Long|null = 
 					Long.fromString
@@ -537,6 +628,285 @@
 		}
 	}
 
+	/**
+	 * A binding plan compiled once from a template element by a
+	 * structure's `compile()` method.  This records the path (child
+	 * indices from the template root, empty for the root itself) of
+	 * each element having a class of the structure or its nested
+	 * structures, and of each `<option>` element, so that filling
+	 * clones of the template resolves elements without querying the
+	 * DOM.
+	 */
+	export class FillPlan {
+		/** @internal */
+		readonly paths: { [cls: string]: number[][] } = {};
+
+		/**
+		 * @param e The template root.
+		 * @param strcts Names of the structures whose classes
+		 * are recorded.
+		 */
+		constructor(e: HTMLElement, strcts: string[])
+		{
+			let i: number;
+			const prefixes: string[] = [];
+
+			for (i = 0; i < strcts.length; i++)
+				prefixes.push(strcts[i] + '-');
+			this.walk(e, [], prefixes);
+		}
+
+		private add(cls: string, path: number[]): void
+		{
+			if (!this.paths.hasOwnProperty(cls))
+				this.paths[cls] = [];
+			this.paths[cls].push(path.slice());
+		}
+
+		private walk(e: Element, path: number[],
+			prefixes: string[]): void
+		{
+			let i: number, j: number;
+
+			for (i = 0; i < e.classList.length; i++)
+				for (j = 0; j < prefixes.length; j++)
+					if (e.classList[i].lastIndexOf
+					    (prefixes[j], 0) === 0) {
+						this.add(e.classList[i], path);
+						break;
+					}
+			if (e.tagName.toLowerCase() === 'option')
+				this.add(' option', path);
+			for (i = 0; i < e.children.length; i++) {
+				path.push(i);
+				this.walk(e.children[i], path, prefixes);
+				path.pop();
+			}
+		}
+	}
+
+	/**
+	 * A {@link FillPlan} resolved against a clone of its template.
+	 * All elements are resolved when bound, so custom callbacks
+	 * modifying the tree while filling don't invalidate it.
+	 * @internal
+	 */
+	export class FillBinding {
+		private readonly elems: { [cls: string]: HTMLElement[] } = {};
+		private readonly paths: { [cls: string]: number[][] } = {};
+		private readonly known: HTMLElement[] = [];
+		private readonly knownpaths: number[][] = [];
+
+		constructor(plan: FillPlan, e: HTMLElement)
+		{
+			let i: number, j: number;
+			let n: Element|undefined;
+
+			this.known.push(e);
+			this.knownpaths.push([]);
+			for (const cls in plan.paths) {
+				if (!plan.paths.hasOwnProperty(cls))
+					continue;
+				const list: number[][] = plan.paths[cls];
+				this.elems[cls] = [];
+				this.paths[cls] = [];
+				for (i = 0; i < list.length; i++) {
+					n = e;
+					for (j = 0; j < list[i].length && 
+					     typeof n !== 'undefined'; j++)
+						n = n.children[list[i][j]];
+					if (typeof n === 'undefined')
+						continue;
+					this.elems[cls].push(<HTMLElement>n);
+					this.paths[cls].push(list[i]);
+					this.known.push(<HTMLElement>n);
+					this.knownpaths.push(list[i]);
+				}
+			}
+		}
+
+		/**
+		 * Like _elemList() but for bound elements.
+		 * @return The elements beneath (possibly including) the
+		 * root or null if the root is not bound.
+		 */
+		list(e: HTMLElement, cls: string,
+			inc: boolean): HTMLElement[]|null
+		{
+			let i: number, j: number;
+			let root: number[]|null = null;
+			let self: HTMLElement|null = null;
+			const a: HTMLElement[] = [];
+
+			for (i = 0; i < this.known.length; i++)
+				if (this.known[i] === e) {
+					root = this.knownpaths[i];
+					break;
+				}
+			if (root === null)
+				return null;
+			if (!this.elems.hasOwnProperty(cls))
+				return a;
+
+			const list: HTMLElement[] = this.elems[cls];
+			const paths: number[][] = this.paths[cls];
+
+			for (i = 0; i < list.length; i++) {
+				if (paths[i].length < root.length)
+					continue;
+				for (j = 0; j < root.length; j++)
+					if (paths[i][j] !== root[j])
+						break;
+				if (j < root.length)
+					continue;
+				if (paths[i].length === root.length)
+					self = list[i];
+				else
+					a.push(list[i]);
+			}
+			if (inc && self !== null)
+				a.push(self);
+			return a;
+		}
+	}
+
+	/**
+	 * Deep comparison of object data as filled, where nested
+	 * structures are objects and values are primitives.
+	 * @return Whether the values are the same.
+	 * @internal
+	 */
+	function _same(a: any, b: any): boolean
+	{
+		if (a === b)
+			return true;
+		if (typeof a !== 'object' || typeof b !== 'object' ||
+		    a === null || b === null)
+			return false;
+		for (const k in a)
+			if (a.hasOwnProperty(k) && (!b.hasOwnProperty(k) ||
+			    !_same(a[k], b[k])))
+				return false;
+		for (const k in b)
+			if (b.hasOwnProperty(k) && !a.hasOwnProperty(k))
+				return false;
+		return true;
+	}
+
+	/**
+	 * Deep copy of object data as filled (see {@link _same}).
+	 * @return The copied value.
+	 * @internal
+	 */
+	function _copy(a: any): any
+	{
+		const c: any = {};
+
+		if (typeof a !== 'object' || a === null)
+			return a;
+		for (const k in a)
+			if (a.hasOwnProperty(k))
+				c[k] = _copy(a[k]);
+		return c;
+	}
+
+	/**
+	 * A row of a list filled by {@link _fillKeyed}.
+	 * @internal
+	 */
+	interface KeyedRow {
+		e: HTMLElement;
+		b: FillBinding;
+		obj: any;
+	}
+
+	/**
+	 * State kept on a list element between keyed fills.
+	 * @internal
+	 */
+	interface KeyedState {
+		tmpl: HTMLElement;
+		plan: FillPlan;
+		rows: { [key: string]: KeyedRow };
+	}
+
+	/**
+	 * Fill the list "e" with "objs" keyed by their "key" member, as
+	 * described by a structure's `fillArrayKeyed()`.  Rows are
+	 * reused by key and only moved, inserted, or removed when they
+	 * differ from the previous fill.  Reused rows whose data has not
+	 * changed are not filled at all.
+	 * @param e The list element.
+	 * @param objs The objects to fill.
+	 * @param key The key member of each object.
+	 * @param compile The structure's `compile()`.
+	 * @param fill Fill a row with its binding given the previous
+	 * object filled into the row, or null if the row is new.
+	 * @internal
+	 */
+	function _fillKeyed(e: HTMLElement, objs: any[], key: string,
+		compile: (tmpl: HTMLElement) => FillPlan,
+		fill: (row: HTMLElement, obj: any, prev: any,
+			b: FillBinding) => void): void
+	{
+		let st: KeyedState|undefined = (<any>e)._ortKeyed;
+		let next: ChildNode|null;
+		let i: number;
+		const rows: { [key: string]: KeyedRow } = {};
+
+		/* On the first fill, save the template. */
+
+		if (typeof st === 'undefined') {
+			if (e.children.length === 0)
+				return;
+			const tmpl: HTMLElement =
+				<HTMLElement>e.children[0];
+			st = { tmpl: tmpl, plan: compile(tmpl), rows: {} };
+			(<any>e)._ortKeyed = st;
+			while (e.firstChild !== null)
+				e.removeChild(e.firstChild);
+		}
+
+		_hide(e);
+		if (objs.length > 0)
+			_show(e);
+
+		/*
+		 * All rows before "next" are in their final position.
+		 * Rows from "next" onward are no longer used.
+		 */
+
+		next = e.firstChild;
+		for (i = 0; i < objs.length; i++) {
+			const k: string = String(objs[i][key]);
+			let r: KeyedRow;
+			if (st.rows.hasOwnProperty(k) &&
+			    !rows.hasOwnProperty(k)) {
+				r = st.rows[k];
+				if (!_same(objs[i], r.obj))
+					fill(r.e, objs[i], r.obj, r.b);
+			} else {
+				const cln: HTMLElement =
+					<HTMLElement>st.tmpl.cloneNode(true);
+				r = { e: cln, obj: null,
+				      b: new FillBinding(st.plan, cln) };
+				fill(cln, objs[i], null, r.b);
+			}
+			r.obj = _copy(objs[i]);
+			rows[k] = r;
+			if (r.e === next)
+				next = r.e.nextSibling;
+			else
+				e.insertBefore(r.e, next);
+		}
+		while (next !== null) {
+			const n: ChildNode|null = next.nextSibling;
+			e.removeChild(next);
+			next = n;
+		}
+		st.rows = rows;
+	}
+
 	/**
 	 * Labels ("jslabel" in ort(5)) may have multiple languages.
 	 * This maps a language name to a translated string.
@@ -623,11 +993,12 @@
 	 * @internal
 	 */
 	function _attrcl(e: HTMLElement, attr: string,
-		name: string, text: string, inc: boolean): void
+		name: string, text: string, inc: boolean,
+		b?: FillBinding|null): void
 	{
 		let i: number;
 		const list: HTMLElement[] =
-			_elemList(e, name, inc);
+			_elemList(e, name, inc, b);
 
 		for (i = 0; i < list.length; i++)
 			_attr(list[i], attr, text);
@@ -635,18 +1006,24 @@
 
 	/**
 	 * Get all elements beneath (possibly including) a root matching
-	 * the given class.
+	 * the given class.  If the root is bound by "b", this is looked
+	 * up without querying the DOM.
 	 * @internal
 	 */
 	function _elemList(e: HTMLElement|null,
-		cls: string, inc: boolean): HTMLElement[]
+		cls: string, inc: boolean,
+		b?: FillBinding|null): HTMLElement[]
 	{
 		let list: HTMLCollectionOf<Element>;
 		let i: number;
+		let bl: HTMLElement[]|null;
 		const a: HTMLElement[] = [];
 
 		if (e === null)
 			return a;
+		if (typeof b !== 'undefined' && b !== null &&
+		    (bl = b.list(e, cls, inc)) !== null)
+			return bl;
 		list = e.getElementsByClassName(cls);
 		for (i = 0; i < list.length; i++)
 			a.push(<HTMLElement>list[i]);
@@ -671,10 +1048,10 @@
 	 * @internal
 	 */
 	function _replcl(e: HTMLElement, name: string,
-		text: string, inc: boolean): void
+		text: string, inc: boolean, b?: FillBinding|null): void
 	{
 		let i: number;
-		const list: HTMLElement[] = _elemList(e, name, inc);
+		const list: HTMLElement[] = _elemList(e, name, inc, b);
 
 		for (i = 0; i < list.length; i++)
 			_repl(list[i], text);
@@ -720,10 +1097,11 @@
 	 * "Hide" all elements matching class by adding *hide* class.
 	 * @internal
 	 */
-	function _hidecl(e: HTMLElement, name: string, inc: boolean): void
+	function _hidecl(e: HTMLElement, name: string, inc: boolean,
+		b?: FillBinding|null): void
 	{
 		let i: number;
-		const list: HTMLElement[] = _elemList(e, name, inc);
+		const list: HTMLElement[] = _elemList(e, name, inc, b);
 
 		for (i = 0; i < list.length; i++)
 			_hide(list[i]);
@@ -744,10 +1122,11 @@
 	 * "Show" all elements matching class by removing *hide* class.
 	 * @internal
 	 */
-	function _showcl(e: HTMLElement, name: string, inc: boolean): void
+	function _showcl(e: HTMLElement, name: string, inc: boolean,
+		b?: FillBinding|null): void
 	{
 		let i: number;
-		const list: HTMLElement[] = _elemList(e, name, inc);
+		const list: HTMLElement[] = _elemList(e, name, inc, b);
 
 		for (i = 0; i < list.length; i++)
 			_show(list[i]);
@@ -763,14 +1142,16 @@
 	 * @param fname Structure name, '-', field name.
 	 * @param val The value to test for.
 	 * @param inc Include root in scanning for elements.
+	 * @param b Binding of the root, if any.
 	 * @internal
 	 */
 	function _fillValueChecked(e: HTMLElement, fname: string,
-		val: number|string|null, inc: boolean): void
+		val: number|string|null, inc: boolean,
+		b?: FillBinding|null): void
 	{
 		let i: number;
 		const list: HTMLElement[] = _elemList
-			(e, fname + '-value-checked', inc);
+			(e, fname + '-value-checked', inc, b);
 
 		for (i = 0; i < list.length; i++) {
 			const attrval: string|null = 
@@ -790,13 +1171,17 @@
 	 * A null value never matches.
 	 * @param e Root of tree scanned for elements.
 	 * @param val The value to test for.
+	 * @param b Binding of the root, if any.
 	 * @internal
 	 */
 	function _fillValueSelect(e: HTMLElement,
-		val: number|string|null): void
+		val: number|string|null, b?: FillBinding|null): void
 	{
 		let i: number;
-		const list: HTMLCollectionOf<HTMLElement> = 
+		const bl: HTMLElement[]|null =
+			typeof b === 'undefined' || b === null ?
+			null : b.list(e, ' option', false);
+		const list: ArrayLike<HTMLElement> = bl !== null ? bl :
 			e.getElementsByTagName('option');
 
 		for (i = 0; i < list.length; i++) {
@@ -817,10 +1202,12 @@
 	 * @param fname Structure name, '-', field name.
 	 * @param val Epoch date itself.
 	 * @param inc Include root in scanning for elements.
+	 * @param b Binding of the root, if any.
 	 * @internal
 	 */
 	function _fillDateValue(e: HTMLElement, fname: string,
-		val: string|number|null|undefined, inc: boolean): void
+		val: string|number|null|undefined, inc: boolean,
+		b?: FillBinding|null): void
 	{
 		const v: Long|null = Long.fromValue(val);
 		const d: Date = new Date();
@@ -839,8 +1226,8 @@
 			(mo < 10 ? '0' : '') + mo + '-' +
 			(day < 10 ? '0' : '') + day;
 
-		_attrcl(e, 'value', fname + '-date-value', full, inc);
-		_replcl(e, fname + '-date-text', full, inc);
+		_attrcl(e, 'value', fname + '-date-value', full, inc, b);
+		_replcl(e, fname + '-date-text', full, inc, b);
 	}
 
 	/**
@@ -853,17 +1240,19 @@
 	 * @param fname Structure name, '-', field name.
 	 * @param val Bit-field to test for.
 	 * @param inc Include root in scanning for elements.
+	 * @param b Binding of the root, if any.
 	 * @internal
 	 */
 	function _fillBitsChecked(e: HTMLElement, fname: string,
-		 val: string|number|null|undefined, inc: boolean): void
+		 val: string|number|null|undefined, inc: boolean,
+		 b?: FillBinding|null): void
 	{
 		let i: number;
 		let v: number;
 		const lval: Long|null|undefined = 
 			Long.fromValueUndef(val);
 		const list: HTMLElement[] = _elemList
-			(e, fname + '-bits-checked', inc);
+			(e, fname + '-bits-checked', inc, b);
 
 		if (typeof lval === 'undefined')
 			return;
@@ -911,11 +1300,12 @@
 	 * @param cannull Whether the data may be null.
 	 * @param sub If the data object is a nested structure
 	 * interface, the allocated class of that interface.
+	 * @param b Binding of the root, if any.
 	 * @internal
 	 */
 	function _fillField(e: HTMLElement, strct: string, name: string,
 		custom: DataCallbacks|null, obj: any, inc: boolean,
-		cannull: boolean, sub: any): void
+		cannull: boolean, sub: any, b?: FillBinding|null): void
 	{
 		let i: number;
 		const fname: string = strct + '-' + name;
@@ -929,11 +1319,11 @@
 
 		if (cannull) {
 			if (obj === null) {
-				_hidecl(e, strct + '-has-' + name, inc);
-				_showcl(e, strct + '-no-' + name, inc);
+				_hidecl(e, strct + '-has-' + name, inc, b);
+				_showcl(e, strct + '-no-' + name, inc, b);
 			} else {
-				_showcl(e, strct + '-has-' + name, inc);
-				_hidecl(e, strct + '-no-' + name, inc);
+				_showcl(e, strct + '-has-' + name, inc, b);
+				_hidecl(e, strct + '-no-' + name, inc, b);
 			}
 		}
 
@@ -958,17 +1348,17 @@
 
 		if (sub !== null) {
 			const list: HTMLElement[] = 
-				_elemList(e, fname + '-obj', inc);
+				_elemList(e, fname + '-obj', inc, b);
 			for (i = 0; i < list.length; i++)
-				sub.fillInner(list[i], custom);
+				sub._fill(list[i], sub.obj, false, custom, b);
 		} else {
 			const list: HTMLElement[] = 
-				_elemList(e, fname + '-enum-select', inc);
+				_elemList(e, fname + '-enum-select', inc, b);
 			for (i = 0; i < list.length; i++)
-				_fillValueSelect(list[i], obj);
-			_replcl(e, fname + '-text', obj, inc);
-			_attrcl(e, 'value', fname + '-value', obj, inc);
-			_fillValueChecked(e, fname, obj, inc);
+				_fillValueSelect(list[i], obj, b);
+			_replcl(e, fname + '-text', obj, inc, b);
+			_attrcl(e, 'value', fname + '-value', obj, inc, b);
+			_fillValueChecked(e, fname, obj, inc, b);
 		}
 
 		/* Lastly, handle the custom callback. */
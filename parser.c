@@ -745,6 +745,8 @@ parse_root(struct parse *p)
 		else if (strcasecmp(p->last.string, "bits") == 0 ||
 		         strcasecmp(p->last.string, "bitfield") == 0)
 			parse_bitfield(p);
+		else if (strcasecmp(p->last.string, "database") == 0)
+			parse_database(p);
 		else
 			parse_errx(p, "unknown top-level type");
 	}
@@ -83,6 +83,7 @@ void		parse_warnx(struct parse *, const char *, ...)
 			__attribute__((format(printf, 2, 3)));
 
 void		parse_bitfield(struct parse *);
+void		parse_database(struct parse *);
 void		parse_enum(struct parse *);
 void		parse_field(struct parse *, struct strct *);
 void		parse_struct(struct parse *);
@@ -0,0 +1,192 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include "config.h"
+
+#if HAVE_SYS_QUEUE
+# include <sys/queue.h>
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ort.h"
+#include "extern.h"
+#include "parser.h"
+
+static	const char *const journals[JOURNAL__MAX] = {
+	NULL, /* JOURNAL_DEFAULT */
+	"delete", /* JOURNAL_DELETE */
+	"truncate", /* JOURNAL_TRUNCATE */
+	"persist", /* JOURNAL_PERSIST */
+	"memory", /* JOURNAL_MEMORY */
+	"wal", /* JOURNAL_WAL */
+	"off", /* JOURNAL_OFF */
+};
+
+static	const char *const syncs[SYNC__MAX] = {
+	NULL, /* SYNC_DEFAULT */
+	"off", /* SYNC_OFF */
+	"normal", /* SYNC_NORMAL */
+	"full", /* SYNC_FULL */
+	"extra", /* SYNC_EXTRA */
+};
+
+/*
+ * Parse a non-negative (unless "neg" is set) integer value for the
+ * setting "name" into "val", setting "flag" in the database flags.
+ * Return zero on failure, non-zero on success.
+ */
+static int
+parse_database_int(struct parse *p, struct database *db,
+	const char *name, int neg, int64_t *val, unsigned int flag)
+{
+
+	if (db->flags & flag) {
+		parse_errx(p, "%s already specified", name);
+		return 0;
+	} else if (parse_next(p) != TOK_INTEGER) {
+		parse_errx(p, "expected %s value", name);
+		return 0;
+	} else if (!neg && p->last.integer < 0) {
+		parse_errx(p, "%s may not be negative", name);
+		return 0;
+	}
+
+	*val = p->last.integer;
+	db->flags |= flag;
+	return 1;
+}
+
+/*
+ * Parse a single setting of the "database" block.
+ * Its syntax is:
+ *
+ *  "journal" journalmode ";"
+ *  "synchronous" synclevel ";"
+ *  "cachesize" integer ";"
+ *  "mmapsize" integer ";"
+ *  "busytimeout" integer ";"
+ *
+ * The identifier has already been parsed.
+ */
+static void
+parse_database_data(struct parse *p, struct database *db)
+{
+	size_t	 i;
+
+	if (strcasecmp(p->last.string, "journal") == 0) {
+		if (db->journal != JOURNAL_DEFAULT) {
+			parse_errx(p, "journal already specified");
+			return;
+		} else if (parse_next(p) != TOK_IDENT) {
+			parse_errx(p, "expected journal mode");
+			return;
+		}
+		for (i = 1; i < JOURNAL__MAX; i++)
+			if (strcasecmp(p->last.string, journals[i]) == 0)
+				break;
+		if (i == JOURNAL__MAX) {
+			parse_errx(p, "unknown journal mode");
+			return;
+		}
+		db->journal = i;
+	} else if (strcasecmp(p->last.string, "synchronous") == 0) {
+		if (db->sync != SYNC_DEFAULT) {
+			parse_errx(p, "synchronous already specified");
+			return;
+		} else if (parse_next(p) != TOK_IDENT) {
+			parse_errx(p, "expected synchronous level");
+			return;
+		}
+		for (i = 1; i < SYNC__MAX; i++)
+			if (strcasecmp(p->last.string, syncs[i]) == 0)
+				break;
+		if (i == SYNC__MAX) {
+			parse_errx(p, "unknown synchronous level");
+			return;
+		}
+		db->sync = i;
+	} else if (strcasecmp(p->last.string, "cachesize") == 0) {
+		if (!parse_database_int(p, db, "cachesize", 1,
+		    &db->cachesize, DATABASE_CACHESIZE))
+			return;
+	} else if (strcasecmp(p->last.string, "mmapsize") == 0) {
+		if (!parse_database_int(p, db, "mmapsize", 0,
+		    &db->mmapsize, DATABASE_MMAPSIZE))
+			return;
+	} else if (strcasecmp(p->last.string, "busytimeout") == 0) {
+		if (!parse_database_int(p, db, "busytimeout", 0,
+		    &db->busytimeout, DATABASE_BUSYTIMEOUT))
+			return;
+	} else {
+		parse_errx(p, "unknown database setting");
+		return;
+	}
+
+	if (parse_next(p) != TOK_SEMICOLON)
+		parse_errx(p, "expected semicolon");
+}
+
+/*
+ * Parse the database tuning block.
+ * This may only be specified once.
+ * See parse_database_data() for the DATA sequence.
+ * Its syntax is:
+ *
+ *  "database" "{" [ DATA ]* "}" ";"
+ */
+void
+parse_database(struct parse *p)
+{
+	struct database	*db;
+
+	if (p->cfg->db != NULL) {
+		parse_errx(p, "database already specified");
+		return;
+	}
+
+	if ((db = calloc(1, sizeof(struct database))) == NULL) {
+		parse_err(p);
+		return;
+	}
+	p->cfg->db = db;
+	parse_point(p, &db->pos);
+
+	if (parse_next(p) != TOK_LBRACE) {
+		parse_errx(p, "expected left brace");
+		return;
+	}
+
+	while (!PARSE_STOP(p)) {
+		if (parse_next(p) == TOK_RBRACE)
+			break;
+		if (p->lasttype != TOK_IDENT) {
+			parse_errx(p, "expected database setting");
+			return;
+		}
+		parse_database_data(p, db);
+	}
+
+	if (PARSE_STOP(p))
+		return;
+	if (parse_next(p) != TOK_SEMICOLON)
+		parse_errx(p, "expected semicolon");
+}
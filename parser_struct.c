@@ -44,6 +44,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	/* Unary types... */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
@@ -59,6 +60,11 @@ static	const char *const rolemapts[ROLEMAP__MAX] = {
 	"search", /* ROLEMAP_SEARCH */
 	"update", /* ROLEMAP_UPDATE */
 	"noexport", /* ROLEMAP_NOEXPORT */
+	"sum", /* ROLEMAP_SUM */
+	"avg", /* ROLEMAP_AVG */
+	"min", /* ROLEMAP_MIN */
+	"max", /* ROLEMAP_MAX */
+	"exists", /* ROLEMAP_EXISTS */
 };
 
 static	const char *const modtypes[MODTYPE__MAX] = {
@@ -505,6 +511,48 @@ parse_config_group_terms(struct parse *p, struct search *srch)
 		parse_err(p);
 }
 
+/*
+ * Parse the field by which count and aggregate queries are grouped.
+ * This must be a field in the query's structure.
+ *
+ *  field
+ */
+static void
+parse_config_groupby_term(struct parse *p, struct search *srch)
+{
+	struct resolve	*r;
+
+	if (srch->type != STYPE_COUNT && !STYPE_ISAGGR(srch->type)) {
+		parse_errx(p, "groupby only allowed in "
+			"count and aggregate queries");
+		return;
+	} else if (p->lasttype != TOK_IDENT) {
+		parse_errx(p, "expected groupby field");
+		return;
+	}
+
+	TAILQ_FOREACH(r, &p->cfg->priv->rq, entries)
+		if (r->type == RESOLVE_GROUPBY &&
+		    r->struct_groupby.result == srch) {
+			parse_errx(p, "duplicate groupby field");
+			return;
+		}
+
+	if ((r = calloc(1, sizeof(struct resolve))) == NULL) {
+		parse_err(p);
+		return;
+	}
+	TAILQ_INSERT_TAIL(&p->cfg->priv->rq, r, entries);
+	r->type = RESOLVE_GROUPBY;
+	r->struct_groupby.result = srch;
+	r->struct_groupby.name = strdup(p->last.string);
+	if (r->struct_groupby.name == NULL) {
+		parse_err(p);
+		return;
+	}
+	parse_next(p);
+}
+
 /*
  * Like parse_config_search_terms() but for order terms.
  *
@@ -743,10 +791,12 @@ parse_config_limit_params(struct parse *p, struct search *s)
  * Parse the search parameters following the search fields:
  *
  *   [ "name" name |
+ *     "cache" |
  *     "comment" quoted_string |
  *     "distinct" distinct_struct |
  *     "minrow"|"maxrow" aggr_fields ]* |
  *     "grouprow" group_fields |
+ *     "groupby" field |
  *     "order" order_fields ]* ";"
  */
 static void
@@ -786,6 +836,16 @@ parse_config_search_params(struct parse *p, struct search *s)
 			for (cp = s->name; *cp != '\0'; cp++)
 				*cp = tolower((unsigned char)*cp);
 			parse_next(p);
+		} else if (strcasecmp("cache", p->last.string) == 0) {
+			if (s->type == STYPE_ITERATE) {
+				parse_errx(p, "cache not "
+					"allowed for iterate");
+				break;
+			}
+			if (s->flags & SEARCH_CACHE)
+				parse_warnx(p, "redeclaring cache");
+			s->flags |= SEARCH_CACHE;
+			parse_next(p);
 		} else if (strcasecmp("comment", p->last.string) == 0) {
 			if (!parse_comment(p, &s->doc))
 				break;
@@ -809,6 +869,9 @@ parse_config_search_params(struct parse *p, struct search *s)
 		} else if (strcasecmp("grouprow", p->last.string) == 0) {
 			parse_next(p);
 			parse_config_group_terms(p, s);
+		} else if (strcasecmp("groupby", p->last.string) == 0) {
+			parse_next(p);
+			parse_config_groupby_term(p, s);
 		} else if (strcasecmp("distinct", p->last.string) == 0) {
 			parse_next(p);
 			parse_config_distinct_term(p, s);
@@ -903,12 +966,14 @@ parse_struct_unique(struct parse *p, struct strct *s)
  *
  *  "update" [ ufield [,ufield]* ]?
  *     [ ":" sfield [,sfield]*
- *       [ ":" [ "name" name | "comment" quot | "action" action ]* ]? 
+ *       [ ":" [ "name" name | "comment" quot | "action" action |
+ *               "returning" | "batch" integer ]* ]? 
  *     ]? ";"
  *
  * The fields ("ufield" for update field and "sfield" for select field)
  * are within the current structure.
- * The former are only for UPT_MODIFY parses.
+ * The former are only for UPT_MODIFY parses, as is "returning".
+ * The "batch" term is only for UPT_DELETE.
  * Note that "sfield" also contains an optional operator, just like in
  * the search parameters.
  */
@@ -1057,7 +1122,8 @@ crq:
 
 	/*
 	 * Lastly, process update terms.
-	 * This now consists of "name" and "comment".
+	 * This now consists of "name", "comment", "returning", and
+	 * "batch".
 	 */
 terms:
 	parse_next(p);
@@ -1086,6 +1152,27 @@ terms:
 		} else if (0 == strcasecmp(p->last.string, "comment")) {
 			if ( ! parse_comment(p, &up->doc))
 				return;
+		} else if (0 == strcasecmp(p->last.string, "returning")) {
+			if (up->type != UP_MODIFY) {
+				parse_errx(p, "returning "
+					"only allowed for updates");
+				return;
+			}
+			up->flags |= UPDATE_RETURNING;
+		} else if (0 == strcasecmp(p->last.string, "batch")) {
+			if (up->type != UP_DELETE) {
+				parse_errx(p, "batch "
+					"only allowed for deletes");
+				return;
+			} else if (TOK_INTEGER != parse_next(p)) {
+				parse_errx(p, "expected batch size");
+				return;
+			} else if (p->last.integer <= 0) {
+				parse_errx(p, "batch size "
+					"must be positive");
+				return;
+			}
+			up->batch = p->last.integer;
 		} else
 			parse_errx(p, "unknown term: %s", p->last.string);
 
@@ -1096,7 +1183,12 @@ terms:
 /*
  * Parse a search clause as follows:
  *
- *  ["search"|"list"|"iterate"|"count"] [ search_terms ]* 
+ *  ["search"|"list"|"iterate"|"count"|"exists"] [ search_terms ]* 
+ *  [":" search_params ]? ";"
+ *
+ * Aggregates also accept the aggregated field in the structure:
+ *
+ *  ["sum"|"avg"|"min"|"max"] field [ search_terms ]* 
  *  [":" search_params ]? ";"
  *
  * The optional terms (searchable field) parts are parsed in
@@ -1107,6 +1199,7 @@ static void
 parse_struct_search(struct parse *p, struct strct *s, enum stype stype)
 {
 	struct search	*srch;
+	struct resolve	*r;
 
 	if ((srch = calloc(1, sizeof(struct search))) == NULL) {
 		parse_err(p);
@@ -1120,6 +1213,25 @@ parse_struct_search(struct parse *p, struct strct *s, enum stype stype)
 	TAILQ_INIT(&srch->ordq);
 	TAILQ_INSERT_TAIL(&s->sq, srch, entries);
 
+	if (STYPE_ISAGGR(stype)) {
+		if (parse_next(p) != TOK_IDENT) {
+			parse_errx(p, "expected aggregate field");
+			return;
+		}
+		if ((r = calloc(1, sizeof(struct resolve))) == NULL) {
+			parse_err(p);
+			return;
+		}
+		TAILQ_INSERT_TAIL(&p->cfg->priv->rq, r, entries);
+		r->type = RESOLVE_AFIELD;
+		r->struct_afield.result = srch;
+		r->struct_afield.name = strdup(p->last.string);
+		if (r->struct_afield.name == NULL) {
+			parse_err(p);
+			return;
+		}
+	}
+
 	/*
 	 * If we have an identifier up next, then consider it the
 	 * prelude to a set of search terms.
@@ -1389,6 +1501,9 @@ parse_struct_comment(struct parse *p, struct strct *s)
 /*
  * Parse the insert statement of a struct until and including the
  * trailing semicolon.
+ * Its syntax is:
+ *
+ *  "insert" [ "returning" ]? ";"
  */
 static void
 parse_struct_insert(struct parse *p, struct strct *s)
@@ -1404,7 +1519,12 @@ parse_struct_insert(struct parse *p, struct strct *s)
 	}
 	s->ins->parent = s;
 	parse_point(p, &s->ins->pos);
-	if (parse_next(p) != TOK_SEMICOLON)
+	if (parse_next(p) == TOK_IDENT &&
+	    strcasecmp(p->last.string, "returning") == 0) {
+		s->ins->flags |= INSERT_RETURNING;
+		parse_next(p);
+	}
+	if (p->lasttype != TOK_SEMICOLON)
 		parse_errx(p, "expected semicolon");
 }
 
@@ -1435,6 +1555,16 @@ parse_struct_data(struct parse *p, struct strct *s)
 			parse_struct_search(p, s, STYPE_LIST);
 		else if (strcasecmp(p->last.string, "iterate") == 0)
 			parse_struct_search(p, s, STYPE_ITERATE);
+		else if (strcasecmp(p->last.string, "exists") == 0)
+			parse_struct_search(p, s, STYPE_EXISTS);
+		else if (strcasecmp(p->last.string, "sum") == 0)
+			parse_struct_search(p, s, STYPE_SUM);
+		else if (strcasecmp(p->last.string, "avg") == 0)
+			parse_struct_search(p, s, STYPE_AVG);
+		else if (strcasecmp(p->last.string, "min") == 0)
+			parse_struct_search(p, s, STYPE_MIN);
+		else if (strcasecmp(p->last.string, "max") == 0)
+			parse_struct_search(p, s, STYPE_MAX);
 		else if (strcasecmp(p->last.string, "update") == 0)
 			parse_struct_update(p, s, UP_MODIFY);
 		else if (strcasecmp(p->last.string, "delete") == 0)
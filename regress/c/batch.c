@@ -0,0 +1,92 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "batch.ort.h"
+
+/*
+ * Check that batched deletes remove all matching rows across several
+ * statements and return the total count.
+ */
+static int
+check(struct ort *ort)
+{
+	int64_t		 i;
+
+	for (i = 1; i <= 25; i++)
+		if (db_session_insert(ort, i) == -1)
+			return 0;
+
+	if (db_session_delete_purge(ort, 20) != 19)
+		return 0;
+	if (db_session_count(ort) != 6)
+		return 0;
+	if (db_session_delete_purge(ort, 20) != 0)
+		return 0;
+	if (db_session_delete(ort) != 6)
+		return 0;
+	return db_session_count(ort) == 0;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
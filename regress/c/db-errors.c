@@ -0,0 +1,198 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2025 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "db-errors.ort.h"
+
+static void
+count_cb(const struct user *p, void *arg)
+{
+
+	(*(size_t *)arg)++;
+}
+
+/*
+ * Successful calls, and constraint failures on insertion, must not
+ * record an error.
+ */
+static int
+check_ok(struct ort *ort)
+{
+	size_t		 n = 0;
+	struct user	*u;
+	struct user_q	*q;
+	int64_t		 id;
+
+	if (db_err(ort) != ORT_ERR_OK)
+		return 0;
+	if ((id = db_user_insert(ort, "foo")) == -1 ||
+	    db_err(ort) != ORT_ERR_OK)
+		return 0;
+	if (db_user_insert(ort, "foo") != -1 ||
+	    db_err(ort) != ORT_ERR_OK)
+		return 0;
+	if ((u = db_user_get_byid(ort, id)) == NULL)
+		return 0;
+	db_user_free(u);
+	if ((q = db_user_list_all(ort)) == NULL)
+		return 0;
+	db_user_freeq(q);
+	db_user_iterate_each(ort, count_cb, &n);
+	if (n != 1 || db_err(ort) != ORT_ERR_OK)
+		return 0;
+	if (db_user_count(ort) != 1)
+		return 0;
+	return db_err(ort) == ORT_ERR_OK;
+}
+
+/*
+ * Writing through a read-only context must fail and record the error
+ * instead of exiting.
+ */
+static int
+check_ro(const char *fname)
+{
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open_ro(fname)) == NULL)
+		return 0;
+	rc = db_user_count(ort) == 1 &&
+		db_err(ort) == ORT_ERR_OK &&
+		db_user_insert(ort, "bar") == -1 &&
+		db_err(ort) == ORT_ERR_DB;
+	db_close(ort);
+	return rc;
+}
+
+/*
+ * Closing a transaction that was never opened must fail and record
+ * the error instead of exiting.
+ */
+static int
+check_trans(const char *fname)
+{
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	db_trans_commit(ort, 1);
+	rc = db_err(ort) == ORT_ERR_DB;
+	db_close(ort);
+	return rc;
+}
+
+/*
+ * Milliseconds elapsed since "start".
+ */
+static long
+elapsed(const struct timespec *start)
+{
+	struct timespec	 now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000 +
+		(now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/*
+ * Failures that persist are retried with back-off (20, 40, then 80
+ * milliseconds) before being recorded, but not while a transaction is
+ * open.
+ */
+static int
+check_retry(const char *fname)
+{
+	struct ort	*ort;
+	struct timespec	 start;
+	int		 rc;
+
+	if ((ort = db_open_ro(fname)) == NULL)
+		return 0;
+	db_set_retry(ort, 3, 20);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	rc = db_user_insert(ort, "bar") == -1 &&
+		db_err(ort) == ORT_ERR_DB &&
+		elapsed(&start) >= 140;
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if ((ort = db_open_ro(fname)) == NULL)
+		return 0;
+	db_set_retry(ort, 1, 5000);
+	db_trans_open(ort, 1, 0);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	rc = db_err(ort) == ORT_ERR_OK &&
+		db_user_insert(ort, "bar") == -1 &&
+		db_err(ort) == ORT_ERR_DB &&
+		elapsed(&start) < 2500;
+	db_close(ort);
+	return rc;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check_ok(ort);
+	db_close(ort);
+	if (!rc || !check_ro(fname) || !check_trans(fname) ||
+	    !check_retry(fname))
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
@@ -0,0 +1,131 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "get-many.ort.h"
+
+/*
+ * Check that batched lookups return the matching rows ordered by value
+ * and that batched null references are filled for every result,
+ * including those sharing the same reference.
+ */
+static int
+check(struct ort *ort)
+{
+	struct company_q	*cq;
+	struct user_q		*uq;
+	struct company		*c;
+	struct user		*u;
+	int64_t			 c1, c2;
+	company_id		 ids[3];
+	const char		*names[2] = { "two", "none" };
+	size_t			 i;
+
+	if ((c1 = db_company_insert(ort, "one")) == -1 ||
+	    (c2 = db_company_insert(ort, "two")) == -1)
+		return 0;
+	if (db_user_insert(ort, &c2, "a@b.com") == -1 ||
+	    db_user_insert(ort, NULL, "b@b.com") == -1 ||
+	    db_user_insert(ort, &c1, "c@b.com") == -1 ||
+	    db_user_insert(ort, &c2, "d@b.com") == -1)
+		return 0;
+
+	ids[0] = c2;
+	ids[1] = c1 + c2;
+	ids[2] = c1;
+	cq = db_company_get_many_by_id(ort, ids, 3);
+	if ((c = TAILQ_FIRST(cq)) == NULL || c->id != c1 ||
+	    (c = TAILQ_NEXT(c, _entries)) == NULL || c->id != c2 ||
+	    TAILQ_NEXT(c, _entries) != NULL)
+		return 0;
+	db_company_freeq(cq);
+
+	cq = db_company_get_many_by_name(ort, names, 2);
+	if ((c = TAILQ_FIRST(cq)) == NULL || c->id != c2 ||
+	    TAILQ_NEXT(c, _entries) != NULL)
+		return 0;
+	db_company_freeq(cq);
+
+	cq = db_company_get_many_by_id(ort, NULL, 0);
+	if (!TAILQ_EMPTY(cq))
+		return 0;
+	db_company_freeq(cq);
+
+	i = 0;
+	uq = db_user_list(ort);
+	TAILQ_FOREACH(u, uq, _entries) {
+		if (u->has_cid != u->has_company)
+			return 0;
+		if (u->has_cid && u->company.id != u->cid)
+			return 0;
+		if (u->has_cid && strcmp(u->company.name,
+		    u->cid == c1 ? "one" : "two"))
+			return 0;
+		i++;
+	}
+	db_user_freeq(uq);
+	return i == 4;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
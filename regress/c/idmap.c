@@ -0,0 +1,140 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2025 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "idmap.ort.h"
+
+/*
+ * Make sure that all remaining results still have intact companies and
+ * countries, whose memory may be shared with results already freed.
+ */
+static int
+check_q(const struct user_q *q, size_t n)
+{
+	const struct user	*u;
+	size_t			 i = 0;
+
+	TAILQ_FOREACH(u, q, _entries) {
+		if (strcmp(u->company.country.name, "country"))
+			return 0;
+		if (u->company.id == 1 && strcmp(u->company.name, "foo"))
+			return 0;
+		if (u->company.id == 2 && strcmp(u->company.name, "bar"))
+			return 0;
+		i++;
+	}
+	return i == n;
+}
+
+/*
+ * Free the results in the order given by "order", checking the rest
+ * after each, then free the queue with whatever remains.
+ * The first result shares its company with later ones, and all share
+ * the same country.
+ */
+static int
+check_free(struct ort *ort, const size_t *order, size_t ordersz)
+{
+	struct user_q	*q;
+	struct user	*u;
+	size_t		 i, n;
+	int		 rc = 0;
+
+	if ((q = db_user_list_all(ort)) == NULL)
+		return 0;
+	if (!check_q(q, 5))
+		goto out;
+	for (n = 5, i = 0; i < ordersz; i++, n--) {
+		TAILQ_FOREACH(u, q, _entries)
+			if (u->id == (int64_t)order[i])
+				break;
+		if (u == NULL)
+			goto out;
+		TAILQ_REMOVE(q, u, _entries);
+		db_user_free(u);
+		if (!check_q(q, n - 1))
+			goto out;
+	}
+	rc = 1;
+out:
+	db_user_freeq(q);
+	return rc;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int64_t		 cnt, c1, c2;
+	int		 rc;
+	static const size_t first[] = { 1, 2 };
+	static const size_t middle[] = { 2, 4, 1 };
+	static const size_t all[] = { 5, 1, 3, 2, 4 };
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = (cnt = db_country_insert(ort, "country")) != -1 &&
+		(c1 = db_company_insert(ort, "foo", cnt)) != -1 &&
+		(c2 = db_company_insert(ort, "bar", cnt)) != -1 &&
+		db_user_insert(ort, "a", c1) != -1 &&
+		db_user_insert(ort, "b", c1) != -1 &&
+		db_user_insert(ort, "c", c2) != -1 &&
+		db_user_insert(ort, "d", c1) != -1 &&
+		db_user_insert(ort, "e", c2) != -1 &&
+		check_free(ort, NULL, 0) &&
+		check_free(ort, first, 2) &&
+		check_free(ort, middle, 3) &&
+		check_free(ort, all, 5);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
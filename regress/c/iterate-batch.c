@@ -0,0 +1,156 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "iterate-batch.ort.h"
+
+struct	batches {
+	size_t	 calls; /* number of callbacks */
+	size_t	 rows; /* total rows seen */
+	size_t	 max; /* largest batch */
+	size_t	 last; /* size of last batch */
+	int	 ok; /* rows seen in order */
+};
+
+static void
+batch_cb(const struct user *p, size_t sz, void *arg)
+{
+	struct batches	*b = arg;
+	size_t		 i;
+	char		 buf[32];
+
+	for (i = 0; i < sz; i++) {
+		snprintf(buf, sizeof(buf), "user%zu", b->rows + i);
+		if (strcmp(p[i].name, buf))
+			b->ok = 0;
+	}
+	b->calls++;
+	b->rows += sz;
+	b->last = sz;
+	if (sz > b->max)
+		b->max = sz;
+}
+
+static int
+check_batch(struct ort *ort, size_t n, 
+	size_t calls, size_t max, size_t last)
+{
+	struct batches	 b;
+
+	memset(&b, 0, sizeof(struct batches));
+	b.ok = 1;
+	db_user_iterate_batch_all(ort, batch_cb, &b, n);
+	return b.ok && b.rows == 7 && b.calls == calls &&
+		b.max == max && b.last == last;
+}
+
+static int
+check(struct ort *ort)
+{
+	size_t		 i;
+	char		 buf[32];
+	struct batches	 b;
+
+	for (i = 0; i < 7; i++) {
+		snprintf(buf, sizeof(buf), "user%zu", i);
+		if (db_user_insert(ort, buf) == -1)
+			return 0;
+	}
+
+	/* Full batches and a remainder. */
+
+	if (!check_batch(ort, 3, 3, 3, 1))
+		return 0;
+
+	/* Exactly filled batches. */
+
+	if (!check_batch(ort, 7, 1, 7, 7))
+		return 0;
+
+	/* A single batch larger than the result set. */
+
+	if (!check_batch(ort, 10, 1, 7, 7))
+		return 0;
+
+	/* A zero-sized batch is a batch of one. */
+
+	if (!check_batch(ort, 0, 7, 1, 1))
+		return 0;
+
+	/* Nothing to report: no callback. */
+
+	memset(&b, 0, sizeof(struct batches));
+	b.ok = 1;
+	db_user_iterate_batch_byname(ort, batch_cb, &b, 3, "nobody");
+	if (b.calls != 0)
+		return 0;
+
+	/* Parameters are bound. */
+
+	db_user_iterate_batch_byname(ort, batch_cb, &b, 3, "user0");
+	return b.ok && b.calls == 1 && b.rows == 1;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
@@ -0,0 +1,123 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2025 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "open-ro.ort.h"
+
+/*
+ * Run "op" on a read-only context in a child process.
+ * Without -e, a rejected statement exits, so the child must not exit
+ * successfully.
+ * Return zero on failure (the write was allowed), non-zero otherwise.
+ */
+static int
+check_write(const char *fname, int op, int64_t id)
+{
+	pid_t		 pid;
+	int		 st;
+	struct ort	*ort;
+
+	if ((pid = fork()) == -1)
+		return 0;
+	if (pid == 0) {
+		if ((ort = db_open_ro(fname)) == NULL)
+			_exit(EXIT_FAILURE);
+		if (op == 0)
+			db_user_insert(ort, "bar");
+		else if (op == 1)
+			db_user_update_byid(ort, "bar", id);
+		else
+			db_user_delete_byid(ort, id);
+		db_close(ort);
+		_exit(EXIT_SUCCESS);
+	}
+	if (waitpid(pid, &st, 0) == -1)
+		return 0;
+	return !WIFEXITED(st) || WEXITSTATUS(st) != EXIT_SUCCESS;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	struct user	*u;
+	int64_t		 id;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	id = db_user_insert(ort, "foo");
+	db_close(ort);
+	if (id == -1)
+		return 0;
+
+	if (!check_write(fname, 0, id) ||
+	    !check_write(fname, 1, id) ||
+	    !check_write(fname, 2, id))
+		return 0;
+
+	/* Reads still work and nothing was modified. */
+
+	if ((ort = db_open_ro(fname)) == NULL)
+		return 0;
+	rc = db_user_count(ort) == 1 &&
+		(u = db_user_get_byid(ort, id)) != NULL;
+	if (rc) {
+		rc = strcmp(u->name, "foo") == 0;
+		db_user_free(u);
+	}
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
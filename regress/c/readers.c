@@ -0,0 +1,130 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "readers.ort.h"
+
+static void
+count_cb(const struct user *p, void *arg)
+{
+
+	(*(size_t *)arg)++;
+}
+
+/*
+ * Queries cycle through the read-only sources, so repeat each one to 
+ * make sure all of them see the same data.
+ * Within a transaction, queries must see uncommitted changes.
+ */
+static int
+check(struct ort *ort)
+{
+	int64_t		 id;
+	size_t		 i, n;
+	struct user	*u;
+	struct user_q	*q;
+
+	if ((id = db_user_insert(ort, "foo")) == -1)
+		return 0;
+	if (db_user_insert(ort, "bar") == -1)
+		return 0;
+
+	for (i = 0; i < 4; i++) {
+		if (db_user_count(ort) != 2)
+			return 0;
+		if ((u = db_user_get_byid(ort, id)) == NULL)
+			return 0;
+		if (strcmp(u->name, "foo")) {
+			db_user_free(u);
+			return 0;
+		}
+		db_user_free(u);
+		if ((q = db_user_list_byname(ort, "bar")) == NULL)
+			return 0;
+		if (TAILQ_EMPTY(q)) {
+			db_user_freeq(q);
+			return 0;
+		}
+		db_user_freeq(q);
+		n = 0;
+		db_user_iterate_all(ort, count_cb, &n);
+		if (n != 2)
+			return 0;
+	}
+
+	db_trans_open(ort, 1, 1);
+	if (db_user_insert(ort, "baz") == -1)
+		return 0;
+	for (i = 0; i < 4; i++)
+		if (db_user_count(ort) != 3)
+			return 0;
+	db_trans_rollback(ort, 1);
+
+	for (i = 0; i < 4; i++)
+		if (db_user_count(ort) != 2)
+			return 0;
+	return 1;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
@@ -0,0 +1,129 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2021 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "returning.ort.h"
+
+/*
+ * Check that inserts and updates return the affected rows, with null
+ * references filled, and NULL on constraint violation.
+ */
+static int
+check(struct ort *ort)
+{
+	struct user_q	*uq;
+	struct user	*u, *uu;
+	int64_t		 c1, id;
+	user_visits	 one = 1;
+	size_t		 i;
+
+	if ((c1 = db_company_insert(ort, "one")) == -1)
+		return 0;
+
+	if ((u = db_user_insert(ort, &c1, "a@b.com", 0)) == NULL)
+		return 0;
+	if (u->id <= 0 || !u->has_company || 
+	    strcmp(u->company.name, "one") ||
+	    strcmp(u->email, "a@b.com"))
+		return 0;
+	id = u->id;
+	db_user_free(u);
+	if (db_user_insert(ort, NULL, "a@b.com", 0) != NULL)
+		return 0;
+	if ((uu = db_user_insert(ort, &c1, "b@b.com", 0)) == NULL)
+		return 0;
+
+	if ((uq = db_user_update_visits_inc_by_cid_eq
+	    (ort, one, c1)) == NULL)
+		return 0;
+	i = 0;
+	TAILQ_FOREACH(u, uq, _entries) {
+		if (u->visits != 1 || !u->has_company ||
+		    u->company.id != c1)
+			return 0;
+		i++;
+	}
+	db_user_freeq(uq);
+	if (i != 2)
+		return 0;
+
+	if ((uq = db_user_update_email(ort, "c@b.com", uu->id)) == NULL)
+		return 0;
+	if ((u = TAILQ_FIRST(uq)) == NULL || u->id != uu->id ||
+	    strcmp(u->email, "c@b.com") ||
+	    TAILQ_NEXT(u, _entries) != NULL)
+		return 0;
+	db_user_freeq(uq);
+
+	if (db_user_update_email(ort, "c@b.com", id) != NULL)
+		return 0;
+	if ((uq = db_user_update_email(ort, "d@b.com", -1)) == NULL ||
+	    !TAILQ_EMPTY(uq))
+		return 0;
+	db_user_freeq(uq);
+	db_user_free(uu);
+	return 1;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
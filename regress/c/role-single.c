@@ -0,0 +1,103 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2025 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "role-single.ort.h"
+
+/*
+ * Only the functions granted to "user" exist, and they're used without
+ * entering any role, as there's no run-time role state.
+ * Fields not exported to the role are still filled.
+ */
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct kjsonreq	 req;
+	struct ort	*ort;
+	struct item	*p;
+	int64_t		 id;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	if ((id = db_item_insert(ort, "foo", "bar")) == -1)
+		return 0;
+	if ((p = db_item_get_byid(ort, id)) == NULL)
+		return 0;
+	if (strcmp(p->name, "foo") || strcmp(p->secret, "bar"))
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_APP_JSON]);
+	khttp_body(&r);
+	kjson_open(&req, &r);
+	kjson_obj_open(&req);
+	json_item_data(&req, p);
+	kjson_close(&req);
+	khttp_free(&r);
+	db_item_free(p);
+	db_close(ort);
+	return 1;
+}
+
+/*
+ * Whether the quoted "key" appears in "buf" of length "sz".
+ */
+static int
+has_key(const char *buf, size_t sz, const char *key)
+{
+	size_t	 i, len = strlen(key);
+
+	for (i = 0; i + len + 2 <= sz; i++)
+		if (buf[i] == '"' && buf[i + len + 1] == '"' &&
+		    strncmp(&buf[i + 1], key, len) == 0)
+			return 1;
+	return 0;
+}
+
+/*
+ * The field not exported to the role is omitted from the output.
+ */
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	if (http != 200)
+		return 0;
+	return has_key(buf, sz, "name") && !has_key(buf, sz, "secret");
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
@@ -0,0 +1,147 @@
+/*	$Id$ */
+/*
+ * Copyright (c) 2025 Kristaps Dzonsons <kristaps@bsd.lv>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <kcgi.h>
+#include <kcgijson.h>
+#include <kcgiregress.h>
+
+#include "regress.h"
+#include "roles.ort.h"
+
+/*
+ * Run "op" in a child process, entering role "role" on a context
+ * opened read-write or, if "ro", read-only.
+ * Return zero if the child exited successfully, non-zero if it was
+ * stopped (i.e., the operation was denied).
+ */
+static int
+check_denied(const char *fname, int ro, enum ort_role role, int op)
+{
+	pid_t		 pid;
+	int		 st;
+	struct ort	*ort;
+
+	if ((pid = fork()) == -1)
+		return 0;
+	if (pid == 0) {
+		ort = ro ? db_open_ro(fname) : db_open(fname);
+		if (ort == NULL)
+			_exit(EXIT_SUCCESS);
+		db_role(ort, role);
+		if (op == 0)
+			db_item_insert(ort, "bar");
+		else if (op == 1)
+			db_role(ort, ROLE_admin);
+		else
+			db_item_count_total(ort);
+		db_close(ort);
+		_exit(EXIT_SUCCESS);
+	}
+	if (waitpid(pid, &st, 0) == -1)
+		return 0;
+	return !WIFEXITED(st) || WEXITSTATUS(st) != EXIT_SUCCESS;
+}
+
+static int
+check(struct ort *ort)
+{
+	struct item_q	*q;
+
+	if (db_role_current(ort) != ROLE_default)
+		return 0;
+	db_role(ort, ROLE_admin);
+	if (db_role_current(ort) != ROLE_admin)
+		return 0;
+	if (db_item_insert(ort, "foo") == -1)
+		return 0;
+
+	/* Statements of the parent role are inherited. */
+
+	if ((q = db_item_list_all(ort)) == NULL)
+		return 0;
+	if (TAILQ_EMPTY(q)) {
+		db_item_freeq(q);
+		return 0;
+	}
+	db_item_freeq(q);
+
+	/* Sub-roles may enter their parent roles. */
+
+	db_role(ort, ROLE_user);
+	if (db_role_current(ort) != ROLE_user)
+		return 0;
+	return db_item_count_total(ort) == 1;
+}
+
+static int
+server(const char *fname)
+{
+	struct kreq	 r;
+	struct ort	*ort;
+	int		 rc;
+
+	if ((ort = db_open(fname)) == NULL)
+		return 0;
+	rc = check(ort);
+	db_close(ort);
+	if (!rc)
+		return 0;
+
+	/* 
+	 * The user role may not insert, nor may the default role 
+	 * query, nor may roles enter their sub-roles.
+	 * Read-only contexts may not insert in any role.
+	 */
+
+	if (!check_denied(fname, 0, ROLE_user, 0) ||
+	    !check_denied(fname, 0, ROLE_default, 2) ||
+	    !check_denied(fname, 0, ROLE_user, 1) ||
+	    !check_denied(fname, 1, ROLE_admin, 0))
+		return 0;
+
+	if (khttp_parse(&r, NULL, 0, NULL, 0, 0) != KCGI_OK)
+		return 0;
+	khttp_head(&r, kresps[KRESP_STATUS], 
+		"%s", khttps[KHTTP_200]);
+	khttp_head(&r, kresps[KRESP_CONTENT_TYPE], 
+		"%s", kmimetypes[KMIME_TEXT_PLAIN]);
+	khttp_body(&r);
+	khttp_free(&r);
+	return 1;
+}
+
+static int
+client(long http, const char *buf, size_t sz)
+{
+
+	return http == 200;
+}
+
+int
+main(int argc, char *argv[])
+{
+
+	return regress(client, server, argc, argv);
+}
@@ -0,0 +1,81 @@
+/// <reference path="../../../node_modules/@types/node/index.d.ts" />
+
+/*
+ * Benchmark ortPrivate.ts's Long with and without native BigInt by
+ * parsing a large JSON response of 64-bit integers and bit-fields
+ * (encoded as strings), testing each bit as filled into checkboxes,
+ * and converting the integers back to strings.
+ */
+
+const ts = require('typescript');
+const fs = require('fs');
+
+const rows: number = 100000;
+const runs: number = 5;
+
+const output = ts.transpileModule(
+	'namespace ortJson {\n' + 
+	fs.readFileSync('ortPrivate.ts').toString() +
+	'}\n' +
+	'return ortJson;\n', {
+		compilerOptions: { alwaysStrict: true },
+	});
+const ortJson: any = new Function(output.outputText)();
+const Long: any = ortJson.Long;
+
+/* Digits for a random 64-bit value. */
+
+function digits(): string
+{
+	let s: string = String(Math.floor(Math.random() * 18) + 1);
+	while (s.length < 19)
+		s += String(Math.floor(Math.random() * 10));
+	return s;
+}
+
+function run(json: string): [number, number]
+{
+	const start: [number, number] = process.hrtime();
+	const objs: any[] = JSON.parse(json);
+	let sum: number = 0;
+	let i: number;
+	let bit: number;
+
+	for (i = 0; i < objs.length; i++) {
+		const id: any = Long.fromValue(objs[i].id);
+		const bits: any = Long.fromValue(objs[i].bits, true);
+		for (bit = 0; bit < 64; bit++)
+			if (!Long.ONE.shl(bit).and(bits).isZero())
+				sum += bit;
+		sum += id.toString().length;
+	}
+
+	const end: [number, number] = process.hrtime(start);
+
+	return [sum, end[0] * 1e3 + end[1] / 1e6];
+}
+
+const data: { id: string, bits: string }[] = [];
+for (let i: number = 0; i < rows; i++)
+	data.push({ id: (i % 2 ? '-' : '') + digits(), bits: digits() });
+const json: string = JSON.stringify(data);
+
+if (!Long.native)
+	console.log('native BigInt not available');
+
+let check: number|null = null;
+for (const native of Long.native ? [false, true] : [false]) {
+	let best: number = Infinity;
+	Long.native = native;
+	for (let i: number = 0; i < runs; i++) {
+		const res: [number, number] = run(json);
+		if (check !== null && res[0] !== check) {
+			console.log('results differ');
+			process.exit(1);
+		}
+		check = res[0];
+		best = Math.min(best, res[1]);
+	}
+	console.log((native ? 'native' : 'portable') + ': ' +
+		rows + ' rows: ' + best.toFixed(1) + ' ms');
+}
@@ -0,0 +1,26 @@
+function runTest(dom: HTMLDocument): HTMLDocument
+{
+	const data: ort.fooData = {
+		'barid': 2,
+		'bar': {
+			'name': 'barbaz',
+			'id': 2,
+		},
+		'name': 'foobar',
+		'id': 1,
+	};
+	const tmpl: HTMLElement|null = dom.getElementById('tmpl');
+	const e: HTMLElement|null = dom.getElementById('foo');
+
+	if (tmpl === null || e === null)
+		return dom;
+
+	const plan: ort.FillPlan = ort.foo.compile(tmpl);
+	const cln: HTMLElement = <HTMLElement>tmpl.cloneNode(true);
+
+	cln.removeAttribute('id');
+	e.appendChild(cln);
+	new ort.foo(data).fillCompiled(cln, plan);
+
+	return dom;
+}
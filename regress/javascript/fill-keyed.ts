@@ -0,0 +1,34 @@
+function runTest(dom: HTMLDocument): HTMLDocument
+{
+	const data: ort.fooData[] = [
+		{ 
+			'foo': 'foobar',
+			'id': 1,
+		}, { 
+			'foo': 'foobaz',
+			'id': 2,
+		}
+	];
+	const next: ort.fooData[] = [
+		{ 
+			'foo': 'foobarbaz',
+			'id': 3,
+		}, { 
+			'foo': 'foobaz2',
+			'id': 2,
+		}
+	];
+	const e: HTMLElement|null = dom.getElementById('foo');
+
+	if (e === null)
+		return dom;
+
+	new ort.foo(data).fillArrayKeyed(e);
+
+	/* Mark the row to be reused. */
+
+	(<HTMLElement>e.children[1]).setAttribute('data-old', 'yes');
+	new ort.foo(next).fillArrayKeyed(e);
+
+	return dom;
+}
@@ -0,0 +1,40 @@
+function runTest(dom: HTMLDocument): HTMLDocument
+{
+	const data: ort.aData[] = [
+		{ 
+			'bid': 1,
+			'b': { 'name': 'bfoo', 'id': 1 },
+			'name': 'afoo',
+			'id': 1,
+		}, { 
+			'bid': 2,
+			'b': { 'name': 'bbar', 'id': 2 },
+			'name': 'abar',
+			'id': 2,
+		}
+	];
+	const next: ort.aData[] = [
+		{ 
+			'bid': 3,
+			'b': { 'name': 'bbaz', 'id': 3 },
+			'name': 'abar',
+			'id': 2,
+		}
+	];
+	const e: HTMLElement|null = dom.getElementById('a');
+	const list: HTMLElement|null = dom.getElementById('list');
+
+	if (e === null || list === null)
+		return dom;
+
+	/*
+	 * The nested structure "b" has the same name as the class of
+	 * its structure, which the fill arguments mustn't shadow.
+	 */
+
+	new ort.a(data[0]).fill(e);
+	new ort.a(data).fillArrayKeyed(list);
+	new ort.a(next).fillArrayKeyed(list);
+
+	return dom;
+}
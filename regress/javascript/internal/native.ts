@@ -0,0 +1,51 @@
+/* 
+ * Parse and print with and without native BigInt, which must have
+ * the same results.  Without BigInt in the run-time, this only tests
+ * the portable implementation.
+ */
+
+const strs: string[] = [
+	'0', '1', '-1', '4294967295', '4294967296', '-4294967296',
+	'9223372036854775807', '-9223372036854775808',
+	'9223372036854775808', '18446744073709551615',
+	'18446744073709551617', '00012'
+];
+const native: boolean = ortJson.Long.native;
+
+for (let i: number = 0; i < strs.length * 2; i++) {
+	const usgn: boolean = i >= strs.length;
+	const str: string = strs[i % strs.length];
+
+	ortJson.Long.native = false;
+	const num1: ortJson.Long|null =
+		ortJson.Long.fromString(str, usgn);
+	if (num1 === null)
+		return false;
+	const str1: string = num1.toString();
+
+	ortJson.Long.native = native;
+	const num2: ortJson.Long|null =
+		ortJson.Long.fromString(str, usgn);
+	if (num2 === null)
+		return false;
+	if (!num1.eq(num2) || num2.toString() !== str1)
+		return false;
+
+	/* Round-trip. */
+
+	const num3: ortJson.Long|null =
+		ortJson.Long.fromString(str1, usgn);
+	if (num3 === null || !num3.eq(num2))
+		return false;
+}
+
+const num4: ortJson.Long|null =
+	ortJson.Long.fromString('-1', true);
+if (num4 === null || num4.toString() !== '18446744073709551615')
+	return false;
+
+if (ortJson.Long.fromString(' 1') !== null ||
+    ortJson.Long.fromString('--1') !== null)
+	return false;
+
+return true;
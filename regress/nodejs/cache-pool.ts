@@ -0,0 +1,34 @@
+const db: ortdb = ort(dbfile, 1);
+const ctx: ortctx = db.connect();
+
+const id: bigint = ctx.db_foo_insert(BigInt(1));
+if (id < 0)
+	return false;
+
+const val = async (async: boolean): Promise<bigint|null> => {
+	const obj: ortns.foo|null = async ?
+		await ctx.db_foo_get_byid_async(id) : ctx.db_foo_get_byid(id);
+	return obj === null ? null : obj.obj.val;
+};
+
+return (async (): Promise<boolean> => {
+	if (await val(true) !== BigInt(1))
+		return false;
+
+	/*
+	 * Within a transaction, the pool reads committed rows, while the
+	 * main connection reads the transaction's own changes: neither
+	 * may be handed the other's through the cache.
+	 */
+
+	ctx.db_trans_open_immediate(1);
+	if (!ctx.db_foo_update_val(BigInt(2), id))
+		return false;
+	if (await val(true) !== BigInt(1) || await val(false) !== BigInt(2))
+		return false;
+	if (await val(false) !== BigInt(2) || await val(true) !== BigInt(1))
+		return false;
+	ctx.db_trans_commit(1);
+
+	return await val(true) === BigInt(2) && await val(false) === BigInt(2);
+})();
@@ -0,0 +1,45 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+/*
+ * Objects are filled from fixed column offsets: our own columns, then
+ * those of each joined structure in turn, nested joins included.
+ */
+
+const fr: bigint = ctx.db_country_insert('France');
+const it: bigint = ctx.db_country_insert('Italy');
+const acme: bigint = ctx.db_company_insert('Acme', fr);
+const duff: bigint = ctx.db_company_insert('Duff', it);
+
+const u1: bigint = ctx.db_user_insert('alice', acme, it, null, 'a@x');
+const u2: bigint = ctx.db_user_insert('bob', duff, fr, acme, 'b@x');
+
+const check = (obj: ortns.userData, name: string, company: string,
+    country: string, home: string, backup: string|null,
+    email: string): boolean =>
+	obj.name === name &&
+	obj.company.name === company &&
+	obj.company.id === obj.cid &&
+	obj.company.ctry === obj.company.country.id &&
+	obj.company.country.name === country &&
+	obj.home.id === obj.hid &&
+	obj.home.name === home &&
+	(backup === null ? obj.backup === null && obj.bid === null :
+	 obj.backup !== null && obj.backup.id === obj.bid &&
+	 obj.backup.name === backup &&
+	 obj.backup.country.name === 'France') &&
+	obj.email === email;
+
+const a: ortns.user|null = ctx.db_user_get_byid(u1);
+if (a === null || a.obj.id !== u1 ||
+    !check(a.obj, 'alice', 'Acme', 'France', 'Italy', null, 'a@x'))
+	return false;
+const b: ortns.user|null = ctx.db_user_get_byid(u2);
+if (b === null || b.obj.id !== u2 ||
+    !check(b.obj, 'bob', 'Duff', 'Italy', 'France', 'Acme', 'b@x'))
+	return false;
+
+const all: ortns.user[] = ctx.db_user_list_all();
+return all.length === 2 &&
+	check(all[0].obj, 'alice', 'Acme', 'France', 'Italy', null, 'a@x') &&
+	check(all[1].obj, 'bob', 'Duff', 'Italy', 'France', 'Acme', 'b@x');
@@ -0,0 +1,40 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+for (const name of ['a', 'b', 'c'])
+	if (ctx.db_item_insert(name) < 0)
+		return false;
+
+return (async (): Promise<boolean> => {
+	/*
+	 * The read-only connection has the busy timeout of the database
+	 * block, so it waits that long on an exclusive lock.
+	 */
+
+	const start: number = Date.now();
+	let busy: boolean = false;
+	let n: number = 0;
+	db.db.exec('BEGIN EXCLUSIVE');
+	try {
+		for await (const obj of ctx.db_item_iterate_all_async())
+			n += obj.obj.name.length;
+	} catch (error) {
+		busy = true;
+	}
+	db.db.exec('ROLLBACK');
+	if (!busy || n !== 0 || Date.now() - start < 250)
+		return false;
+
+	/*
+	 * The role is checked when the iterator is created, so it may
+	 * be consumed after moving to a role without the query.
+	 */
+
+	const iter: AsyncIterableIterator<ortns.item> =
+		ctx.db_item_iterate_all_async();
+	ctx.db_role('user');
+	const names: string[] = [];
+	for await (const obj of iter)
+		names.push(obj.obj.name);
+	return names.join() === 'a,b,c';
+})();
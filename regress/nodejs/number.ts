@@ -0,0 +1,46 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+/*
+ * Integers provably within 53 bits are numbers; the rest, along with
+ * row identifiers, are bigint.
+ */
+
+const id: bigint = ctx.db_foo_insert(-100, null, BigInt(1) << BigInt(60),
+	(1 << 0) + 2 ** 52, BigInt(1) << BigInt(63), 5);
+if (id < 0)
+	return false;
+if (ctx.db_foo_insert(100, -9, BigInt(0), 2 ** 52, BigInt(1), 0) < 0)
+	return false;
+
+const obj: ortns.foo|null = ctx.db_foo_get_byid(id);
+if (obj === null)
+	return false;
+if (typeof obj.obj.a !== 'number' || obj.obj.a !== -100)
+	return false;
+if (obj.obj.b !== null)
+	return false;
+if (typeof obj.obj.c !== 'bigint' ||
+    obj.obj.c !== BigInt(1) << BigInt(60))
+	return false;
+if (typeof obj.obj.d !== 'number' || obj.obj.d !== 1 + 2 ** 52)
+	return false;
+if (typeof obj.obj.e !== 'bigint' || 
+    BigInt.asUintN(64, obj.obj.e) !== BigInt(1) << BigInt(63))
+	return false;
+if (typeof obj.obj.f !== 'number' || obj.obj.f !== 5)
+	return false;
+if (typeof obj.obj.id !== 'bigint')
+	return false;
+
+/* Numbers are also used as query parameters. */
+
+const bya: ortns.foo|null = ctx.db_foo_get_bya(100);
+if (bya === null || bya.obj.b !== -9)
+	return false;
+
+const q: ortns.foo[] = ctx.db_foo_list_bybits(2 ** 52);
+if (q.length !== 2)
+	return false;
+
+return true;
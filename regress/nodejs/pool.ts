@@ -0,0 +1,71 @@
+const db: ortdb = ort(dbfile, 2);
+const ctx: ortctx = db.connect();
+const blob: Buffer = Buffer.from([0, 1, 2, 255]);
+
+for (let i: number = 0; i < 5; i++)
+	if (ctx.db_item_insert('item' + i, i === 0 ? blob : null) < 0)
+		return false;
+
+return (async (): Promise<boolean> => {
+	/* Queries are run by the workers, several at once. */
+
+	const [obj, all, total] = await Promise.all([
+		ctx.db_item_get_byid_async(BigInt(1)),
+		ctx.db_item_list_all_async(),
+		ctx.db_item_count_total_async(),
+	]);
+	if (obj === null || obj.obj.name !== 'item0')
+		return false;
+	if (!Buffer.isBuffer(obj.obj.data) || !blob.equals(obj.obj.data))
+		return false;
+	if (all.length !== 5 || total !== BigInt(5))
+		return false;
+
+	/* Rows are passed in batches smaller than the results. */
+
+	const names: string[] = [];
+	for await (const obj of ctx.db_item_iterate_each_async(2))
+		names.push(obj.obj.name);
+	if (names.join() !== 'item0,item1,item2,item3,item4')
+		return false;
+
+	/*
+	 * An iterator left early gives its worker back, so there are
+	 * still two for these.
+	 */
+
+	for await (const obj of ctx.db_item_iterate_each_async(2))
+		if (obj.obj.name === 'item1')
+			break;
+	const counts: bigint[] = await Promise.all([
+		ctx.db_item_count_total_async(),
+		ctx.db_item_count_total_async(),
+		ctx.db_item_count_total_async(),
+	]);
+	if (counts.some(n => n !== BigInt(5)))
+		return false;
+
+	/*
+	 * Closing with queries running and waiting: the running ones
+	 * may fail with their workers, but those waiting run on the main
+	 * connection.  After this, queries run there too.
+	 */
+
+	const running: Promise<bigint>[] = [];
+	for (let i: number = 0; i < 4; i++)
+		running.push(ctx.db_item_count_total_async());
+	const closing: Promise<PromiseSettledResult<bigint>[]> =
+		Promise.allSettled(running);
+	await db.pool.close();
+	const settled: PromiseSettledResult<bigint>[] = await closing;
+	if (settled.slice(2).some(r =>
+	    r.status !== 'fulfilled' || r.value !== BigInt(5)))
+		return false;
+
+	if (await ctx.db_item_count_total_async() !== BigInt(5))
+		return false;
+	const rest: string[] = [];
+	for await (const obj of ctx.db_item_iterate_each_async(2))
+		rest.push(obj.obj.name);
+	return rest.length === 5;
+})();
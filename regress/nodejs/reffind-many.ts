@@ -0,0 +1,49 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+/*
+ * Null references looked up for a whole list at once: text keys must
+ * be quoted (and escaped) in the bound set, real keys have no batched
+ * query so are looked up one by one.
+ */
+
+const c1: bigint = ctx.db_company_insert('a, "quoted" name', 1.5);
+const c2: bigint = ctx.db_company_insert('[b]', 2.5);
+if (c1 < 0 || c2 < 0)
+	return false;
+
+if (ctx.db_user_insert('a, "quoted" name', 1.5, c1) < 0)
+	return false;
+if (ctx.db_user_insert('[b]', 2.5, c2) < 0)
+	return false;
+if (ctx.db_user_insert('a, "quoted" name', 2.5, null) < 0)
+	return false;
+if (ctx.db_user_insert(null, null, c1) < 0)
+	return false;
+
+const list: ortns.user[] = ctx.db_user_list_all();
+if (list.length !== 4)
+	return false;
+
+const u1: ortns.userData = list[0].obj;
+const u2: ortns.userData = list[1].obj;
+const u3: ortns.userData = list[2].obj;
+const u4: ortns.userData = list[3].obj;
+
+if (u1.cn === null || u1.cn.id !== c1 ||
+    u1.cr === null || u1.cr.id !== c1 ||
+    u1.c === null || u1.c.id !== c1)
+	return false;
+if (u2.cn === null || u2.cn.name !== '[b]' ||
+    u2.cr === null || u2.cr.id !== c2 ||
+    u2.c === null || u2.c.id !== c2)
+	return false;
+if (u3.cn === null || u3.cn.id !== c1 ||
+    u3.cr === null || u3.cr.rate !== 2.5 ||
+    u3.c !== null)
+	return false;
+if (u4.cn !== null || u4.cr !== null ||
+    u4.c === null || u4.c.id !== c1)
+	return false;
+
+return true;
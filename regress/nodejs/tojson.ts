@@ -0,0 +1,38 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+const b1: bigint = ctx.db_bar_insert(Buffer.from('abc'), 'a"b\n ', 'x');
+const b2: bigint = ctx.db_bar_insert(null, '', 'y');
+if (b1 < 0 || b2 < 0)
+	return false;
+
+if (ctx.db_foo_insert(b1, null, 'p', 1.5, ortns.enm.a, null) < 0)
+	return false;
+if (ctx.db_foo_insert(b2, b1, 'p', -2, ortns.enm.b, BigInt(10)) < 0)
+	return false;
+
+const objs: ortns.foo[] = ctx.db_foo_list_all();
+if (objs.length !== 2)
+	return false;
+
+for (let i: number = 0; i < objs.length; i++)
+	if (objs[i].toJSONString() !== JSON.stringify(objs[i].export()))
+		return false;
+
+const exp: string = JSON.stringify(objs.map(o => o.export()));
+if (ortns.foo.toJSONArrayString(objs) !== exp)
+	return false;
+if (ortns.foo.toJSONArrayString([]) !== '[]')
+	return false;
+
+let out: string = '';
+ortns.foo.writeJSONArray({ write: (s: string) => out += s }, objs);
+if (out !== exp)
+	return false;
+
+out = '';
+objs[0].writeJSON({ write: (s: string) => out += s });
+if (out !== JSON.stringify(objs[0].export()))
+	return false;
+
+return true;
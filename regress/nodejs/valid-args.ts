@@ -0,0 +1,58 @@
+const db: ortdb = ort(dbfile);
+const ctx: ortctx = db.connect();
+
+const ins: [string, number|null, bigint, ortns.baz, bigint]|null =
+	ortvalid.db_foo_insert({
+		'foo-mail': ' hello@hello.com ',
+		'foo-num': '12',
+		'foo-bz': '2',
+		'foo-dt': '2020-01-01',
+	});
+if (ins === null)
+	return false;
+if (ins[0] !== 'hello@hello.com' || ins[1] !== null ||
+    ins[2] !== BigInt(12) || ins[3] !== ortns.baz.b ||
+    ins[4] !== BigInt(1577836800))
+	return false;
+if (ctx.db_foo_insert(...ins) < 0)
+	return false;
+
+if (ortvalid.db_foo_insert({ 'foo-mail': 'hello@hello.com',
+    'foo-num': '0x12', 'foo-bz': '2', 'foo-dt': '2020-01-01' }) !== null)
+	return false;
+if (ortvalid.db_foo_insert({ 'foo-mail': 'hello@hello.com',
+    'foo-num': '12', 'foo-bz': '3', 'foo-dt': '2020-01-01' }) !== null)
+	return false;
+if (ortvalid.db_foo_insert({ 'foo-mail': 'hello@hello.com',
+    'foo-num': '12', 'foo-bz': '2', 'foo-dt': '2021-02-29' }) !== null)
+	return false;
+if (ortvalid.db_foo_insert({ 'foo-mail': 'hello@hello.com',
+    'foo-rl': '1.', 'foo-num': '12', 'foo-bz': '2',
+    'foo-dt': '2020-01-01' }) !== null)
+	return false;
+if (ortvalid.db_foo_insert({ 'foo-mail': 'hello@hello.com',
+    'foo-num': '12', 'foo-bz': '2' }) !== null)
+	return false;
+
+const up: [bigint, bigint]|null =
+	ortvalid.db_foo_update_num_set_by_num_eq
+		({ 'foo-num': '13', 'foo-num-2': '12' });
+if (up === null || up[0] !== BigInt(13) || up[1] !== BigInt(12))
+	return false;
+if (!ctx.db_foo_update_num_set_by_num_eq(...up))
+	return false;
+
+const lst: [ortns.baz[]]|null =
+	ortvalid.db_foo_list_bzs({ 'foo-bz': [ '1', '2' ] });
+if (lst === null || lst[0].length !== 2)
+	return false;
+if (ctx.db_foo_list_bzs(...lst).length !== 1)
+	return false;
+if (ortvalid.db_foo_list_bzs({ 'foo-bz': '2' }) === null)
+	return false;
+if (ortvalid.db_foo_list_bzs({ 'foo-bz': [ '2', 'c' ] }) !== null)
+	return false;
+if (ortvalid.db_foo_list_bzs({}) !== null)
+	return false;
+
+return true;
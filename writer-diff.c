@@ -81,6 +81,7 @@ static	const char *difftypes[DIFF__MAX] = {
 	"type", /* DIFF_MOD_FIELD_TYPE */
 	"valids", /* DIFF_MOD_FIELD_VALIDS */
 	NULL, /* DIFF_MOD_INSERT */
+	"flags", /* DIFF_MOD_INSERT_FLAGS */
 	"params", /* DIFF_MOD_INSERT_PARAMS */
 	"rolemap", /* DIFF_MOD_INSERT_ROLEMAP */
 	NULL, /* DIFF_MOD_ROLE */
@@ -92,7 +93,10 @@ static	const char *difftypes[DIFF__MAX] = {
 	"aggr", /* DIFF_MOD_SEARCH_AGGR */
 	"comment", /* DIFF_MOD_SEARCH_COMMENT */
 	"distinct", /* DIFF_MOD_SEARCH_DISTINCT */
+	"field", /* DIFF_MOD_SEARCH_FIELD */
+	"flags", /* DIFF_MOD_SEARCH_FLAGS */
 	"group", /* DIFF_MOD_SEARCH_GROUP */
+	"groupby", /* DIFF_MOD_SEARCH_GROUPBY */
 	"limit", /* DIFF_MOD_SEARCH_LIMIT */
 	"offset", /* DIFF_MOD_SEARCH_OFFSET */
 	"order", /* DIFF_MOD_SEARCH_ORDER */
@@ -101,6 +105,7 @@ static	const char *difftypes[DIFF__MAX] = {
 	NULL, /* DIFF_MOD_STRCT */
 	NULL, /* DIFF_MOD_STRCT_COMMENT */
 	NULL, /* DIFF_MOD_UPDATE */
+	"batch", /* DIFF_MOD_UPDATE_BATCH */
 	"comment", /* DIFF_MOD_UPDATE_COMMENT */
 	"flags", /* DIFF_MOD_UPDATE_FLAGS */
 	"params", /* DIFF_MOD_UPDATE_PARAMS */
@@ -448,6 +453,7 @@ ort_write_diff_update(FILE *f, const struct diffq *q, const struct diff *d)
 
 	TAILQ_FOREACH(dd, q, entries)
 		switch (dd->type) {
+		case DIFF_MOD_UPDATE_BATCH:
 		case DIFF_MOD_UPDATE_COMMENT:
 		case DIFF_MOD_UPDATE_FLAGS:
 		case DIFF_MOD_UPDATE_PARAMS:
@@ -487,6 +493,7 @@ ort_write_diff_insert(FILE *f, const struct diffq *q, const struct diff *d)
 	TAILQ_FOREACH(dd, q, entries) {
 		rc = 1;
 		switch (dd->type) {
+		case DIFF_MOD_INSERT_FLAGS:
 		case DIFF_MOD_INSERT_PARAMS:
 		case DIFF_MOD_INSERT_ROLEMAP:
 			if (dd->strct_pair.into != 
@@ -526,7 +533,10 @@ ort_write_diff_search(FILE *f,
 		case DIFF_MOD_SEARCH_AGGR:
 		case DIFF_MOD_SEARCH_COMMENT:
 		case DIFF_MOD_SEARCH_DISTINCT:
+		case DIFF_MOD_SEARCH_FIELD:
+		case DIFF_MOD_SEARCH_FLAGS:
 		case DIFF_MOD_SEARCH_GROUP:
+		case DIFF_MOD_SEARCH_GROUPBY:
 		case DIFF_MOD_SEARCH_LIMIT:
 		case DIFF_MOD_SEARCH_OFFSET:
 		case DIFF_MOD_SEARCH_ORDER:
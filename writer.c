@@ -35,6 +35,11 @@ static	const char *const stypes[STYPE__MAX] = {
 	"search", /* STYPE_SEARCH */
 	"list", /* STYPE_LIST */
 	"iterate", /* STYPE_ITERATE */
+	"exists", /* STYPE_EXISTS */
+	"sum", /* STYPE_SUM */
+	"avg", /* STYPE_AVG */
+	"min", /* STYPE_MIN */
+	"max", /* STYPE_MAX */
 };
 
 static	const char *const upts[UP__MAX] = {
@@ -93,6 +98,7 @@ static	const char *const optypes[OPTYPE__MAX] = {
 	"or", /* OPTYPE_OR */
 	"streq", /* OPTYPE_STREQ */
 	"strneq", /* OPTYPE_STRNEQ */
+	"in", /* OPTYPE_IN */
 	/* Unary types... */
 	"isnull", /* OPTYPE_ISNULL */
 	"notnull", /* OPTYPE_NOTNULL */
@@ -108,6 +114,29 @@ static	const char *const rolemapts[ROLEMAP__MAX] = {
 	"search", /* ROLEMAP_SEARCH */
 	"update", /* ROLEMAP_UPDATE */
 	"noexport", /* ROLEMAP_NOEXPORT */
+	"sum", /* ROLEMAP_SUM */
+	"avg", /* ROLEMAP_AVG */
+	"min", /* ROLEMAP_MIN */
+	"max", /* ROLEMAP_MAX */
+	"exists", /* ROLEMAP_EXISTS */
+};
+
+static	const char *const journals[JOURNAL__MAX] = {
+	NULL, /* JOURNAL_DEFAULT */
+	"delete", /* JOURNAL_DELETE */
+	"truncate", /* JOURNAL_TRUNCATE */
+	"persist", /* JOURNAL_PERSIST */
+	"memory", /* JOURNAL_MEMORY */
+	"wal", /* JOURNAL_WAL */
+	"off", /* JOURNAL_OFF */
+};
+
+static	const char *const syncs[SYNC__MAX] = {
+	NULL, /* SYNC_DEFAULT */
+	"off", /* SYNC_OFF */
+	"normal", /* SYNC_NORMAL */
+	"full", /* SYNC_FULL */
+	"extra", /* SYNC_EXTRA */
 };
 
 struct	writer {
@@ -354,8 +383,8 @@ parse_write_modify(struct writer *w, const struct update *p)
 		}
 	}
 
-	if (TAILQ_EMPTY(&p->crq) &&
-	    p->name == NULL && p->doc == NULL)
+	if (TAILQ_EMPTY(&p->crq) && p->name == NULL && p->doc == NULL &&
+	    !(p->flags & UPDATE_RETURNING) && p->batch == 0)
 		return wputs(w, ";\n");
 
 	if (p->type == UP_MODIFY && !wputc(w, ':'))
@@ -375,12 +404,19 @@ parse_write_modify(struct writer *w, const struct update *p)
 
 	/* Trailing data (optional). */
 
-	if (p->name != NULL || p->doc != NULL) {
+	if (p->name != NULL || p->doc != NULL ||
+	    (p->flags & UPDATE_RETURNING) || p->batch > 0) {
 		if (!wputc(w, ':'))
 			return 0;
 		if (p->name != NULL && 
 		    !wprint(w, " name %s", p->name))
 			return 0;
+		if ((p->flags & UPDATE_RETURNING) &&
+		    !wputs(w, " returning"))
+			return 0;
+		if (p->batch > 0 &&
+		    !wprint(w, " batch %" PRId64, p->batch))
+			return 0;
 		if (!parse_write_comment(w, p->doc, 2))
 			return 0;
 	}
@@ -424,6 +460,12 @@ parse_write_query(struct writer *w, const struct search *p)
 	if (!wprint(w, "\t%s", stypes[p->type]))
 		return 0;
 
+	/* Aggregated field, if applicable. */
+
+	if (p->afield != NULL &&
+	    !wprint(w, " %s", p->afield->name))
+		return 0;
+
 	/* Search reference queue. */
 
 	nf = 0;
@@ -487,6 +529,14 @@ parse_write_query(struct writer *w, const struct search *p)
 		colon = 1;
 	}
 
+	if (p->groupby != NULL) {
+		if (!colon && !wputc(w, ':'))
+			return 0;
+		if (!wprint(w, " groupby %s", p->groupby->name))
+			return 0;
+		colon = 1;
+	}
+
 	/* Distinct selection. */
 
 	if (p->dst != NULL) {
@@ -498,6 +548,16 @@ parse_write_query(struct writer *w, const struct search *p)
 		colon = 1;
 	}
 
+	/* Result caching. */
+
+	if (p->flags & SEARCH_CACHE) {
+		if (!colon && !wputc(w, ':'))
+			return 0;
+		if (!wputs(w, " cache"))
+			return 0;
+		colon = 1;
+	}
+
 	/* Comments. */
 
 	if (p->doc != NULL) {
@@ -532,10 +592,15 @@ parse_write_rolemap(struct writer *w, const struct rolemap *p)
 	if (!wprint(w, " { %s", rolemapts[p->type]))
 		return 0;
 	switch (p->type) {
+	case ROLEMAP_AVG:
 	case ROLEMAP_COUNT:
+	case ROLEMAP_EXISTS:
 	case ROLEMAP_ITERATE:
 	case ROLEMAP_LIST:
+	case ROLEMAP_MAX:
+	case ROLEMAP_MIN:
 	case ROLEMAP_SEARCH:
+	case ROLEMAP_SUM:
 		if (p->s != NULL && !wprint(w, " %s", p->s->name))
 			return 0;
 		break;
@@ -583,7 +648,8 @@ parse_write_strct(struct writer *w, const struct strct *p)
 	TAILQ_FOREACH(u, &p->dq, entries)
 		if (!parse_write_modify(w, u))
 			return 0;
-	if (p->ins != NULL && !wputs(w, "\tinsert;\n"))
+	if (p->ins != NULL && !wprint(w, "\tinsert%s;\n",
+	    (p->ins->flags & INSERT_RETURNING) ? " returning" : ""))
 		return 0;
 	TAILQ_FOREACH(n, &p->nq, entries)
 		if (!parse_write_unique(w, n))
@@ -816,6 +882,34 @@ parse_write_roles(struct writer *w, const struct config *cfg)
 	return wputs(w, "};\n\n");
 }
 
+/*
+ * Write the top-level database tuning block.
+ * Returns zero on failure (memory), non-zero otherwise.
+ */
+static int
+parse_write_database(struct writer *w, const struct database *db)
+{
+
+	if (!wputs(w, "database {\n"))
+		return 0;
+	if (db->journal != JOURNAL_DEFAULT &&
+	    !wprint(w, "\tjournal %s;\n", journals[db->journal]))
+		return 0;
+	if (db->sync != SYNC_DEFAULT &&
+	    !wprint(w, "\tsynchronous %s;\n", syncs[db->sync]))
+		return 0;
+	if ((db->flags & DATABASE_CACHESIZE) &&
+	    !wprint(w, "\tcachesize %" PRId64 ";\n", db->cachesize))
+		return 0;
+	if ((db->flags & DATABASE_MMAPSIZE) &&
+	    !wprint(w, "\tmmapsize %" PRId64 ";\n", db->mmapsize))
+		return 0;
+	if ((db->flags & DATABASE_BUSYTIMEOUT) &&
+	    !wprint(w, "\tbusytimeout %" PRId64 ";\n", db->busytimeout))
+		return 0;
+	return wputs(w, "};\n\n");
+}
+
 int
 ort_write_file(FILE *f, const struct config *cfg)
 {
@@ -827,6 +921,8 @@ ort_write_file(FILE *f, const struct config *cfg)
 	memset(&w, 0, sizeof(struct writer));
 	w.f = f;
 
+	if (cfg->db != NULL && !parse_write_database(&w, cfg->db))
+		return 0;
 	if (!TAILQ_EMPTY(&cfg->rq))
 		if (!parse_write_roles(&w, cfg))
 			return 0;